@@ -0,0 +1,734 @@
+// ============================================================================
+// joy_bench - Kernel Microbenchmarks and End-to-End Pipeline Benchmarks
+// ============================================================================
+// Kernel suite: every vec_* kernel, the batch interpreter and the row
+// interpreter (VM::eval_expr), across input sizes and NULL densities
+// Pipeline suite: scan -> filter -> transform -> write over generated files
+//
+// Results print as a table, or as CSV / JSON (--format) for tracking
+// regressions between releases. Timings are the best and median of repeated
+// runs; each case repeats until --min-time seconds have passed.
+//
+// Examples:
+//   joy_bench --suite kernels --sizes 65536,1048576 --nulls 0,0.5
+//   joy_bench --suite pipelines --rows 10000000 --format json --output bench.json
+//   joy_bench --generate data.csv --rows 1000000 --columns "id:int:seq,dept:string:20"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "batch_interpreter.hpp"
+#include "binder.hpp"
+#include "compiler.hpp"
+#include "file_format.hpp"
+#include "lexer.hpp"
+#include "optimizer.hpp"
+#include "parser.hpp"
+#include "simd_kernels.hpp"
+#include "vectorized_ops.hpp"
+#include "vm.hpp"
+
+using namespace joy;
+
+namespace {
+
+// ============================================================================
+// Options
+// ============================================================================
+
+struct BenchOptions {
+    bool kernels = true;
+    bool pipelines = true;
+    std::vector<size_t> sizes = {1 << 10, 1 << 16, 1 << 20};  // Kernel input rows
+    std::vector<double> null_densities = {0.0, 0.1, 0.5};
+    std::vector<size_t> pipeline_rows = {1000000};
+    std::vector<std::string> formats = {"csv"};  // Pipeline input formats
+    std::string columns = "id:int:seq,age:int:80,dept:string:20,name:string:100000,"
+                          "salary:double:0:0.01,score:double,active:bool";
+    std::string filter;  // Only cases whose name contains this
+    std::string format = "text";
+    std::string output;  // Results file (default: stdout)
+    std::string dir = (std::filesystem::temp_directory_path() / "joy_bench").string();
+    std::string generate;  // --generate: write one data file and exit
+    double min_time = 0.2;
+    size_t repeat = 3;  // Pipeline runs per case
+    size_t threads = 0;
+    uint64_t seed = 42;
+};
+
+void print_usage() {
+    std::cerr
+        << "Usage: joy_bench [options]\n"
+           "  --suite kernels|pipelines|all  Benchmarks to run (default all)\n"
+           "  --sizes N,...                  Kernel input rows (default 1024,65536,1048576)\n"
+           "  --nulls F,...                  Kernel NULL densities (default 0,0.1,0.5)\n"
+           "  --rows N,...                   Pipeline input rows (default 1000000)\n"
+           "  --formats csv,joyc,parquet,... Pipeline input formats (default csv)\n"
+           "  --columns SPEC                 Generated columns: name:type[:cardinality[:nulls]]\n"
+           "                                 type int|double|string|bool, cardinality seq\n"
+           "  --filter TEXT                  Only run cases whose name contains TEXT\n"
+           "  --format text|csv|json         Result format (default text)\n"
+           "  --output FILE                  Write results to FILE instead of stdout\n"
+           "  --dir DIR                      Where generated data is cached\n"
+           "  --min-time SECONDS             Minimum time per kernel case (default 0.2)\n"
+           "  --repeat N                     Runs per pipeline case (default 3)\n"
+           "  --threads N                    VM threads (default: one per hardware thread)\n"
+           "  --seed N                       Data generator seed (default 42)\n"
+           "  --generate FILE                Only write generated data (--rows, --columns)\n";
+}
+
+template <typename T>
+bool parse_list(const std::string& text, std::vector<T>& out) {
+    out.clear();
+    std::stringstream in(text);
+    std::string item;
+    while (std::getline(in, item, ',')) {
+        std::istringstream value(item);
+        T parsed;
+        if (!(value >> parsed) || !value.eof())
+            return false;
+        out.push_back(parsed);
+    }
+    return !out.empty();
+}
+
+bool parse_options(int argc, char* argv[], BenchOptions& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            return false;  // Every option takes a value
+        }
+        std::string value = argv[++i];
+        bool ok = true;
+        if (arg == "--suite") {
+            options.kernels = value == "kernels" || value == "all";
+            options.pipelines = value == "pipelines" || value == "all";
+            ok = options.kernels || options.pipelines;
+        } else if (arg == "--sizes") {
+            ok = parse_list(value, options.sizes);
+        } else if (arg == "--nulls") {
+            ok = parse_list(value, options.null_densities);
+        } else if (arg == "--rows") {
+            ok = parse_list(value, options.pipeline_rows);
+        } else if (arg == "--formats") {
+            ok = parse_list(value, options.formats);
+        } else if (arg == "--columns") {
+            options.columns = value;
+        } else if (arg == "--filter") {
+            options.filter = value;
+        } else if (arg == "--format") {
+            options.format = value;
+            ok = value == "text" || value == "csv" || value == "json";
+        } else if (arg == "--output") {
+            options.output = value;
+        } else if (arg == "--dir") {
+            options.dir = value;
+        } else if (arg == "--min-time") {
+            options.min_time = std::strtod(value.c_str(), nullptr);
+        } else if (arg == "--repeat") {
+            options.repeat = std::strtoull(value.c_str(), nullptr, 10);
+            ok = options.repeat > 0;
+        } else if (arg == "--threads") {
+            options.threads = std::strtoull(value.c_str(), nullptr, 10);
+        } else if (arg == "--seed") {
+            options.seed = std::strtoull(value.c_str(), nullptr, 10);
+        } else if (arg == "--generate") {
+            options.generate = value;
+        } else {
+            ok = false;
+        }
+        if (!ok) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// ============================================================================
+// Results
+// ============================================================================
+
+struct Result {
+    std::string suite;  // "kernel" or "pipeline"
+    std::string name;
+    size_t rows = 0;
+    double null_density = 0;
+    size_t iterations = 0;
+    double best_seconds = 0;
+    double median_seconds = 0;
+    uint64_t input_bytes = 0;  // Pipelines: size of the input file
+};
+
+// Helper: Seconds of fn() per call (best and median), repeating until
+// min_time has passed (at least min_runs times) after one untimed warm-up run
+template <typename F>
+Result measure(F&& fn, double min_time, size_t min_runs) {
+    using Clock = std::chrono::steady_clock;
+    fn();
+    std::vector<double> runs;
+    const auto deadline = Clock::now() + std::chrono::duration<double>(min_time);
+    do {
+        const auto start = Clock::now();
+        fn();
+        runs.push_back(std::chrono::duration<double>(Clock::now() - start).count());
+    } while (runs.size() < min_runs || (Clock::now() < deadline && runs.size() < 1000000));
+    std::sort(runs.begin(), runs.end());
+    Result result;
+    result.iterations = runs.size();
+    result.best_seconds = runs.front();
+    result.median_seconds = runs[runs.size() / 2];
+    return result;
+}
+
+std::string json_string(const std::string& s) {
+    std::string out = "\"";
+    for (char c : s) {
+        if (c == '"' || c == '\\')
+            out.push_back('\\');
+        out.push_back(c);
+    }
+    return out + "\"";
+}
+
+void write_results(const std::vector<Result>& results, const BenchOptions& options,
+                   std::ostream& out) {
+    auto ns_per_row = [](const Result& r) {
+        return r.rows ? r.best_seconds * 1e9 / static_cast<double>(r.rows) : 0.0;
+    };
+    auto rows_per_second = [](const Result& r) {
+        return r.best_seconds > 0 ? static_cast<double>(r.rows) / r.best_seconds : 0.0;
+    };
+    char line[256];
+    if (options.format == "csv") {
+        out << "suite,name,rows,null_density,iterations,best_seconds,median_seconds,"
+               "ns_per_row,rows_per_second,input_bytes\n";
+        for (const auto& r : results) {
+            std::snprintf(line, sizeof(line), "%s,%s,%zu,%g,%zu,%.9g,%.9g,%.6g,%.6g,%llu\n",
+                          r.suite.c_str(), r.name.c_str(), r.rows, r.null_density, r.iterations,
+                          r.best_seconds, r.median_seconds, ns_per_row(r), rows_per_second(r),
+                          static_cast<unsigned long long>(r.input_bytes));
+            out << line;
+        }
+        return;
+    }
+    if (options.format == "json") {
+        out << "{\"context\": {\"threads\": "
+            << (options.threads ? options.threads : std::thread::hardware_concurrency())
+            << ", \"simd\": " << json_string(simd_level_name(active_simd_level()))
+            << "},\n \"benchmarks\": [";
+        for (size_t i = 0; i < results.size(); ++i) {
+            const auto& r = results[i];
+            std::snprintf(line, sizeof(line),
+                          "\"rows\": %zu, \"null_density\": %g, \"iterations\": %zu, "
+                          "\"best_seconds\": %.9g, \"median_seconds\": %.9g, "
+                          "\"ns_per_row\": %.6g, \"rows_per_second\": %.6g, \"input_bytes\": %llu",
+                          r.rows, r.null_density, r.iterations, r.best_seconds, r.median_seconds,
+                          ns_per_row(r), rows_per_second(r),
+                          static_cast<unsigned long long>(r.input_bytes));
+            out << (i > 0 ? ",\n  " : "\n  ") << "{\"suite\": " << json_string(r.suite)
+                << ", \"name\": " << json_string(r.name) << ", " << line << "}";
+        }
+        out << "\n]}\n";
+        return;
+    }
+    std::snprintf(line, sizeof(line), "%-9s %-44s %11s %6s %12s %12s %10s\n", "suite", "name",
+                  "rows", "nulls", "best (ms)", "median (ms)", "ns/row");
+    out << line;
+    for (const auto& r : results) {
+        std::snprintf(line, sizeof(line), "%-9s %-44s %11zu %6g %12.3f %12.3f %10.3f\n",
+                      r.suite.c_str(), r.name.c_str(), r.rows, r.null_density,
+                      r.best_seconds * 1000, r.median_seconds * 1000, ns_per_row(r));
+        out << line;
+    }
+}
+
+// ============================================================================
+// Data Generation
+// ============================================================================
+
+struct ColumnSpec {
+    std::string name;
+    ColumnType type = ColumnType::INT64;
+    bool sequential = false;  // int: 0, 1, 2, ...
+    size_t cardinality = 0;   // Distinct values (0 = unbounded)
+    double null_density = 0;
+};
+
+bool parse_column_specs(const std::string& text, std::vector<ColumnSpec>& specs) {
+    std::stringstream in(text);
+    std::string item;
+    while (std::getline(in, item, ',')) {
+        std::vector<std::string> parts;
+        std::stringstream fields(item);
+        std::string part;
+        while (std::getline(fields, part, ':'))
+            parts.push_back(part);
+        if (parts.size() < 2 || parts.size() > 4 || parts[0].empty())
+            return false;
+        ColumnSpec spec;
+        spec.name = parts[0];
+        if (parts[1] == "int")
+            spec.type = ColumnType::INT64;
+        else if (parts[1] == "double")
+            spec.type = ColumnType::DOUBLE;
+        else if (parts[1] == "string")
+            spec.type = ColumnType::STRING;
+        else if (parts[1] == "bool")
+            spec.type = ColumnType::BOOL;
+        else
+            return false;
+        if (parts.size() > 2 && parts[2] == "seq")
+            spec.sequential = true;
+        else if (parts.size() > 2 && !parts[2].empty())
+            spec.cardinality = std::strtoull(parts[2].c_str(), nullptr, 10);
+        if (parts.size() > 3)
+            spec.null_density = std::strtod(parts[3].c_str(), nullptr);
+        specs.push_back(spec);
+    }
+    return !specs.empty();
+}
+
+// Rows [begin, begin + count) of the generated data set
+// Values depend only on the seed and the row, so any batch size gives the same file
+class DataGenerator {
+public:
+    DataGenerator(std::vector<ColumnSpec> specs, uint64_t seed)
+        : specs_(std::move(specs)), seed_(seed) {}
+
+    Table batch(size_t begin, size_t count) const {
+        Table table;
+        table.num_rows = count;
+        for (size_t c = 0; c < specs_.size(); ++c) {
+            const ColumnSpec& spec = specs_[c];
+            Column col = Column::make(spec.name, spec.type);
+            col.reserve(count);
+            for (size_t i = 0; i < count; ++i) {
+                const uint64_t row = begin + i;
+                const uint64_t h = mix(row * 0x100000001b3ULL + c * 0x9e3779b97f4a7c15ULL);
+                if (spec.null_density > 0 && to_unit(mix(h)) < spec.null_density) {
+                    col.append_null();
+                    continue;
+                }
+                const uint64_t v = spec.cardinality ? h % spec.cardinality : h;
+                switch (spec.type) {
+                case ColumnType::INT64:
+                    col.append_int(spec.sequential ? static_cast<int64_t>(row)
+                                                   : static_cast<int64_t>(v % 1000000000));
+                    break;
+                case ColumnType::DOUBLE:
+                    col.append_double(spec.cardinality ? static_cast<double>(v) * 0.5
+                                                       : to_unit(v) * 1000.0);
+                    break;
+                case ColumnType::STRING: {
+                    std::string s = spec.name + "_" + std::to_string(v % 100000000);
+                    col.append_string(std::string_view(s));
+                    break;
+                }
+                case ColumnType::BOOL:
+                    col.append_bool((v & 1) != 0);
+                    break;
+                }
+            }
+            table.add_column(std::move(col));
+        }
+        return table;
+    }
+
+private:
+    uint64_t mix(uint64_t x) const {
+        x += seed_ * 0xbf58476d1ce4e5b9ULL;
+        x ^= x >> 30;
+        x *= 0xbf58476d1ce4e5b9ULL;
+        x ^= x >> 27;
+        x *= 0x94d049bb133111ebULL;
+        return x ^ (x >> 31);
+    }
+    static double to_unit(uint64_t x) {
+        return static_cast<double>(x >> 11) * (1.0 / 9007199254740992.0);
+    }
+
+    std::vector<ColumnSpec> specs_;
+    uint64_t seed_;
+};
+
+// Write rows of generated data to filepath in the format its extension names
+void generate_file(const std::string& filepath, const std::vector<ColumnSpec>& specs,
+                   size_t rows, uint64_t seed, ThreadPool* pool) {
+    DataGenerator generator(specs, seed);
+    auto writer = open_writer(filepath, pool);
+    const size_t batch_rows = kDefaultBatchSize;
+    for (size_t begin = 0; begin < rows; begin += batch_rows) {
+        writer->write(generator.batch(begin, std::min(batch_rows, rows - begin)));
+    }
+    writer->close();
+}
+
+// ============================================================================
+// Program Helpers
+// ============================================================================
+
+ExecutionPlan compile_program(const std::string& source) {
+    Lexer lexer(source);
+    Parser parser(lexer.tokenize());
+    Program program = parser.parse();
+    return Optimizer().optimize(Compiler().compile(program));
+}
+
+void run_program(const std::string& source, const BenchOptions& options) {
+    VMOptions vm_options;
+    vm_options.num_threads = options.threads;
+    VM vm(vm_options);
+    vm.execute(compile_program(source));
+}
+
+bool selected(const BenchOptions& options, const std::string& name) {
+    return options.filter.empty() || name.find(options.filter) != std::string::npos;
+}
+
+volatile size_t g_sink = 0;  // Keeps benchmarked results alive
+
+// ============================================================================
+// Kernel Suite
+// ============================================================================
+
+struct KernelInputs {
+    Column ints_a, ints_b, doubles_a, doubles_b, strings, dict_strings;
+    SelectionVector condition;
+    Table table;  // a, b (INT64) and c (DOUBLE) for the interpreters
+};
+
+KernelInputs make_kernel_inputs(size_t n, double nulls, uint64_t seed) {
+    std::mt19937_64 rng(seed ^ n);
+    std::uniform_int_distribution<int64_t> int_dist(1, 1000);  // Never 0: safe divisors
+    std::uniform_real_distribution<double> double_dist(1.0, 1000.0);
+    std::uniform_int_distribution<int> string_dist(0, 999);
+    std::bernoulli_distribution is_null(nulls);
+
+    KernelInputs in;
+    in.ints_a = Column::make("a", ColumnType::INT64);
+    in.ints_b = Column::make("b", ColumnType::INT64);
+    in.doubles_a = Column::make("c", ColumnType::DOUBLE);
+    in.doubles_b = Column::make("d", ColumnType::DOUBLE);
+    in.strings = Column::make("s", ColumnType::STRING);
+    in.dict_strings = Column::make_dict("s");
+    char buf[16];
+    for (size_t i = 0; i < n; ++i) {
+        std::snprintf(buf, sizeof(buf), "s%04d", string_dist(rng));
+        auto maybe = [&](auto value) {
+            return is_null(rng) ? std::nullopt : std::optional<decltype(value)>(value);
+        };
+        in.ints_a.append_int(maybe(int_dist(rng)));
+        in.ints_b.append_int(maybe(int_dist(rng)));
+        in.doubles_a.append_double(maybe(double_dist(rng)));
+        in.doubles_b.append_double(maybe(double_dist(rng)));
+        auto s = maybe(std::string_view(buf));
+        in.strings.append_string(s);
+        in.dict_strings.append_string(s);
+        in.condition.push_back(int_dist(rng) > 500);
+    }
+    in.table.num_rows = n;
+    in.table.add_column(in.ints_a);
+    in.table.add_column(in.ints_b);
+    in.table.add_column(in.doubles_a);
+    return in;
+}
+
+using Kernel = std::function<size_t(const KernelInputs&)>;
+
+std::vector<std::pair<std::string, Kernel>> kernel_cases() {
+    std::vector<std::pair<std::string, Kernel>> cases;
+    const std::pair<const char*, CompareOp> compares[] = {
+        {"gt", CompareOp::GT},   {"lt", CompareOp::LT}, {"gte", CompareOp::GTE},
+        {"lte", CompareOp::LTE}, {"eq", CompareOp::EQ}, {"neq", CompareOp::NEQ}};
+    for (const auto& [op_name, op] : compares) {
+        const std::string name = op_name;
+        const CompareOp o = op;
+        cases.push_back({"vec_compare_int64/" + name, [o](const KernelInputs& in) {
+                             return vec_compare_int64(o, in.ints_a, 500, nullptr).count();
+                         }});
+        cases.push_back({"vec_compare_int64/" + name + "/active", [o](const KernelInputs& in) {
+                             return vec_compare_int64(o, in.ints_a, 500, &in.condition).count();
+                         }});
+        cases.push_back({"vec_compare_double/" + name, [o](const KernelInputs& in) {
+                             return vec_compare_double(o, in.doubles_a, 500.0, nullptr).count();
+                         }});
+        cases.push_back({"vec_compare_double/" + name + "/int64", [o](const KernelInputs& in) {
+                             return vec_compare_double(o, in.ints_a, 500.5, nullptr).count();
+                         }});
+        cases.push_back({"vec_compare_string/" + name, [o](const KernelInputs& in) {
+                             return vec_compare_string(o, in.strings, "s0500", nullptr).count();
+                         }});
+        cases.push_back({"vec_compare_string/" + name + "/dict", [o](const KernelInputs& in) {
+                             return vec_compare_string(o, in.dict_strings, "s0500", nullptr)
+                                 .count();
+                         }});
+        cases.push_back({"vec_compare_columns/" + name + "/int64", [o](const KernelInputs& in) {
+                             return vec_compare_columns(o, in.ints_a, in.ints_b).count();
+                         }});
+        cases.push_back({"vec_compare_columns/" + name + "/double", [o](const KernelInputs& in) {
+                             return vec_compare_columns(o, in.doubles_a, in.doubles_b).count();
+                         }});
+        cases.push_back(
+            {"vec_compare_columns/" + name + "/int64_double", [o](const KernelInputs& in) {
+                 return vec_compare_columns(o, in.ints_a, in.doubles_a).count();
+             }});
+        cases.push_back({"vec_compare_columns/" + name + "/string", [o](const KernelInputs& in) {
+                             return vec_compare_columns(o, in.strings, in.dict_strings).count();
+                         }});
+    }
+
+    const std::pair<const char*, VectorArithOp> ops[] = {{"add", VectorArithOp::ADD},
+                                                         {"sub", VectorArithOp::SUB},
+                                                         {"mul", VectorArithOp::MUL},
+                                                         {"div", VectorArithOp::DIV}};
+    for (const auto& [op_name, op] : ops) {
+        const std::string name = op_name;
+        const VectorArithOp o = op;
+        cases.push_back({"vec_arith_int64/" + name, [o](const KernelInputs& in) {
+                             return vec_arith_int64(o, in.ints_a, in.ints_b).size();
+                         }});
+        cases.push_back({"vec_arith_double/" + name, [o](const KernelInputs& in) {
+                             return vec_arith_double(o, in.doubles_a, in.doubles_b).size();
+                         }});
+        cases.push_back({"vec_arith_int64_scalar/" + name, [o](const KernelInputs& in) {
+                             return vec_arith_int64_scalar(o, in.ints_a, 3).size();
+                         }});
+        cases.push_back({"vec_arith_double_scalar/" + name, [o](const KernelInputs& in) {
+                             return vec_arith_double_scalar(o, in.doubles_a, 3.0).size();
+                         }});
+        cases.push_back({"vec_arith_scalar_int64/" + name, [o](const KernelInputs& in) {
+                             return vec_arith_scalar_int64(o, 3, in.ints_a).size();
+                         }});
+        cases.push_back({"vec_arith_scalar_double/" + name, [o](const KernelInputs& in) {
+                             return vec_arith_scalar_double(o, 3.0, in.doubles_a).size();
+                         }});
+    }
+
+    cases.push_back({"vec_select_int64", [](const KernelInputs& in) {
+                         return vec_select_int64(in.condition, in.ints_a, in.ints_b).size();
+                     }});
+    cases.push_back({"vec_select_double", [](const KernelInputs& in) {
+                         return vec_select_double(in.condition, in.doubles_a, in.doubles_b).size();
+                     }});
+    cases.push_back({"vec_select_string", [](const KernelInputs& in) {
+                         return vec_select_string(in.condition, in.strings, in.dict_strings).size();
+                     }});
+    return cases;
+}
+
+// The bound bytecode of a transform expression over columns a, b (INT64) and c (DOUBLE)
+IRExpr bound_expression(const std::string& expr) {
+    ExecutionPlan plan = Compiler().compile(
+        Parser(Lexer("from \"x.csv\"\ntransform r = " + expr).tokenize()).parse());
+    const auto& transform = std::get<PhysicalOp::TransformOp>(plan.operators[1].data);
+    Schema schema;
+    schema.names = {"a", "b", "c"};
+    schema.types = {ColumnType::INT64, ColumnType::INT64, ColumnType::DOUBLE};
+    return Binder().bind_expr(transform.expression, schema);
+}
+
+// Run the row interpreter through a pipeline: a ternary with INT64 and DOUBLE
+// branches has a per-row type, so its transform always takes VM::eval_expr.
+// The time of the same scan without the transform is subtracted, leaving the
+// interpreter's own cost
+Result measure_eval_expr(size_t n, double nulls, const BenchOptions& options) {
+    std::filesystem::create_directories(options.dir);
+    char name[64];
+    std::snprintf(name, sizeof(name), "eval_%zu_%g.joyc", n, nulls);
+    const std::string path = (std::filesystem::path(options.dir) / name).string();
+    if (!std::filesystem::exists(path)) {
+        char spec[128];
+        std::snprintf(spec, sizeof(spec), "a:int:1000:%g,b:int:1000:%g,c:double:0:%g", nulls,
+                      nulls, nulls);
+        std::vector<ColumnSpec> specs;
+        parse_column_specs(spec, specs);
+        generate_file(path, specs, n, options.seed, nullptr);
+    }
+    const std::string scan = "from \"" + path + "\"\n";
+    const std::string transform = "transform r = (a + b) * 2 > 1000 ? a * b : c / 2\n";
+    const size_t runs = std::max<size_t>(options.repeat, 3);
+    Result base = measure([&] { run_program(scan + "select a, b, c\n", options); }, 0, runs);
+    Result full = measure([&] { run_program(scan + transform, options); }, 0, runs);
+    Result result = full;
+    result.best_seconds = std::max(0.0, full.best_seconds - base.best_seconds);
+    result.median_seconds = std::max(0.0, full.median_seconds - base.median_seconds);
+    return result;
+}
+
+void run_kernel_suite(const BenchOptions& options, std::vector<Result>& results) {
+    const auto cases = kernel_cases();
+    struct Expression {
+        const char* name;
+        const char* source;
+    };
+    const Expression expressions[] = {
+        {"batch_interpreter/arith", "a * 2 + b - c / 3"},
+        {"batch_interpreter/predicate", "a * 2 + b > 1000 and c < 500.5"},
+    };
+
+    for (size_t n : options.sizes) {
+        for (double nulls : options.null_densities) {
+            const KernelInputs inputs = make_kernel_inputs(n, nulls, options.seed);
+            auto record = [&](const std::string& name, Result r) {
+                r.suite = "kernel";
+                r.name = name;
+                r.rows = n;
+                r.null_density = nulls;
+                results.push_back(r);
+                std::cerr << "." << std::flush;
+            };
+
+            for (const auto& [name, kernel] : cases) {
+                if (!selected(options, name))
+                    continue;
+                auto& k = kernel;
+                record(name, measure([&] { g_sink = g_sink + k(inputs); }, options.min_time, 3));
+            }
+
+            for (const auto& expr : expressions) {
+                if (!selected(options, expr.name))
+                    continue;
+                const IRExpr bound = bound_expression(expr.source);
+                BatchInterpreter interpreter(bound, inputs.table);
+                auto run = [&] {
+                    for (size_t begin = 0; begin < n; begin += kEvalBatchSize) {
+                        size_t count = std::min(kEvalBatchSize, n - begin);
+                        g_sink = g_sink + interpreter.evaluate(begin, count).valid.size();
+                    }
+                };
+                record(expr.name, measure(run, options.min_time, 3));
+            }
+
+            if (selected(options, "eval_expr")) {
+                record("eval_expr", measure_eval_expr(n, nulls, options));
+            }
+        }
+    }
+}
+
+// ============================================================================
+// Pipeline Suite
+// ============================================================================
+
+struct Pipeline {
+    const char* name;
+    const char* operations;  // Appended after the from statement
+};
+
+const Pipeline kPipelines[] = {
+    {"scan", "select id, age, dept, salary\n"},
+    {"scan_filter", "filter age > 40\n"},
+    {"scan_filter_string", "filter dept == \"dept_7\"\n"},
+    {"scan_filter_transform", "filter age > 40\ntransform bonus = salary * 2\n"},
+    {"scan_filter_transform_write",
+     "filter age > 40\ntransform bonus = salary * 2\nwrite \"{out}\"\n"},
+    {"scan_transform_scalar", "transform level = age * 2 + salary / 1000 > 100\n"},
+    {"scan_write", "write \"{out}\"\n"},
+};
+
+void run_pipeline_suite(const BenchOptions& options, std::vector<Result>& results) {
+    std::vector<ColumnSpec> specs;
+    if (!parse_column_specs(options.columns, specs)) {
+        throw std::runtime_error("Invalid --columns: " + options.columns);
+    }
+    std::filesystem::create_directories(options.dir);
+    ThreadPool pool(options.threads);
+    const std::string spec_hash =
+        std::to_string(std::hash<std::string>{}(options.columns) ^ options.seed);
+
+    for (size_t rows : options.pipeline_rows) {
+        for (const auto& format : options.formats) {
+            // Generated inputs are cached by row count, column spec and seed
+            const auto base = std::filesystem::path(options.dir) /
+                              ("data_" + std::to_string(rows) + "_" + spec_hash);
+            const std::string input = base.string() + "." + format;
+            if (!std::filesystem::exists(input)) {
+                std::cerr << "Generating " << input << "\n";
+                generate_file(input, specs, rows, options.seed, &pool);
+            }
+            const uint64_t input_bytes = std::filesystem::file_size(input);
+            const std::string out = (std::filesystem::path(options.dir) / "out.csv").string();
+
+            for (const auto& pipeline : kPipelines) {
+                const std::string name = std::string(pipeline.name) + "/" + format;
+                if (!selected(options, name))
+                    continue;
+                std::string ops = pipeline.operations;
+                size_t pos = ops.find("{out}");
+                if (pos != std::string::npos)
+                    ops.replace(pos, 5, out);
+                const std::string source = "from \"" + input + "\"\n" + ops;
+                try {
+                    Result r = measure([&] { run_program(source, options); }, 0, options.repeat);
+                    r.suite = "pipeline";
+                    r.name = name;
+                    r.rows = rows;
+                    r.input_bytes = input_bytes;
+                    results.push_back(r);
+                } catch (const std::exception& e) {
+                    // Pipelines over columns the spec lacks are skipped
+                    std::cerr << "Skipping " << name << ": " << e.what() << "\n";
+                }
+                std::cerr << "." << std::flush;
+            }
+            std::filesystem::remove(out);
+        }
+    }
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    BenchOptions options;
+    if (!parse_options(argc, argv, options)) {
+        print_usage();
+        return 1;
+    }
+
+    try {
+        if (!options.generate.empty()) {
+            std::vector<ColumnSpec> specs;
+            if (!parse_column_specs(options.columns, specs)) {
+                print_usage();
+                return 1;
+            }
+            ThreadPool pool(options.threads);
+            generate_file(options.generate, specs, options.pipeline_rows.front(), options.seed,
+                          &pool);
+            return 0;
+        }
+
+        std::vector<Result> results;
+        if (options.kernels)
+            run_kernel_suite(options, results);
+        if (options.pipelines)
+            run_pipeline_suite(options, results);
+        std::cerr << "\n";
+
+        if (options.output.empty()) {
+            write_results(results, options, std::cout);
+        } else {
+            std::ofstream out(options.output);
+            if (!out) {
+                std::cerr << "Error: Cannot create file: " << options.output << "\n";
+                return 1;
+            }
+            write_results(results, options, out);
+        }
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "ir.hpp"
+#include "table.hpp"
+#include "thread_pool.hpp"
+
+namespace joy {
+
+// ============================================================================
+// Hash Aggregation (GROUP BY)
+// ============================================================================
+// Groups live in an open-addressing hash table (linear probing). Each slot
+// packs the group index with 32 bits of the key hash, so most mismatches are
+// rejected without touching the keys. Keys and aggregate states are stored
+// column-wise by group index, in typed vectors
+//
+// Batches are split into contiguous chunks, one per thread, and chunk i
+// always goes to partial aggregate i, so threads never share a hash table.
+// finish() merges the partials into the first one (DOUBLE sums may differ in
+// the last digits between thread counts, since they are added in another order)
+//
+// NULL handling follows SQL (and the filters' NULL-is-false rule):
+//   - NULL keys form one group of their own
+//   - aggregates skip NULL inputs; sum/min/max/avg of no values is NULL
+//   - count() counts rows, count(col) counts non-NULL values
+
+class HashAggregate {
+public:
+    // partitions = number of partial aggregates (threads) batches are split over
+    HashAggregate(const PhysicalOp::AggregateOp& op, size_t partitions);
+    ~HashAggregate();
+
+    HashAggregate(const HashAggregate&) = delete;
+    HashAggregate& operator=(const HashAggregate&) = delete;
+
+    // Accumulate every row of batch (column types must not change between batches)
+    void consume(const Table& batch, ThreadPool* pool);
+
+    // Merge the partials and return one row per group, ordered by the
+    // position of each group's first row in the input
+    Table finish();
+
+private:
+    struct Partial;  // One hash table with its groups' keys and states
+
+    // Fix key and input types from the first batch
+    void init(const Table& batch);
+
+    const PhysicalOp::AggregateOp& op_;
+    size_t num_partitions_;
+    std::vector<std::unique_ptr<Partial>> partials_;
+    std::vector<ColumnType> key_types_;
+    std::vector<ColumnType> input_types_;  // Per aggregate (unused for count())
+    uint64_t rows_seen_ = 0;               // Input position of the next batch's first row
+};
+
+}  // namespace joy
@@ -0,0 +1,156 @@
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "table.hpp"
+
+namespace joy {
+
+// ============================================================================
+// Apache Arrow IPC (.arrow / .feather files, .arrows streams)
+// ============================================================================
+// Arrow arrays have Column's layout: validity bitmaps (bit set = value
+// present), contiguous fixed-width values, bit-packed booleans and
+// offsets + bytes for strings. Reading copies each buffer range out of the
+// memory-mapped file in bulk (integers narrower than 64 bits are widened);
+// writing emits Column's buffers as they are.
+//
+// Types read, and their Joy types:
+//   Int (any width), Date, Time, Timestamp, Duration     INT64
+//   FloatingPoint (single, double)                       DOUBLE
+//   Bool                                                 BOOL
+//   Utf8, LargeUtf8, Binary, LargeBinary                 STRING
+//   Dictionary-encoded Utf8 / LargeUtf8                  STRING (dictionary-encoded)
+// Columns of other types can be read past but not selected. Compressed
+// bodies are not supported.
+// Types written: Int64, Double, Bool and Utf8, one record batch per batch
+
+// Bounds-checked view of a FlatBuffers table (Arrow metadata, see arrow_ipc.cpp)
+class FbTable;
+
+// A byte range of the file
+struct ArrowRange {
+    uint64_t offset = 0;
+    uint64_t size = 0;
+};
+
+// Reads an Arrow IPC file (footer directory) or stream (messages in order)
+// All metadata and dictionaries are read when the file is opened; batches
+// then copy rows straight out of the mapping, decoding columns in parallel
+class ArrowReader : public BatchReader {
+public:
+    // columns: only these columns are returned, in file order (nullptr = all)
+    explicit ArrowReader(const std::string& filepath, ThreadPool* pool = nullptr,
+                         const std::vector<std::string>* columns = nullptr);
+
+    bool next_batch(Table& out, size_t max_rows) override;
+
+    const std::vector<std::string>& column_names() const override {
+        return headers_;
+    }
+    const std::vector<ColumnType>& column_types() const override {
+        return types_;
+    }
+    const std::vector<bool>& inferred_types() const override {
+        return inferred_;
+    }
+
+private:
+    // Physical layout of a returned column
+    struct Field {
+        enum class Kind { INT, FLOAT, BOOL, STRING, DICT };
+        Kind kind;
+        int byte_width = 8;     // INT / FLOAT values, DICT indices
+        bool is_signed = true;  // INT values, DICT indices
+        bool large = false;     // STRING (or DICT values): 64-bit offsets
+        int64_t dict_id = -1;   // DICT
+        size_t node = 0;        // Index of the column's FieldNode in a record batch
+        size_t buffer = 0;      // Index of its first buffer
+    };
+
+    // A dictionary's values interned into a StringDictionary
+    struct Dictionary {
+        std::shared_ptr<StringDictionary> dict;
+        std::vector<int32_t> codes;  // Per Arrow index: dictionary code (-1 = NULL value)
+    };
+
+    struct ColumnData {
+        uint64_t null_count = 0;
+        ArrowRange buffers[3];
+        std::shared_ptr<Dictionary> dict;  // DICT: the dictionary when the batch was read
+    };
+
+    struct Batch {
+        uint64_t num_rows = 0;
+        std::vector<ColumnData> columns;  // Per returned column
+    };
+
+    struct Message;
+
+    // Parse the encapsulated message at offset into message
+    // Returns the offset past its body (0 = end-of-stream marker)
+    uint64_t read_message(uint64_t offset, Message& message) const;
+    void read_schema(const FbTable& schema, const std::vector<std::string>* columns);
+    void read_dictionary(const Message& message);
+    void read_record_batch(const Message& message);
+
+    // Append rows [begin, begin + count) of returned column c of batch to col
+    void append_rows(Column& col, const Batch& batch, size_t c, size_t begin,
+                     size_t count) const;
+
+    std::string filepath_;
+    MappedFile file_;
+    ThreadPool* pool_;
+    std::vector<std::string> headers_;
+    std::vector<ColumnType> types_;
+    std::vector<bool> inferred_;
+    std::vector<Field> fields_;  // Per returned column
+    size_t num_nodes_ = 0;       // FieldNodes / buffers per record batch
+    size_t num_buffers_ = 0;
+    std::unordered_map<int64_t, std::shared_ptr<Dictionary>> dictionaries_;
+    std::vector<Batch> batches_;
+    size_t batch_ = 0;  // Position of the next row: batch, then row within it
+    size_t row_ = 0;
+    bool started_ = false;
+};
+
+// Writes batches as an Arrow IPC file or stream (schema from the first batch)
+class ArrowWriter : public BatchWriter {
+public:
+    enum class Format { FILE, STREAM };
+
+    ArrowWriter(const std::string& filepath, Format format);
+    ~ArrowWriter() override;
+
+    void write(const Table& batch) override;
+    void close() override;
+
+private:
+    struct Block {
+        uint64_t offset;
+        uint32_t metadata_length;
+        uint64_t body_length;
+    };
+
+    // Write one encapsulated message: flatbuffer metadata, then body
+    Block write_message(const std::string& metadata, const std::string& body);
+
+    // Write the schema message (FILE: after the leading magic)
+    void write_schema();
+
+    std::string filepath_;
+    Format format_;
+    std::ofstream file_;
+    uint64_t pos_ = 0;
+    bool closed_ = false;
+    bool schema_written_ = false;
+    std::vector<std::pair<std::string, ColumnType>> schema_;
+    std::vector<Block> blocks_;  // Record batches (for the file footer)
+};
+
+}  // namespace joy
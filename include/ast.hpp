@@ -25,7 +25,9 @@ enum class BinaryOp {
     Lt,   // <
     Gt,   // >
     Lte,  // <=
-    Gte   // >=
+    Gte,  // >=
+    And,  // and
+    Or    // or
 };
 
 enum class UnaryOp {
@@ -67,17 +69,39 @@ struct TernaryExpr {
     std::unique_ptr<Expr> false_branch;
 };
 
+enum class StringFunc {
+    StartsWith,  // starts_with(s, "prefix")
+    EndsWith,    // ends_with(s, "suffix")
+    Contains,    // contains(s, "part")
+    IEquals      // iequals(s, "text"): equal ignoring ASCII case
+};
+
+// String predicate against a literal pattern
+// Example: contains(url, "/api/") → {Contains, ColumnRef("url"), "/api/"}
+struct StringMatchExpr {
+    StringFunc func;
+    std::unique_ptr<Expr> subject;
+    std::string pattern;
+};
+
 // Expression wrapper
 struct Expr {
-    std::variant<LiteralExpr, ColumnRef, BinaryExpr, UnaryExpr, TernaryExpr> node;
+    std::variant<LiteralExpr, ColumnRef, BinaryExpr, UnaryExpr, TernaryExpr, StringMatchExpr> node;
 };
 
 // ============================================================================
 // Statement Types
 // ============================================================================
 
+// schema (age int, name string)
+struct ColumnDecl {
+    std::string name;
+    ValueType type;
+};
+
 struct FromStmt {
-    std::string filepath;
+    std::vector<std::string> filepaths;  // Paths or glob patterns, read in order
+    std::vector<ColumnDecl> schema;      // Declared column types (others are inferred)
 };
 
 struct FilterStmt {
@@ -97,9 +121,49 @@ struct WriteStmt {
     std::string filepath;
 };
 
+enum class AggregateFunc { Sum, Count, Min, Max, Avg };
+
+// One aggregate of a group statement
+// Example: total = sum(salary) → {Sum, "salary", "total"}
+struct AggregateCall {
+    AggregateFunc func;
+    std::string column;       // Empty for count()
+    std::string output_name;  // Alias, or func_column by default (count() → count)
+};
+
+// group by dept aggregate sum(salary), count()
+// keys is empty for a bare aggregate statement (one group over all rows)
+struct GroupByStmt {
+    std::vector<std::string> keys;
+    std::vector<AggregateCall> aggregates;
+};
+
+// join "dim.csv" on key1, key2 (inner join; key names are the same in both inputs)
+struct JoinStmt {
+    std::string filepath;
+    std::vector<std::string> keys;
+};
+
+// sort by score desc, name
+struct SortKey {
+    std::string column;
+    bool descending = false;
+};
+
+struct SortStmt {
+    std::vector<SortKey> keys;  // Most significant first
+};
+
+// limit 100
+struct LimitStmt {
+    int64_t count;
+};
+
 // Statement wrapper
 struct Stmt {
-    std::variant<FromStmt, FilterStmt, SelectStmt, TransformStmt, WriteStmt> node;
+    std::variant<FromStmt, FilterStmt, SelectStmt, TransformStmt, WriteStmt, GroupByStmt, JoinStmt,
+                 SortStmt, LimitStmt>
+        node;
 };
 
 // ============================================================================
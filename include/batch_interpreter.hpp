@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+#include "ir.hpp"
+#include "table.hpp"
+
+namespace joy {
+
+// ============================================================================
+// Batch Interpreter (vector-at-a-time bytecode evaluation)
+// ============================================================================
+// Runs each IRExpr instruction over a chunk of up to kEvalBatchSize rows
+// instead of one row at a time. Stack slots are typed vectors rather than
+// Values, so the per-instruction dispatch (and the std::visit/variant cost)
+// is paid once per chunk and the inner loops are plain typed arrays that the
+// compiler can vectorize.
+//
+// Expressions must be bound (see binder.hpp): slot types come from the
+// typed opcodes, so expressions whose type depends on the row (e.g.
+// cond ? 1 : "x") report supported() == false and callers fall back to the
+// row interpreter, which keeps its per-row semantics.
+
+// Rows per chunk: large enough to amortize dispatch, small enough that the
+// slots stay in L1/L2 cache
+constexpr size_t kEvalBatchSize = 1024;
+
+// One stack slot: values for the rows of the current chunk
+// Only the vector matching type is meaningful; valid[i] == 0 means NULL
+struct VectorSlot {
+    ColumnType type = ColumnType::INT64;
+    std::vector<int64_t> ints;
+    std::vector<double> doubles;
+    std::vector<std::string_view> strings;  // Views into the table or the bytecode
+    std::vector<uint8_t> bools;
+    std::vector<uint8_t> valid;
+};
+
+class BatchInterpreter {
+public:
+    // Resolve the column references of bound expr against table
+    BatchInterpreter(const IRExpr& expr, const Table& table);
+
+    // False if the expression needs the row interpreter
+    bool supported() const {
+        return supported_;
+    }
+
+    // Static type of the expression's result (only meaningful if supported)
+    ColumnType result_type() const {
+        return result_type_;
+    }
+
+    // Evaluate rows [begin, begin + n) of the table (n <= kEvalBatchSize)
+    // active[i] == 0 marks rows whose result is ignored (e.g. rejected by an
+    // earlier filter): they never raise errors such as division by zero
+    // The returned slot is valid until the next call
+    const VectorSlot& evaluate(size_t begin, size_t n, const uint8_t* active = nullptr);
+
+private:
+    VectorSlot& push(ColumnType type, size_t n);
+    VectorSlot& top(size_t k) {  // k-th slot from the top of the stack
+        return slots_[depth_ - 1 - k];
+    }
+    void load_column(VectorSlot& slot, const Column& col, size_t begin, size_t n);
+
+    const IRExpr& expr_;
+    std::vector<const Column*> columns_;  // Column per instruction (LOAD_COLUMN)
+    bool supported_ = true;
+    ColumnType result_type_ = ColumnType::INT64;
+
+    // Stack of slots; slots above depth_ are kept to reuse their buffers
+    std::vector<VectorSlot> slots_;
+    size_t depth_ = 0;
+};
+
+}  // namespace joy
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "compiler.hpp"  // For CompileError
+#include "ir.hpp"
+#include "table.hpp"
+
+namespace joy {
+
+// ============================================================================
+// Schema (Column Names and Types Flowing Between Operators)
+// ============================================================================
+
+struct Schema {
+    std::vector<std::string> names;
+    // nullopt = only known at runtime (e.g. an all-NULL CSV column, or a
+    // transform whose type depends on the row)
+    std::vector<std::optional<ColumnType>> types;
+
+    // Index of a column, or -1 if not found
+    int index_of(const std::string& name) const;
+};
+
+// ============================================================================
+// Binder (IR → Bound IR, Once the Scan Schema Is Known)
+// ============================================================================
+// The compiler runs before any input is opened, so its bytecode refers to
+// columns by name and leaves every type check to the row interpreter. The
+// binder walks the plan with the scan's schema, tracking how each operator
+// changes it, and for every expression:
+//   - resolves LOAD_COLUMN names to column indices
+//   - rewrites generic opcodes into typed ones (ADD → ADD_I64, ...), adding
+//     CAST_F64 for INT64/DOUBLE promotion and fusing comparisons against
+//     numeric literals (GT + PUSH_INT → GT_I64_CONST)
+//   - reports type errors (and missing columns) before execution starts
+// Values whose type is not static keep the generic opcodes and are checked
+// per row as before
+
+class Binder {
+public:
+    // Bind every operator of plan; input is the schema produced by its scan
+    // join_inputs[j] is the schema of the file read by the plan's j-th JOIN
+    ExecutionPlan bind(const ExecutionPlan& plan, Schema input,
+                       std::vector<Schema> join_inputs = {});
+
+    // Bind a single expression against schema
+    IRExpr bind_expr(const IRExpr& expr, const Schema& schema);
+
+private:
+    // Apply op's effect on the schema (after binding its expressions)
+    void bind_op(PhysicalOp& op, Schema& schema);
+
+    // Filter predicates must be BOOL or INT64
+    void bind_predicate(IRExpr& predicate, const Schema& schema);
+    void bind_filter_node(PhysicalOp::FilterNode& node, const Schema& schema);
+
+    // Append the join file's columns (keys must exist on both sides with one type)
+    void bind_join(const PhysicalOp::JoinOp& op, Schema& schema);
+
+    std::vector<Schema> join_inputs_;
+    size_t next_join_ = 0;
+};
+
+}  // namespace joy
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "table.hpp"
+
+namespace joy {
+
+// ============================================================================
+// Incremental Runs (--incremental checkpoint)
+// ============================================================================
+// A pipeline without pipeline breakers over an append-only CSV file can be
+// run again on just the rows added since its last run. The checkpoint file
+// remembers where that run stopped reading, the types it read the columns
+// as (so later runs parse new rows the same way instead of inferring again)
+// and how long each output was, so a run that failed after writing part of
+// its output is rolled back instead of leaving duplicate rows.
+//
+// Text format, one entry per line:
+//   joy-checkpoint 1
+//   file <input path>
+//   offset <byte offset of the first row not yet read>
+//   header <first line of the input>
+//   column <type> <name>        (per typed column, e.g. "column int64 age")
+//   output <bytes> <path>       (per output file)
+
+struct ScanCheckpoint {
+    std::string filepath;
+    uint64_t offset = 0;
+    std::string header;
+    std::vector<DeclaredColumn> schema;
+    std::vector<std::pair<std::string, uint64_t>> outputs;  // Path, size in bytes
+};
+
+// nullopt if there is no checkpoint at path yet
+std::optional<ScanCheckpoint> load_checkpoint(const std::string& path);
+
+// Written to a temporary file that then replaces path, so an interrupted save
+// leaves the previous checkpoint intact
+void save_checkpoint(const std::string& path, const ScanCheckpoint& checkpoint);
+
+}  // namespace joy
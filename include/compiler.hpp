@@ -34,18 +34,27 @@ private:
     // Compile statement into physical operator
     PhysicalOp compile_stmt(const Stmt& stmt);
 
+    // Compile a group/aggregate statement
+    PhysicalOp::AggregateOp compile_aggregate(const GroupByStmt& node);
+
     // Expression compilation helpers
     void compile_literal(const LiteralExpr& node, IRExpr& result);
     void compile_column_ref(const ColumnRef& node, IRExpr& result);
     void compile_binary(const BinaryExpr& node, IRExpr& result);
     void compile_unary(const UnaryExpr& node, IRExpr& result);
     void compile_ternary(const TernaryExpr& node, IRExpr& result);
+    void compile_string_match(const StringMatchExpr& node, IRExpr& result);
 
     // Vectorization pattern detection
     // Try to convert filter expression to vectorized operation
     // Returns nullopt if expression is too complex
     std::optional<PhysicalOp::VectorizedFilterOp> try_vectorize_filter(const Expr& expr);
 
+    // Convert a filter whose top level is and/or into a selection-refining tree
+    // Returns nullopt if the expression is not a conjunction or disjunction
+    std::optional<PhysicalOp::LogicalFilterOp> try_logical_filter(const Expr& expr);
+    PhysicalOp::FilterNode compile_filter_node(const Expr& expr);
+
     // Try to convert transform expressions to vectorized operations
     std::optional<PhysicalOp::VectorizedTransformOp> try_vectorize_arith_transform(
         const std::string& column_name, const Expr& expr);
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace joy {
+
+class ThreadPool;
+
+// ============================================================================
+// Compressed Files (.gz, .zst)
+// ============================================================================
+// CSV files may be gzip or zstd compressed; the last extension picks the
+// codec (events.csv.gz, events.csv.zst) and the one before it the format.
+// Input is decompressed as a stream into the CSV tokenizer, so the text of a
+// compressed file is never written to disk or held in memory whole.
+//
+// Output is written as a sequence of independently compressed blocks (gzip
+// members or zstd frames), which standard tools read as one stream. zstd
+// frames record their decompressed size, so a reader can decompress several
+// of them in parallel; gzip has no such index and decompresses on one thread.
+//
+// zlib and zstd are optional at build time (JOY_COMPRESSION); without them,
+// opening a file that needs one throws.
+
+enum class Compression { NONE, GZIP, ZSTD };
+
+// Codec implied by the file name (.gz = GZIP, .zst / .zstd = ZSTD)
+Compression compression_of(const std::string& filepath);
+
+// filepath without its compression extension ("a.csv.gz" -> "a.csv")
+std::string strip_compression(const std::string& filepath);
+
+// Decompressed bytes of a file, front to back
+class Decompressor {
+public:
+    virtual ~Decompressor() = default;
+
+    // Copy up to n decompressed bytes into out; returns 0 only at the end
+    virtual size_t read(char* out, size_t n) = 0;
+};
+
+// pool: decompresses several zstd frames at once (nullptr = one at a time)
+std::unique_ptr<Decompressor> open_decompressor(const std::string& filepath,
+                                                Compression compression,
+                                                ThreadPool* pool = nullptr);
+
+// Throw unless joy was built with the library compression needs
+void check_compression(Compression compression, const std::string& filepath);
+
+// Append data as one complete gzip member or zstd frame to out
+// Thread-safe: writers compress the blocks of a batch in parallel
+void compress_block(Compression compression, std::string_view data, std::string& out);
+
+}  // namespace joy
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <variant>
+#include <vector>
+
+#include "ir.hpp"
+#include "table.hpp"
+
+namespace joy {
+
+// ============================================================================
+// File Formats (chosen by file extension)
+// ============================================================================
+//   .joyc                native columnar format (joyc.hpp)
+//   .parquet             Apache Parquet (parquet.hpp)
+//   .arrow .feather      Apache Arrow IPC file (arrow_ipc.hpp)
+//   .arrows              Apache Arrow IPC stream
+//   anything else        CSV
+//   .gz .zst             compressed CSV (compression.hpp), e.g. events.csv.gz
+
+// columns: only these columns are read, in file order (nullptr = all)
+// predicates: comparisons every row the pipeline keeps satisfies; readers with
+// statistics skip blocks of rows where none can (rows are still filtered later)
+// schema: declared column types; CSV columns are parsed as them, and the typed
+// formats must already store them (nullptr = infer CSV types)
+std::unique_ptr<BatchReader> open_reader(
+    const std::string& filepath, ThreadPool* pool = nullptr,
+    const std::vector<std::string>* columns = nullptr,
+    const std::vector<PhysicalOp::VectorizedFilterOp>* predicates = nullptr,
+    const std::vector<DeclaredColumn>* schema = nullptr);
+
+// Reader for a scan's files: paths or glob patterns (see multi_file.hpp)
+// A single matching file is opened with open_reader
+std::unique_ptr<BatchReader> open_scan(
+    const std::vector<std::string>& filepaths, ThreadPool* pool = nullptr,
+    const std::vector<std::string>* columns = nullptr,
+    const std::vector<PhysicalOp::VectorizedFilterOp>* predicates = nullptr,
+    const std::vector<DeclaredColumn>* schema = nullptr);
+
+// pool: formats CSV output in parallel
+// append: add to the end of an existing CSV file (other formats throw)
+std::unique_ptr<BatchWriter> open_writer(const std::string& filepath, ThreadPool* pool = nullptr,
+                                         bool append = false);
+
+// Known value range of one column over a block of rows
+struct ColumnStats {
+    using Value = std::variant<int64_t, double, std::string>;
+    std::optional<Value> min;  // Of the non-NULL values (nullopt = unknown)
+    std::optional<Value> max;
+    std::optional<uint64_t> null_count;
+    uint64_t num_rows = 0;
+};
+
+// Whether some row of the block may satisfy predicate
+// False only when no row can (the block can be skipped)
+bool may_match(const PhysicalOp::VectorizedFilterOp& predicate, const ColumnStats& stats);
+
+}  // namespace joy
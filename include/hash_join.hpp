@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "ir.hpp"
+#include "table.hpp"
+#include "thread_pool.hpp"
+
+namespace joy {
+
+// ============================================================================
+// Hash Join (Inner Equi-Join With a Second File)
+// ============================================================================
+// The joined file (the build side, typically a dimension table) is read
+// once and indexed; the pipeline's batches (the probe side) stream through.
+//
+// Build: rows are radix-partitioned on the top bits of their key hash so
+// each partition's hash table fits in cache, then the partitions are built in
+// parallel. A partition's open-addressing table holds one entry per distinct
+// key; rows sharing a key are chained through next_ in file order.
+//
+// Probe: each batch is partitioned the same way, every partition is looked
+// up against its own table (in parallel for large batches), and the matches
+// are emitted in batch order, duplicates in file order, in pieces of bounded
+// size (a key repeated many times on both sides cannot exhaust memory).
+//
+// NULL keys never match (SQL semantics)
+
+class HashJoin {
+public:
+    // Read op.filepath (only op.columns, if set) and build the hash table
+    HashJoin(const PhysicalOp::JoinOp& op, ThreadPool* pool);
+
+    // The file's contents, for the binder's schema
+    const Table& build_table() const {
+        return build_;
+    }
+    // False for columns with no non-NULL value (see BatchReader)
+    const std::vector<bool>& inferred_types() const {
+        return inferred_;
+    }
+
+    // Position in the output of a probe: the next (batch row, build row) pair
+    struct Cursor {
+        size_t row = 0;
+        uint32_t build = kNone;  // kNone = start of row's matches
+    };
+
+    // First matching build row of every row of batch (kNone = no match)
+    std::vector<uint32_t> match(const Table& batch, ThreadPool* pool) const;
+
+    // Replace out with the next matching pairs (at most max_rows) from cursor:
+    // the batch's columns, followed by the file's other columns (those the
+    // batch does not already have). Returns false once every pair is emitted
+    bool emit(const Table& batch, const std::vector<uint32_t>& matches, Cursor& cursor,
+              size_t max_rows, Table& out) const;
+
+    static constexpr uint32_t kNone = UINT32_MAX;
+
+private:
+    struct Partition {
+        std::vector<uint64_t> slots;  // (hash tag) | (entry + 1); 0 = empty
+        std::vector<uint32_t> heads;  // Per entry: first build row with the key
+    };
+
+    // Build row heading the chain for a probe row (kNone if no match)
+    uint32_t find(const Partition& part, const std::vector<const Column*>& probe_keys, size_t row,
+                  uint64_t hash) const;
+
+    size_t partition_of(uint64_t hash) const {
+        return radix_bits_ == 0 ? 0 : static_cast<size_t>(hash >> (64 - radix_bits_));
+    }
+
+    std::vector<std::string> keys_;
+    Table build_;
+    std::vector<bool> inferred_;
+    std::vector<const Column*> build_keys_;
+    std::vector<size_t> payload_;  // Build columns that are not keys
+    int radix_bits_ = 0;
+    std::vector<Partition> partitions_;
+    std::vector<uint32_t> next_;  // Per build row: next row with the same key (kNone = last)
+};
+
+}  // namespace joy
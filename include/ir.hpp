@@ -1,5 +1,6 @@
 #pragma once
 
+#include <optional>
 #include <string>
 #include <variant>
 #include <vector>
@@ -19,7 +20,7 @@ struct IRExpr {
         PUSH_DOUBLE,
         PUSH_STRING,
         PUSH_BOOL,
-        LOAD_COLUMN,  // Load column value at current row
+        LOAD_COLUMN,  // Load column value at current row (operand: name, or index once bound)
 
         // Arithmetic
         ADD,
@@ -36,11 +37,71 @@ struct IRExpr {
         LTE,
         GTE,
 
-        // Logical
+        // Logical (AND/OR evaluate both operands; NULL counts as false)
         NOT,
+        AND,
+        OR,
 
         // Ternary conditional
-        TERNARY  // Pop 3: condition, true_val, false_val; push result
+        TERNARY,  // Pop 3: condition, true_val, false_val; push result
+
+        // String predicates: pop a STRING, push whether it matches the
+        // pattern operand (NULL stays NULL)
+        STARTS_WITH,
+        ENDS_WITH,
+        CONTAINS,
+        IEQUALS,  // Equal ignoring ASCII case
+
+        // Typed opcodes (emitted by the binder, never by the compiler)
+        // Operand types are known statically, so these skip the per-row type
+        // dispatch; NULL handling is the same as for the generic opcodes
+        CAST_F64,  // Convert INT64 on top of stack to DOUBLE (numeric promotion)
+
+        ADD_I64,
+        ADD_F64,
+        SUB_I64,
+        SUB_F64,
+        MUL_I64,
+        MUL_F64,
+        DIV_I64,
+        DIV_F64,
+        NEG_I64,
+        NEG_F64,
+
+        EQ_I64,
+        NEQ_I64,
+        LT_I64,
+        GT_I64,
+        LTE_I64,
+        GTE_I64,
+        EQ_F64,
+        NEQ_F64,
+        LT_F64,
+        GT_F64,
+        LTE_F64,
+        GTE_F64,
+        EQ_STR,
+        NEQ_STR,
+        LT_STR,
+        GT_STR,
+        LTE_STR,
+        GTE_STR,
+        EQ_BOOL,
+        NEQ_BOOL,
+
+        // Compare top of stack against the literal operand (fused PUSH + compare)
+        EQ_I64_CONST,
+        NEQ_I64_CONST,
+        LT_I64_CONST,
+        GT_I64_CONST,
+        LTE_I64_CONST,
+        GTE_I64_CONST,
+        EQ_F64_CONST,
+        NEQ_F64_CONST,
+        LT_F64_CONST,
+        GT_F64_CONST,
+        LTE_F64_CONST,
+        GTE_F64_CONST
     };
 
     struct Instruction {
@@ -50,6 +111,10 @@ struct IRExpr {
     };
 
     std::vector<Instruction> instructions;
+
+    // Filled in by the binder (see binder.hpp)
+    std::optional<ColumnType> type;  // Static result type (nullopt = depends on the row)
+    bool statically_typed = false;   // Every value has a static type: no generic opcodes left
 };
 
 // ============================================================================
@@ -60,10 +125,15 @@ enum class OpType {
     SCAN,                          // Read CSV into table
     FILTER,                        // Filter rows by predicate (scalar, row-at-a-time)
     VECTORIZED_FILTER,             // Filter rows using vectorized operations (FAST!)
+    LOGICAL_FILTER,                // Filter rows by an and/or tree, refining the selection
     PROJECT,                       // Select specific columns
     TRANSFORM,                     // Add/update column with expression (scalar)
     VECTORIZED_TRANSFORM,          // Add/update column with vectorized arithmetic (FAST!)
     VECTORIZED_TERNARY_TRANSFORM,  // Add/update column with vectorized ternary (FAST!)
+    AGGREGATE,                     // Group rows by key and aggregate (pipeline breaker)
+    JOIN,                          // Inner hash join with a second CSV file
+    SORT,                          // Order rows by key columns (pipeline breaker)
+    LIMIT,                         // Keep the first N rows
     WRITE                          // Write table to CSV
 };
 
@@ -78,15 +148,36 @@ enum class VectorOp {
     GTE,  // Greater than or equal
     LTE,  // Less than or equal
     EQ,   // Equal
-    NEQ   // Not equal
+    NEQ,  // Not equal
+
+    // String predicates (value: the pattern; column: STRING)
+    STARTS_WITH,
+    ENDS_WITH,
+    CONTAINS,
+    IEQUALS  // Equal ignoring ASCII case
+};
+
+// Aggregate functions (NULL inputs are skipped, as in SQL)
+enum class AggOp {
+    SUM,    // Sum (INT64 stays INT64; NULL if no non-NULL input)
+    COUNT,  // Rows (count()) or non-NULL values (count(col))
+    MIN,    // Smallest value (numbers or strings)
+    MAX,    // Largest value (numbers or strings)
+    AVG     // Mean as DOUBLE
 };
 
 struct PhysicalOp {
     OpType type;
 
     // Operator-specific data
+    // Several files (or glob patterns) are read in order as one input
+    // Example: from "logs/2026-10-*.csv" → ScanOp{{"logs/2026-10-*.csv"}}
     struct ScanOp {
-        std::string filepath;
+        std::vector<std::string> filepaths;
+        std::vector<DeclaredColumn> schema;  // Types not to infer (from ... schema (...))
+        // Columns the rest of the pipeline reads (set by the optimizer's
+        // projection pushdown; nullopt = all columns)
+        std::optional<std::vector<std::string>> columns;
     };
 
     struct FilterOp {
@@ -95,11 +186,36 @@ struct PhysicalOp {
 
     // Vectorized filter - processes entire column at once
     // Example: "age > 30" → VectorizedFilterOp{"age", GT, int(30)}
+    // Example: "revenue > cost" → VectorizedFilterOp{"revenue", GT, {}, true, "cost"}
+    // Example: "contains(url, "/api/")" → VectorizedFilterOp{"url", CONTAINS, "/api/"}
     struct VectorizedFilterOp {
         std::string column_name;
         VectorOp op;
         // Scalar value to compare against (type depends on column)
         std::variant<int64_t, double, std::string> value;
+
+        // Compare against a second column instead of value
+        bool is_right_column = false;
+        std::string right_column_name;
+    };
+
+    // Boolean combination of filter predicates
+    // Example: filter age > 30 and (dept == "Ops" or salary > 1000)
+    //   → AND[COMPARE age > 30, OR[COMPARE dept == "Ops", COMPARE salary > 1000]]
+    // Evaluated by refining the selection: each conjunct only sees the rows
+    // that passed the previous ones, each disjunct only the rows that are
+    // still undecided. Leaves that are not simple comparisons are scalar
+    // predicates evaluated on those rows
+    struct FilterNode {
+        enum class Kind { COMPARE, PREDICATE, AND, OR };
+        Kind kind;
+        VectorizedFilterOp compare;      // COMPARE
+        IRExpr predicate;                // PREDICATE
+        std::vector<FilterNode> children;  // AND / OR (flattened, two or more)
+    };
+
+    struct LogicalFilterOp {
+        FilterNode root;  // AND or OR
     };
 
     struct ProjectOp {
@@ -109,6 +225,11 @@ struct PhysicalOp {
     struct TransformOp {
         std::string column_name;
         IRExpr expression;
+
+        // Column type of the result, fixed by the binder for the whole run:
+        // the expression's static type, else the type of the branches that
+        // have one (cond ? missing : 1 → INT64), else STRING
+        ColumnType result_type = ColumnType::STRING;
     };
 
     // Vectorized transform - processes entire columns at once (FAST!)
@@ -154,12 +275,58 @@ struct PhysicalOp {
         ColumnType result_type;
     };
 
+    // Hash aggregation - consumes every batch before producing output
+    // Example: "group by dept aggregate sum(salary)" → AggregateOp{{"dept"}, {{SUM, "salary"}}}
+    // Output: key columns, then one column per aggregate, one row per group
+    // (groups appear in the order their first row arrived)
+    struct AggregateOp {
+        struct Aggregate {
+            AggOp op;
+            std::string column;  // Input column (empty for count())
+            std::string output_name;
+        };
+        std::vector<std::string> keys;  // Empty = one group over all rows
+        std::vector<Aggregate> aggregates;
+    };
+
+    // Hash join - the file is read into a hash table once; every batch probes it
+    // Example: join "dim.csv" on id → JoinOp{"dim.csv", {"id"}}
+    // Output: the batch's columns, then the file's other columns (columns the
+    // batch already has are not added), one row per matching pair
+    struct JoinOp {
+        std::string filepath;
+        std::vector<std::string> keys;
+        // Columns of the file the rest of the pipeline reads (set by the
+        // optimizer's projection pushdown; nullopt = all columns)
+        std::optional<std::vector<std::string>> columns;
+    };
+
+    // Sort - consumes every batch before producing output (stable: rows with
+    // equal keys keep their input order; NULLs sort last in either direction)
+    // Example: "sort by score desc" → SortOp{{{"score", true}}}
+    // With limit (set by the optimizer for "sort ... limit N"), only the first
+    // N rows are produced and only those are kept while reading the input
+    struct SortOp {
+        struct Key {
+            std::string column;
+            bool descending;
+        };
+        std::vector<Key> keys;  // Most significant first
+        std::optional<size_t> limit;
+    };
+
+    // Limit - passes the first count rows and drops the rest
+    struct LimitOp {
+        size_t count;
+    };
+
     struct WriteOp {
         std::string filepath;
     };
 
-    std::variant<ScanOp, FilterOp, VectorizedFilterOp, ProjectOp, TransformOp,
-                 VectorizedTransformOp, VectorizedTernaryTransformOp, WriteOp>
+    std::variant<ScanOp, FilterOp, VectorizedFilterOp, LogicalFilterOp, ProjectOp, TransformOp,
+                 VectorizedTransformOp, VectorizedTernaryTransformOp, AggregateOp, JoinOp, SortOp,
+                 LimitOp, WriteOp>
         data;
 };
 
@@ -171,4 +338,40 @@ struct ExecutionPlan {
     std::vector<PhysicalOp> operators;
 };
 
+// ============================================================================
+// String Predicate Kinds
+// ============================================================================
+// The kernels' spelling of a string predicate opcode or filter operator
+// (nullopt for anything else)
+
+inline std::optional<StringMatch> string_match_of(IRExpr::OpCode op) {
+    switch (op) {
+    case IRExpr::OpCode::STARTS_WITH:
+        return StringMatch::PREFIX;
+    case IRExpr::OpCode::ENDS_WITH:
+        return StringMatch::SUFFIX;
+    case IRExpr::OpCode::CONTAINS:
+        return StringMatch::CONTAINS;
+    case IRExpr::OpCode::IEQUALS:
+        return StringMatch::IEQUALS;
+    default:
+        return std::nullopt;
+    }
+}
+
+inline std::optional<StringMatch> string_match_of(VectorOp op) {
+    switch (op) {
+    case VectorOp::STARTS_WITH:
+        return StringMatch::PREFIX;
+    case VectorOp::ENDS_WITH:
+        return StringMatch::SUFFIX;
+    case VectorOp::CONTAINS:
+        return StringMatch::CONTAINS;
+    case VectorOp::IEQUALS:
+        return StringMatch::IEQUALS;
+    default:
+        return std::nullopt;
+    }
+}
+
 }  // namespace joy
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "batch_interpreter.hpp"
+#include "ir.hpp"
+#include "table.hpp"
+
+namespace joy {
+
+// ============================================================================
+// Expression JIT (native kernels for bound expressions)
+// ============================================================================
+// Compiles a bound IRExpr, together with the types of the columns it reads,
+// into one fused native loop (LLVM ORC): each row loads its column values
+// and validity bits straight from the column buffers, runs the whole
+// expression in registers and stores the result, so no stack slots are
+// materialized between instructions.
+//
+// Only available when joy is built with LLVM (JOY_JIT); otherwise, or when
+// an expression uses something the JIT does not compile (strings, or
+// opcodes whose type depends on the row), compile() returns nullptr and
+// callers keep using the BatchInterpreter. Results and errors are exactly
+// the interpreter's.
+
+// Rows an expression must evaluate (counting the current batch) before the
+// VM compiles it: compiling costs a few milliseconds, so short inputs never pay it
+constexpr size_t kJitMinRows = 256 * 1024;
+
+class JitKernel {
+public:
+    ~JitKernel();
+
+    // Static type of the result (same as the expression's)
+    ColumnType result_type() const {
+        return result_type_;
+    }
+
+    // Same contract as BatchInterpreter::evaluate, for rows [begin, begin + n)
+    // of table (any n), but into the caller's result slot, so threads may
+    // share one kernel; table must have the column types it was compiled for
+    void evaluate(const Table& table, size_t begin, size_t n, const uint8_t* active,
+                  VectorSlot& result) const;
+
+    // True if table's columns still have the types the kernel was compiled for
+    bool matches(const Table& table) const;
+
+private:
+    friend class ExpressionJit;
+    struct Code;  // Compiled machine code (released with the kernel)
+    JitKernel() = default;
+
+    std::unique_ptr<Code> code_;
+    std::vector<int> columns_;  // Table column per kernel input
+    std::vector<ColumnType> column_types_;
+    ColumnType result_type_ = ColumnType::INT64;
+};
+
+class ExpressionJit {
+public:
+    ExpressionJit();
+    ~ExpressionJit();
+
+    // False if joy was built without LLVM or the host target is unsupported
+    bool available() const;
+
+    // Native kernel for bound expr over table's column types, or nullptr if
+    // the expression needs the interpreter
+    std::unique_ptr<JitKernel> compile(const IRExpr& expr, const Table& table);
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
+}  // namespace joy
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "ir.hpp"
+#include "table.hpp"
+#include "vm.hpp"
+
+namespace joy {
+
+// ============================================================================
+// Embedding API
+// ============================================================================
+// For applications that run pipelines in-process, e.g. a service running one
+// query on many inputs per second. A Query is lexed, parsed, compiled and
+// optimized once; a Session then runs it any number of times. Input may be
+// the files the query names, a Table or CSV text in memory, or any
+// BatchReader; the batches of a WRITE may go to a callback instead of its
+// file.
+//
+// A Session keeps its thread pool, worker VMs and per-worker buffers between
+// runs, and while a query's input keeps the same schema it also keeps the
+// query's bound plan and JIT-compiled expressions (see VM::execute).
+//
+//   Query query = Query::compile(R"(
+//       from "requests"
+//       filter status >= 500
+//       select path, status
+//       write "errors"
+//   )");
+//   Session session;
+//   session.run_csv(query, text, {{"errors", [&](const Table& batch) { ... }}});
+//
+// Errors are thrown as in the command line tool: ParseError and CompileError
+// from compile(), RuntimeError (or std::runtime_error from I/O) from run().
+// A Query is immutable and may be shared by Sessions on several threads; a
+// Session runs one query at a time.
+
+class Query {
+public:
+    // Lex, parse, compile and optimize source
+    static Query compile(const std::string& source);
+
+    const ExecutionPlan& plan() const {
+        return *plan_;
+    }
+
+private:
+    friend class Session;
+    explicit Query(std::shared_ptr<const ExecutionPlan> plan) : plan_(std::move(plan)) {}
+
+    std::shared_ptr<const ExecutionPlan> plan_;
+};
+
+// Receives each batch a WRITE produces, in order (the batch is only valid
+// during the call)
+using BatchCallback = std::function<void(const Table& batch)>;
+
+// Callbacks by the path of the WRITE they replace (other WRITEs write files)
+using Outputs = std::unordered_map<std::string, BatchCallback>;
+
+// A Table as the input of a run: the columns are moved, not copied, into the
+// first batch (all of it unless the batch size is smaller, in which case
+// each batch is gathered from it). Declared column types must match
+class TableReader : public BatchReader {
+public:
+    explicit TableReader(Table table, const std::vector<DeclaredColumn>* schema = nullptr);
+
+    bool next_batch(Table& out, size_t max_rows) override;
+
+    const std::vector<std::string>& column_names() const override {
+        return names_;
+    }
+    const std::vector<ColumnType>& column_types() const override {
+        return types_;
+    }
+    const std::vector<bool>& inferred_types() const override {
+        return inferred_;
+    }
+
+private:
+    Table table_;  // Moved into the batch if it fits one
+    size_t num_rows_;
+    size_t next_row_ = 0;
+    bool started_ = false;
+    std::vector<std::string> names_;
+    std::vector<ColumnType> types_;
+    std::vector<bool> inferred_;  // Every type is real (a Table has no defaults)
+};
+
+class Session {
+public:
+    explicit Session(VMOptions options = {}) : vm_(options) {}
+
+    // Read the files the query's scan names
+    void run(const Query& query, const Outputs& outputs = {});
+
+    // Read input instead (moved into the run; see TableReader)
+    void run(const Query& query, Table input, const Outputs& outputs = {});
+
+    // Read CSV text instead, tokenized in place (csv must outlive the call)
+    void run_csv(const Query& query, std::string_view csv, const Outputs& outputs = {});
+
+    // Read batches from a reader the caller owns
+    void run(const Query& query, BatchReader& input, const Outputs& outputs = {});
+
+    // Per-operator profile of the last run (with VMOptions::analyze)
+    const ExecutionProfile& profile() const {
+        return vm_.profile();
+    }
+
+private:
+    void execute(const Query& query, ExecutionIO io, const Outputs& outputs);
+
+    VM vm_;
+};
+
+}  // namespace joy
@@ -0,0 +1,146 @@
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "table.hpp"
+
+namespace joy {
+
+// ============================================================================
+// Joyc: Native Columnar File Format (.joyc)
+// ============================================================================
+// A .joyc file stores tables the way Column holds them in memory, so loading
+// one is a memory copy per buffer instead of parsing text. Every batch written
+// becomes a chunk; the chunk directory at the end of the file lets readers
+// cut batches anywhere and decode columns in parallel.
+//
+// Layout (little-endian, every buffer starts on a 64-byte boundary):
+//   "JOYC" u32 version
+//   chunk buffers ...
+//   footer:
+//     u32 num_columns, per column: u32 name_length, name, u8 type, u8 has_values
+//     u64 num_chunks, per chunk: u64 num_rows, per column:
+//       u8 encoding, kJoycBuffers × (u64 offset, u64 size)
+//   u64 footer_offset, "JOYC"
+//
+// Buffers of one column in one chunk:
+//   [0] validity bitmap words (bit set = value present)
+//   [1] INT64/DOUBLE: values; BOOL: bitmap words;
+//       STRING: u64 offsets (rows + 1, PLAIN) or dictionary offsets (DICT)
+//   [2] STRING: value bytes (PLAIN) or dictionary bytes (DICT);
+//       INT64/DOUBLE: zone map, per kZoneRows rows (min, max, u64 null count)
+//   [3] STRING DICT: i32 codes, one per row
+//
+// Version 1 files (no zone maps) are still read
+
+constexpr uint32_t kJoycVersion = 2;
+constexpr size_t kJoycAlignment = 64;
+constexpr size_t kJoycBuffers = 4;
+
+enum class JoycEncoding : uint8_t { PLAIN, DICT };
+
+struct JoycBuffer {
+    uint64_t offset = 0;
+    uint64_t size = 0;
+};
+
+struct JoycColumnChunk {
+    JoycEncoding encoding = JoycEncoding::PLAIN;
+    JoycBuffer buffers[kJoycBuffers];
+};
+
+// Writes batches to a .joyc file, one chunk per non-empty batch
+// The schema is taken from the first batch; the footer is written by close()
+class JoycWriter : public BatchWriter {
+public:
+    explicit JoycWriter(const std::string& filepath);
+    ~JoycWriter() override;
+
+    void write(const Table& batch) override;
+    void close() override;
+
+private:
+    struct ColumnInfo {
+        std::string name;
+        ColumnType type;
+        bool has_values = false;  // Any non-NULL value written
+    };
+
+    // Write size bytes at the next aligned offset
+    JoycBuffer write_buffer(const void* data, size_t size);
+
+    std::string filepath_;
+    std::ofstream file_;
+    uint64_t pos_ = 0;  // Bytes written so far
+    bool schema_known_ = false;
+    bool closed_ = false;
+    std::vector<ColumnInfo> columns_;
+    std::vector<uint64_t> chunk_rows_;
+    std::vector<std::vector<JoycColumnChunk>> chunks_;  // [chunk][column]
+};
+
+// Reads a .joyc file as a sequence of row batches
+// The file is memory-mapped; a batch copies its rows' buffers straight out of
+// the mapping (bit ranges for bitmaps), and its columns are decoded in
+// parallel on the thread pool. Unselected columns are never touched, and
+// pages of chunks already handed out are released as the reader moves on
+class JoycReader : public BatchReader {
+public:
+    // columns: only these columns are returned, in file order (nullptr = all)
+    explicit JoycReader(const std::string& filepath, ThreadPool* pool = nullptr,
+                        const std::vector<std::string>* columns = nullptr);
+
+    bool next_batch(Table& out, size_t max_rows) override;
+
+    const std::vector<std::string>& column_names() const override {
+        return headers_;
+    }
+    const std::vector<ColumnType>& column_types() const override {
+        return types_;
+    }
+    const std::vector<bool>& inferred_types() const override {
+        return inferred_;
+    }
+
+private:
+    struct Chunk {
+        uint64_t num_rows = 0;
+        uint64_t end = 0;                      // Offset past the chunk's last buffer
+        std::vector<JoycColumnChunk> columns;  // Per file column
+        // Per file column: dictionary of a DICT chunk, built on first use
+        std::vector<std::shared_ptr<StringDictionary>> dicts;
+    };
+
+    // Rows [begin, begin + count) of a chunk
+    struct Piece {
+        size_t chunk, begin, count;
+    };
+
+    // Append rows [begin, begin + count) of file column field in chunk to col
+    void append_rows(Column& col, Chunk& chunk, size_t field, size_t begin, size_t count);
+
+    // Zone map of col, decoded from file column field of pieces
+    std::shared_ptr<const ZoneMap> zone_map(const Column& col, size_t field,
+                                            const std::vector<Piece>& pieces) const;
+
+    const char* buffer(const JoycBuffer& buf) const {
+        return file_.data() + buf.offset;
+    }
+
+    MappedFile file_;
+    ThreadPool* pool_;
+    std::vector<std::string> headers_;  // Names of the returned columns
+    std::vector<size_t> fields_;        // File column of each returned column
+    std::vector<ColumnType> types_;
+    std::vector<bool> inferred_;
+    std::vector<Chunk> chunks_;
+    size_t chunk_ = 0;  // Position of the next row: chunk, then row within it
+    size_t row_ = 0;
+    bool started_ = false;
+};
+
+}  // namespace joy
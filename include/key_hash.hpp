@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "table.hpp"
+
+namespace joy {
+
+// ============================================================================
+// Key Hashing (shared by hash aggregation and hash join)
+// ============================================================================
+// A row's hash combines the per-column value hashes of its keys, in order.
+// Values that compare equal hash alike across encodings (a dictionary code
+// and the same string in an arena; -0.0 and 0.0); NULL hashes to a constant
+
+// Hash of every entry of a dictionary-encoded column (empty for other
+// columns), computed once per batch and shared by the threads hashing it
+std::vector<uint64_t> dictionary_hashes(const Column& col);
+
+// Hash rows [begin, end) of keys into out (out[i] is row begin + i)
+// dict_hashes[k] = dictionary_hashes(*keys[k])
+void hash_keys(const std::vector<const Column*>& keys,
+               const std::vector<std::vector<uint64_t>>& dict_hashes, size_t begin, size_t end,
+               std::vector<uint64_t>& out);
+
+// Whether row a of keys_a equals row b of keys_b (same column types)
+// NULL equals NULL here (grouping); joins skip NULL keys before comparing
+bool keys_equal(const std::vector<const Column*>& keys_a, size_t a,
+                const std::vector<const Column*>& keys_b, size_t b);
+
+}  // namespace joy
@@ -16,7 +16,19 @@ enum class TokenType {
     SELECT,
     WRITE,
     TRANSFORM,
+    GROUP,
+    BY,
+    AGGREGATE,
+    JOIN,
+    ON,
+    SORT,
+    LIMIT,
+    ASC,
+    DESC,
+    SCHEMA,
     NOT,
+    AND,
+    OR,
 
     // Literals
     IDENT,
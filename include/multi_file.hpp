@@ -0,0 +1,86 @@
+#pragma once
+
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "ir.hpp"
+#include "table.hpp"
+#include "thread_pool.hpp"
+
+namespace joy {
+
+// ============================================================================
+// Multi-File Sources (from "a.csv", "logs/*.csv")
+// ============================================================================
+// A scan may name several files, each a path or a glob pattern (*, ? and
+// [...] in the last path component; matches are read in name order). The
+// files are read in order as one input with one schema:
+//   - columns are matched by name, in order of first appearance; a file
+//     without a column contributes NULLs
+//   - a declared column (schema clause) has its declared type in every file
+//   - any other column's type is unified across files by the CSV inference rules:
+//     INT64 and DOUBLE widen to DOUBLE, any other mix to STRING (CSV files
+//     are parsed as the unified type; other formats only widen INT64)
+//
+// Files smaller than kWholeFileBytes are read several at a time, one per
+// thread of the pool, each whole; larger ones stream through their own
+// reader, which parses in parallel itself
+
+// Files up to this size are read whole, alongside other small files
+constexpr size_t kWholeFileBytes = 64 * 1024 * 1024;
+
+// Assumed text bytes per byte of a compressed file when comparing it with
+// kWholeFileBytes (CSV typically compresses 5-10x)
+constexpr size_t kCompressionRatio = 8;
+
+// Paths matching pattern, sorted (a path without wildcards is returned as is)
+// Throws if a pattern matches nothing
+std::vector<std::string> expand_glob(const std::string& pattern);
+
+class MultiFileReader : public BatchReader {
+public:
+    // filepaths: already expanded, two or more
+    MultiFileReader(const std::vector<std::string>& filepaths, ThreadPool* pool,
+                    const std::vector<std::string>* columns,
+                    const std::vector<PhysicalOp::VectorizedFilterOp>* predicates,
+                    const std::vector<DeclaredColumn>* schema = nullptr);
+
+    bool next_batch(Table& out, size_t max_rows) override;
+
+    const std::vector<std::string>& column_names() const override {
+        return names_;
+    }
+    const std::vector<ColumnType>& column_types() const override {
+        return types_;
+    }
+    const std::vector<bool>& inferred_types() const override {
+        return inferred_;
+    }
+
+private:
+    struct Source {
+        std::string filepath;
+        std::unique_ptr<BatchReader> reader;
+        bool whole = false;  // Small: read in one go on a pool thread
+    };
+
+    // Read the next run of small files (up to one per thread) into ready_
+    void read_whole_files(size_t max_rows);
+    // Move one batch of the current large file into ready_
+    void read_streaming(size_t max_rows);
+    // batch with the unified columns, in order and of the unified types
+    Table conform(Table batch) const;
+
+    ThreadPool* pool_;
+    std::vector<Source> sources_;
+    size_t next_ = 0;  // First source not completely read
+    std::vector<std::string> names_;
+    std::vector<ColumnType> types_;
+    std::vector<bool> inferred_;
+    std::deque<Table> ready_;  // Conformed batches not yet handed out, in file order
+    bool started_ = false;
+};
+
+}  // namespace joy
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <set>
+#include <string>
+
+#include "ir.hpp"
+
+namespace joy {
+
+// ============================================================================
+// Optimizer (Logical Plan Rewrites Between Compiler and VM)
+// ============================================================================
+// The compiler translates one statement at a time; the optimizer rewrites
+// the whole plan before it runs:
+//   1. Constant folding: literal-only subexpressions are evaluated once
+//      (salary > 1000 * 12 → salary > 12000), after which filters that became
+//      "column op literal" use the vectorized kernels and filters that are
+//      always true are dropped
+//   2. Predicate pushdown: filters move ahead of transforms that don't
+//      produce a column they read, and ahead of selects, so fewer rows are
+//      computed and copied
+//   3. Top-N: a limit right after a sort becomes part of the sort, which
+//      then keeps only N rows instead of sorting its whole input
+//   4. Projection pushdown: the scan is told which columns the pipeline
+//      reads, so the reader skips every other field while tokenizing
+// Rewrites never need the input schema, so they run before the file is opened
+
+class Optimizer {
+public:
+    ExecutionPlan optimize(const ExecutionPlan& plan);
+
+    // Fold the constant subexpressions of expr
+    IRExpr fold_constants(const IRExpr& expr);
+
+private:
+    void fold_plan_constants(ExecutionPlan& plan);
+    void push_down_filters(ExecutionPlan& plan);
+    void fuse_top_n(ExecutionPlan& plan);
+    void push_down_projection(ExecutionPlan& plan);
+};
+
+// Names of the columns an operator reads
+std::set<std::string> referenced_columns(const PhysicalOp& op);
+
+}  // namespace joy
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "file_format.hpp"
+#include "ir.hpp"
+#include "table.hpp"
+
+namespace joy {
+
+// ============================================================================
+// Apache Parquet (.parquet)
+// ============================================================================
+// A Parquet file is a sequence of row groups holding one column chunk per
+// column, followed by a footer (Thrift compact protocol) with the schema,
+// where every chunk starts and per-chunk statistics. Supported:
+//   - Flat schemas of REQUIRED and OPTIONAL columns
+//   - BOOLEAN, INT32, INT64, FLOAT, DOUBLE and BYTE_ARRAY columns (INT32 and
+//     FLOAT are widened to INT64 and DOUBLE)
+//   - PLAIN and dictionary encodings, data pages v1 and v2
+//   - UNCOMPRESSED and SNAPPY pages
+// Columns of other types can be read past but not selected.
+//
+// Reading: only the selected columns' chunks are decoded, row groups whose
+// statistics show that a pushed-down filter matches no row are skipped
+// without being read, and each row group's chunks are decoded in parallel.
+// Dictionary-encoded strings stay dictionary-encoded.
+//
+// Writing: one row group per batch, every column OPTIONAL and uncompressed
+// with min/max/null-count statistics; values are PLAIN-encoded, except that
+// dictionary-encoded strings keep their dictionary
+
+class ParquetReader : public BatchReader {
+public:
+    // columns: only these columns are returned, in file order (nullptr = all)
+    // predicates: row groups where one of these matches no row are skipped
+    explicit ParquetReader(
+        const std::string& filepath, ThreadPool* pool = nullptr,
+        const std::vector<std::string>* columns = nullptr,
+        const std::vector<PhysicalOp::VectorizedFilterOp>* predicates = nullptr);
+
+    bool next_batch(Table& out, size_t max_rows) override;
+
+    const std::vector<std::string>& column_names() const override {
+        return headers_;
+    }
+    const std::vector<ColumnType>& column_types() const override {
+        return types_;
+    }
+    const std::vector<bool>& inferred_types() const override {
+        return inferred_;
+    }
+
+    // Row groups skipped because of their statistics
+    size_t skipped_row_groups() const {
+        return skipped_;
+    }
+
+private:
+    // A returned column
+    struct Field {
+        int32_t physical_type = 0;
+        bool optional = false;     // May hold NULLs (definition levels present)
+        bool is_unsigned = false;  // INT32 holding unsigned values
+    };
+
+    // Where a column chunk's pages are
+    struct Chunk {
+        uint64_t offset = 0;  // First page (dictionary page if any)
+        uint64_t size = 0;
+        int64_t num_values = 0;
+        int32_t codec = 0;
+        ColumnStats stats;
+    };
+
+    struct RowGroup {
+        uint64_t num_rows = 0;
+        std::vector<Chunk> chunks;  // Per returned column
+    };
+
+    // Decode every page of a column chunk into col
+    void decode_chunk(const Chunk& chunk, size_t c, Column& col) const;
+
+    std::string filepath_;
+    MappedFile file_;
+    ThreadPool* pool_;
+    std::vector<std::string> headers_;
+    std::vector<ColumnType> types_;
+    std::vector<bool> inferred_;
+    std::vector<Field> fields_;  // Per returned column
+    std::vector<RowGroup> row_groups_;
+    size_t skipped_ = 0;
+    size_t group_ = 0;  // Next row group to decode
+    Table current_;     // Decoded row group; rows before row_ were handed out
+    size_t row_ = 0;
+    bool started_ = false;
+};
+
+class ParquetWriter : public BatchWriter {
+public:
+    explicit ParquetWriter(const std::string& filepath);
+    ~ParquetWriter() override;
+
+    void write(const Table& batch) override;
+    void close() override;  // Writes the footer
+
+private:
+    // Write one column of batch as a column chunk; returns its ColumnChunk metadata
+    std::string write_chunk(const Column& col, size_t num_rows, uint64_t& bytes);
+
+    std::string filepath_;
+    std::ofstream file_;
+    uint64_t pos_ = 0;
+    bool schema_known_ = false;
+    bool closed_ = false;
+    std::vector<std::pair<std::string, ColumnType>> schema_;
+    std::vector<std::string> row_groups_;  // Serialized RowGroup structs
+    uint64_t num_rows_ = 0;
+};
+
+}  // namespace joy
@@ -52,16 +52,26 @@ private:
     Stmt parse_select_stmt();
     Stmt parse_transform_stmt();
     Stmt parse_write_stmt();
+    Stmt parse_group_stmt();
+    Stmt parse_aggregate_stmt();
+    std::vector<AggregateCall> parse_aggregate_list();
+    AggregateCall parse_aggregate_call();
+    Stmt parse_join_stmt();
+    Stmt parse_sort_stmt();
+    Stmt parse_limit_stmt();
 
     // Expression parsing (precedence climbing)
     std::unique_ptr<Expr> parse_expr();
     std::unique_ptr<Expr> parse_ternary();
+    std::unique_ptr<Expr> parse_or();
+    std::unique_ptr<Expr> parse_and();
     std::unique_ptr<Expr> parse_equality();
     std::unique_ptr<Expr> parse_comparison();
     std::unique_ptr<Expr> parse_term();
     std::unique_ptr<Expr> parse_factor();
     std::unique_ptr<Expr> parse_unary();
     std::unique_ptr<Expr> parse_primary();
+    std::unique_ptr<Expr> parse_call(const Token& func);
 
     // Column list parsing
     std::vector<std::string> parse_column_list();
@@ -0,0 +1,136 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "ir.hpp"
+
+namespace joy {
+
+// ============================================================================
+// Plan Description (--explain)
+// ============================================================================
+
+// Operator variant name, e.g. "VECTORIZED_FILTER"
+const char* operator_name(const PhysicalOp& op);
+
+// Operator arguments in source-like syntax, e.g. "age > 30"
+std::string describe_operator(const PhysicalOp& op);
+
+// Expression bytecode decompiled to infix, e.g. "(price * qty) > 100"
+std::string describe_expr(const IRExpr& expr);
+
+// One line per operator: index, variant and arguments
+std::string explain_plan(const ExecutionPlan& plan);
+std::string explain_plan_json(const ExecutionPlan& plan);
+
+// ============================================================================
+// Heap Accounting
+// ============================================================================
+// Counts heap bytes while enabled. The counters are fed by operator new and
+// operator delete replacements that call record_alloc / record_free when
+// enabled() (joy's main.cpp installs them); without them every count stays zero
+// Each count is kept for the whole process and for the calling thread: while
+// several threads run operators at once, only a thread's own counters say
+// what its operator allocated
+
+class HeapStats {
+public:
+    static void enable(bool on) {
+        enabled_.store(on, std::memory_order_relaxed);
+    }
+
+    static bool enabled() {
+        return enabled_.load(std::memory_order_relaxed);
+    }
+
+    static void record_alloc(size_t bytes) {
+        allocated_.fetch_add(bytes, std::memory_order_relaxed);
+        int64_t now = in_use_.fetch_add(static_cast<int64_t>(bytes), std::memory_order_relaxed) +
+                      static_cast<int64_t>(bytes);
+        int64_t peak = peak_.load(std::memory_order_relaxed);
+        while (now > peak && !peak_.compare_exchange_weak(peak, now, std::memory_order_relaxed)) {
+        }
+        thread_allocated_ += bytes;
+        thread_in_use_ += static_cast<int64_t>(bytes);
+        thread_peak_ = std::max(thread_peak_, thread_in_use_);
+    }
+
+    static void record_free(size_t bytes) {
+        in_use_.fetch_sub(static_cast<int64_t>(bytes), std::memory_order_relaxed);
+        thread_in_use_ -= static_cast<int64_t>(bytes);
+    }
+
+    // Bytes allocated since enabled (frees are not subtracted)
+    static uint64_t allocated() {
+        return allocated_.load(std::memory_order_relaxed);
+    }
+
+    // Bytes in use, relative to when accounting was enabled
+    static int64_t in_use() {
+        return in_use_.load(std::memory_order_relaxed);
+    }
+
+    // Highest in_use() since the last reset_peak()
+    static int64_t peak() {
+        return peak_.load(std::memory_order_relaxed);
+    }
+    static void reset_peak() {
+        peak_.store(in_use(), std::memory_order_relaxed);
+    }
+
+    // The same counts for the calling thread alone. Memory freed by another
+    // thread than the one that allocated it lowers the freeing thread's
+    // in-use count, so only differences over a stretch of work are meaningful
+    static uint64_t thread_allocated() {
+        return thread_allocated_;
+    }
+    static int64_t thread_in_use() {
+        return thread_in_use_;
+    }
+    static int64_t thread_peak() {
+        return thread_peak_;
+    }
+    static void reset_thread_peak() {
+        thread_peak_ = thread_in_use_;
+    }
+
+private:
+    static inline std::atomic<bool> enabled_{false};
+    static inline std::atomic<uint64_t> allocated_{0};
+    static inline std::atomic<int64_t> in_use_{0};
+    static inline std::atomic<int64_t> peak_{0};
+    static inline thread_local uint64_t thread_allocated_ = 0;
+    static inline thread_local int64_t thread_in_use_ = 0;
+    static inline thread_local int64_t thread_peak_ = 0;
+};
+
+// ============================================================================
+// Execution Profile (--analyze)
+// ============================================================================
+
+struct OperatorProfile {
+    std::string name;    // operator_name()
+    std::string detail;  // describe_operator()
+    uint64_t batches = 0;
+    uint64_t rows_in = 0;
+    uint64_t rows_out = 0;
+    double seconds = 0;            // Wall time in the operator itself (not downstream)
+    uint64_t bytes_allocated = 0;  // Heap bytes it allocated, summed over its threads
+    uint64_t peak_bytes = 0;       // Highest heap use while it ran (see VM::profile_stop)
+};
+
+struct ExecutionProfile {
+    std::vector<OperatorProfile> operators;  // Same order as the plan
+    double seconds = 0;
+    uint64_t bytes_allocated = 0;
+    uint64_t peak_bytes = 0;
+};
+
+std::string format_profile(const ExecutionProfile& profile);
+std::string format_profile_json(const ExecutionProfile& profile);
+
+}  // namespace joy
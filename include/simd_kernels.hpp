@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace joy {
+
+// ============================================================================
+// SIMD Comparison Kernels (runtime ISA dispatch)
+// ============================================================================
+// Hand-vectorized column-vs-scalar comparisons for INT64/DOUBLE buffers.
+// Each kernel writes a packed bitmap (bit i = data[i] op value, 64 rows per
+// word) and never looks at validity; callers AND with the validity bitmap.
+//
+// The instruction set is chosen once, on first use, from CPUID:
+//   x86-64:  AVX-512F -> AVX2 -> scalar
+//   AArch64: NEON (always available)
+// Setting JOY_SIMD=scalar|avx2|avx512|neon forces a level (if supported),
+// which is useful for testing every code path on one machine
+
+enum class CompareOp { GT, LT, GTE, LTE, EQ, NEQ };
+
+enum class SimdLevel { SCALAR, AVX2, AVX512, NEON };
+
+// Level the kernels below dispatch to
+SimdLevel active_simd_level();
+const char* simd_level_name(SimdLevel level);
+
+// Write (n + 63) / 64 words to out; bits past n are zero
+void simd_compare_int64(CompareOp op, const int64_t* data, size_t n, int64_t value,
+                        uint64_t* out);
+void simd_compare_double(CompareOp op, const double* data, size_t n, double value,
+                         uint64_t* out);
+
+// ============================================================================
+// SIMD String Kernels
+// ============================================================================
+// Substring search compares the pattern's first and last byte against 32
+// (AVX2) or 16 (NEON) consecutive positions at once and confirms only the
+// positions where both match; AVX-512 uses the AVX2 kernels (byte compares
+// need AVX-512BW)
+
+// Offset of the first occurrence of pattern[0, len) (len > 0) in
+// text[from, size), or size if there is none
+size_t simd_find(const char* text, size_t size, size_t from, const char* pattern, size_t len);
+
+// Whether a[0, n) and b[0, n) are equal, ignoring ASCII case
+bool simd_iequals(const char* a, const char* b, size_t n);
+
+}  // namespace joy
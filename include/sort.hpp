@@ -0,0 +1,101 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "ir.hpp"
+#include "table.hpp"
+#include "thread_pool.hpp"
+
+namespace joy {
+
+// ============================================================================
+// Sort (sort by, and sort ... limit N)
+// ============================================================================
+// Full sort: batches are buffered in memory. A buffer is ordered by an LSD
+// radix sort that produces a row permutation: INT64, DOUBLE, BOOL and
+// dictionary-encoded STRING keys are mapped to order-preserving unsigned
+// integers and sorted 8 bits per pass (passes where every row has the same
+// byte are skipped); other STRING keys use a stable comparison sort. Every
+// column is then gathered once through the permutation.
+//
+// When the buffer outgrows the memory limit it is sorted and written to a
+// temporary file as a run. At the end the runs are merged k-way, reading one
+// block of each run at a time, so the input may be far larger than memory.
+//
+// Top-N (a limit was fused into the sort): a max-heap holds the best N rows
+// seen so far, worst on top. Rows that cannot beat the top are rejected
+// straight from the batch, so memory stays at about 2N rows. (Very large
+// limits run as a full sort whose output stops after N rows.)
+//
+// Order is stable (rows with equal keys keep their input order) and NULLs
+// sort last, ascending or descending
+
+// Default bytes of buffered rows before a sort spills a run to disk
+constexpr size_t kDefaultSortMemory = size_t{256} << 20;
+
+class Sorter {
+public:
+    // memory_limit = bytes of buffered input before a sorted run is spilled
+    Sorter(const PhysicalOp::SortOp& op, size_t memory_limit);
+    ~Sorter();
+
+    Sorter(const Sorter&) = delete;
+    Sorter& operator=(const Sorter&) = delete;
+
+    // Add every row of batch (column types must not change between batches)
+    void consume(const Table& batch, ThreadPool* pool);
+
+    // After the last consume(): replace out with the next batch of at most
+    // max_rows sorted rows. The first call always succeeds (possibly with an
+    // empty batch, so the next operators still see the schema)
+    // Returns false once every row has been produced
+    bool next_batch(Table& out, size_t max_rows, ThreadPool* pool);
+
+private:
+    struct Run;  // A sorted run in a temporary file
+
+    // Fix key columns and the schema from the first batch
+    void init(const Table& batch);
+
+    // Sort buffer_ and write it out as a run
+    void spill(ThreadPool* pool);
+
+    // Keep the rows of batch that belong in the top N
+    void consume_top_n(const Table& batch);
+
+    // Rebuild kept_ from the rows still in the heap
+    void compact_top_n();
+
+    // Sort what is left in memory and prepare the output
+    void finish(ThreadPool* pool);
+
+    // Merge heap order: whether run a's current row sorts after run b's
+    // (ties: the later run, which holds later input)
+    bool run_after(size_t a, size_t b) const;
+
+    const PhysicalOp::SortOp& op_;
+    size_t memory_limit_;
+    bool top_n_;  // Bounded heap instead of a full sort
+    bool initialized_ = false;
+    bool finished_ = false;
+    std::vector<size_t> key_indices_;  // Column index of each key
+    Table schema_;                     // Empty table with the input's columns
+
+    // Full sort: rows buffered since the last spill
+    Table buffer_;
+    size_t buffer_bytes_ = 0;
+    std::vector<std::unique_ptr<Run>> runs_;
+    std::vector<size_t> merge_heap_;  // Runs with rows left, best current row on top
+
+    // Top-N: kept_ holds candidate rows in input order, heap_ the best of them
+    Table kept_;
+    std::vector<uint32_t> heap_;
+
+    // In-memory output: rows of buffer_ in sorted order, and how many were produced
+    std::vector<uint32_t> order_;
+    size_t emitted_ = 0;
+};
+
+}  // namespace joy
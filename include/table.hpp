@@ -1,46 +1,330 @@
 #pragma once
 
+#include <algorithm>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <limits>
 #include <memory>
 #include <optional>
 #include <string>
+#include <string_view>
 #include <variant>
 #include <vector>
 
+#include "compression.hpp"
+
 namespace joy {
 
+class ThreadPool;
+
+// ============================================================================
+// Bitmap (packed bits, 64 per word)
+// ============================================================================
+// Used for NULL validity (Arrow-style: bit set = value present) and for
+// boolean data. Bits past size() are always zero, so whole words can be
+// combined with bitwise AND/OR without masking the tail
+
+class Bitmap {
+public:
+    Bitmap() = default;
+    explicit Bitmap(size_t n, bool value = false) {
+        resize(n, value);
+    }
+
+    size_t size() const {
+        return size_;
+    }
+    size_t num_words() const {
+        return words_.size();
+    }
+    uint64_t* words() {
+        return words_.data();
+    }
+    const uint64_t* words() const {
+        return words_.data();
+    }
+
+    bool get(size_t i) const {
+        return (words_[i >> 6] >> (i & 63)) & 1;
+    }
+    bool operator[](size_t i) const {
+        return get(i);
+    }
+    void set(size_t i, bool value) {
+        uint64_t mask = uint64_t{1} << (i & 63);
+        if (value)
+            words_[i >> 6] |= mask;
+        else
+            words_[i >> 6] &= ~mask;
+    }
+
+    void push_back(bool value) {
+        if ((size_ & 63) == 0)
+            words_.push_back(0);
+        size_++;
+        if (value)
+            words_.back() |= uint64_t{1} << ((size_ - 1) & 63);
+    }
+
+    void reserve(size_t n) {
+        words_.reserve((n + 63) / 64);
+    }
+    void resize(size_t n, bool value = false);
+
+    // Append all bits of other
+    void append(const Bitmap& other);
+
+    // Append bits [begin, begin + count) of a packed word array (same layout)
+    void append_bits(const uint64_t* words, size_t begin, size_t count);
+
+    // Number of set bits
+    size_t count() const;
+
+    // Word-wise set operations with a bitmap of the same size
+    Bitmap& operator|=(const Bitmap& other);  // Union
+    Bitmap& subtract(const Bitmap& other);    // Clear the bits set in other
+
+    // Zero the unused bits of the last word (after writing whole words)
+    void clear_tail();
+
+private:
+    std::vector<uint64_t> words_;
+    size_t size_ = 0;
+};
+
+// ============================================================================
+// String Storage
+// ============================================================================
+// STRING columns never store one heap object per cell. Two encodings:
+//   - StringArena: all bytes in one buffer plus an offsets array (high cardinality)
+//   - DictStrings: int32 codes into a dictionary of unique values (low cardinality,
+//     e.g. department), so equality against a literal is one integer compare
+
+// Contiguous offsets + bytes (value i is bytes[offsets[i], offsets[i + 1]))
+class StringArena {
+public:
+    size_t size() const {
+        return offsets_.size() - 1;
+    }
+    std::string_view get(size_t i) const {
+        return std::string_view(bytes_.data() + offsets_[i], offsets_[i + 1] - offsets_[i]);
+    }
+    std::string_view operator[](size_t i) const {
+        return get(i);
+    }
+
+    void push_back(std::string_view s) {
+        bytes_.append(s.data(), s.size());
+        offsets_.push_back(bytes_.size());
+    }
+    void reserve(size_t n) {
+        offsets_.reserve(n + 1);
+    }
+    size_t num_bytes() const {
+        return bytes_.size();
+    }
+
+    // Raw layout, for kernels that scan every value in one pass
+    const char* data() const {
+        return bytes_.data();
+    }
+    const size_t* offsets() const {
+        return offsets_.data();
+    }
+
+    // Append all values of other
+    void append(const StringArena& other);
+
+private:
+    std::vector<size_t> offsets_{0};
+    std::string bytes_;
+};
+
+// Set of unique strings, each identified by a dense code (0, 1, 2, ...)
+// Values live in a StringArena; lookups go through an open-addressing hash
+// table of codes, so interning a string_view never allocates per call
+class StringDictionary {
+public:
+    static constexpr int32_t kNotFound = -1;
+
+    size_t size() const {
+        return values_.size();
+    }
+    std::string_view get(int32_t code) const {
+        return values_.get(static_cast<size_t>(code));
+    }
+
+    // Code of s, or kNotFound
+    int32_t find(std::string_view s) const;
+
+    // Code of s, adding it if not present
+    int32_t intern(std::string_view s);
+
+    // Every value, in code order
+    const StringArena& values() const {
+        return values_;
+    }
+
+private:
+    void rehash(size_t num_slots);
+
+    StringArena values_;
+    std::vector<int32_t> slots_;  // Codes (kNotFound = empty), size is a power of two
+};
+
+// Dictionary-encoded strings: one code per row
+// The dictionary is shared between columns derived from the same source
+// (filter results, projections), and copied before it is modified
+struct DictStrings {
+    std::vector<int32_t> codes;  // NULL slots hold code 0
+    std::shared_ptr<StringDictionary> dict = std::make_shared<StringDictionary>();
+
+    size_t size() const {
+        return codes.size();
+    }
+    std::string_view get(size_t i) const {
+        return dict->get(codes[i]);
+    }
+
+    void push_back(std::string_view s);
+    void push_null() {
+        codes.push_back(0);
+    }
+    void reserve(size_t n) {
+        codes.reserve(n);
+    }
+};
+
 // ============================================================================
 // Column-major Table Representation with NULL support
 // ============================================================================
 
 enum class ColumnType { INT64, DOUBLE, STRING, BOOL };
 
+// Name of a type as written in a schema clause ("int64", "double", ...)
+const char* column_type_name(ColumnType type);
+
+// ============================================================================
+// Zone Maps (per-chunk min / max / null count)
+// ============================================================================
+// Readers attach a ZoneMap to INT64 and DOUBLE columns, one zone per
+// kZoneRows consecutive rows. Range filters skip zones where no row can match
+// and accept zones where every non-NULL row matches, without comparing rows
+// (see vectorized_ops.cpp). .joyc files store them with each chunk
+
+// Rows per zone (a multiple of 64, so a zone covers whole selection words)
+constexpr size_t kZoneRows = 2048;
+
+struct ZoneMap {
+    size_t num_rows = 0;  // Rows covered (a column that has grown since is not)
+
+    // Per zone; min/max are of the non-NULL values (0 when there are none)
+    // Only the pair matching the column type is filled; a DOUBLE zone that
+    // holds a NaN has NaN bounds, so no range check can decide it
+    std::vector<uint32_t> null_counts;
+    std::vector<int64_t> int_min, int_max;
+    std::vector<double> double_min, double_max;
+
+    size_t num_zones() const {
+        return null_counts.size();
+    }
+
+    // Size for num_rows rows of a column of type (bounds zeroed)
+    void resize(ColumnType type, size_t rows);
+};
+
+struct Column;
+
+// Fill zone z (rows [z * kZoneRows, ...)) of zones from col's values
+// zones must already be sized for col
+void compute_zone(const Column& col, size_t z, ZoneMap& zones);
+
+// Zone map over every row of an INT64 or DOUBLE column (nullptr for other types)
+std::shared_ptr<const ZoneMap> build_zone_map(const Column& col);
+
 struct Column {
     std::string name;
     ColumnType type;
 
-    // Type-erased storage using std::optional for NULL support
-    // std::nullopt represents NULL values (SQL-style NULL semantics)
-    std::variant<std::vector<std::optional<int64_t>>, std::vector<std::optional<double>>,
-                 std::vector<std::optional<std::string>>, std::vector<std::optional<bool>>>
+    // Flat value storage: one contiguous buffer per type (BOOL is bit-packed)
+    // STRING uses either StringArena or DictStrings (see String Storage)
+    // NULL slots hold a default value (0, 0.0, "" or false) so kernels can
+    // run over the whole buffer without branching
+    std::variant<std::vector<int64_t>, std::vector<double>, StringArena, DictStrings, Bitmap>
         data;
 
-    size_t size() const;
+    // NULL support (SQL-style NULL semantics): bit i clear = value i is NULL
+    Bitmap validity;
+
+    // Per-zone statistics from the reader (see ZoneMap); copies share them
+    std::shared_ptr<const ZoneMap> zones;
+
+    // zones if they still describe every row, else nullptr
+    const ZoneMap* zone_map() const {
+        return zones && zones->num_rows == size() ? zones.get() : nullptr;
+    }
+
+    // Create an empty column with the storage alternative for its type
+    // STRING columns start as a StringArena
+    static Column make(const std::string& name, ColumnType type);
+
+    // Create an empty dictionary-encoded STRING column
+    static Column make_dict(const std::string& name);
+
+    // Create an empty column with the same type and encoding as src
+    // (dictionary-encoded columns share src's dictionary)
+    static Column make_like(const Column& src);
+
+    bool is_dict_encoded() const {
+        return std::holds_alternative<DictStrings>(data);
+    }
+
+    size_t size() const {
+        return validity.size();
+    }
     void reserve(size_t n);
 
     // Check if value at index is NULL
-    bool is_null(size_t idx) const;
+    bool is_null(size_t idx) const {
+        return !validity.get(idx);
+    }
 
     // Get typed value at index (throws if NULL or wrong type)
     int64_t get_int(size_t idx) const;
     double get_double(size_t idx) const;
-    const std::string& get_string(size_t idx) const;
+    std::string_view get_string(size_t idx) const;  // Valid while the column lives
     bool get_bool(size_t idx) const;
 
-    // Append typed value
+    // Append typed value (std::nullopt appends NULL)
     void append_int(std::optional<int64_t> val);
     void append_double(std::optional<double> val);
-    void append_string(std::optional<std::string> val);
+    void append_string(std::optional<std::string_view> val);
     void append_bool(std::optional<bool> val);
+
+    // Append a NULL of the column's type
+    void append_null();
+
+    // Append row `row` of src (same type), copying codes when both columns
+    // share a dictionary
+    void append_from(const Column& src, size_t row);
+
+    // New column holding only the rows whose bit is set in selection
+    // (dictionary-encoded columns share this column's dictionary)
+    Column gather(const Bitmap& selection) const;
+
+    // New column holding rows[0], rows[1], ... (in that order, repeats allowed)
+    Column gather(const std::vector<uint32_t>& rows) const;
+
+    // Typed access to the value buffer
+    template <typename T>
+    const std::vector<T>& values() const {
+        return std::get<std::vector<T>>(data);
+    }
+    template <typename T>
+    std::vector<T>& values() {
+        return std::get<std::vector<T>>(data);
+    }
 };
 
 struct Table {
@@ -58,7 +342,17 @@ struct Table {
     void add_column(Column col);
 
     // Create new table with subset of columns
-    Table project(const std::vector<std::string>& cols) const;
+    // With a selection, only the rows whose bit is set are copied
+    Table project(const std::vector<std::string>& cols, const Bitmap* selection = nullptr) const;
+
+    // Create new table with only the rows whose bit is set in selection
+    Table gather(const Bitmap& selection) const;
+
+    // Create new table holding rows[0], rows[1], ... of this one
+    Table gather(const std::vector<uint32_t>& rows) const;
+
+    // Append all rows of other (must have the same schema)
+    void append(const Table& other);
 };
 
 // ============================================================================
@@ -66,9 +360,229 @@ struct Table {
 // ============================================================================
 
 // Read CSV file into table (infers types from data)
-Table read_csv(const std::string& filepath);
+// With a pool, byte ranges of the file are parsed in parallel
+Table read_csv(const std::string& filepath, ThreadPool* pool = nullptr);
+
+// Write table to CSV file (with a pool, row ranges are formatted in parallel)
+void write_csv(const std::string& filepath, const Table& table, ThreadPool* pool = nullptr);
+
+// ============================================================================
+// Streaming CSV I/O (batch-at-a-time)
+// ============================================================================
+// Used by the VM so that peak memory depends on batch size, not file size
+
+// Default number of rows per batch in streaming execution
+constexpr size_t kDefaultBatchSize = 64 * 1024;
+
+// Uncompressed bytes per block of a compressed CSV file (one zstd frame or
+// gzip member; small enough for readers to decompress frames in parallel)
+constexpr size_t kCompressBlockBytes = 1024 * 1024;
+
+// Number of leading rows the CSV reader samples to choose STRING encodings
+constexpr size_t kEncodingSampleRows = 1024;
+
+// Number of leading rows the CSV reader samples to infer column types
+constexpr size_t kTypeSampleRows = 16 * 1024;
+
+// Read-only view of an entire file (memory-mapped where the platform allows)
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& filepath);
+    // View of memory the caller owns and keeps alive (never unmapped or
+    // discarded)
+    explicit MappedFile(std::string_view borrowed)
+        : data_(borrowed.data()), size_(borrowed.size()), borrowed_(true) {}
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const char* data() const {
+        return data_;
+    }
+    size_t size() const {
+        return size_;
+    }
+
+    // Let the OS drop pages before offset end (already consumed by a reader)
+    // Keeps resident memory flat while streaming through a large file
+    void discard_before(size_t end);
+
+private:
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+    size_t discarded_ = 0;  // Bytes [0, discarded_) have been released
+    bool borrowed_ = false;
+    std::string fallback_;  // Owned copy on platforms without mmap
+};
+
+// A column type given by the pipeline instead of inferred from the data
+// Example: from "people.csv" schema (age int) -> DeclaredColumn{"age", INT64}
+struct DeclaredColumn {
+    std::string name;
+    ColumnType type;
+};
+
+// Narrowest type that holds values of both types, in the CSV inference
+// order INT64 -> DOUBLE -> STRING (INT64 and DOUBLE widen to DOUBLE, any
+// other mix to STRING)
+ColumnType widen_type(ColumnType a, ColumnType b);
+
+// Source of row batches (a CSV, .joyc, Parquet or Arrow file, see file_format.hpp)
+class BatchReader {
+public:
+    virtual ~BatchReader() = default;
+
+    // Replace out with the next batch of at most max_rows rows
+    // The first call always succeeds (possibly with an empty batch) so that
+    // downstream operators still see the schema of a file without rows
+    // Returns false once the input is exhausted
+    virtual bool next_batch(Table& out, size_t max_rows) = 0;
+
+    virtual const std::vector<std::string>& column_names() const = 0;
+    virtual const std::vector<ColumnType>& column_types() const = 0;
+    // False for columns with no non-NULL value (their STRING type is a default)
+    virtual const std::vector<bool>& inferred_types() const = 0;
+};
+
+// Sink for row batches (see file_format.hpp)
+class BatchWriter {
+public:
+    virtual ~BatchWriter() = default;
+
+    // Append all rows of batch to the file
+    virtual void write(const Table& batch) = 0;
+
+    // Complete the file after the last batch
+    virtual void close() {}
+};
+
+// Reads a CSV file as a sequence of row batches
+// Column types are fixed when the reader is opened: declared ones as given,
+// the others from the first kTypeSampleRows rows, widening as values arrive
+// (a column of 1, 2 and 2.5 is DOUBLE). A column without any value in the
+// sample keeps the STRING default. Later rows are parsed straight into the
+// typed columns, so the file is only read once beyond the sample
+// The file is memory-mapped and tokenized in place without per-row copies
+//
+// With a thread pool, the reader cuts the input into byte ranges that start
+// on line boundaries (one per thread, each holding the rows of one batch),
+// parses the ranges concurrently into separate tables, and hands them out in
+// file order. Types are decided once up front, so every range agrees
+//
+// A compressed file (compression.hpp) is decompressed into a window that
+// holds the text of one wave of ranges at a time; the type pre-pass reads
+// the start of the file through a second decompressor, so the window never
+// has to hold more than the rows about to be parsed
+class CsvReader : public BatchReader {
+public:
+    // columns: only these fields are parsed and returned, in file order
+    // (nullptr = all); other fields are tokenized past but never converted
+    // schema: types of some or all fields, which must be in the header
+    explicit CsvReader(const std::string& filepath, ThreadPool* pool = nullptr,
+                       const std::vector<std::string>* columns = nullptr,
+                       const std::vector<DeclaredColumn>* schema = nullptr);
+
+    // CSV text in memory, tokenized in place like a mapped file (text must
+    // outlive the reader; name stands for the file in error messages)
+    CsvReader(std::string_view text, const std::string& name, ThreadPool* pool = nullptr,
+              const std::vector<std::string>* columns = nullptr,
+              const std::vector<DeclaredColumn>* schema = nullptr);
+
+    bool next_batch(Table& out, size_t max_rows) override;
+
+    const std::vector<std::string>& column_names() const override {
+        return headers_;
+    }
+    const std::vector<ColumnType>& column_types() const override {
+        return types_;
+    }
+    const std::vector<bool>& inferred_types() const override {
+        return inferred_;
+    }
 
-// Write table to CSV file
-void write_csv(const std::string& filepath, const Table& table);
+    // Parse the returned columns as types instead of the inferred ones (before
+    // the first batch; used to give several files one schema). Columns that
+    // become STRING are stored in an arena
+    void set_column_types(const std::vector<ColumnType>& types);
+
+    // Incremental runs over an uncompressed file (before the first batch):
+    // read only the rows from byte offset on (an offset past the end of a
+    // file that shrank starts over after the header), and stop after the
+    // last line break, leaving a partly written last row for the next run
+    void resume(size_t offset);
+
+    // Byte offset to resume from once every batch has been read
+    size_t offset() const {
+        return pos_;
+    }
+
+private:
+    // Input text not yet discarded (the mapping up to end_, or the window)
+    std::string_view text() const {
+        return file_ ? std::string_view(file_->data(), std::min(file_->size(), end_))
+                     : std::string_view(window_);
+    }
+
+    // Compressed input: drop the text before pos_ and decompress until the
+    // window holds rows more non-blank lines, or the rest of the file
+    void fill_window(size_t rows);
+
+    // Read the header and decide the column types (the input is open)
+    void read_header(const std::string& filepath, const std::vector<std::string>* columns,
+                     const std::vector<DeclaredColumn>* schema);
+
+    // Parse the next wave of byte ranges (one per thread) into ready_
+    void parse_ranges(size_t max_rows);
+
+    std::unique_ptr<MappedFile> file_;         // Uncompressed input
+    std::unique_ptr<Decompressor> stream_;     // Compressed input
+    std::string window_;                       // Decompressed text from pos_ on
+    bool stream_done_ = false;                 // Everything decompressed
+    ThreadPool* pool_;
+    size_t pos_ = 0;  // Byte offset in text() of the first line not yet assigned to a range
+    size_t end_ = std::numeric_limits<size_t>::max();  // Mapped bytes past end_ are not read
+    std::vector<std::string> headers_;  // Names of the returned columns
+    std::vector<int> field_columns_;    // Per CSV field: returned column index, or -1 if skipped
+    std::vector<ColumnType> types_;
+    std::vector<bool> inferred_;
+    std::vector<bool> declared_;      // Columns typed by the schema rather than the sample
+    std::vector<bool> dict_encoded_;  // STRING columns stored as DictStrings
+    std::deque<Table> ready_;  // Parsed batches not yet handed out, in file order
+    size_t row_number_ = 1;    // Last row parsed (header is row 1), for error messages
+    bool started_ = false;
+};
+
+// Writes a CSV file batch by batch (header is taken from the first batch)
+// Each batch is formatted in row ranges, in parallel with a pool, into
+// per-range text buffers that are then written to the file in order
+// A compressed file (.gz, .zst) is written as blocks of kCompressBlockBytes
+// of text, compressed in parallel; close() writes the last partial block
+// append: add rows to the end of an existing file, whose header is kept (a
+// missing or empty file is written as usual)
+class CsvWriter : public BatchWriter {
+public:
+    explicit CsvWriter(const std::string& filepath, ThreadPool* pool = nullptr,
+                       bool append = false);
+    ~CsvWriter() override;
+
+    void write(const Table& batch) override;
+    void close() override;
+
+private:
+    // Write text to the file (compressed output: once it fills blocks)
+    void emit(const std::string& text);
+    // Compress and write the first num_blocks blocks of pending_
+    void write_blocks(size_t num_blocks);
+
+    std::string filepath_;
+    std::ofstream file_;
+    ThreadPool* pool_;
+    Compression compression_;
+    bool header_written_ = false;
+    bool closed_ = false;
+    std::vector<std::string> buffers_;  // Per row range of a wave (reused across batches)
+    std::string pending_;               // Text not yet compressed
+    std::vector<std::string> blocks_;   // Compressed blocks of a wave
+};
 
 }  // namespace joy
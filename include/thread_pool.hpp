@@ -0,0 +1,55 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace joy {
+
+// ============================================================================
+// Thread Pool (fork/join parallelism for scans and operators)
+// ============================================================================
+// A fixed set of worker threads plus the calling thread
+// parallel_for() hands out indices [0, n) dynamically, so uneven tasks
+// (e.g. byte ranges with different row densities) still balance out
+
+class ThreadPool {
+public:
+    // num_threads = total threads including the caller (0 = hardware concurrency)
+    explicit ThreadPool(size_t num_threads = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Number of threads that run tasks (workers + calling thread)
+    size_t size() const {
+        return workers_.size() + 1;
+    }
+
+    // Run fn(i) for every i in [0, n) and wait for all calls to finish
+    // The first exception thrown by fn is rethrown on the calling thread
+    void parallel_for(size_t n, const std::function<void(size_t)>& fn);
+
+    // Run fn(worker, i) for every i in [0, n) and wait, like parallel_for
+    // worker in [0, size()) identifies the thread (0 = caller), so fn may keep
+    // per-thread state. Each thread starts with its own contiguous block of
+    // indices, taken from the front; a thread that runs out steals from the
+    // back of another thread's block, so neighbouring indices tend to stay on
+    // one thread while uneven tasks still balance out
+    void parallel_for_stealing(size_t n, const std::function<void(size_t, size_t)>& fn);
+
+private:
+    void worker_loop();
+
+    std::vector<std::thread> workers_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<std::function<void()>> tasks_;
+    bool stopping_ = false;
+};
+
+}  // namespace joy
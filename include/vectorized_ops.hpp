@@ -1,8 +1,11 @@
 #pragma once
 
 #include <cstdint>
+#include <string_view>
+#include <type_traits>
 #include <vector>
 
+#include "simd_kernels.hpp"
 #include "table.hpp"
 
 namespace joy {
@@ -11,59 +14,69 @@ namespace joy {
 // Vectorized Column Operations
 // ============================================================================
 // Process entire columns at once instead of row-at-a-time
-// Compiler auto-vectorization applied where possible
+// INT64/DOUBLE comparisons use explicit SIMD kernels (see simd_kernels.hpp);
+// compiler auto-vectorization applies elsewhere where possible
 // NULL values return false for all comparisons
+//
+// Kernels compare the flat value buffer without looking at NULLs, pack the
+// results 64 rows per word, and then clear NULL rows with a single AND
+// against the column's validity bitmap
 
-// Selection vector indicating which rows pass the filter
-using SelectionVector = std::vector<bool>;
+// Selection vector indicating which rows pass the filter (bit-packed)
+using SelectionVector = Bitmap;
 
-// ============================================================================
-// Column > Scalar
-// ============================================================================
-
-SelectionVector vec_gt_int64(const Column& col, int64_t value);
-SelectionVector vec_gt_double(const Column& col, double value);
-SelectionVector vec_gt_string(const Column& col, const std::string& value);
+// Comparisons take an optional `active` selection (rows still selected by
+// earlier filters): the result is pred AND valid AND active, and kernels may
+// skip rows outside it entirely
+//
+// Every comparison is an instance of one kernel template, specialized at
+// compile time for the comparator, the operand types (INT64 vs DOUBLE
+// compares as DOUBLE) and whether any operand holds NULLs; the functions
+// below pick the instance at runtime
 
 // ============================================================================
-// Column < Scalar
+// Column op Scalar
 // ============================================================================
 
-SelectionVector vec_lt_int64(const Column& col, int64_t value);
-SelectionVector vec_lt_double(const Column& col, double value);
-SelectionVector vec_lt_string(const Column& col, const std::string& value);
+// INT64 column
+SelectionVector vec_compare_int64(CompareOp op, const Column& col, int64_t value,
+                                  const SelectionVector* active = nullptr);
+// INT64 or DOUBLE column (INT64 values are promoted)
+SelectionVector vec_compare_double(CompareOp op, const Column& col, double value,
+                                   const SelectionVector* active = nullptr);
+// STRING column (byte-wise order)
+SelectionVector vec_compare_string(CompareOp op, const Column& col, const std::string& value,
+                                   const SelectionVector* active = nullptr);
 
 // ============================================================================
-// Column >= Scalar
+// String Predicates
 // ============================================================================
+// starts_with, ends_with, contains and iequals (equality ignoring ASCII
+// case) against a constant pattern. Plain columns are matched over their
+// whole arena at once (contains is one SIMD search across every value);
+// dictionary columns match each distinct value once and then look up codes
+// An empty pattern matches every value (iequals: only the empty string)
 
-SelectionVector vec_gte_int64(const Column& col, int64_t value);
-SelectionVector vec_gte_double(const Column& col, double value);
-SelectionVector vec_gte_string(const Column& col, const std::string& value);
-
-// ============================================================================
-// Column <= Scalar
-// ============================================================================
+enum class StringMatch { PREFIX, SUFFIX, CONTAINS, IEQUALS };
 
-SelectionVector vec_lte_int64(const Column& col, int64_t value);
-SelectionVector vec_lte_double(const Column& col, double value);
-SelectionVector vec_lte_string(const Column& col, const std::string& value);
+// Name of the expression function (starts_with, ends_with, contains, iequals)
+const char* string_match_name(StringMatch match);
 
-// ============================================================================
-// Column == Scalar
-// ============================================================================
+// Scalar form, shared by the row interpreters and constant folding
+bool string_matches(StringMatch match, std::string_view value, std::string_view pattern);
 
-SelectionVector vec_eq_int64(const Column& col, int64_t value);
-SelectionVector vec_eq_double(const Column& col, double value);
-SelectionVector vec_eq_string(const Column& col, const std::string& value);
+SelectionVector vec_match_string(StringMatch match, const Column& col, const std::string& pattern,
+                                 const SelectionVector* active = nullptr);
 
 // ============================================================================
-// Column != Scalar
+// Column op Column
 // ============================================================================
+// Row i compares left[i] with right[i]; NULL on either side never matches
+// Operands are both numeric (INT64/DOUBLE in any mix), both STRING, or both
+// BOOL (EQ/NEQ only)
 
-SelectionVector vec_neq_int64(const Column& col, int64_t value);
-SelectionVector vec_neq_double(const Column& col, double value);
-SelectionVector vec_neq_string(const Column& col, const std::string& value);
+SelectionVector vec_compare_columns(CompareOp op, const Column& left, const Column& right,
+                                    const SelectionVector* active = nullptr);
 
 // ============================================================================
 // Vectorized Arithmetic Operations (for TRANSFORM)
@@ -73,6 +86,19 @@ SelectionVector vec_neq_string(const Column& col, const std::string& value);
 
 enum class VectorArithOp { ADD, SUB, MUL, DIV };
 
+// Quotient of a non-zero divisor, for every evaluator (interpreters, kernels,
+// JIT): an INT64 divided by -1 is negated with wraparound, since
+// INT64_MIN / -1 overflows (and traps on x86)
+template <typename T>
+inline T divide(T a, T b) {
+    if constexpr (std::is_integral_v<T>) {
+        using U = std::make_unsigned_t<T>;
+        if (b == -1)
+            return static_cast<T>(U{0} - static_cast<U>(a));
+    }
+    return a / b;
+}
+
 // Column op Column
 Column vec_arith_int64(VectorArithOp op, const Column& left, const Column& right);
 Column vec_arith_double(VectorArithOp op, const Column& left, const Column& right);
@@ -92,6 +118,10 @@ Column vec_arith_scalar_double(VectorArithOp op, double scalar, const Column& co
 // selection[i] == true  → result[i] = true_col[i]
 // selection[i] == false → result[i] = false_col[i]
 
+// Result type of a blend whose branches so far give type, with a branch of
+// type branch: STRING wins, then DOUBLE (INT64 values are promoted)
+ColumnType select_result_type(ColumnType type, ColumnType branch);
+
 Column vec_select_int64(const SelectionVector& condition, const Column& true_col,
                         const Column& false_col);
 Column vec_select_double(const SelectionVector& condition, const Column& true_col,
@@ -1,11 +1,27 @@
 #pragma once
 
+#include <chrono>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <optional>
 #include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
 #include <variant>
 #include <vector>
 
+#include "aggregate.hpp"
+#include "checkpoint.hpp"
+#include "hash_join.hpp"
 #include "ir.hpp"
+#include "jit.hpp"
+#include "profile.hpp"
+#include "sort.hpp"
 #include "table.hpp"
+#include "thread_pool.hpp"
 
 namespace joy {
 
@@ -23,8 +39,11 @@ public:
 // ============================================================================
 
 // NULL is represented using std::monostate (SQL-style NULL semantics)
+// Strings are views into column storage or the bytecode's literals, never
+// copies, so a Value is only valid while the batch and the plan it was
+// evaluated on are (results are copied when they are stored in a column)
 struct Value {
-    std::variant<std::monostate, int64_t, double, std::string, bool> data;
+    std::variant<std::monostate, int64_t, double, std::string_view, bool> data;
 
     // Type queries
     bool is_null() const;
@@ -36,14 +55,14 @@ struct Value {
     // Getters
     int64_t as_int() const;
     double as_double() const;
-    const std::string& as_string() const;
+    std::string_view as_string() const;
     bool as_bool() const;
 
     // Constructors
     static Value make_null();
     static Value make_int(int64_t val);
     static Value make_double(double val);
-    static Value make_string(std::string val);
+    static Value make_string(std::string_view val);
     static Value make_bool(bool val);
 };
 
@@ -51,25 +70,177 @@ struct Value {
 // Virtual Machine (Executes IR)
 // ============================================================================
 
+struct VMOptions {
+    // Rows per batch flowing through the pipeline (0 = whole input in one batch)
+    size_t batch_size = kDefaultBatchSize;
+
+    // Threads used for parallel work such as parsing and running batches
+    // through the operators (0 = one per hardware thread)
+    size_t num_threads = 0;
+
+    // Bytes a sort buffers before spilling sorted runs to temporary files
+    size_t sort_memory = kDefaultSortMemory;
+
+    // Time and count every operator (see VM::profile())
+    bool analyze = false;
+
+    // Compile hot filter and transform expressions to native code (see jit.hpp)
+    bool jit = true;
+
+    // Checkpoint file of an incremental run (see checkpoint.hpp): only rows
+    // appended to the input since the run that saved it are read, and the
+    // output is appended to ("" = read everything, overwrite the output)
+    std::string checkpoint;
+};
+
+// Input and outputs an embedding application supplies in place of the files
+// a plan names (see joy.hpp)
+struct ExecutionIO {
+    // Opens the scan's input instead of its files (empty = read the files)
+    // The scan gives the columns the pipeline reads and the declared types
+    std::function<std::unique_ptr<BatchReader>(const PhysicalOp::ScanOp& scan, ThreadPool* pool)>
+        input;
+
+    // Receive the batches of a WRITE instead of its file, by the path the
+    // WRITE names (WRITEs without an entry write their files); each is
+    // closed after its last batch
+    std::unordered_map<std::string, BatchWriter*> outputs;
+};
+
 class VM {
 public:
-    VM() = default;
+    explicit VM(VMOptions options = {})
+        : options_(options), pool_(std::make_shared<ThreadPool>(options.num_threads)) {}
 
-    // Execute entire plan
-    void execute(const ExecutionPlan& plan);
+    // Execute entire plan, streaming the scan output through the remaining
+    // operators one batch at a time
+    void execute(const ExecutionPlan& plan, const ExecutionIO& io = {});
+
+    // Execute a plan that is run again and again (the pointer keeps it alive
+    // and unchanged): as long as the scan's schema stays the same, the plan
+    // is bound once, and expressions compiled by the JIT stay compiled
+    // (plans with a JOIN are bound every time, as their build files may change)
+    void execute(const std::shared_ptr<const ExecutionPlan>& plan, const ExecutionIO& io = {});
+
+    // Per-operator timings and row counts of the last execute() (with analyze)
+    const ExecutionProfile& profile() const {
+        return profile_;
+    }
 
 private:
+    // Worker for morsel-driven execution: shares parent's pool and its
+    // per-execution expression state (JIT kernels)
+    explicit VM(VM* parent) : options_(parent->options_), pool_(parent->pool_), parent_(parent) {}
+
+    VMOptions options_;
+    std::shared_ptr<ThreadPool> pool_;
+
+    // Morsel-driven execution: each scan batch (a morsel) runs through the
+    // streaming operators after the scan on one of the workers (one per pool
+    // thread, stealing morsels from each other); the rest of the pipeline
+    // then sees the results in input order on the calling thread
+    VM* parent_ = nullptr;  // Owner of the shared state (nullptr for the main VM)
+    std::vector<std::unique_ptr<VM>> workers_;
+    std::mutex shared_mutex_;  // Guards jit_kernels_
+    std::mutex jit_mutex_;     // Guards jit_ (one compile at a time)
+
+    // Current batch (the slice of the input that is flowing through the pipeline)
     Table current_table_;
 
+    // Rows of current_table_ still selected by the filters run so far
+    // (nullopt = every row). Filters only narrow this; rows are copied once,
+    // by materialize(), when an operator needs physical data
+    std::optional<SelectionVector> selection_;
+
+    void execute_plan(const ExecutionPlan& plan, const ExecutionIO& io,
+                      const std::shared_ptr<const ExecutionPlan>& reused);
+
+    // The last plan bound, and what it was bound for (bound_source_ is the
+    // shared plan it came from, or nullptr if it cannot be reused)
+    ExecutionPlan bound_;
+    std::shared_ptr<const ExecutionPlan> bound_source_;
+    std::vector<std::string> bound_names_;  // The scan's schema
+    std::vector<std::optional<ColumnType>> bound_types_;
+
+    // Per-execution operator state (batches share one reader and one writer per WRITE)
+    std::unique_ptr<BatchReader> reader_;
+    std::unordered_map<const PhysicalOp::WriteOp*, std::unique_ptr<BatchWriter>> writers_;
+    std::unordered_map<const PhysicalOp::AggregateOp*, std::unique_ptr<HashAggregate>> aggregates_;
+    std::unordered_map<const PhysicalOp::JoinOp*, std::unique_ptr<HashJoin>> joins_;
+    std::unordered_map<const PhysicalOp::SortOp*, std::unique_ptr<Sorter>> sorts_;
+    std::unordered_map<const PhysicalOp::LimitOp*, size_t> limits_;  // Rows still to pass
+    std::optional<ScanCheckpoint> checkpoint_;  // Where an incremental run started / stops
+
+    // Incremental runs: open the scan's file from the checkpoint's offset,
+    // and roll the outputs back to their checkpointed sizes before appending
+    void resume_scan(const PhysicalOp::ScanOp& op,
+                     const std::vector<PhysicalOp::VectorizedFilterOp>& predicates);
+    void resume_writers(const ExecutionPlan& plan);
+
+    // Run operators [begin, end) of plan on the current batch, stopping after
+    // the first pipeline breaker (which keeps the batch instead of passing it on)
+    // A join hands each piece of its output to the operators after it
+    void run_pipeline(const ExecutionPlan& plan, size_t begin,
+                      size_t end = std::numeric_limits<size_t>::max());
+
+    // Scan stage with operators [1, end) (all streaming) run on the workers
+    // limit_reached() stops reading once the stage's limit has passed its rows
+    void execute_morsels(const ExecutionPlan& plan, size_t end,
+                         const std::function<bool()>& limit_reached);
+
     // Execute individual operators
-    void execute_scan(const PhysicalOp::ScanOp& op);
+    void execute_scan(const PhysicalOp::ScanOp& op,
+                      const std::vector<PhysicalOp::VectorizedFilterOp>& predicates);
+    bool next_batch();
+    void materialize();
+    void execute_op(const PhysicalOp& op);
     void execute_filter(const PhysicalOp::FilterOp& op);
     void execute_vectorized_filter(const PhysicalOp::VectorizedFilterOp& op);
+    void execute_logical_filter(const PhysicalOp::LogicalFilterOp& op);
     void execute_project(const PhysicalOp::ProjectOp& op);
     void execute_transform(const PhysicalOp::TransformOp& op);
     void execute_vectorized_transform(const PhysicalOp::VectorizedTransformOp& op);
     void execute_vectorized_ternary_transform(const PhysicalOp::VectorizedTernaryTransformOp& op);
     void execute_write(const PhysicalOp::WriteOp& op);
+    void execute_aggregate(const PhysicalOp::AggregateOp& op);
+    void execute_join(const PhysicalOp::JoinOp& op, const ExecutionPlan& plan, size_t index);
+    void execute_sort(const PhysicalOp::SortOp& op);
+    void execute_limit(const PhysicalOp::LimitOp& op);
+
+    // Filter building blocks: the rows of active (nullptr = all rows) that pass
+    SelectionVector filter_predicate(const IRExpr& predicate, const SelectionVector* active);
+    SelectionVector filter_compare(const PhysicalOp::VectorizedFilterOp& op,
+                                   const SelectionVector* active);
+    SelectionVector filter_node(const PhysicalOp::FilterNode& node, const SelectionVector* active);
+
+    // Native kernel for expr over the current batch, compiled once the
+    // expression has seen kJitMinRows rows (nullptr = use the interpreter)
+    const JitKernel* jit_kernel(const IRExpr& expr);
+    VectorSlot jit_result_;  // Output of this VM's kernel calls
+
+    struct JitState {
+        size_t rows = 0;        // Rows evaluated so far
+        bool attempted = false;  // compile() was called (kernel may still be null)
+        std::unique_ptr<JitKernel> kernel;
+    };
+    std::unique_ptr<ExpressionJit> jit_;  // Created on first compile
+    std::unordered_map<const IRExpr*, JitState> jit_kernels_;
+
+    // --analyze bookkeeping: profile_start() before an operator runs,
+    // profile_stop() after it (both do nothing unless options_.analyze)
+    struct ProfileMark {
+        std::chrono::steady_clock::time_point start;
+        uint64_t allocated = 0;     // Process count, or this thread's in a worker
+        int64_t in_use = 0;         // HeapStats::in_use()
+        int64_t thread_in_use = 0;  // HeapStats::thread_in_use() (workers only)
+    };
+    ProfileMark profile_start() const;
+    void profile_stop(size_t index, const ProfileMark& mark, uint64_t rows_in, uint64_t rows_out,
+                      bool count_batch = true);
+    size_t selected_rows() const;  // Rows of current_table_ still selected
+
+    ExecutionProfile profile_;
+    int64_t heap_base_ = 0;  // HeapStats::in_use() when execute() started
 
     // Evaluate expression bytecode for a single row
     Value eval_expr(const IRExpr& expr, size_t row_idx);
@@ -0,0 +1,472 @@
+#include "aggregate.hpp"
+
+#include <algorithm>
+#include <numeric>
+#include <string_view>
+
+#include "key_hash.hpp"
+#include "vm.hpp"  // For RuntimeError
+
+namespace joy {
+
+// Batches smaller than this are not split across threads
+constexpr size_t kMinChunkRows = 16 * 1024;
+
+// ============================================================================
+// Aggregate States
+// ============================================================================
+
+// Which typed vector holds an aggregate's running value
+enum class Storage { NONE, INTS, DOUBLES, STRINGS };
+
+struct AggState {
+    AggOp op;
+    Storage storage;
+    std::vector<int64_t> counts;  // Non-NULL inputs per group (rows for count())
+    std::vector<int64_t> ints;
+    std::vector<double> doubles;
+    std::vector<std::string> strings;
+
+    void add_group() {
+        counts.push_back(0);
+        switch (storage) {
+        case Storage::INTS:
+            ints.push_back(0);
+            break;
+        case Storage::DOUBLES:
+            doubles.push_back(0.0);
+            break;
+        case Storage::STRINGS:
+            strings.emplace_back();
+            break;
+        case Storage::NONE:
+            break;
+        }
+    }
+};
+
+// Helper: Whether v should replace cur as the running min/max
+template <typename T>
+static bool better(AggOp op, const T& v, const T& cur) {
+    return op == AggOp::MIN ? v < cur : v > cur;
+}
+
+static const char* agg_name(AggOp op) {
+    switch (op) {
+    case AggOp::SUM:
+        return "sum";
+    case AggOp::COUNT:
+        return "count";
+    case AggOp::MIN:
+        return "min";
+    case AggOp::MAX:
+        return "max";
+    case AggOp::AVG:
+        return "avg";
+    }
+    return "aggregate";
+}
+
+// Accumulate rows [begin, end) of col (nullptr for count()) into st
+// groups[i] is the group of row begin + i
+static void update(AggState& st, const Column* col, const uint32_t* groups, size_t begin,
+                   size_t end) {
+    if (!col) {
+        for (size_t r = begin; r < end; ++r)
+            st.counts[groups[r - begin]]++;
+        return;
+    }
+
+    const Bitmap& valid = col->validity;
+    switch (st.op) {
+    case AggOp::COUNT:
+        for (size_t r = begin; r < end; ++r) {
+            if (valid.get(r))
+                st.counts[groups[r - begin]]++;
+        }
+        return;
+
+    case AggOp::SUM:
+    case AggOp::AVG:
+        if (col->type == ColumnType::INT64) {
+            const auto& v = col->values<int64_t>();
+            for (size_t r = begin; r < end; ++r) {
+                if (!valid.get(r))
+                    continue;
+                uint32_t g = groups[r - begin];
+                if (st.storage == Storage::INTS)
+                    st.ints[g] += v[r];
+                else
+                    st.doubles[g] += static_cast<double>(v[r]);
+                st.counts[g]++;
+            }
+        } else if (col->type == ColumnType::DOUBLE) {
+            const auto& v = col->values<double>();
+            for (size_t r = begin; r < end; ++r) {
+                if (!valid.get(r))
+                    continue;
+                uint32_t g = groups[r - begin];
+                st.doubles[g] += v[r];
+                st.counts[g]++;
+            }
+        } else {
+            // Only an all-NULL column of another type can be summed
+            for (size_t r = begin; r < end; ++r) {
+                if (valid.get(r)) {
+                    throw RuntimeError(std::string(agg_name(st.op)) +
+                                       " requires a numeric column: " + col->name);
+                }
+            }
+        }
+        return;
+
+    case AggOp::MIN:
+    case AggOp::MAX:
+        for (size_t r = begin; r < end; ++r) {
+            if (!valid.get(r))
+                continue;
+            uint32_t g = groups[r - begin];
+            bool first = st.counts[g]++ == 0;
+            switch (st.storage) {
+            case Storage::INTS: {
+                int64_t v = col->values<int64_t>()[r];
+                if (first || better(st.op, v, st.ints[g]))
+                    st.ints[g] = v;
+                break;
+            }
+            case Storage::DOUBLES: {
+                double v = col->values<double>()[r];
+                if (first || better(st.op, v, st.doubles[g]))
+                    st.doubles[g] = v;
+                break;
+            }
+            case Storage::STRINGS: {
+                std::string_view v = col->get_string(r);
+                if (first || better(st.op, v, std::string_view(st.strings[g])))
+                    st.strings[g].assign(v);
+                break;
+            }
+            case Storage::NONE:
+                break;
+            }
+        }
+        return;
+    }
+}
+
+// Fold group b of src into group a of dst (same aggregate)
+static void merge_state(AggState& dst, size_t a, const AggState& src, size_t b) {
+    if (src.counts[b] == 0)
+        return;  // Nothing accumulated (not even rows, for count())
+
+    if (dst.op == AggOp::MIN || dst.op == AggOp::MAX) {
+        bool replace = dst.counts[a] == 0;
+        switch (dst.storage) {
+        case Storage::INTS:
+            if (replace || better(dst.op, src.ints[b], dst.ints[a]))
+                dst.ints[a] = src.ints[b];
+            break;
+        case Storage::DOUBLES:
+            if (replace || better(dst.op, src.doubles[b], dst.doubles[a]))
+                dst.doubles[a] = src.doubles[b];
+            break;
+        case Storage::STRINGS:
+            if (replace || better(dst.op, src.strings[b], dst.strings[a]))
+                dst.strings[a] = src.strings[b];
+            break;
+        case Storage::NONE:
+            break;
+        }
+    } else if (dst.storage == Storage::INTS) {
+        dst.ints[a] += src.ints[b];
+    } else if (dst.storage == Storage::DOUBLES) {
+        dst.doubles[a] += src.doubles[b];
+    }
+    dst.counts[a] += src.counts[b];
+}
+
+// Build the output column of an aggregate, groups in the given order
+static Column result_column(const std::string& name, const AggState& st,
+                            const std::vector<uint32_t>& order) {
+    auto has = [&](uint32_t g) { return st.counts[g] > 0; };
+
+    if (st.op == AggOp::COUNT) {
+        Column col = Column::make(name, ColumnType::INT64);
+        col.reserve(order.size());
+        for (uint32_t g : order)
+            col.append_int(st.counts[g]);
+        return col;
+    }
+    if (st.op == AggOp::AVG) {
+        Column col = Column::make(name, ColumnType::DOUBLE);
+        col.reserve(order.size());
+        for (uint32_t g : order) {
+            col.append_double(has(g) ? std::optional<double>(st.doubles[g] /
+                                                             static_cast<double>(st.counts[g]))
+                                     : std::nullopt);
+        }
+        return col;
+    }
+
+    switch (st.storage) {
+    case Storage::DOUBLES: {
+        Column col = Column::make(name, ColumnType::DOUBLE);
+        col.reserve(order.size());
+        for (uint32_t g : order)
+            col.append_double(has(g) ? std::optional<double>(st.doubles[g]) : std::nullopt);
+        return col;
+    }
+    case Storage::STRINGS: {
+        Column col = Column::make(name, ColumnType::STRING);
+        col.reserve(order.size());
+        for (uint32_t g : order) {
+            col.append_string(has(g) ? std::optional<std::string_view>(st.strings[g])
+                                     : std::nullopt);
+        }
+        return col;
+    }
+    default: {
+        Column col = Column::make(name, ColumnType::INT64);
+        col.reserve(order.size());
+        for (uint32_t g : order)
+            col.append_int(has(g) ? std::optional<int64_t>(st.ints[g]) : std::nullopt);
+        return col;
+    }
+    }
+}
+
+// ============================================================================
+// Partial Aggregate (One Hash Table)
+// ============================================================================
+
+struct HashAggregate::Partial {
+    static constexpr uint64_t kTagMask = 0xffffffff00000000ULL;
+
+    std::vector<Column> keys;             // Row g = key of group g
+    std::vector<const Column*> key_cols;  // Pointers into keys, for keys_equal
+    std::vector<uint64_t> hashes;         // Per group
+    std::vector<uint64_t> first_row;      // Per group: input position of its first row
+    std::vector<AggState> states;         // Per aggregate
+    std::vector<uint64_t> slots;          // (hash tag) | (group + 1); 0 = empty
+
+    size_t num_groups() const {
+        return hashes.size();
+    }
+
+    // Group of row `row` of cols (hash = its row hash), created if new
+    uint32_t find_or_insert(const std::vector<const Column*>& cols, size_t row, uint64_t hash,
+                            uint64_t position) {
+        if ((num_groups() + 1) * 2 > slots.size())
+            grow();
+
+        const size_t mask = slots.size() - 1;
+        const uint64_t tag = hash & kTagMask;
+        for (size_t i = hash & mask;; i = (i + 1) & mask) {
+            uint64_t slot = slots[i];
+            if (slot == 0) {
+                auto g = static_cast<uint32_t>(num_groups());
+                slots[i] = tag | (uint64_t{g} + 1);
+                hashes.push_back(hash);
+                first_row.push_back(position);
+                for (size_t k = 0; k < keys.size(); ++k)
+                    keys[k].append_from(*cols[k], row);
+                for (auto& st : states)
+                    st.add_group();
+                return g;
+            }
+            if ((slot & kTagMask) == tag) {
+                auto g = static_cast<uint32_t>((slot & ~kTagMask) - 1);
+                if (keys_equal(key_cols, g, cols, row))
+                    return g;
+            }
+        }
+    }
+
+    // Double the slot array (load factor stays at most 1/2)
+    void grow() {
+        slots.assign(std::max<size_t>(1024, slots.size() * 2), 0);
+        const size_t mask = slots.size() - 1;
+        for (size_t g = 0; g < num_groups(); ++g) {
+            size_t i = hashes[g] & mask;
+            while (slots[i] != 0)
+                i = (i + 1) & mask;
+            slots[i] = (hashes[g] & kTagMask) | (g + 1);
+        }
+    }
+
+    // Accumulate rows [begin, end) of a batch
+    // (position = input position of the batch's first row)
+    void consume(const std::vector<const Column*>& batch_keys,
+                 const std::vector<std::vector<uint64_t>>& dict_hashes,
+                 const std::vector<const Column*>& inputs, size_t begin, size_t end,
+                 uint64_t position) {
+        std::vector<uint64_t> row_hashes;
+        hash_keys(batch_keys, dict_hashes, begin, end, row_hashes);
+
+        std::vector<uint32_t> groups(end - begin);
+        for (size_t r = begin; r < end; ++r)
+            groups[r - begin] = find_or_insert(batch_keys, r, row_hashes[r - begin], position + r);
+
+        for (size_t a = 0; a < states.size(); ++a)
+            update(states[a], inputs[a], groups.data(), begin, end);
+    }
+
+    // Fold every group of other into this table
+    void merge(const Partial& other) {
+        std::vector<const Column*> cols;
+        for (const auto& col : other.keys)
+            cols.push_back(&col);
+
+        for (size_t b = 0; b < other.num_groups(); ++b) {
+            uint32_t a = find_or_insert(cols, b, other.hashes[b], other.first_row[b]);
+            first_row[a] = std::min(first_row[a], other.first_row[b]);
+            for (size_t s = 0; s < states.size(); ++s)
+                merge_state(states[s], a, other.states[s], b);
+        }
+    }
+};
+
+// ============================================================================
+// HashAggregate
+// ============================================================================
+
+HashAggregate::HashAggregate(const PhysicalOp::AggregateOp& op, size_t partitions)
+    : op_(op), num_partitions_(std::max<size_t>(1, partitions)) {}
+
+HashAggregate::~HashAggregate() = default;
+
+// Helper: Column an aggregate reads (it must exist)
+static const Column& input_column(const Table& batch, const std::string& name) {
+    const Column* col = batch.get_column(name);
+    if (!col) {
+        throw RuntimeError("Column not found: " + name);
+    }
+    return *col;
+}
+
+void HashAggregate::init(const Table& batch) {
+    for (const auto& key : op_.keys)
+        key_types_.push_back(input_column(batch, key).type);
+
+    std::vector<AggState> states;
+    for (const auto& agg : op_.aggregates) {
+        ColumnType input = ColumnType::INT64;
+        if (!agg.column.empty())
+            input = input_column(batch, agg.column).type;
+        input_types_.push_back(input);
+
+        Storage storage = Storage::NONE;
+        switch (agg.op) {
+        case AggOp::COUNT:
+            break;
+        case AggOp::SUM:
+            storage = input == ColumnType::DOUBLE ? Storage::DOUBLES : Storage::INTS;
+            break;
+        case AggOp::AVG:
+            storage = Storage::DOUBLES;
+            break;
+        case AggOp::MIN:
+        case AggOp::MAX:
+            if (input == ColumnType::BOOL) {
+                throw RuntimeError(std::string(agg_name(agg.op)) +
+                                   " requires a numeric or string column: " + agg.column);
+            }
+            storage = input == ColumnType::INT64    ? Storage::INTS
+                      : input == ColumnType::DOUBLE ? Storage::DOUBLES
+                                                    : Storage::STRINGS;
+            break;
+        }
+        states.push_back(AggState{agg.op, storage, {}, {}, {}, {}});
+    }
+
+    for (size_t p = 0; p < num_partitions_; ++p) {
+        auto partial = std::make_unique<Partial>();
+        for (size_t k = 0; k < op_.keys.size(); ++k)
+            partial->keys.push_back(Column::make(op_.keys[k], key_types_[k]));
+        for (const auto& col : partial->keys)
+            partial->key_cols.push_back(&col);
+        partial->states = states;
+        partials_.push_back(std::move(partial));
+    }
+}
+
+void HashAggregate::consume(const Table& batch, ThreadPool* pool) {
+    if (partials_.empty()) {
+        init(batch);
+    }
+
+    // Resolve columns by name (batches keep the schema, so types must match)
+    std::vector<const Column*> key_cols;
+    std::vector<std::vector<uint64_t>> dict_hashes;
+    for (size_t k = 0; k < op_.keys.size(); ++k) {
+        const Column& col = input_column(batch, op_.keys[k]);
+        if (col.type != key_types_[k]) {
+            throw RuntimeError("Column type changed between batches: " + col.name);
+        }
+        dict_hashes.push_back(dictionary_hashes(col));
+        key_cols.push_back(&col);
+    }
+    std::vector<const Column*> inputs;
+    for (size_t a = 0; a < op_.aggregates.size(); ++a) {
+        const auto& agg = op_.aggregates[a];
+        const Column* col = agg.column.empty() ? nullptr : &input_column(batch, agg.column);
+        if (col && col->type != input_types_[a]) {
+            throw RuntimeError("Column type changed between batches: " + col->name);
+        }
+        inputs.push_back(col);
+    }
+
+    // Contiguous chunk i of the batch goes to partial i
+    const size_t n = batch.num_rows;
+    const size_t chunks = std::min(num_partitions_, std::max<size_t>(1, n / kMinChunkRows));
+    const size_t per_chunk = (n + chunks - 1) / chunks;
+    auto run = [&](size_t i) {
+        size_t begin = std::min(n, i * per_chunk);
+        size_t end = std::min(n, begin + per_chunk);
+        partials_[i]->consume(key_cols, dict_hashes, inputs, begin, end, rows_seen_);
+    };
+    if (chunks == 1 || !pool) {
+        run(0);
+    } else {
+        pool->parallel_for(chunks, run);
+    }
+    rows_seen_ += n;
+}
+
+Table HashAggregate::finish() {
+    if (partials_.empty()) {
+        throw RuntimeError("Aggregate received no input");
+    }
+
+    Partial& result = *partials_.front();
+    for (size_t p = 1; p < partials_.size(); ++p) {
+        result.merge(*partials_[p]);
+        partials_[p].reset();
+    }
+
+    // Without keys there is exactly one group, even for an empty input
+    if (op_.keys.empty() && result.num_groups() == 0) {
+        result.find_or_insert({}, 0, 0, 0);
+    }
+
+    std::vector<uint32_t> order(result.num_groups());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(),
+              [&](uint32_t a, uint32_t b) { return result.first_row[a] < result.first_row[b]; });
+
+    Table out;
+    for (const auto& keys : result.keys) {
+        Column col = Column::make(keys.name, keys.type);
+        col.reserve(order.size());
+        for (uint32_t g : order)
+            col.append_from(keys, g);
+        out.add_column(std::move(col));
+    }
+    for (size_t a = 0; a < op_.aggregates.size(); ++a) {
+        out.add_column(result_column(op_.aggregates[a].output_name, result.states[a], order));
+    }
+    out.num_rows = order.size();
+    return out;
+}
+
+}  // namespace joy
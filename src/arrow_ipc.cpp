@@ -0,0 +1,1099 @@
+#include "arrow_ipc.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <optional>
+#include <stdexcept>
+#include <string_view>
+
+#include "thread_pool.hpp"
+
+namespace joy {
+
+constexpr char kArrowMagic[6] = {'A', 'R', 'R', 'O', 'W', '1'};
+constexpr uint32_t kContinuation = 0xFFFFFFFF;
+constexpr int16_t kMetadataV5 = 4;
+constexpr size_t kArrowAlignment = 64;  // Body buffers (the format requires 8)
+
+// Batches with fewer rows are decoded on the calling thread
+constexpr size_t kMinParallelDecodeRows = 16 * 1024;
+
+// Type union of Schema.fbs (Field.type_type)
+enum class ArrowType : uint8_t {
+    NONE,
+    NULL_TYPE,
+    INT,
+    FLOATING_POINT,
+    BINARY,
+    UTF8,
+    BOOL,
+    DECIMAL,
+    DATE,
+    TIME,
+    TIMESTAMP,
+    INTERVAL,
+    LIST,
+    STRUCT,
+    UNION,
+    FIXED_SIZE_BINARY,
+    FIXED_SIZE_LIST,
+    MAP,
+    DURATION,
+    LARGE_BINARY,
+    LARGE_UTF8,
+    LARGE_LIST,
+    RUN_END_ENCODED,
+    BINARY_VIEW,
+    UTF8_VIEW,
+    LIST_VIEW,
+    LARGE_LIST_VIEW
+};
+
+// MessageHeader union of Message.fbs
+enum class MessageType : uint8_t { NONE, SCHEMA, DICTIONARY_BATCH, RECORD_BATCH };
+
+template <typename T>
+static void put(std::string& out, T value) {
+    out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+static T load(const char* p) {
+    T value;
+    std::memcpy(&value, p, sizeof(T));
+    return value;
+}
+
+static void pad(std::string& out, size_t alignment) {
+    out.append((alignment - out.size() % alignment) % alignment, '\0');
+}
+
+// ============================================================================
+// FlatBuffers
+// ============================================================================
+// Arrow metadata is FlatBuffers-encoded: a table starts with a signed offset
+// to its vtable, which lists where each field lives inside the table (0 =
+// absent, use the default). Tables, strings and vectors are reached through
+// unsigned offsets relative to where the offset is stored
+
+class FbTable {
+public:
+    FbTable() = default;
+    FbTable(const char* buf, size_t size, size_t pos, const std::string* filepath)
+        : buf_(buf), size_(size), pos_(pos), filepath_(filepath) {
+        check(pos <= size_ && size_ - pos >= 4 && pos % 4 == 0);
+        int64_t vtable = static_cast<int64_t>(pos) - load<int32_t>(buf_ + pos);
+        check(vtable >= 0 && static_cast<size_t>(vtable) + 4 <= size_ && vtable % 2 == 0);
+        vtable_ = static_cast<size_t>(vtable);
+        vtable_size_ = load<uint16_t>(buf_ + vtable_);
+        check(vtable_size_ >= 4 && vtable_size_ % 2 == 0 && vtable_ + vtable_size_ <= size_);
+        check(size_ - pos >= load<uint16_t>(buf_ + vtable_ + 2));
+    }
+
+    // The root table of a buffer
+    static FbTable root(const char* buf, size_t size, const std::string* filepath) {
+        FbTable t;
+        t.buf_ = buf;
+        t.size_ = size;
+        t.filepath_ = filepath;
+        return FbTable(buf, size, t.deref(0), filepath);
+    }
+
+    template <typename T>
+    T scalar(int id, T default_value) const {
+        size_t p = field(id, sizeof(T));
+        return p ? load<T>(buf_ + p) : default_value;
+    }
+
+    std::optional<FbTable> table(int id) const {
+        size_t p = field(id, 4);
+        if (!p)
+            return std::nullopt;
+        return FbTable(buf_, size_, deref(p), filepath_);
+    }
+
+    std::string_view string(int id) const {
+        size_t p = field(id, 4);
+        if (!p)
+            return {};
+        size_t s = deref(p);
+        check(size_ - s >= 4);
+        uint32_t length = load<uint32_t>(buf_ + s);
+        check(size_ - s - 4 >= length);
+        return std::string_view(buf_ + s + 4, length);
+    }
+
+    // Vector field: returns its length; first = position of element 0
+    size_t vector(int id, size_t elem_size, size_t& first) const {
+        size_t p = field(id, 4);
+        if (!p)
+            return 0;
+        size_t v = deref(p);
+        check(size_ - v >= 4);
+        uint32_t length = load<uint32_t>(buf_ + v);
+        check((size_ - v - 4) / elem_size >= length);
+        first = v + 4;
+        return length;
+    }
+
+    // Element i of a vector of tables
+    FbTable table_at(size_t first, size_t i) const {
+        return FbTable(buf_, size_, deref(first + 4 * i), filepath_);
+    }
+
+    // Scalar member at byte offset of element i of a vector of structs
+    template <typename T>
+    T struct_at(size_t first, size_t elem_size, size_t i, size_t offset) const {
+        return load<T>(buf_ + first + elem_size * i + offset);
+    }
+
+private:
+    void check(bool ok) const {
+        if (!ok)
+            throw std::runtime_error("Corrupt Arrow file: " + *filepath_);
+    }
+
+    // Position of field id, or 0 if absent
+    size_t field(int id, size_t size) const {
+        size_t entry = 4 + 2 * static_cast<size_t>(id);
+        if (entry + 2 > vtable_size_)
+            return 0;
+        uint16_t offset = load<uint16_t>(buf_ + vtable_ + entry);
+        if (offset == 0)
+            return 0;
+        check(size_ - pos_ >= offset + size);
+        return pos_ + offset;
+    }
+
+    // Follow the unsigned offset stored at p
+    size_t deref(size_t p) const {
+        check(size_ - p >= 4);
+        uint64_t target = p + uint64_t{load<uint32_t>(buf_ + p)};
+        check(target < size_);
+        return static_cast<size_t>(target);
+    }
+
+    const char* buf_ = nullptr;
+    size_t size_ = 0;
+    size_t pos_ = 0;
+    size_t vtable_ = 0;
+    size_t vtable_size_ = 0;
+    const std::string* filepath_ = nullptr;
+};
+
+// Helper: FlatBuffers writer for the few tables Joy emits
+// An object is laid out before its children, so every offset points forward
+struct FbObject {
+    enum class Kind { TABLE, TABLES, STRUCTS, STRING };
+    struct Field {
+        std::string scalar;  // Little-endian bytes (empty = child or absent)
+        std::unique_ptr<FbObject> child;
+    };
+
+    Kind kind = Kind::TABLE;
+    std::vector<Field> fields;       // TABLE, indexed by field id
+    std::vector<FbObject> elements;  // TABLES
+    std::string bytes;               // STRUCTS (packed 8-byte aligned elements), STRING
+    size_t count = 0;                // STRUCTS
+
+    static FbObject string(std::string_view s) {
+        FbObject obj;
+        obj.kind = Kind::STRING;
+        obj.bytes = std::string(s);
+        return obj;
+    }
+    static FbObject tables(std::vector<FbObject> elements) {
+        FbObject obj;
+        obj.kind = Kind::TABLES;
+        obj.elements = std::move(elements);
+        return obj;
+    }
+    static FbObject structs(std::string bytes, size_t count) {
+        FbObject obj;
+        obj.kind = Kind::STRUCTS;
+        obj.bytes = std::move(bytes);
+        obj.count = count;
+        return obj;
+    }
+
+    template <typename T>
+    FbObject& set(size_t id, T value) {
+        slot(id).scalar.assign(reinterpret_cast<const char*>(&value), sizeof(T));
+        return *this;
+    }
+    FbObject& set(size_t id, FbObject child) {
+        slot(id).child = std::make_unique<FbObject>(std::move(child));
+        return *this;
+    }
+
+    // Serialize as the root of a buffer (padded to 8 bytes)
+    std::string finish() {
+        std::string out(4, '\0');
+        patch(out, 0, place(out));
+        pad(out, 8);
+        return out;
+    }
+
+private:
+    Field& slot(size_t id) {
+        if (fields.size() <= id)
+            fields.resize(id + 1);
+        return fields[id];
+    }
+
+    static void patch(std::string& out, size_t at, size_t target) {
+        uint32_t offset = static_cast<uint32_t>(target - at);
+        std::memcpy(&out[at], &offset, sizeof(offset));
+    }
+
+    // Append this object and its children to out; returns its position
+    size_t place(std::string& out) {
+        switch (kind) {
+        case Kind::STRING: {
+            pad(out, 4);
+            size_t pos = out.size();
+            put<uint32_t>(out, static_cast<uint32_t>(bytes.size()));
+            out += bytes;
+            out.push_back('\0');
+            return pos;
+        }
+        case Kind::STRUCTS: {
+            // Length at 4 mod 8 so the elements are 8-byte aligned
+            pad(out, 8);
+            out.append(4, '\0');
+            size_t pos = out.size();
+            put<uint32_t>(out, static_cast<uint32_t>(count));
+            out += bytes;
+            return pos;
+        }
+        case Kind::TABLES: {
+            pad(out, 4);
+            size_t pos = out.size();
+            put<uint32_t>(out, static_cast<uint32_t>(elements.size()));
+            size_t slots = out.size();
+            out.append(4 * elements.size(), '\0');
+            for (size_t i = 0; i < elements.size(); ++i)
+                patch(out, slots + 4 * i, elements[i].place(out));
+            return pos;
+        }
+        case Kind::TABLE:
+            break;
+        }
+
+        // Inline layout: vtable offset, then fields from the largest down so
+        // each is aligned (child offsets take 4 bytes)
+        auto size_of = [](const Field& f) { return f.child ? size_t{4} : f.scalar.size(); };
+        std::vector<size_t> order;
+        for (size_t id = 0; id < fields.size(); ++id) {
+            if (size_of(fields[id]) > 0)
+                order.push_back(id);
+        }
+        std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+            return size_of(fields[a]) > size_of(fields[b]);
+        });
+        std::vector<uint16_t> at(fields.size(), 0);
+        size_t inline_size = 4;
+        for (size_t id : order) {
+            size_t size = size_of(fields[id]);
+            inline_size = (inline_size + size - 1) / size * size;
+            at[id] = static_cast<uint16_t>(inline_size);
+            inline_size += size;
+        }
+
+        pad(out, 2);
+        size_t vtable = out.size();
+        put<uint16_t>(out, static_cast<uint16_t>(4 + 2 * fields.size()));
+        put<uint16_t>(out, static_cast<uint16_t>(inline_size));
+        for (uint16_t offset : at)
+            put<uint16_t>(out, offset);
+
+        pad(out, 8);
+        size_t table = out.size();
+        put<int32_t>(out, static_cast<int32_t>(table - vtable));
+        out.resize(table + inline_size, '\0');
+        for (size_t id : order) {
+            const auto& scalar = fields[id].scalar;
+            if (!fields[id].child)
+                std::memcpy(&out[table + at[id]], scalar.data(), scalar.size());
+        }
+        for (size_t id : order) {
+            if (fields[id].child)
+                patch(out, table + at[id], fields[id].child->place(out));
+        }
+        return table;
+    }
+};
+
+// ============================================================================
+// Reader
+// ============================================================================
+
+struct ArrowReader::Message {
+    MessageType type = MessageType::NONE;
+    FbTable header;
+    uint64_t body = 0;  // Offset of the body in the file
+    uint64_t body_length = 0;
+};
+
+// Helper: FieldNodes and buffers a field (with its children) takes in a record batch
+static void count_layout(const FbTable& field, size_t& nodes, size_t& buffers,
+                         const std::string& filepath) {
+    nodes++;
+    if (field.table(4)) {
+        buffers += 2;  // Dictionary-encoded: validity + indices
+        return;
+    }
+    switch (static_cast<ArrowType>(field.scalar<uint8_t>(2, 0))) {
+    case ArrowType::NULL_TYPE:
+    case ArrowType::RUN_END_ENCODED:
+        break;
+    case ArrowType::STRUCT:
+    case ArrowType::FIXED_SIZE_LIST:
+        buffers += 1;
+        break;
+    case ArrowType::UNION: {
+        auto type = field.table(3);
+        buffers += type && type->scalar<int16_t>(0, 0) == 1 ? 2 : 1;  // Dense: + offsets
+        break;
+    }
+    case ArrowType::BINARY:
+    case ArrowType::UTF8:
+    case ArrowType::LARGE_BINARY:
+    case ArrowType::LARGE_UTF8:
+    case ArrowType::LIST_VIEW:
+    case ArrowType::LARGE_LIST_VIEW:
+        buffers += 3;
+        break;
+    case ArrowType::BINARY_VIEW:
+    case ArrowType::UTF8_VIEW:
+    case ArrowType::NONE:
+        throw std::runtime_error("Unsupported Arrow column " + std::string(field.string(0)) +
+                                 ": " + filepath);
+    default:
+        buffers += 2;  // Fixed-width types, List, LargeList, Map
+        break;
+    }
+    size_t first = 0;
+    size_t num_children = field.vector(5, 4, first);
+    for (size_t i = 0; i < num_children; ++i)
+        count_layout(field.table_at(first, i), nodes, buffers, filepath);
+}
+
+ArrowReader::ArrowReader(const std::string& filepath, ThreadPool* pool,
+                         const std::vector<std::string>* columns)
+    : filepath_(filepath), file_(filepath), pool_(pool) {
+    const char* data = file_.data();
+    const size_t size = file_.size();
+    auto corrupt = [&] { throw std::runtime_error("Corrupt Arrow file: " + filepath); };
+
+    Message message;
+    if (size >= 8 && std::memcmp(data, kArrowMagic, sizeof(kArrowMagic)) == 0) {
+        // File: the footer holds the schema and the offsets of every message
+        if (size < 8 + 10 ||
+            std::memcmp(data + size - sizeof(kArrowMagic), kArrowMagic, sizeof(kArrowMagic)))
+            corrupt();
+        int32_t footer_size = load<int32_t>(data + size - 10);
+        if (footer_size <= 0 || static_cast<size_t>(footer_size) > size - 18)
+            corrupt();
+        const char* footer_data = data + size - 10 - footer_size;
+        if (reinterpret_cast<uintptr_t>(footer_data) % 4 != 0)
+            corrupt();
+        FbTable footer = FbTable::root(footer_data, footer_size, &filepath_);
+        auto schema = footer.table(1);
+        if (!schema)
+            corrupt();
+        read_schema(*schema, columns);
+
+        constexpr size_t kBlockSize = 24;  // Block: offset, metaDataLength, bodyLength
+        for (int id : {2, 3}) {            // Dictionaries, then record batches
+            size_t first = 0;
+            size_t num_blocks = footer.vector(id, kBlockSize, first);
+            for (size_t i = 0; i < num_blocks; ++i) {
+                auto offset = footer.struct_at<int64_t>(first, kBlockSize, i, 0);
+                if (offset < 0 || read_message(static_cast<uint64_t>(offset), message) == 0)
+                    corrupt();
+                if (message.type == MessageType::DICTIONARY_BATCH)
+                    read_dictionary(message);
+                else if (message.type == MessageType::RECORD_BATCH)
+                    read_record_batch(message);
+                else
+                    corrupt();
+            }
+        }
+    } else {
+        // Stream: the schema, then dictionaries and record batches in order
+        uint64_t pos = read_message(0, message);
+        if (pos == 0 || message.type != MessageType::SCHEMA)
+            throw std::runtime_error("Not an Arrow file: " + filepath);
+        read_schema(message.header, columns);
+        while (pos < size && (pos = read_message(pos, message)) != 0) {
+            if (message.type == MessageType::DICTIONARY_BATCH)
+                read_dictionary(message);
+            else if (message.type == MessageType::RECORD_BATCH)
+                read_record_batch(message);
+        }
+    }
+}
+
+uint64_t ArrowReader::read_message(uint64_t offset, Message& message) const {
+    const char* data = file_.data();
+    const size_t size = file_.size();
+    auto corrupt = [&] { throw std::runtime_error("Corrupt Arrow file: " + filepath_); };
+
+    if (offset % 8 != 0 || offset > size || size - offset < 4)
+        corrupt();
+    uint64_t pos = offset + 4;
+    uint32_t length = load<uint32_t>(data + offset);
+    if (length == kContinuation) {
+        if (size - pos < 4)
+            corrupt();
+        length = load<uint32_t>(data + pos);
+        pos += 4;
+    }
+    if (length == 0) {
+        return 0;  // End of stream
+    }
+    if (length > size - pos)
+        corrupt();
+
+    FbTable root = FbTable::root(data + pos, length, &filepath_);
+    auto header = root.table(2);
+    int64_t body_length = root.scalar<int64_t>(3, 0);
+    message.type = static_cast<MessageType>(root.scalar<uint8_t>(1, 0));
+    message.body = pos + length;
+    if (!header || body_length < 0 || static_cast<uint64_t>(body_length) > size - message.body)
+        corrupt();
+    message.header = *header;
+    message.body_length = static_cast<uint64_t>(body_length);
+    return message.body + message.body_length;
+}
+
+void ArrowReader::read_schema(const FbTable& schema, const std::vector<std::string>* columns) {
+    if (schema.scalar<int16_t>(0, 0) != 0) {
+        throw std::runtime_error("Big-endian Arrow files are not supported: " + filepath_);
+    }
+    size_t first = 0;
+    size_t num_fields = schema.vector(1, 4, first);
+    for (size_t i = 0; i < num_fields; ++i) {
+        FbTable f = schema.table_at(first, i);
+        std::string name(f.string(0));
+        size_t node = num_nodes_;
+        size_t buffer = num_buffers_;
+        count_layout(f, num_nodes_, num_buffers_, filepath_);
+        if (columns && std::find(columns->begin(), columns->end(), name) == columns->end()) {
+            continue;
+        }
+
+        auto unsupported = [&] {
+            throw std::runtime_error("Unsupported Arrow type for column " + name + ": " +
+                                     filepath_);
+        };
+        auto type_id = static_cast<ArrowType>(f.scalar<uint8_t>(2, 0));
+        auto type = f.table(3);
+        Field field;
+        field.node = node;
+        field.buffer = buffer;
+        auto int_layout = [&](const std::optional<FbTable>& int_type, int default_bits) {
+            int bits = int_type ? int_type->scalar<int32_t>(0, default_bits) : default_bits;
+            if (bits != 8 && bits != 16 && bits != 32 && bits != 64)
+                unsupported();
+            field.byte_width = bits / 8;
+            field.is_signed = int_type ? int_type->scalar<uint8_t>(1, 0) != 0 : true;
+        };
+        ColumnType column_type = ColumnType::INT64;
+
+        if (auto dict = f.table(4)) {
+            if (type_id != ArrowType::UTF8 && type_id != ArrowType::LARGE_UTF8)
+                unsupported();
+            field.kind = Field::Kind::DICT;
+            field.dict_id = dict->scalar<int64_t>(0, 0);
+            field.large = type_id == ArrowType::LARGE_UTF8;
+            int_layout(dict->table(1), 32);  // Indices (signed int32 by default)
+            column_type = ColumnType::STRING;
+        } else {
+            switch (type_id) {
+            case ArrowType::INT:
+                if (!type)
+                    unsupported();
+                field.kind = Field::Kind::INT;
+                int_layout(type, 0);
+                break;
+            case ArrowType::DATE:  // Days (int32) or milliseconds (int64)
+                field.kind = Field::Kind::INT;
+                field.byte_width = type && type->scalar<int16_t>(0, 1) == 0 ? 4 : 8;
+                break;
+            case ArrowType::TIME:
+                field.kind = Field::Kind::INT;
+                field.byte_width = type ? type->scalar<int32_t>(1, 32) / 8 : 4;
+                if (field.byte_width != 4 && field.byte_width != 8)
+                    unsupported();
+                break;
+            case ArrowType::TIMESTAMP:
+            case ArrowType::DURATION:
+                field.kind = Field::Kind::INT;
+                break;
+            case ArrowType::FLOATING_POINT: {
+                int16_t precision = type ? type->scalar<int16_t>(0, 0) : 0;
+                if (precision != 1 && precision != 2)
+                    unsupported();  // Half precision
+                field.kind = Field::Kind::FLOAT;
+                field.byte_width = precision == 1 ? 4 : 8;
+                column_type = ColumnType::DOUBLE;
+                break;
+            }
+            case ArrowType::BOOL:
+                field.kind = Field::Kind::BOOL;
+                column_type = ColumnType::BOOL;
+                break;
+            case ArrowType::UTF8:
+            case ArrowType::BINARY:
+            case ArrowType::LARGE_UTF8:
+            case ArrowType::LARGE_BINARY:
+                field.kind = Field::Kind::STRING;
+                field.large = type_id == ArrowType::LARGE_UTF8 || type_id == ArrowType::LARGE_BINARY;
+                column_type = ColumnType::STRING;
+                break;
+            default:
+                unsupported();
+            }
+        }
+        headers_.push_back(std::move(name));
+        types_.push_back(column_type);
+        inferred_.push_back(true);  // Declared by the schema
+        fields_.push_back(field);
+    }
+}
+
+// Helper: Record batch metadata with buffer ranges made absolute and checked
+struct RecordBatchLayout {
+    int64_t length = 0;
+    std::vector<std::pair<int64_t, int64_t>> nodes;  // length, null_count
+    std::vector<ArrowRange> buffers;
+};
+
+static RecordBatchLayout read_layout(const FbTable& batch, uint64_t body, uint64_t body_length,
+                                     const std::string& filepath) {
+    auto corrupt = [&] { throw std::runtime_error("Corrupt Arrow file: " + filepath); };
+    if (batch.table(3)) {
+        throw std::runtime_error("Compressed Arrow files are not supported: " + filepath);
+    }
+    RecordBatchLayout layout;
+    layout.length = batch.scalar<int64_t>(0, 0);
+    if (layout.length < 0)
+        corrupt();
+
+    constexpr size_t kStructSize = 16;  // FieldNode and Buffer: two int64 each
+    size_t first = 0;
+    size_t num_nodes = batch.vector(1, kStructSize, first);
+    for (size_t i = 0; i < num_nodes; ++i) {
+        layout.nodes.emplace_back(batch.struct_at<int64_t>(first, kStructSize, i, 0),
+                                  batch.struct_at<int64_t>(first, kStructSize, i, 8));
+    }
+    size_t num_buffers = batch.vector(2, kStructSize, first);
+    for (size_t i = 0; i < num_buffers; ++i) {
+        auto offset = batch.struct_at<int64_t>(first, kStructSize, i, 0);
+        auto size = batch.struct_at<int64_t>(first, kStructSize, i, 8);
+        if (offset < 0 || size < 0 || static_cast<uint64_t>(offset) > body_length ||
+            static_cast<uint64_t>(size) > body_length - static_cast<uint64_t>(offset))
+            corrupt();
+        layout.buffers.push_back({body + static_cast<uint64_t>(offset),
+                                  static_cast<uint64_t>(size)});
+    }
+    return layout;
+}
+
+// Helper: Byte offsets of a STRING array's values (32- or 64-bit)
+struct ArrowOffsets {
+    const char* data;
+    bool large;
+    uint64_t bytes_size;  // Size of the value bytes buffer
+
+    uint64_t at(size_t i) const {
+        return large ? static_cast<uint64_t>(load<int64_t>(data + 8 * i))
+                     : static_cast<uint64_t>(static_cast<uint32_t>(load<int32_t>(data + 4 * i)));
+    }
+};
+
+void ArrowReader::read_dictionary(const Message& message) {
+    auto corrupt = [&] { throw std::runtime_error("Corrupt Arrow file: " + filepath_); };
+    const int64_t id = message.header.scalar<int64_t>(0, 0);
+    auto data = message.header.table(1);
+    const bool delta = message.header.scalar<uint8_t>(2, 0) != 0;
+    if (!data)
+        corrupt();
+
+    // Only dictionaries of returned columns are decoded
+    auto field = std::find_if(fields_.begin(), fields_.end(),
+                              [&](const Field& f) { return f.dict_id == id; });
+    if (field == fields_.end()) {
+        return;
+    }
+    RecordBatchLayout layout = read_layout(*data, message.body, message.body_length, filepath_);
+    const size_t n = static_cast<size_t>(layout.length);
+    const size_t offset_width = field->large ? 8 : 4;
+    if (layout.nodes.empty() || layout.buffers.size() < 3 || layout.nodes[0].first != layout.length ||
+        (n > 0 && layout.buffers[1].size < (n + 1) * offset_width) ||
+        (layout.buffers[0].size > 0 && layout.buffers[0].size < (n + 7) / 8))
+        corrupt();
+
+    auto& entry = dictionaries_[id];
+    if (!entry || !delta) {
+        entry = std::make_shared<Dictionary>();
+        entry->dict = std::make_shared<StringDictionary>();
+    }
+    const char* base = file_.data();
+    const char* validity = layout.buffers[0].size > 0 ? base + layout.buffers[0].offset : nullptr;
+    ArrowOffsets offsets{base + layout.buffers[1].offset, field->large, layout.buffers[2].size};
+    const char* bytes = base + layout.buffers[2].offset;
+    for (size_t i = 0; i < n; ++i) {
+        if (validity && !((validity[i >> 3] >> (i & 7)) & 1)) {
+            entry->codes.push_back(-1);
+            continue;
+        }
+        uint64_t begin = offsets.at(i);
+        uint64_t end = offsets.at(i + 1);
+        if (end < begin || end > offsets.bytes_size)
+            corrupt();
+        entry->codes.push_back(entry->dict->intern(std::string_view(bytes + begin, end - begin)));
+    }
+}
+
+void ArrowReader::read_record_batch(const Message& message) {
+    auto corrupt = [&] { throw std::runtime_error("Corrupt Arrow file: " + filepath_); };
+    RecordBatchLayout layout =
+        read_layout(message.header, message.body, message.body_length, filepath_);
+    if (layout.nodes.size() < num_nodes_ || layout.buffers.size() < num_buffers_)
+        corrupt();
+    if (layout.length == 0) {
+        return;
+    }
+
+    Batch batch;
+    batch.num_rows = static_cast<uint64_t>(layout.length);
+    const uint64_t n = batch.num_rows;
+    const uint64_t bitmap_bytes = (n + 7) / 8;
+    for (const Field& field : fields_) {
+        ColumnData col;
+        const auto& node = layout.nodes[field.node];
+        if (static_cast<uint64_t>(node.first) != n || node.second < 0)
+            corrupt();
+        col.null_count = static_cast<uint64_t>(node.second);
+        size_t num_buffers = field.kind == Field::Kind::STRING ? 3 : 2;
+        for (size_t b = 0; b < num_buffers; ++b)
+            col.buffers[b] = layout.buffers[field.buffer + b];
+
+        const auto& buf = col.buffers;
+        bool valid = buf[0].size >= bitmap_bytes || (buf[0].size == 0 && col.null_count == 0);
+        switch (field.kind) {
+        case Field::Kind::INT:
+        case Field::Kind::FLOAT:
+        case Field::Kind::DICT:
+            valid &= buf[1].size >= n * static_cast<uint64_t>(field.byte_width);
+            break;
+        case Field::Kind::BOOL:
+            valid &= buf[1].size >= bitmap_bytes;
+            break;
+        case Field::Kind::STRING:
+            valid &= buf[1].size >= (n + 1) * (field.large ? 8 : 4);
+            break;
+        }
+        if (field.kind == Field::Kind::DICT) {
+            auto it = dictionaries_.find(field.dict_id);
+            valid &= it != dictionaries_.end();
+            if (valid)
+                col.dict = it->second;
+        }
+        if (!valid)
+            corrupt();
+        batch.columns.push_back(col);
+    }
+    batches_.push_back(std::move(batch));
+}
+
+// Helper: Bitmap words covering bits [0, bits) of a buffer, copied when the
+// buffer is not 8-byte aligned or too short to read as whole words
+static const uint64_t* bitmap_words(const char* data, uint64_t size, size_t bits,
+                                    std::vector<uint64_t>& scratch) {
+    const size_t bytes = (bits + 63) / 64 * sizeof(uint64_t);
+    if (reinterpret_cast<uintptr_t>(data) % alignof(uint64_t) == 0 && size >= bytes) {
+        return reinterpret_cast<const uint64_t*>(data);
+    }
+    scratch.assign(bytes / sizeof(uint64_t), 0);
+    std::memcpy(scratch.data(), data, std::min<uint64_t>(size, bytes));
+    return scratch.data();
+}
+
+// Helper: Append count integers of type T starting at index begin, widened to int64
+template <typename T>
+static void append_ints(std::vector<int64_t>& dst, const char* data, size_t begin, size_t count) {
+    if constexpr (sizeof(T) == sizeof(int64_t)) {
+        size_t old = dst.size();
+        dst.resize(old + count);
+        std::memcpy(dst.data() + old, data + begin * sizeof(T), count * sizeof(T));
+    } else {
+        for (size_t i = 0; i < count; ++i)
+            dst.push_back(static_cast<int64_t>(load<T>(data + (begin + i) * sizeof(T))));
+    }
+}
+
+// Helper: Dictionary index of row r (any integer width)
+static int64_t index_at(const char* data, int width, bool is_signed, size_t r) {
+    switch (width) {
+    case 1:
+        return is_signed ? load<int8_t>(data + r) : load<uint8_t>(data + r);
+    case 2:
+        return is_signed ? load<int16_t>(data + 2 * r) : load<uint16_t>(data + 2 * r);
+    case 4:
+        return is_signed ? load<int32_t>(data + 4 * r) : load<uint32_t>(data + 4 * r);
+    default:
+        return load<int64_t>(data + 8 * r);
+    }
+}
+
+void ArrowReader::append_rows(Column& col, const Batch& batch, size_t c, size_t begin,
+                              size_t count) const {
+    const Field& field = fields_[c];
+    const ColumnData& data = batch.columns[c];
+    const char* base = file_.data();
+    auto corrupt = [&] { throw std::runtime_error("Corrupt Arrow file: " + filepath_); };
+    std::vector<uint64_t> scratch;
+
+    const size_t start = col.validity.size();
+    if (data.buffers[0].size == 0) {
+        col.validity.resize(start + count, true);
+    } else {
+        col.validity.append_bits(bitmap_words(base + data.buffers[0].offset, data.buffers[0].size,
+                                              begin + count, scratch),
+                                 begin, count);
+    }
+
+    const char* values = base + data.buffers[1].offset;
+    switch (field.kind) {
+    case Field::Kind::INT: {
+        auto& dst = col.values<int64_t>();
+        switch (field.byte_width) {
+        case 1:
+            field.is_signed ? append_ints<int8_t>(dst, values, begin, count)
+                            : append_ints<uint8_t>(dst, values, begin, count);
+            break;
+        case 2:
+            field.is_signed ? append_ints<int16_t>(dst, values, begin, count)
+                            : append_ints<uint16_t>(dst, values, begin, count);
+            break;
+        case 4:
+            field.is_signed ? append_ints<int32_t>(dst, values, begin, count)
+                            : append_ints<uint32_t>(dst, values, begin, count);
+            break;
+        default:
+            append_ints<int64_t>(dst, values, begin, count);  // uint64 keeps its bits
+            break;
+        }
+        return;
+    }
+    case Field::Kind::FLOAT: {
+        auto& dst = col.values<double>();
+        if (field.byte_width == 8) {
+            size_t old = dst.size();
+            dst.resize(old + count);
+            std::memcpy(dst.data() + old, values + begin * 8, count * 8);
+        } else {
+            for (size_t i = 0; i < count; ++i)
+                dst.push_back(load<float>(values + (begin + i) * 4));
+        }
+        return;
+    }
+    case Field::Kind::BOOL:
+        std::get<Bitmap>(col.data).append_bits(
+            bitmap_words(values, data.buffers[1].size, begin + count, scratch), begin, count);
+        return;
+    case Field::Kind::STRING: {
+        ArrowOffsets offsets{values, field.large, data.buffers[2].size};
+        const char* bytes = base + data.buffers[2].offset;
+        auto& dst = std::get<StringArena>(col.data);
+        for (size_t r = begin; r < begin + count; ++r) {
+            uint64_t a = offsets.at(r);
+            uint64_t b = offsets.at(r + 1);
+            if (b < a || b > offsets.bytes_size)
+                corrupt();
+            dst.push_back(col.validity.get(start + r - begin)
+                              ? std::string_view(bytes + a, b - a)
+                              : std::string_view());
+        }
+        return;
+    }
+    case Field::Kind::DICT:
+        break;
+    }
+
+    // Dictionary-encoded: copy codes while the column shares the batch's dictionary
+    const Dictionary& dict = *data.dict;
+    auto& dst = std::get<DictStrings>(col.data);
+    if (dst.codes.empty()) {
+        dst.dict = dict.dict;
+    }
+    const bool same = dst.dict == dict.dict;
+    for (size_t r = begin; r < begin + count; ++r) {
+        const size_t row = start + r - begin;
+        if (!col.validity.get(row)) {
+            dst.push_null();
+            continue;
+        }
+        int64_t index = index_at(values, field.byte_width, field.is_signed, r);
+        if (index < 0 || static_cast<uint64_t>(index) >= dict.codes.size())
+            corrupt();
+        int32_t code = dict.codes[static_cast<size_t>(index)];
+        if (code < 0) {
+            col.validity.set(row, false);  // NULL dictionary value
+            dst.push_null();
+        } else if (same) {
+            dst.codes.push_back(code);
+        } else {
+            dst.push_back(dict.dict->get(code));
+        }
+    }
+}
+
+bool ArrowReader::next_batch(Table& out, size_t max_rows) {
+    if (started_ && batch_ == batches_.size()) {
+        return false;
+    }
+    started_ = true;
+
+    // Rows of the batch: a run of pieces, each a row range of one record batch
+    struct Piece {
+        size_t batch, begin, count;
+    };
+    std::vector<Piece> pieces;
+    size_t rows = 0;
+    while (batch_ < batches_.size() && rows < max_rows) {
+        size_t count = std::min<size_t>(batches_[batch_].num_rows - row_, max_rows - rows);
+        pieces.push_back({batch_, row_, count});
+        rows += count;
+        row_ += count;
+        if (row_ == batches_[batch_].num_rows) {
+            batch_++;
+            row_ = 0;
+        }
+    }
+
+    out = Table{};
+    out.num_rows = rows;
+    out.columns.resize(headers_.size());
+    auto decode_column = [&](size_t c) {
+        Column col = fields_[c].kind == Field::Kind::DICT ? Column::make_dict(headers_[c])
+                                                          : Column::make(headers_[c], types_[c]);
+        col.reserve(rows);
+        for (const auto& piece : pieces)
+            append_rows(col, batches_[piece.batch], c, piece.begin, piece.count);
+        out.columns[c] = std::move(col);
+    };
+    if (pool_ && headers_.size() > 1 && rows >= kMinParallelDecodeRows) {
+        pool_->parallel_for(headers_.size(), decode_column);
+    } else {
+        for (size_t c = 0; c < headers_.size(); ++c)
+            decode_column(c);
+    }
+    return true;
+}
+
+// ============================================================================
+// Writer
+// ============================================================================
+
+// Helper: Schema table (shared by the schema message and the file footer)
+static FbObject schema_table(const std::vector<std::pair<std::string, ColumnType>>& schema) {
+    std::vector<FbObject> fields;
+    for (const auto& [name, type] : schema) {
+        FbObject type_table;
+        ArrowType type_id = ArrowType::NONE;
+        switch (type) {
+        case ColumnType::INT64:
+            type_id = ArrowType::INT;
+            type_table.set<int32_t>(0, 64).set<uint8_t>(1, 1);  // bitWidth, is_signed
+            break;
+        case ColumnType::DOUBLE:
+            type_id = ArrowType::FLOATING_POINT;
+            type_table.set<int16_t>(0, 2);  // precision = DOUBLE
+            break;
+        case ColumnType::STRING:
+            type_id = ArrowType::UTF8;
+            break;
+        case ColumnType::BOOL:
+            type_id = ArrowType::BOOL;
+            break;
+        }
+        FbObject field;
+        field.set(0, FbObject::string(name))
+            .set<uint8_t>(1, 1)  // nullable
+            .set<uint8_t>(2, static_cast<uint8_t>(type_id))
+            .set(3, std::move(type_table))
+            .set(5, FbObject::tables({}));  // children
+        fields.push_back(std::move(field));
+    }
+    FbObject table;
+    table.set<int16_t>(0, 0)  // Little-endian
+        .set(1, FbObject::tables(std::move(fields)));
+    return table;
+}
+
+// Helper: Message table around a header
+static std::string message_metadata(MessageType type, FbObject header, uint64_t body_length) {
+    FbObject message;
+    message.set<int16_t>(0, kMetadataV5)
+        .set<uint8_t>(1, static_cast<uint8_t>(type))
+        .set(2, std::move(header))
+        .set<int64_t>(3, static_cast<int64_t>(body_length));
+    return message.finish();
+}
+
+ArrowWriter::ArrowWriter(const std::string& filepath, Format format)
+    : filepath_(filepath), format_(format), file_(filepath, std::ios::binary) {
+    if (!file_) {
+        throw std::runtime_error("Cannot create file: " + filepath);
+    }
+    if (format_ == Format::FILE) {
+        file_.write(kArrowMagic, sizeof(kArrowMagic));
+        file_.write("\0\0", 2);
+        pos_ = 8;
+    }
+}
+
+ArrowWriter::~ArrowWriter() {
+    if (!closed_) {
+        try {
+            close();
+        } catch (...) {
+        }
+    }
+}
+
+ArrowWriter::Block ArrowWriter::write_message(const std::string& metadata,
+                                              const std::string& body) {
+    std::string prefix;
+    put<uint32_t>(prefix, kContinuation);
+    put<int32_t>(prefix, static_cast<int32_t>(metadata.size()));  // Padded to 8 bytes
+    file_.write(prefix.data(), static_cast<std::streamsize>(prefix.size()));
+    file_.write(metadata.data(), static_cast<std::streamsize>(metadata.size()));
+    file_.write(body.data(), static_cast<std::streamsize>(body.size()));
+
+    Block block{pos_, static_cast<uint32_t>(prefix.size() + metadata.size()), body.size()};
+    pos_ += block.metadata_length + body.size();
+    return block;
+}
+
+void ArrowWriter::write_schema() {
+    write_message(message_metadata(MessageType::SCHEMA, schema_table(schema_), 0), "");
+    schema_written_ = true;
+}
+
+void ArrowWriter::write(const Table& batch) {
+    if (!schema_written_) {
+        for (const auto& col : batch.columns)
+            schema_.emplace_back(col.name, col.type);
+        write_schema();
+    } else if (batch.columns.size() != schema_.size()) {
+        throw std::runtime_error("Cannot append tables with different schemas");
+    }
+    if (batch.num_rows == 0) {
+        return;
+    }
+
+    const size_t n = batch.num_rows;
+    std::string body;
+    std::string nodes;
+    std::string buffers;
+    auto add_buffer = [&](const void* data, size_t size) {
+        put<int64_t>(buffers, static_cast<int64_t>(body.size()));
+        put<int64_t>(buffers, static_cast<int64_t>(size));
+        body.append(static_cast<const char*>(data), size);
+        pad(body, kArrowAlignment);
+    };
+    for (size_t c = 0; c < schema_.size(); ++c) {
+        const Column& col = batch.columns[c];
+        if (col.type != schema_[c].second) {
+            throw std::runtime_error("Cannot append column " + col.name + ": type mismatch");
+        }
+        const size_t null_count = n - col.validity.count();
+        put<int64_t>(nodes, static_cast<int64_t>(n));
+        put<int64_t>(nodes, static_cast<int64_t>(null_count));
+        // Validity is omitted when every value is present
+        add_buffer(col.validity.words(), null_count > 0 ? (n + 7) / 8 : 0);
+
+        switch (col.type) {
+        case ColumnType::INT64:
+            add_buffer(col.values<int64_t>().data(), n * sizeof(int64_t));
+            break;
+        case ColumnType::DOUBLE:
+            add_buffer(col.values<double>().data(), n * sizeof(double));
+            break;
+        case ColumnType::BOOL:
+            add_buffer(std::get<Bitmap>(col.data).words(), (n + 7) / 8);
+            break;
+        case ColumnType::STRING: {
+            std::vector<int32_t> offsets{0};
+            std::string bytes;
+            for (size_t i = 0; i < n; ++i) {
+                if (!col.is_null(i))
+                    bytes += col.get_string(i);
+                if (bytes.size() > static_cast<size_t>(INT32_MAX)) {
+                    throw std::runtime_error("Column " + col.name +
+                                             " holds over 2 GiB of strings in one batch: " +
+                                             filepath_);
+                }
+                offsets.push_back(static_cast<int32_t>(bytes.size()));
+            }
+            add_buffer(offsets.data(), offsets.size() * sizeof(int32_t));
+            add_buffer(bytes.data(), bytes.size());
+            break;
+        }
+        }
+    }
+
+    FbObject record_batch;
+    record_batch.set<int64_t>(0, static_cast<int64_t>(n))
+        .set(1, FbObject::structs(nodes, schema_.size()))
+        .set(2, FbObject::structs(buffers, buffers.size() / 16));
+    std::string metadata =
+        message_metadata(MessageType::RECORD_BATCH, std::move(record_batch), body.size());
+    blocks_.push_back(write_message(metadata, body));
+
+    if (!file_) {
+        throw std::runtime_error("Failed to write file: " + filepath_);
+    }
+}
+
+void ArrowWriter::close() {
+    closed_ = true;
+    if (!schema_written_) {
+        write_schema();
+    }
+
+    std::string tail;
+    put<uint32_t>(tail, kContinuation);  // End of stream
+    put<uint32_t>(tail, 0);
+    if (format_ == Format::FILE) {
+        std::string blocks;
+        for (const auto& block : blocks_) {
+            put<int64_t>(blocks, static_cast<int64_t>(block.offset));
+            put<int32_t>(blocks, static_cast<int32_t>(block.metadata_length));
+            put<int32_t>(blocks, 0);  // Padding
+            put<int64_t>(blocks, static_cast<int64_t>(block.body_length));
+        }
+        FbObject footer;
+        footer.set<int16_t>(0, kMetadataV5)
+            .set(1, schema_table(schema_))
+            .set(2, FbObject::structs("", 0))
+            .set(3, FbObject::structs(blocks, blocks_.size()));
+        std::string footer_data = footer.finish();
+        tail += footer_data;
+        put<int32_t>(tail, static_cast<int32_t>(footer_data.size()));
+        tail.append(kArrowMagic, sizeof(kArrowMagic));
+    }
+    file_.write(tail.data(), static_cast<std::streamsize>(tail.size()));
+    file_.close();
+    if (file_.fail()) {
+        throw std::runtime_error("Failed to write file: " + filepath_);
+    }
+}
+
+}  // namespace joy
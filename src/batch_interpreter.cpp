@@ -0,0 +1,484 @@
+#include "batch_interpreter.hpp"
+
+#include <algorithm>
+#include <functional>
+
+#include "vm.hpp"  // For RuntimeError
+
+namespace joy {
+
+// ============================================================================
+// Setup
+// ============================================================================
+// The binder has already resolved columns and typed every opcode; all that
+// is left is to find the columns and size the slot stack
+
+// Helper: Net change in stack depth of an instruction
+static int stack_effect(IRExpr::OpCode op) {
+    switch (op) {
+    case IRExpr::OpCode::PUSH_INT:
+    case IRExpr::OpCode::PUSH_DOUBLE:
+    case IRExpr::OpCode::PUSH_STRING:
+    case IRExpr::OpCode::PUSH_BOOL:
+    case IRExpr::OpCode::LOAD_COLUMN:
+        return 1;
+    case IRExpr::OpCode::NEG:
+    case IRExpr::OpCode::NOT:
+    case IRExpr::OpCode::CAST_F64:
+    case IRExpr::OpCode::NEG_I64:
+    case IRExpr::OpCode::NEG_F64:
+    case IRExpr::OpCode::EQ_I64_CONST:
+    case IRExpr::OpCode::NEQ_I64_CONST:
+    case IRExpr::OpCode::LT_I64_CONST:
+    case IRExpr::OpCode::GT_I64_CONST:
+    case IRExpr::OpCode::LTE_I64_CONST:
+    case IRExpr::OpCode::GTE_I64_CONST:
+    case IRExpr::OpCode::EQ_F64_CONST:
+    case IRExpr::OpCode::NEQ_F64_CONST:
+    case IRExpr::OpCode::LT_F64_CONST:
+    case IRExpr::OpCode::GT_F64_CONST:
+    case IRExpr::OpCode::LTE_F64_CONST:
+    case IRExpr::OpCode::GTE_F64_CONST:
+    case IRExpr::OpCode::STARTS_WITH:
+    case IRExpr::OpCode::ENDS_WITH:
+    case IRExpr::OpCode::CONTAINS:
+    case IRExpr::OpCode::IEQUALS:
+        return 0;
+    case IRExpr::OpCode::TERNARY:
+        return -2;
+    default:
+        return -1;  // Binary operators
+    }
+}
+
+BatchInterpreter::BatchInterpreter(const IRExpr& expr, const Table& table)
+    : expr_(expr), columns_(expr.instructions.size(), nullptr) {
+    // Values whose type depends on the row need the row interpreter
+    supported_ = expr.statically_typed && expr.type.has_value();
+    if (!supported_) {
+        return;
+    }
+    result_type_ = *expr.type;
+
+    size_t depth = 0;
+    size_t max_depth = 0;
+    for (size_t pc = 0; pc < expr.instructions.size(); ++pc) {
+        const auto& instr = expr.instructions[pc];
+        if (instr.op == IRExpr::OpCode::LOAD_COLUMN) {
+            columns_[pc] = &table.columns[std::get<int>(instr.operand)];
+        }
+        depth += stack_effect(instr.op);
+        max_depth = std::max(max_depth, depth);
+    }
+    slots_.resize(max_depth);  // push() never reallocates, so slot references stay valid
+}
+
+// ============================================================================
+// Evaluation
+// ============================================================================
+// Binary operators combine the top two slots into the lower one in place;
+// slot buffers are reused across chunks
+
+VectorSlot& BatchInterpreter::push(ColumnType type, size_t n) {
+    VectorSlot& slot = slots_[depth_++];
+    slot.type = type;
+    slot.valid.assign(n, 1);
+    return slot;
+}
+
+void BatchInterpreter::load_column(VectorSlot& slot, const Column& col, size_t begin, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        slot.valid[i] = col.validity.get(begin + i);
+    }
+    switch (col.type) {
+    case ColumnType::INT64: {
+        const int64_t* data = col.values<int64_t>().data() + begin;
+        slot.ints.assign(data, data + n);
+        break;
+    }
+    case ColumnType::DOUBLE: {
+        const double* data = col.values<double>().data() + begin;
+        slot.doubles.assign(data, data + n);
+        break;
+    }
+    case ColumnType::STRING:
+        slot.strings.resize(n);
+        for (size_t i = 0; i < n; ++i) {
+            slot.strings[i] = slot.valid[i] ? col.get_string(begin + i) : std::string_view{};
+        }
+        break;
+    case ColumnType::BOOL: {
+        const auto& bits = std::get<Bitmap>(col.data);
+        slot.bools.resize(n);
+        for (size_t i = 0; i < n; ++i) {
+            slot.bools[i] = bits.get(begin + i);
+        }
+        break;
+    }
+    }
+}
+
+// Helper: Convert an INT64 slot to DOUBLE (numeric promotion)
+static void promote_to_double(VectorSlot& slot, size_t n) {
+    slot.doubles.resize(n);
+    for (size_t i = 0; i < n; ++i) {
+        slot.doubles[i] = static_cast<double>(slot.ints[i]);
+    }
+    slot.type = ColumnType::DOUBLE;
+}
+
+// Values of type T in a slot (ints, doubles, strings or bools)
+template <typename T>
+using SlotValues = std::vector<T> VectorSlot::*;
+
+// Helper: a = a op b for ADD/SUB/MUL (NULL op anything = NULL)
+template <typename T, typename Op>
+static void arith_slots(VectorSlot& a, const VectorSlot& b, SlotValues<T> values, size_t n,
+                        Op op) {
+    std::vector<T>& av = a.*values;
+    const std::vector<T>& bv = b.*values;
+    for (size_t i = 0; i < n; ++i) {
+        a.valid[i] &= b.valid[i];
+        av[i] = op(av[i], bv[i]);
+    }
+}
+
+// Helper: a = a / b; a zero divisor in a live, non-NULL row is an error,
+// matching the row interpreter
+template <typename T>
+static void div_slots(VectorSlot& a, const VectorSlot& b, SlotValues<T> values, size_t n,
+                      const uint8_t* active) {
+    std::vector<T>& av = a.*values;
+    const std::vector<T>& bv = b.*values;
+    for (size_t i = 0; i < n; ++i) {
+        a.valid[i] &= b.valid[i];
+        bool live = a.valid[i] && (!active || active[i]);
+        if (bv[i] == 0) {
+            if (live)
+                throw RuntimeError("Division by zero");
+            av[i] = 0;
+            continue;
+        }
+        av[i] = live ? divide(av[i], bv[i]) : T{0};
+    }
+}
+
+// Helper: Comparison into a BOOL slot; NULL on either side yields false
+// Comparison results are never NULL: validity folds into the value
+template <typename T, typename Cmp>
+static void compare_slots(VectorSlot& a, const VectorSlot& b, SlotValues<T> values, size_t n,
+                          Cmp cmp) {
+    const std::vector<T>& av = a.*values;
+    const std::vector<T>& bv = b.*values;
+    a.bools.resize(n);  // May alias av for BOOL operands; each row reads before it writes
+    for (size_t i = 0; i < n; ++i) {
+        a.bools[i] = a.valid[i] && b.valid[i] && cmp(av[i], bv[i]);
+    }
+    a.type = ColumnType::BOOL;
+    std::fill(a.valid.begin(), a.valid.begin() + static_cast<std::ptrdiff_t>(n), 1);
+}
+
+// Helper: Comparison against a literal (fused *_CONST opcodes)
+template <typename T, typename Cmp>
+static void compare_const(VectorSlot& a, SlotValues<T> values, T value, size_t n, Cmp cmp) {
+    const std::vector<T>& av = a.*values;
+    a.bools.resize(n);
+    for (size_t i = 0; i < n; ++i) {
+        a.bools[i] = a.valid[i] && cmp(av[i], value);
+    }
+    a.type = ColumnType::BOOL;
+    std::fill(a.valid.begin(), a.valid.begin() + static_cast<std::ptrdiff_t>(n), 1);
+}
+
+// Helper: Truthiness of a BOOL/INT64 slot (NULL is false)
+static void truthy(const VectorSlot& slot, size_t n, std::vector<uint8_t>& out) {
+    out.resize(n);
+    if (slot.type == ColumnType::BOOL) {
+        for (size_t i = 0; i < n; ++i)
+            out[i] = slot.valid[i] && slot.bools[i];
+    } else {
+        for (size_t i = 0; i < n; ++i)
+            out[i] = slot.valid[i] && slot.ints[i] != 0;
+    }
+}
+
+// Helper: t = cond ? t : f (values and validity)
+template <typename T>
+static void blend_loop(std::vector<T>& t, const std::vector<T>& f, const std::vector<uint8_t>& cond,
+                       size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        t[i] = cond[i] ? t[i] : f[i];
+    }
+}
+
+const VectorSlot& BatchInterpreter::evaluate(size_t begin, size_t n, const uint8_t* active) {
+    depth_ = 0;
+
+    for (size_t pc = 0; pc < expr_.instructions.size(); ++pc) {
+        const auto& instr = expr_.instructions[pc];
+        switch (instr.op) {
+        case IRExpr::OpCode::PUSH_INT:
+            push(ColumnType::INT64, n).ints.assign(n, std::get<int64_t>(instr.operand));
+            break;
+        case IRExpr::OpCode::PUSH_DOUBLE:
+            push(ColumnType::DOUBLE, n).doubles.assign(n, std::get<double>(instr.operand));
+            break;
+        case IRExpr::OpCode::PUSH_STRING:
+            push(ColumnType::STRING, n)
+                .strings.assign(n, std::string_view(std::get<std::string>(instr.operand)));
+            break;
+        case IRExpr::OpCode::PUSH_BOOL:
+            push(ColumnType::BOOL, n).bools.assign(n, std::get<bool>(instr.operand));
+            break;
+        case IRExpr::OpCode::LOAD_COLUMN: {
+            const Column& col = *columns_[pc];
+            load_column(push(col.type, n), col, begin, n);
+            break;
+        }
+
+        case IRExpr::OpCode::CAST_F64:
+            promote_to_double(top(0), n);
+            break;
+
+        case IRExpr::OpCode::ADD_I64:
+            arith_slots<int64_t>(top(1), top(0), &VectorSlot::ints, n,
+                             [](int64_t x, int64_t y) { return x + y; });
+            break;
+        case IRExpr::OpCode::ADD_F64:
+            arith_slots<double>(top(1), top(0), &VectorSlot::doubles, n,
+                             [](double x, double y) { return x + y; });
+            break;
+        case IRExpr::OpCode::SUB_I64:
+            arith_slots<int64_t>(top(1), top(0), &VectorSlot::ints, n,
+                             [](int64_t x, int64_t y) { return x - y; });
+            break;
+        case IRExpr::OpCode::SUB_F64:
+            arith_slots<double>(top(1), top(0), &VectorSlot::doubles, n,
+                             [](double x, double y) { return x - y; });
+            break;
+        case IRExpr::OpCode::MUL_I64:
+            arith_slots<int64_t>(top(1), top(0), &VectorSlot::ints, n,
+                             [](int64_t x, int64_t y) { return x * y; });
+            break;
+        case IRExpr::OpCode::MUL_F64:
+            arith_slots<double>(top(1), top(0), &VectorSlot::doubles, n,
+                             [](double x, double y) { return x * y; });
+            break;
+        case IRExpr::OpCode::DIV_I64:
+            div_slots<int64_t>(top(1), top(0), &VectorSlot::ints, n, active);
+            break;
+        case IRExpr::OpCode::DIV_F64:
+            div_slots<double>(top(1), top(0), &VectorSlot::doubles, n, active);
+            break;
+
+        case IRExpr::OpCode::NEG_I64:
+            for (size_t i = 0; i < n; ++i)
+                top(0).ints[i] = -top(0).ints[i];
+            break;
+        case IRExpr::OpCode::NEG_F64:
+            for (size_t i = 0; i < n; ++i)
+                top(0).doubles[i] = -top(0).doubles[i];
+            break;
+
+        case IRExpr::OpCode::EQ_I64:
+            compare_slots<int64_t>(top(1), top(0), &VectorSlot::ints, n, std::equal_to<>());
+            break;
+        case IRExpr::OpCode::NEQ_I64:
+            compare_slots<int64_t>(top(1), top(0), &VectorSlot::ints, n, std::not_equal_to<>());
+            break;
+        case IRExpr::OpCode::LT_I64:
+            compare_slots<int64_t>(top(1), top(0), &VectorSlot::ints, n, std::less<>());
+            break;
+        case IRExpr::OpCode::GT_I64:
+            compare_slots<int64_t>(top(1), top(0), &VectorSlot::ints, n, std::greater<>());
+            break;
+        case IRExpr::OpCode::LTE_I64:
+            compare_slots<int64_t>(top(1), top(0), &VectorSlot::ints, n, std::less_equal<>());
+            break;
+        case IRExpr::OpCode::GTE_I64:
+            compare_slots<int64_t>(top(1), top(0), &VectorSlot::ints, n, std::greater_equal<>());
+            break;
+        case IRExpr::OpCode::EQ_F64:
+            compare_slots<double>(top(1), top(0), &VectorSlot::doubles, n, std::equal_to<>());
+            break;
+        case IRExpr::OpCode::NEQ_F64:
+            compare_slots<double>(top(1), top(0), &VectorSlot::doubles, n, std::not_equal_to<>());
+            break;
+        case IRExpr::OpCode::LT_F64:
+            compare_slots<double>(top(1), top(0), &VectorSlot::doubles, n, std::less<>());
+            break;
+        case IRExpr::OpCode::GT_F64:
+            compare_slots<double>(top(1), top(0), &VectorSlot::doubles, n, std::greater<>());
+            break;
+        case IRExpr::OpCode::LTE_F64:
+            compare_slots<double>(top(1), top(0), &VectorSlot::doubles, n, std::less_equal<>());
+            break;
+        case IRExpr::OpCode::GTE_F64:
+            compare_slots<double>(top(1), top(0), &VectorSlot::doubles, n, std::greater_equal<>());
+            break;
+        case IRExpr::OpCode::EQ_STR:
+            compare_slots<std::string_view>(top(1), top(0), &VectorSlot::strings, n, std::equal_to<>());
+            break;
+        case IRExpr::OpCode::NEQ_STR:
+            compare_slots<std::string_view>(top(1), top(0), &VectorSlot::strings, n, std::not_equal_to<>());
+            break;
+        case IRExpr::OpCode::LT_STR:
+            compare_slots<std::string_view>(top(1), top(0), &VectorSlot::strings, n, std::less<>());
+            break;
+        case IRExpr::OpCode::GT_STR:
+            compare_slots<std::string_view>(top(1), top(0), &VectorSlot::strings, n, std::greater<>());
+            break;
+        case IRExpr::OpCode::LTE_STR:
+            compare_slots<std::string_view>(top(1), top(0), &VectorSlot::strings, n, std::less_equal<>());
+            break;
+        case IRExpr::OpCode::GTE_STR:
+            compare_slots<std::string_view>(top(1), top(0), &VectorSlot::strings, n, std::greater_equal<>());
+            break;
+        case IRExpr::OpCode::EQ_BOOL:
+            compare_slots<uint8_t>(top(1), top(0), &VectorSlot::bools, n, std::equal_to<>());
+            break;
+        case IRExpr::OpCode::NEQ_BOOL:
+            compare_slots<uint8_t>(top(1), top(0), &VectorSlot::bools, n, std::not_equal_to<>());
+            break;
+
+        case IRExpr::OpCode::EQ_I64_CONST:
+            compare_const<int64_t>(top(0), &VectorSlot::ints, std::get<int64_t>(instr.operand), n,
+                                std::equal_to<>());
+            break;
+        case IRExpr::OpCode::NEQ_I64_CONST:
+            compare_const<int64_t>(top(0), &VectorSlot::ints, std::get<int64_t>(instr.operand), n,
+                                std::not_equal_to<>());
+            break;
+        case IRExpr::OpCode::LT_I64_CONST:
+            compare_const<int64_t>(top(0), &VectorSlot::ints, std::get<int64_t>(instr.operand), n,
+                                std::less<>());
+            break;
+        case IRExpr::OpCode::GT_I64_CONST:
+            compare_const<int64_t>(top(0), &VectorSlot::ints, std::get<int64_t>(instr.operand), n,
+                                std::greater<>());
+            break;
+        case IRExpr::OpCode::LTE_I64_CONST:
+            compare_const<int64_t>(top(0), &VectorSlot::ints, std::get<int64_t>(instr.operand), n,
+                                std::less_equal<>());
+            break;
+        case IRExpr::OpCode::GTE_I64_CONST:
+            compare_const<int64_t>(top(0), &VectorSlot::ints, std::get<int64_t>(instr.operand), n,
+                                std::greater_equal<>());
+            break;
+        case IRExpr::OpCode::EQ_F64_CONST:
+            compare_const<double>(top(0), &VectorSlot::doubles, std::get<double>(instr.operand), n,
+                                std::equal_to<>());
+            break;
+        case IRExpr::OpCode::NEQ_F64_CONST:
+            compare_const<double>(top(0), &VectorSlot::doubles, std::get<double>(instr.operand), n,
+                                std::not_equal_to<>());
+            break;
+        case IRExpr::OpCode::LT_F64_CONST:
+            compare_const<double>(top(0), &VectorSlot::doubles, std::get<double>(instr.operand), n,
+                                std::less<>());
+            break;
+        case IRExpr::OpCode::GT_F64_CONST:
+            compare_const<double>(top(0), &VectorSlot::doubles, std::get<double>(instr.operand), n,
+                                std::greater<>());
+            break;
+        case IRExpr::OpCode::LTE_F64_CONST:
+            compare_const<double>(top(0), &VectorSlot::doubles, std::get<double>(instr.operand), n,
+                                std::less_equal<>());
+            break;
+        case IRExpr::OpCode::GTE_F64_CONST:
+            compare_const<double>(top(0), &VectorSlot::doubles, std::get<double>(instr.operand), n,
+                                std::greater_equal<>());
+            break;
+
+        case IRExpr::OpCode::NOT: {
+            // NOT NULL is false, like the row interpreter
+            VectorSlot& a = top(0);
+            std::vector<uint8_t> out(n);
+            if (a.type == ColumnType::BOOL) {
+                for (size_t i = 0; i < n; ++i)
+                    out[i] = a.valid[i] && !a.bools[i];
+            } else {
+                for (size_t i = 0; i < n; ++i)
+                    out[i] = a.valid[i] && a.ints[i] == 0;
+            }
+            a.bools.swap(out);
+            a.type = ColumnType::BOOL;
+            std::fill(a.valid.begin(), a.valid.begin() + static_cast<std::ptrdiff_t>(n), 1);
+            break;
+        }
+
+        case IRExpr::OpCode::STARTS_WITH:
+        case IRExpr::OpCode::ENDS_WITH:
+        case IRExpr::OpCode::CONTAINS:
+        case IRExpr::OpCode::IEQUALS: {
+            // NULL stays NULL (validity is unchanged)
+            VectorSlot& a = top(0);
+            const StringMatch match = *string_match_of(instr.op);
+            const std::string_view pattern = std::get<std::string>(instr.operand);
+            a.bools.resize(n);
+            for (size_t i = 0; i < n; ++i)
+                a.bools[i] = a.valid[i] && string_matches(match, a.strings[i], pattern);
+            a.type = ColumnType::BOOL;
+            break;
+        }
+
+        case IRExpr::OpCode::AND:
+        case IRExpr::OpCode::OR: {
+            // NULL operands count as false; the result is never NULL
+            VectorSlot& a = top(1);
+            std::vector<uint8_t> lhs, rhs;
+            truthy(a, n, lhs);
+            truthy(top(0), n, rhs);
+            a.bools.resize(n);
+            if (instr.op == IRExpr::OpCode::AND) {
+                for (size_t i = 0; i < n; ++i)
+                    a.bools[i] = lhs[i] & rhs[i];
+            } else {
+                for (size_t i = 0; i < n; ++i)
+                    a.bools[i] = lhs[i] | rhs[i];
+            }
+            a.type = ColumnType::BOOL;
+            std::fill(a.valid.begin(), a.valid.begin() + static_cast<std::ptrdiff_t>(n), 1);
+            break;
+        }
+
+        case IRExpr::OpCode::TERNARY: {
+            // Both branches were evaluated (as in the row interpreter); blend them
+            VectorSlot& f = slots_[--depth_];
+            VectorSlot& t = slots_[--depth_];
+            VectorSlot& cond = slots_[depth_ - 1];
+            std::vector<uint8_t> take_true;
+            truthy(cond, n, take_true);
+            blend_loop(t.valid, f.valid, take_true, n);
+            switch (t.type) {
+            case ColumnType::INT64:
+                blend_loop(t.ints, f.ints, take_true, n);
+                break;
+            case ColumnType::DOUBLE:
+                blend_loop(t.doubles, f.doubles, take_true, n);
+                break;
+            case ColumnType::STRING:
+                blend_loop(t.strings, f.strings, take_true, n);
+                break;
+            case ColumnType::BOOL:
+                blend_loop(t.bools, f.bools, take_true, n);
+                break;
+            }
+            std::swap(cond, t);  // Result replaces the condition slot
+            break;
+        }
+
+        default:
+            throw RuntimeError("Batch interpreter requires bound bytecode");
+        }
+
+        // Binary operators leave their result in the lower slot
+        if (instr.op != IRExpr::OpCode::TERNARY && stack_effect(instr.op) < 0) {
+            --depth_;
+        }
+    }
+
+    return slots_[0];
+}
+
+}  // namespace joy
@@ -0,0 +1,619 @@
+#include "binder.hpp"
+
+#include <variant>
+
+namespace joy {
+
+using OpCode = IRExpr::OpCode;
+
+// ============================================================================
+// Schema
+// ============================================================================
+
+int Schema::index_of(const std::string& name) const {
+    for (size_t i = 0; i < names.size(); ++i) {
+        if (names[i] == name) {
+            return static_cast<int>(i);
+        }
+    }
+    return -1;
+}
+
+// Helper: Type of a column the operator reads (it must exist)
+static std::optional<ColumnType> column_type(const Schema& schema, const std::string& name) {
+    int idx = schema.index_of(name);
+    if (idx < 0) {
+        throw CompileError("Column not found: " + name);
+    }
+    return schema.types[idx];
+}
+
+// Helper: Replace or add a column, like the VM's transform operators do
+static void set_column(Schema& schema, const std::string& name, std::optional<ColumnType> type) {
+    int idx = schema.index_of(name);
+    if (idx >= 0) {
+        schema.types[idx] = type;
+    } else {
+        schema.names.push_back(name);
+        schema.types.push_back(type);
+    }
+}
+
+static bool is_numeric(std::optional<ColumnType> t) {
+    return t == ColumnType::INT64 || t == ColumnType::DOUBLE;
+}
+
+// ============================================================================
+// Opcode Tables (generic opcode → typed variants)
+// ============================================================================
+
+struct ArithOpcodes {
+    OpCode generic, i64, f64;
+    const char* error;  // Same message the row interpreter raises
+};
+
+// Same order as VectorArithOp
+static const ArithOpcodes kArithOpcodes[] = {
+    {OpCode::ADD, OpCode::ADD_I64, OpCode::ADD_F64, "Cannot add non-numeric types"},
+    {OpCode::SUB, OpCode::SUB_I64, OpCode::SUB_F64, "Cannot subtract non-numeric types"},
+    {OpCode::MUL, OpCode::MUL_I64, OpCode::MUL_F64, "Cannot multiply non-numeric types"},
+    {OpCode::DIV, OpCode::DIV_I64, OpCode::DIV_F64, "Cannot divide non-numeric types"},
+};
+
+struct CompareOpcodes {
+    OpCode generic, i64, f64, str, i64_const, f64_const;
+    bool equality;  // Also defined for BOOL operands (EQ_BOOL / NEQ_BOOL)
+    OpCode boolean;
+};
+
+static const CompareOpcodes kCompareOpcodes[] = {
+    {OpCode::EQ, OpCode::EQ_I64, OpCode::EQ_F64, OpCode::EQ_STR, OpCode::EQ_I64_CONST,
+     OpCode::EQ_F64_CONST, true, OpCode::EQ_BOOL},
+    {OpCode::NEQ, OpCode::NEQ_I64, OpCode::NEQ_F64, OpCode::NEQ_STR, OpCode::NEQ_I64_CONST,
+     OpCode::NEQ_F64_CONST, true, OpCode::NEQ_BOOL},
+    {OpCode::LT, OpCode::LT_I64, OpCode::LT_F64, OpCode::LT_STR, OpCode::LT_I64_CONST,
+     OpCode::LT_F64_CONST, false, OpCode::LT},
+    {OpCode::GT, OpCode::GT_I64, OpCode::GT_F64, OpCode::GT_STR, OpCode::GT_I64_CONST,
+     OpCode::GT_F64_CONST, false, OpCode::GT},
+    {OpCode::LTE, OpCode::LTE_I64, OpCode::LTE_F64, OpCode::LTE_STR, OpCode::LTE_I64_CONST,
+     OpCode::LTE_F64_CONST, false, OpCode::LTE},
+    {OpCode::GTE, OpCode::GTE_I64, OpCode::GTE_F64, OpCode::GTE_STR, OpCode::GTE_I64_CONST,
+     OpCode::GTE_F64_CONST, false, OpCode::GTE},
+};
+
+static const ArithOpcodes& arith_opcodes(OpCode op) {
+    for (const auto& entry : kArithOpcodes) {
+        if (entry.generic == op)
+            return entry;
+    }
+    throw CompileError("Unknown arithmetic opcode");
+}
+
+static const CompareOpcodes& compare_opcodes(OpCode op) {
+    for (const auto& entry : kCompareOpcodes) {
+        if (entry.generic == op)
+            return entry;
+    }
+    throw CompileError("Unknown comparison opcode");
+}
+
+// ============================================================================
+// Expression Binding
+// ============================================================================
+// Abstract interpretation over the operand stack. Each entry records its
+// static type and where its bytecode starts in the output, so a CAST_F64 can
+// be inserted right after the left operand when it needs promotion
+
+namespace {
+
+struct Operand {
+    std::optional<ColumnType> type;
+    size_t start;  // Index of the operand's first instruction in the output
+    // The type a value without a static type is stored as when non-NULL
+    // (from the ternary branches that have one; see TransformOp::result_type)
+    std::optional<ColumnType> stored;
+};
+
+class ExprBinder {
+public:
+    ExprBinder(const Schema& schema) : schema_(schema) {}
+
+    IRExpr bind(const IRExpr& expr);
+
+    // Column type a transform of the bound expression produces
+    ColumnType stored_type() const {
+        return stored_.value_or(ColumnType::STRING);
+    }
+
+private:
+    void push(std::optional<ColumnType> type, size_t start) {
+        statically_typed_ &= type.has_value();
+        stack_.push_back({type, start, type});
+    }
+    Operand pop();
+
+    // Single literal instruction of an operand (for constant fusion), or nullptr
+    const IRExpr::Instruction* literal(const Operand& x, size_t end) const;
+
+    // Convert an INT64 operand ending at end to DOUBLE: literals are rewritten
+    // in place, anything else gets a CAST_F64
+    void promote(Operand& x, size_t end);
+
+    void bind_arith(OpCode op);
+    void bind_compare(OpCode op);
+
+    const Schema& schema_;
+    std::vector<IRExpr::Instruction> code_;
+    std::vector<Operand> stack_;
+    bool statically_typed_ = true;
+    std::optional<ColumnType> stored_;
+};
+
+Operand ExprBinder::pop() {
+    if (stack_.empty()) {
+        throw CompileError("Invalid expression: stack underflow");
+    }
+    Operand x = stack_.back();
+    stack_.pop_back();
+    return x;
+}
+
+const IRExpr::Instruction* ExprBinder::literal(const Operand& x, size_t end) const {
+    if (end - x.start != 1)
+        return nullptr;
+    const auto& instr = code_[x.start];
+    bool numeric = instr.op == OpCode::PUSH_INT || instr.op == OpCode::PUSH_DOUBLE;
+    return numeric ? &instr : nullptr;
+}
+
+void ExprBinder::promote(Operand& x, size_t end) {
+    if (x.type != ColumnType::INT64)
+        return;
+    if (end - x.start == 1 && code_[x.start].op == OpCode::PUSH_INT) {
+        auto& instr = code_[x.start];
+        instr.op = OpCode::PUSH_DOUBLE;
+        instr.operand = static_cast<double>(std::get<int64_t>(instr.operand));
+    } else {
+        code_.insert(code_.begin() + static_cast<std::ptrdiff_t>(end), {OpCode::CAST_F64, 0});
+    }
+    x.type = ColumnType::DOUBLE;
+    x.stored = ColumnType::DOUBLE;
+}
+
+void ExprBinder::bind_arith(OpCode op) {
+    const ArithOpcodes& ops = arith_opcodes(op);
+    Operand b = pop();
+    Operand a = pop();
+
+    if (!a.type || !b.type) {
+        code_.push_back({op, 0});  // Checked per row
+        push(std::nullopt, a.start);
+        return;
+    }
+    if (!is_numeric(a.type) || !is_numeric(b.type)) {
+        throw CompileError(ops.error);
+    }
+    if (a.type == ColumnType::INT64 && b.type == ColumnType::INT64) {
+        code_.push_back({ops.i64, 0});
+        push(ColumnType::INT64, a.start);
+        return;
+    }
+    // Promote b first: inserting after a shifts b's code
+    promote(b, code_.size());
+    promote(a, b.start);
+    code_.push_back({ops.f64, 0});
+    push(ColumnType::DOUBLE, a.start);
+}
+
+void ExprBinder::bind_compare(OpCode op) {
+    const CompareOpcodes& ops = compare_opcodes(op);
+    Operand b = pop();
+    Operand a = pop();
+
+    if (!a.type || !b.type) {
+        code_.push_back({op, 0});  // Checked per row
+    } else if (is_numeric(a.type) && is_numeric(b.type)) {
+        bool f64 = a.type == ColumnType::DOUBLE || b.type == ColumnType::DOUBLE;
+        if (const auto* lit = literal(b, code_.size())) {
+            // column < 5 → LT_I64_CONST 5: the literal becomes the operand
+            auto operand = lit->operand;
+            code_.pop_back();
+            if (f64) {
+                if (std::holds_alternative<int64_t>(operand))
+                    operand = static_cast<double>(std::get<int64_t>(operand));
+                promote(a, code_.size());
+                code_.push_back({ops.f64_const, operand});
+            } else {
+                code_.push_back({ops.i64_const, operand});
+            }
+        } else if (f64) {
+            promote(b, code_.size());
+            promote(a, b.start);
+            code_.push_back({ops.f64, 0});
+        } else {
+            code_.push_back({ops.i64, 0});
+        }
+    } else if (a.type == ColumnType::STRING && b.type == ColumnType::STRING) {
+        code_.push_back({ops.str, 0});
+    } else if (ops.equality && a.type == ColumnType::BOOL && b.type == ColumnType::BOOL) {
+        code_.push_back({ops.boolean, 0});
+    } else {
+        throw CompileError("Cannot compare incompatible types");
+    }
+    push(ColumnType::BOOL, a.start);
+}
+
+IRExpr ExprBinder::bind(const IRExpr& expr) {
+    for (const auto& instr : expr.instructions) {
+        size_t start = code_.size();
+        switch (instr.op) {
+        case OpCode::PUSH_INT:
+            code_.push_back(instr);
+            push(ColumnType::INT64, start);
+            break;
+        case OpCode::PUSH_DOUBLE:
+            code_.push_back(instr);
+            push(ColumnType::DOUBLE, start);
+            break;
+        case OpCode::PUSH_STRING:
+            code_.push_back(instr);
+            push(ColumnType::STRING, start);
+            break;
+        case OpCode::PUSH_BOOL:
+            code_.push_back(instr);
+            push(ColumnType::BOOL, start);
+            break;
+
+        case OpCode::LOAD_COLUMN: {
+            const std::string& name = std::get<std::string>(instr.operand);
+            int idx = schema_.index_of(name);
+            if (idx < 0) {
+                throw CompileError("Column not found: " + name);
+            }
+            code_.push_back({OpCode::LOAD_COLUMN, idx});
+            push(schema_.types[idx], start);
+            break;
+        }
+
+        case OpCode::ADD:
+        case OpCode::SUB:
+        case OpCode::MUL:
+        case OpCode::DIV:
+            bind_arith(instr.op);
+            break;
+
+        case OpCode::NEG: {
+            Operand a = pop();
+            if (!a.type) {
+                code_.push_back(instr);
+            } else if (a.type == ColumnType::INT64) {
+                code_.push_back({OpCode::NEG_I64, 0});
+            } else if (a.type == ColumnType::DOUBLE) {
+                code_.push_back({OpCode::NEG_F64, 0});
+            } else {
+                throw CompileError("Cannot negate non-numeric value");
+            }
+            push(a.type, a.start);
+            break;
+        }
+
+        case OpCode::EQ:
+        case OpCode::NEQ:
+        case OpCode::LT:
+        case OpCode::GT:
+        case OpCode::LTE:
+        case OpCode::GTE:
+            bind_compare(instr.op);
+            break;
+
+        case OpCode::NOT: {
+            // Stays generic: BOOL and INT64 operands are both valid
+            Operand a = pop();
+            if (a.type && a.type != ColumnType::BOOL && a.type != ColumnType::INT64) {
+                throw CompileError("Cannot apply NOT to non-boolean value");
+            }
+            code_.push_back(instr);
+            push(ColumnType::BOOL, a.start);
+            break;
+        }
+
+        case OpCode::STARTS_WITH:
+        case OpCode::ENDS_WITH:
+        case OpCode::CONTAINS:
+        case OpCode::IEQUALS: {
+            Operand a = pop();
+            if (a.type && a.type != ColumnType::STRING) {
+                throw CompileError(std::string(string_match_name(*string_match_of(instr.op))) +
+                                   " requires a string value");
+            }
+            code_.push_back(instr);
+            push(ColumnType::BOOL, a.start);
+            break;
+        }
+
+        case OpCode::AND:
+        case OpCode::OR: {
+            // Stays generic, like NOT; the result is always BOOL
+            Operand b = pop();
+            Operand a = pop();
+            for (const Operand* x : {&a, &b}) {
+                if (x->type && x->type != ColumnType::BOOL && x->type != ColumnType::INT64) {
+                    throw CompileError(instr.op == OpCode::AND
+                                           ? "Cannot apply AND to non-boolean value"
+                                           : "Cannot apply OR to non-boolean value");
+                }
+            }
+            code_.push_back(instr);
+            push(ColumnType::BOOL, a.start);
+            break;
+        }
+
+        case OpCode::TERNARY: {
+            Operand false_val = pop();
+            Operand true_val = pop();
+            Operand cond = pop();
+            if (cond.type && cond.type != ColumnType::BOOL && cond.type != ColumnType::INT64) {
+                throw CompileError("Ternary condition must be boolean or numeric");
+            }
+            if (is_numeric(true_val.type) && is_numeric(false_val.type)) {
+                // INT64 and DOUBLE branches give DOUBLE, as in the vectorized
+                // select (promote the false branch first: see bind_arith)
+                if (true_val.type != false_val.type) {
+                    promote(false_val, code_.size());
+                    promote(true_val, false_val.start);
+                }
+            }
+            code_.push_back(instr);
+            // Branches of other different types (cond ? 1 : "x") give a per-row type
+            bool same = true_val.type && true_val.type == false_val.type;
+            push(same ? true_val.type : std::nullopt, cond.start);
+            if (!true_val.stored || !false_val.stored) {
+                stack_.back().stored = true_val.stored ? true_val.stored : false_val.stored;
+            } else if (true_val.stored != false_val.stored) {
+                stack_.back().stored =
+                    select_result_type(*true_val.stored, *false_val.stored);
+            }
+            break;
+        }
+
+        default:
+            throw CompileError("Expression is already bound");
+        }
+    }
+
+    if (stack_.size() != 1) {
+        throw CompileError("Invalid expression: expected a single result");
+    }
+
+    IRExpr result;
+    result.instructions = std::move(code_);
+    result.type = stack_.back().type;
+    result.statically_typed = statically_typed_;
+    stored_ = stack_.back().stored;
+    return result;
+}
+
+}  // namespace
+
+IRExpr Binder::bind_expr(const IRExpr& expr, const Schema& schema) {
+    return ExprBinder(schema).bind(expr);
+}
+
+// ============================================================================
+// Plan Binding
+// ============================================================================
+// Operators run in order on every batch, so the schema after operator i is
+// the same for all batches and can be tracked statically
+
+ExecutionPlan Binder::bind(const ExecutionPlan& plan, Schema input,
+                           std::vector<Schema> join_inputs) {
+    join_inputs_ = std::move(join_inputs);
+    next_join_ = 0;
+    ExecutionPlan bound = plan;
+    for (auto& op : bound.operators) {
+        bind_op(op, input);
+    }
+    return bound;
+}
+
+// Helper: A vectorized comparison's column must exist and match the literal
+// (or the other column, as in the scalar VM: numbers of either type, strings,
+// or booleans for == and !=)
+static void check_compare(const PhysicalOp::VectorizedFilterOp& op, const Schema& schema) {
+    auto type = column_type(schema, op.column_name);
+    if (op.is_right_column) {
+        auto right = column_type(schema, op.right_column_name);
+        if (!type || !right)
+            return;  // Checked per batch
+        bool equality = op.op == VectorOp::EQ || op.op == VectorOp::NEQ;
+        bool compatible = (is_numeric(type) && is_numeric(right)) ||
+                          (type == ColumnType::STRING && right == ColumnType::STRING) ||
+                          (equality && type == ColumnType::BOOL && right == ColumnType::BOOL);
+        if (!compatible)
+            throw CompileError("Cannot compare incompatible types");
+        return;
+    }
+    if (auto match = string_match_of(op.op)) {
+        if (type && type != ColumnType::STRING) {
+            throw CompileError(std::string(string_match_name(*match)) +
+                               " requires a string value");
+        }
+        return;
+    }
+    bool string_value = std::holds_alternative<std::string>(op.value);
+    if (type == ColumnType::STRING && !string_value) {
+        throw CompileError("Type mismatch: column is STRING but value is not");
+    } else if (is_numeric(type) && string_value) {
+        throw CompileError("Type mismatch: " +
+                           std::string(type == ColumnType::INT64 ? "INT64" : "DOUBLE") +
+                           " column requires numeric value");
+    } else if (type == ColumnType::BOOL) {
+        throw CompileError("Unsupported column type for vectorized filter");
+    }
+}
+
+void Binder::bind_predicate(IRExpr& predicate, const Schema& schema) {
+    predicate = bind_expr(predicate, schema);
+    auto type = predicate.type;
+    if (type && type != ColumnType::BOOL && type != ColumnType::INT64) {
+        throw CompileError("Filter predicate must return boolean");
+    }
+}
+
+void Binder::bind_filter_node(PhysicalOp::FilterNode& node, const Schema& schema) {
+    switch (node.kind) {
+    case PhysicalOp::FilterNode::Kind::COMPARE:
+        check_compare(node.compare, schema);
+        break;
+    case PhysicalOp::FilterNode::Kind::PREDICATE:
+        bind_predicate(node.predicate, schema);
+        break;
+    case PhysicalOp::FilterNode::Kind::AND:
+    case PhysicalOp::FilterNode::Kind::OR:
+        for (auto& child : node.children)
+            bind_filter_node(child, schema);
+        break;
+    }
+}
+
+// Output schema of an aggregate: the keys, then one column per aggregate
+//   count       → INT64
+//   sum         → INT64 or DOUBLE, like the input
+//   min / max   → the input type (numbers and strings)
+//   avg         → DOUBLE
+static Schema aggregate_schema(const PhysicalOp::AggregateOp& op, const Schema& schema) {
+    Schema out;
+    for (const auto& key : op.keys) {
+        out.names.push_back(key);
+        out.types.push_back(column_type(schema, key));
+    }
+    for (const auto& agg : op.aggregates) {
+        std::optional<ColumnType> input;
+        if (!agg.column.empty())
+            input = column_type(schema, agg.column);
+
+        std::optional<ColumnType> type;
+        switch (agg.op) {
+        case AggOp::COUNT:
+            type = ColumnType::INT64;
+            break;
+        case AggOp::SUM:
+        case AggOp::AVG:
+            if (input && !is_numeric(input)) {
+                throw CompileError(std::string(agg.op == AggOp::SUM ? "sum" : "avg") +
+                                   " requires a numeric column: " + agg.column);
+            }
+            type = agg.op == AggOp::AVG ? std::optional<ColumnType>(ColumnType::DOUBLE) : input;
+            break;
+        case AggOp::MIN:
+        case AggOp::MAX:
+            if (input == ColumnType::BOOL) {
+                throw CompileError(std::string(agg.op == AggOp::MIN ? "min" : "max") +
+                                   " requires a numeric or string column: " + agg.column);
+            }
+            type = input;
+            break;
+        }
+        out.names.push_back(agg.output_name);
+        out.types.push_back(type);
+    }
+    return out;
+}
+
+void Binder::bind_join(const PhysicalOp::JoinOp& op, Schema& schema) {
+    if (next_join_ >= join_inputs_.size()) {
+        throw CompileError("Join input not loaded: " + op.filepath);
+    }
+    const Schema& build = join_inputs_[next_join_++];
+
+    for (const auto& key : op.keys) {
+        auto probe_type = column_type(schema, key);
+        int idx = build.index_of(key);
+        if (idx < 0) {
+            throw CompileError("Column not found in " + op.filepath + ": " + key);
+        }
+        auto build_type = build.types[idx];
+        if (probe_type && build_type && probe_type != build_type) {
+            throw CompileError("Join key types differ: " + key);
+        }
+    }
+    for (size_t i = 0; i < build.names.size(); ++i) {
+        if (schema.index_of(build.names[i]) < 0) {
+            schema.names.push_back(build.names[i]);
+            schema.types.push_back(build.types[i]);
+        }
+    }
+}
+
+void Binder::bind_op(PhysicalOp& op, Schema& schema) {
+    std::visit(
+        [&](auto& op_data) {
+            using T = std::decay_t<decltype(op_data)>;
+
+            if constexpr (std::is_same_v<T, PhysicalOp::FilterOp>) {
+                bind_predicate(op_data.predicate, schema);
+            } else if constexpr (std::is_same_v<T, PhysicalOp::VectorizedFilterOp>) {
+                check_compare(op_data, schema);
+            } else if constexpr (std::is_same_v<T, PhysicalOp::LogicalFilterOp>) {
+                bind_filter_node(op_data.root, schema);
+            } else if constexpr (std::is_same_v<T, PhysicalOp::ProjectOp>) {
+                Schema projected;
+                for (const auto& name : op_data.columns) {
+                    projected.names.push_back(name);
+                    projected.types.push_back(column_type(schema, name));
+                }
+                schema = std::move(projected);
+            } else if constexpr (std::is_same_v<T, PhysicalOp::TransformOp>) {
+                ExprBinder binder(schema);
+                op_data.expression = binder.bind(op_data.expression);
+                op_data.result_type = binder.stored_type();
+                set_column(schema, op_data.column_name, op_data.expression.type);
+            } else if constexpr (std::is_same_v<T, PhysicalOp::VectorizedTransformOp>) {
+                // Any DOUBLE column operand promotes the result (see the VM)
+                std::optional<ColumnType> type = op_data.result_type;
+                bool known = true;
+                auto operand = [&](bool is_column, const std::string& name) {
+                    if (!is_column)
+                        return;
+                    auto col_type = column_type(schema, name);
+                    if (col_type && !is_numeric(col_type)) {
+                        throw CompileError(kArithOpcodes[static_cast<int>(op_data.op)].error);
+                    }
+                    known &= col_type.has_value();
+                    if (col_type == ColumnType::DOUBLE)
+                        type = ColumnType::DOUBLE;
+                };
+                operand(op_data.is_left_column, op_data.left_column_name);
+                operand(op_data.is_right_column, op_data.right_column_name);
+                set_column(schema, op_data.column_name, known ? type : std::nullopt);
+            } else if constexpr (std::is_same_v<T, PhysicalOp::VectorizedTernaryTransformOp>) {
+                // The compiler typed the result from the literal branches;
+                // column branches can widen it (see the VM)
+                check_compare(op_data.condition, schema);
+                bool known = true;
+                auto branch = [&](bool is_column, const std::string& name) {
+                    if (!is_column)
+                        return;
+                    auto col_type = column_type(schema, name);
+                    known &= col_type.has_value();
+                    if (col_type)
+                        op_data.result_type = select_result_type(op_data.result_type, *col_type);
+                };
+                branch(op_data.is_true_column, op_data.true_column_name);
+                branch(op_data.is_false_column, op_data.false_column_name);
+                set_column(schema, op_data.column_name,
+                           known ? std::optional<ColumnType>(op_data.result_type) : std::nullopt);
+            } else if constexpr (std::is_same_v<T, PhysicalOp::AggregateOp>) {
+                schema = aggregate_schema(op_data, schema);
+            } else if constexpr (std::is_same_v<T, PhysicalOp::JoinOp>) {
+                bind_join(op_data, schema);
+            } else if constexpr (std::is_same_v<T, PhysicalOp::SortOp>) {
+                for (const auto& key : op_data.keys)
+                    column_type(schema, key.column);
+            }
+            // SCAN, LIMIT and WRITE leave the schema unchanged
+        },
+        op.data);
+}
+
+}  // namespace joy
@@ -0,0 +1,91 @@
+#include "checkpoint.hpp"
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+
+namespace joy {
+
+constexpr const char* kCheckpointMagic = "joy-checkpoint 1";
+
+// Helper: Parse a type name written by column_type_name
+static ColumnType parse_type(const std::string& name, const std::string& path) {
+    for (ColumnType type :
+         {ColumnType::INT64, ColumnType::DOUBLE, ColumnType::STRING, ColumnType::BOOL}) {
+        if (name == column_type_name(type))
+            return type;
+    }
+    throw std::runtime_error("Unknown column type '" + name + "' in checkpoint " + path);
+}
+
+std::optional<ScanCheckpoint> load_checkpoint(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        return std::nullopt;
+    }
+    std::string line;
+    if (!std::getline(file, line) || line != kCheckpointMagic) {
+        throw std::runtime_error("Not a joy checkpoint: " + path);
+    }
+
+    ScanCheckpoint checkpoint;
+    while (std::getline(file, line)) {
+        size_t space = line.find(' ');
+        std::string key = line.substr(0, space);
+        std::string rest = space == std::string::npos ? "" : line.substr(space + 1);
+        // "column" and "output" entries hold a second field before the rest
+        size_t split = rest.find(' ');
+        std::string first = rest.substr(0, split);
+        std::string second = split == std::string::npos ? "" : rest.substr(split + 1);
+        try {
+            if (key == "file") {
+                checkpoint.filepath = rest;
+            } else if (key == "offset") {
+                checkpoint.offset = std::stoull(rest);
+            } else if (key == "header") {
+                checkpoint.header = rest;
+            } else if (key == "column") {
+                checkpoint.schema.push_back({second, parse_type(first, path)});
+            } else if (key == "output") {
+                checkpoint.outputs.emplace_back(second, std::stoull(first));
+            } else if (!key.empty()) {
+                throw std::runtime_error("Unknown entry '" + key + "' in checkpoint " + path);
+            }
+        } catch (const std::logic_error&) {
+            throw std::runtime_error("Corrupt checkpoint " + path + ": " + line);
+        }
+    }
+    return checkpoint;
+}
+
+void save_checkpoint(const std::string& path, const ScanCheckpoint& checkpoint) {
+    std::string temp = path + ".tmp";
+    {
+        std::ofstream file(temp, std::ios::binary | std::ios::trunc);
+        if (!file) {
+            throw std::runtime_error("Cannot create file: " + temp);
+        }
+        file << kCheckpointMagic << "\n";
+        file << "file " << checkpoint.filepath << "\n";
+        file << "offset " << checkpoint.offset << "\n";
+        file << "header " << checkpoint.header << "\n";
+        for (const auto& decl : checkpoint.schema) {
+            file << "column " << column_type_name(decl.type) << " " << decl.name << "\n";
+        }
+        for (const auto& [output, bytes] : checkpoint.outputs) {
+            file << "output " << bytes << " " << output << "\n";
+        }
+        file.close();
+        if (file.fail()) {
+            throw std::runtime_error("Failed to write file: " + temp);
+        }
+    }
+    std::error_code ec;
+    std::filesystem::rename(temp, path, ec);
+    if (ec) {
+        throw std::runtime_error("Cannot replace checkpoint " + path + ": " + ec.message());
+    }
+}
+
+}  // namespace joy
@@ -32,6 +32,21 @@ ExecutionPlan Compiler::compile(const Program& program) {
     return plan;
 }
 
+// Helper: Map a declared AST type to its column type
+static ColumnType to_column_type(ValueType type) {
+    switch (type) {
+    case ValueType::Int:
+        return ColumnType::INT64;
+    case ValueType::Double:
+        return ColumnType::DOUBLE;
+    case ValueType::String:
+        return ColumnType::STRING;
+    case ValueType::Bool:
+        return ColumnType::BOOL;
+    }
+    return ColumnType::STRING;
+}
+
 // Compile a single statement into a physical operator
 // Uses std::visit to pattern-match on the variant type
 // This is C++17's type-safe alternative to virtual dispatch
@@ -42,16 +57,25 @@ PhysicalOp Compiler::compile_stmt(const Stmt& stmt) {
         [&](const auto& node) {
             using T = std::decay_t<decltype(node)>;  // Get actual type without references
 
-            // FROM "file.csv" → SCAN operator (load data from file)
+            // FROM "file.csv" → SCAN operator (load data from file(s))
             if constexpr (std::is_same_v<T, FromStmt>) {
                 op.type = OpType::SCAN;
-                op.data = PhysicalOp::ScanOp{node.filepath};
+                PhysicalOp::ScanOp scan{node.filepaths, {}, std::nullopt};
+                for (const auto& decl : node.schema) {
+                    scan.schema.push_back({decl.name, to_column_type(decl.type)});
+                }
+                op.data = std::move(scan);
             }
             // FILTER expr → Try vectorized path first, fall back to scalar
             else if constexpr (std::is_same_v<T, FilterStmt>) {
                 // Try to detect simple vectorizable pattern: column op scalar
                 auto vec_pattern = try_vectorize_filter(*node.condition);
-                if (vec_pattern.has_value()) {
+                auto logical = try_logical_filter(*node.condition);
+                if (logical.has_value()) {
+                    // and/or: combine the operands' selections
+                    op.type = OpType::LOGICAL_FILTER;
+                    op.data = std::move(*logical);
+                } else if (vec_pattern.has_value()) {
                     // Use fast vectorized path
                     op.type = OpType::VECTORIZED_FILTER;
                     op.data = vec_pattern.value();
@@ -93,12 +117,75 @@ PhysicalOp Compiler::compile_stmt(const Stmt& stmt) {
                 op.type = OpType::WRITE;
                 op.data = PhysicalOp::WriteOp{node.filepath};
             }
+            // GROUP BY keys AGGREGATE ... → AGGREGATE operator (pipeline breaker)
+            else if constexpr (std::is_same_v<T, GroupByStmt>) {
+                op.type = OpType::AGGREGATE;
+                op.data = compile_aggregate(node);
+            }
+            // JOIN "file.csv" ON keys → JOIN operator (hash join with a second input)
+            else if constexpr (std::is_same_v<T, JoinStmt>) {
+                op.type = OpType::JOIN;
+                op.data = PhysicalOp::JoinOp{node.filepath, node.keys, std::nullopt};
+            }
+            // SORT BY keys → SORT operator (pipeline breaker)
+            else if constexpr (std::is_same_v<T, SortStmt>) {
+                op.type = OpType::SORT;
+                PhysicalOp::SortOp sort;
+                for (const auto& key : node.keys)
+                    sort.keys.push_back({key.column, key.descending});
+                op.data = std::move(sort);
+            }
+            // LIMIT N → LIMIT operator
+            else if constexpr (std::is_same_v<T, LimitStmt>) {
+                op.type = OpType::LIMIT;
+                op.data = PhysicalOp::LimitOp{static_cast<size_t>(node.count)};
+            }
         },
         stmt.node);
 
     return op;
 }
 
+// Helper: Map an AST aggregate function to its IR operator
+static AggOp to_agg_op(AggregateFunc func) {
+    switch (func) {
+    case AggregateFunc::Sum:
+        return AggOp::SUM;
+    case AggregateFunc::Count:
+        return AggOp::COUNT;
+    case AggregateFunc::Min:
+        return AggOp::MIN;
+    case AggregateFunc::Max:
+        return AggOp::MAX;
+    case AggregateFunc::Avg:
+        return AggOp::AVG;
+    }
+    return AggOp::COUNT;
+}
+
+// Compile a group statement
+// Every output column needs a distinct name (keys first, then aggregates)
+// Example: group by dept aggregate total = sum(salary), count()
+//   → AggregateOp{keys: [dept], aggregates: [SUM salary → total, COUNT → count]}
+PhysicalOp::AggregateOp Compiler::compile_aggregate(const GroupByStmt& node) {
+    PhysicalOp::AggregateOp op;
+    op.keys = node.keys;
+
+    std::vector<std::string> outputs = node.keys;
+    for (const auto& call : node.aggregates) {
+        op.aggregates.push_back({to_agg_op(call.func), call.column, call.output_name});
+        outputs.push_back(call.output_name);
+    }
+    for (size_t i = 0; i < outputs.size(); ++i) {
+        for (size_t j = 0; j < i; ++j) {
+            if (outputs[i] == outputs[j]) {
+                throw CompileError("Duplicate column in group statement: " + outputs[i]);
+            }
+        }
+    }
+    return op;
+}
+
 // ============================================================================
 // Expression Compilation (AST → Bytecode)
 // ============================================================================
@@ -133,6 +220,8 @@ IRExpr Compiler::compile_expr(const Expr& expr) {
                 compile_unary(node, result);
             } else if constexpr (std::is_same_v<T, TernaryExpr>) {
                 compile_ternary(node, result);
+            } else if constexpr (std::is_same_v<T, StringMatchExpr>) {
+                compile_string_match(node, result);
             }
         },
         expr.node);
@@ -225,6 +314,12 @@ void Compiler::compile_binary(const BinaryExpr& node, IRExpr& result) {
     case BinaryOp::Gte:
         op_code = IRExpr::OpCode::GTE;
         break;
+    case BinaryOp::And:
+        op_code = IRExpr::OpCode::AND;
+        break;
+    case BinaryOp::Or:
+        op_code = IRExpr::OpCode::OR;
+        break;
     }
 
     // Operator instructions have no operand (they operate on stack)
@@ -283,15 +378,71 @@ void Compiler::compile_ternary(const TernaryExpr& node, IRExpr& result) {
     result.instructions.push_back({IRExpr::OpCode::TERNARY, 0});
 }
 
+// Compile string predicate into bytecode (the pattern is the operand)
+// Example: contains(url, "/api/")
+//   Bytecode: [LOAD_COLUMN "url", CONTAINS "/api/"]
+void Compiler::compile_string_match(const StringMatchExpr& node, IRExpr& result) {
+    IRExpr subject = compile_expr(*node.subject);
+    result.instructions.insert(result.instructions.end(), subject.instructions.begin(),
+                               subject.instructions.end());
+
+    IRExpr::OpCode op_code;
+    switch (node.func) {
+    case StringFunc::StartsWith:
+        op_code = IRExpr::OpCode::STARTS_WITH;
+        break;
+    case StringFunc::EndsWith:
+        op_code = IRExpr::OpCode::ENDS_WITH;
+        break;
+    case StringFunc::Contains:
+        op_code = IRExpr::OpCode::CONTAINS;
+        break;
+    case StringFunc::IEquals:
+        op_code = IRExpr::OpCode::IEQUALS;
+        break;
+    default:
+        throw CompileError("Unknown string function");
+    }
+
+    result.instructions.push_back({op_code, node.pattern});
+}
+
 // ============================================================================
 // Vectorization Pattern Detection
 // ============================================================================
 // Detects simple filter patterns that can be vectorized
-// Pattern: column comparison_op literal
-// Examples: age > 30, name == "Alice", salary <= 50000
+// Pattern: column comparison_op literal, column comparison_op column, or a
+// string predicate on a column
+// Examples: age > 30, name == "Alice", salary <= 50000, revenue > cost,
+//           starts_with(path, "/api/")
 
 std::optional<PhysicalOp::VectorizedFilterOp> Compiler::try_vectorize_filter(const Expr& expr) {
-    // Only handle binary expressions
+    if (const auto* call = std::get_if<StringMatchExpr>(&expr.node)) {
+        const auto* col = std::get_if<ColumnRef>(&call->subject->node);
+        if (!col) {
+            return std::nullopt;
+        }
+        PhysicalOp::VectorizedFilterOp result;
+        result.column_name = col->name;
+        switch (call->func) {
+        case StringFunc::StartsWith:
+            result.op = VectorOp::STARTS_WITH;
+            break;
+        case StringFunc::EndsWith:
+            result.op = VectorOp::ENDS_WITH;
+            break;
+        case StringFunc::Contains:
+            result.op = VectorOp::CONTAINS;
+            break;
+        case StringFunc::IEquals:
+            result.op = VectorOp::IEQUALS;
+            break;
+        }
+        result.value = call->pattern;
+        return result;
+    }
+
+    // Otherwise only handle binary expressions
     const auto* binary_node = std::get_if<BinaryExpr>(&expr.node);
     if (!binary_node) {
         return std::nullopt;
@@ -403,10 +554,91 @@ std::optional<PhysicalOp::VectorizedFilterOp> Compiler::try_vectorize_filter(con
         return result;
     }
 
+    // Pattern 3: column op column (types are checked by the binder)
+    if (left_col && right_col) {
+        PhysicalOp::VectorizedFilterOp result;
+        result.column_name = left_col->name;
+        result.is_right_column = true;
+        result.right_column_name = right_col->name;
+        switch (op) {
+        case BinaryOp::Gt:
+            result.op = VectorOp::GT;
+            break;
+        case BinaryOp::Lt:
+            result.op = VectorOp::LT;
+            break;
+        case BinaryOp::Gte:
+            result.op = VectorOp::GTE;
+            break;
+        case BinaryOp::Lte:
+            result.op = VectorOp::LTE;
+            break;
+        case BinaryOp::Eq:
+            result.op = VectorOp::EQ;
+            break;
+        case BinaryOp::Neq:
+            result.op = VectorOp::NEQ;
+            break;
+        default:
+            return std::nullopt;
+        }
+        return result;
+    }
+
     // Complex expression - cannot vectorize
     return std::nullopt;
 }
 
+// ============================================================================
+// Logical Filter Trees (and / or)
+// ============================================================================
+// A filter whose top level is and/or becomes a tree of leaves combined by
+// refining the selection vector: comparisons use the vectorized kernels,
+// anything else is a scalar predicate. Nested operators of the same kind are
+// flattened: a and (b and c) → AND[a, b, c]
+// Operands keep their source order here; the optimizer reorders them
+
+std::optional<PhysicalOp::LogicalFilterOp> Compiler::try_logical_filter(const Expr& expr) {
+    const auto* binary_node = std::get_if<BinaryExpr>(&expr.node);
+    if (!binary_node || (binary_node->op != BinaryOp::And && binary_node->op != BinaryOp::Or)) {
+        return std::nullopt;
+    }
+    return PhysicalOp::LogicalFilterOp{compile_filter_node(expr)};
+}
+
+PhysicalOp::FilterNode Compiler::compile_filter_node(const Expr& expr) {
+    using Kind = PhysicalOp::FilterNode::Kind;
+    PhysicalOp::FilterNode node;
+
+    const auto* binary_node = std::get_if<BinaryExpr>(&expr.node);
+    if (!binary_node || (binary_node->op != BinaryOp::And && binary_node->op != BinaryOp::Or)) {
+        // Leaf: vectorized comparison if possible, else scalar bytecode
+        auto compare = try_vectorize_filter(expr);
+        if (compare.has_value()) {
+            node.kind = Kind::COMPARE;
+            node.compare = std::move(*compare);
+        } else {
+            node.kind = Kind::PREDICATE;
+            node.predicate = compile_expr(expr);
+        }
+        return node;
+    }
+
+    node.kind = binary_node->op == BinaryOp::And ? Kind::AND : Kind::OR;
+    for (const Expr* operand : {binary_node->left.get(), binary_node->right.get()}) {
+        PhysicalOp::FilterNode child = compile_filter_node(*operand);
+        if (child.kind == node.kind) {
+            // Flatten: (a and b) and c → AND[a, b, c]
+            for (auto& grandchild : child.children)
+                node.children.push_back(std::move(grandchild));
+        } else {
+            node.children.push_back(std::move(child));
+        }
+    }
+
+    return node;
+}
+
 // ============================================================================
 // Transform Vectorization Pattern Detection
 // ============================================================================
@@ -459,6 +691,8 @@ std::optional<PhysicalOp::VectorizedTransformOp> Compiler::try_vectorize_arith_t
         return std::nullopt;  // Nested - bail out
     if (!right_col && !right_lit)
         return std::nullopt;  // Nested - bail out
+    if (!left_col && !right_col)
+        return std::nullopt;  // Literals only - folded into a constant by the optimizer
 
     PhysicalOp::VectorizedTransformOp result;
     result.column_name = column_name;
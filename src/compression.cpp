@@ -0,0 +1,357 @@
+#include "compression.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <stdexcept>
+#include <vector>
+
+#include "table.hpp"
+#include "thread_pool.hpp"
+
+#ifdef JOY_HAVE_ZLIB
+#include <zlib.h>
+#endif
+#ifdef JOY_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+namespace joy {
+
+// Compressed bytes handed to zlib per call (its counters are 32-bit)
+constexpr size_t kZlibChunkBytes = 1 << 20;
+
+// zstd frames up to this decompressed size are decompressed in one go, one
+// per thread; larger frames (or ones without a recorded size) are streamed
+constexpr size_t kWholeFrameBytes = 16 * 1024 * 1024;
+
+static bool has_suffix(const std::string& s, const std::string& suffix) {
+    return s.size() >= suffix.size() &&
+           s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+Compression compression_of(const std::string& filepath) {
+    if (has_suffix(filepath, ".gz")) {
+        return Compression::GZIP;
+    }
+    if (has_suffix(filepath, ".zst") || has_suffix(filepath, ".zstd")) {
+        return Compression::ZSTD;
+    }
+    return Compression::NONE;
+}
+
+std::string strip_compression(const std::string& filepath) {
+    if (compression_of(filepath) == Compression::NONE) {
+        return filepath;
+    }
+    return filepath.substr(0, filepath.find_last_of('.'));
+}
+
+void check_compression(Compression compression, const std::string& filepath) {
+#ifndef JOY_HAVE_ZLIB
+    if (compression == Compression::GZIP) {
+        throw std::runtime_error("joy was built without zlib, cannot use gzip file: " + filepath);
+    }
+#endif
+#ifndef JOY_HAVE_ZSTD
+    if (compression == Compression::ZSTD) {
+        throw std::runtime_error("joy was built without zstd, cannot use zstd file: " + filepath);
+    }
+#endif
+    (void)compression;
+    (void)filepath;
+}
+
+// ============================================================================
+// gzip
+// ============================================================================
+
+#ifdef JOY_HAVE_ZLIB
+
+// Inflates the mapped file member by member (concatenated gzip members,
+// as written by compress_block or `cat a.gz b.gz`, are one stream)
+class GzipDecompressor : public Decompressor {
+public:
+    explicit GzipDecompressor(const std::string& filepath) : file_(filepath), filepath_(filepath) {
+        // 16 + MAX_WBITS: expect a gzip header and trailer
+        if (inflateInit2(&stream_, 16 + MAX_WBITS) != Z_OK) {
+            throw std::runtime_error("Cannot initialize zlib for " + filepath);
+        }
+        in_member_ = file_.size() > 0;
+    }
+    ~GzipDecompressor() override {
+        inflateEnd(&stream_);
+    }
+
+    size_t read(char* out, size_t n) override {
+        stream_.next_out = reinterpret_cast<Bytef*>(out);
+        stream_.avail_out = static_cast<uInt>(std::min(n, kZlibChunkBytes));
+        const uInt capacity = stream_.avail_out;
+        while (stream_.avail_out > 0 && in_member_) {
+            if (stream_.avail_in == 0) {
+                if (fed_ == file_.size()) {
+                    throw std::runtime_error("Truncated gzip file: " + filepath_);
+                }
+                size_t chunk = std::min(file_.size() - fed_, kZlibChunkBytes);
+                stream_.next_in =
+                    reinterpret_cast<Bytef*>(const_cast<char*>(file_.data() + fed_));
+                stream_.avail_in = static_cast<uInt>(chunk);
+                fed_ += chunk;
+            }
+            int ret = inflate(&stream_, Z_NO_FLUSH);
+            if (ret == Z_STREAM_END) {
+                // Another member follows, unless the rest is padding
+                size_t at = fed_ - stream_.avail_in;
+                in_member_ = at + 1 < file_.size() &&
+                             static_cast<unsigned char>(file_.data()[at]) == 0x1f &&
+                             static_cast<unsigned char>(file_.data()[at + 1]) == 0x8b;
+                if (in_member_)
+                    inflateReset(&stream_);
+            } else if (ret != Z_OK) {
+                throw std::runtime_error("Corrupt gzip data in " + filepath_);
+            }
+        }
+        file_.discard_before(fed_ - stream_.avail_in);
+        return capacity - stream_.avail_out;
+    }
+
+private:
+    MappedFile file_;
+    std::string filepath_;
+    z_stream stream_{};
+    size_t fed_ = 0;          // Bytes of the file handed to zlib so far
+    bool in_member_ = false;  // False once the last member has ended
+};
+
+#endif  // JOY_HAVE_ZLIB
+
+// ============================================================================
+// zstd
+// ============================================================================
+
+#ifdef JOY_HAVE_ZSTD
+
+// Helper: Context reused by every block a thread (de)compresses
+static ZSTD_DCtx* thread_dctx() {
+    thread_local std::unique_ptr<ZSTD_DCtx, size_t (*)(ZSTD_DCtx*)> ctx(ZSTD_createDCtx(),
+                                                                       ZSTD_freeDCtx);
+    return ctx.get();
+}
+
+static ZSTD_CCtx* thread_cctx() {
+    thread_local std::unique_ptr<ZSTD_CCtx, size_t (*)(ZSTD_CCtx*)> ctx(ZSTD_createCCtx(),
+                                                                       ZSTD_freeCCtx);
+    return ctx.get();
+}
+
+// Decompresses runs of consecutive small frames in parallel (one per thread)
+// and hands their text out in file order; a large frame is streamed alone
+class ZstdDecompressor : public Decompressor {
+public:
+    ZstdDecompressor(const std::string& filepath, ThreadPool* pool)
+        : file_(filepath), filepath_(filepath), pool_(pool) {}
+    ~ZstdDecompressor() override {
+        ZSTD_freeDCtx(stream_);
+    }
+
+    size_t read(char* out, size_t n) override {
+        size_t total = 0;
+        while (total < n) {
+            if (streaming_) {
+                ZSTD_outBuffer output{out + total, n - total, 0};
+                size_t ret = ZSTD_decompressStream(stream_, &output, &input_);
+                if (ZSTD_isError(ret)) {
+                    throw std::runtime_error("Corrupt zstd data in " + filepath_ + ": " +
+                                             ZSTD_getErrorName(ret));
+                }
+                total += output.pos;
+                file_.discard_before(pos_ + input_.pos);
+                if (ret == 0) {
+                    streaming_ = false;  // Frame complete and flushed
+                    pos_ += input_.size;
+                } else if (output.pos < output.size && input_.pos == input_.size) {
+                    throw std::runtime_error("Truncated zstd file: " + filepath_);
+                }
+                continue;
+            }
+            if (!ready_.empty()) {
+                const std::string& text = ready_.front();
+                size_t len = std::min(n - total, text.size() - ready_pos_);
+                std::memcpy(out + total, text.data() + ready_pos_, len);
+                total += len;
+                ready_pos_ += len;
+                if (ready_pos_ == text.size()) {
+                    ready_.pop_front();
+                    ready_pos_ = 0;
+                }
+                continue;
+            }
+            if (pos_ == file_.size()) {
+                break;  // End of file
+            }
+            decompress_frames();
+        }
+        return total;
+    }
+
+private:
+    // Decompress the next run of small frames (up to one per thread) into
+    // ready_, or start streaming the next frame if it is large
+    void decompress_frames() {
+        const char* data = file_.data();
+        const size_t size = file_.size();
+        const size_t limit = pool_ ? pool_->size() : 1;
+
+        std::vector<std::pair<size_t, size_t>> frames;  // Offset, compressed bytes
+        std::vector<size_t> lengths;                    // Decompressed bytes
+        size_t at = pos_;
+        while (frames.size() < limit && at < size) {
+            size_t bytes = ZSTD_findFrameCompressedSize(data + at, size - at);
+            if (ZSTD_isError(bytes)) {
+                throw std::runtime_error("Corrupt zstd data in " + filepath_ + ": " +
+                                         ZSTD_getErrorName(bytes));
+            }
+            unsigned long long length = ZSTD_getFrameContentSize(data + at, bytes);
+            if (length == ZSTD_CONTENTSIZE_ERROR) {
+                throw std::runtime_error("Corrupt zstd data in " + filepath_);
+            }
+            if (length == ZSTD_CONTENTSIZE_UNKNOWN || length > kWholeFrameBytes) {
+                if (frames.empty()) {
+                    if (!stream_)
+                        stream_ = ZSTD_createDCtx();
+                    ZSTD_DCtx_reset(stream_, ZSTD_reset_session_only);
+                    input_ = ZSTD_inBuffer{data + at, bytes, 0};
+                    streaming_ = true;
+                }
+                break;
+            }
+            frames.emplace_back(at, bytes);
+            lengths.push_back(static_cast<size_t>(length));
+            at += bytes;
+        }
+        if (frames.empty()) {
+            return;
+        }
+
+        std::vector<std::string> texts(frames.size());
+        std::vector<std::exception_ptr> errors(frames.size());
+        auto decompress = [&](size_t k) {
+            try {
+                texts[k].resize(lengths[k]);
+                size_t ret = ZSTD_decompressDCtx(thread_dctx(), texts[k].data(), lengths[k],
+                                                 data + frames[k].first, frames[k].second);
+                if (ZSTD_isError(ret) || ret != lengths[k]) {
+                    throw std::runtime_error("Corrupt zstd data in " + filepath_);
+                }
+            } catch (...) {
+                errors[k] = std::current_exception();
+            }
+        };
+        if (pool_ && frames.size() > 1) {
+            pool_->parallel_for(frames.size(), decompress);
+        } else {
+            for (size_t k = 0; k < frames.size(); ++k)
+                decompress(k);
+        }
+
+        // Report the first error in file order, as a sequential reader would
+        for (size_t k = 0; k < frames.size(); ++k) {
+            if (errors[k]) {
+                std::rethrow_exception(errors[k]);
+            }
+            if (!texts[k].empty())
+                ready_.push_back(std::move(texts[k]));
+        }
+        pos_ = at;
+        file_.discard_before(pos_);
+    }
+
+    MappedFile file_;
+    std::string filepath_;
+    ThreadPool* pool_;
+    size_t pos_ = 0;               // Offset of the first frame not completely decompressed
+    std::deque<std::string> ready_;  // Decompressed frames not yet read, in file order
+    size_t ready_pos_ = 0;         // Bytes of ready_.front() already read
+    ZSTD_DCtx* stream_ = nullptr;  // For streaming a large frame
+    ZSTD_inBuffer input_{};        // That frame's compressed bytes
+    bool streaming_ = false;
+};
+
+#endif  // JOY_HAVE_ZSTD
+
+// ============================================================================
+// Entry Points
+// ============================================================================
+
+std::unique_ptr<Decompressor> open_decompressor(const std::string& filepath,
+                                                Compression compression, ThreadPool* pool) {
+    check_compression(compression, filepath);
+#ifdef JOY_HAVE_ZLIB
+    if (compression == Compression::GZIP) {
+        return std::make_unique<GzipDecompressor>(filepath);
+    }
+#endif
+#ifdef JOY_HAVE_ZSTD
+    if (compression == Compression::ZSTD) {
+        return std::make_unique<ZstdDecompressor>(filepath, pool);
+    }
+#endif
+    (void)pool;
+    throw std::runtime_error("File is not compressed: " + filepath);
+}
+
+void compress_block(Compression compression, std::string_view data, std::string& out) {
+#ifdef JOY_HAVE_ZLIB
+    if (compression == Compression::GZIP) {
+        z_stream stream{};
+        if (deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 16 + MAX_WBITS, 8,
+                         Z_DEFAULT_STRATEGY) != Z_OK) {
+            throw std::runtime_error("Cannot initialize zlib");
+        }
+        const size_t old_size = out.size();
+        out.resize(old_size + deflateBound(&stream, data.size()));
+        stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+        stream.next_out = reinterpret_cast<Bytef*>(out.data() + old_size);
+        stream.avail_out = static_cast<uInt>(out.size() - old_size);
+        // Feed the input in chunks that fit zlib's 32-bit counters
+        int ret = Z_OK;
+        size_t fed = 0;
+        while (ret == Z_OK) {
+            if (stream.avail_in == 0 && fed < data.size()) {
+                size_t chunk = std::min(data.size() - fed, kZlibChunkBytes);
+                stream.avail_in = static_cast<uInt>(chunk);
+                fed += chunk;
+            }
+            ret = deflate(&stream, fed == data.size() ? Z_FINISH : Z_NO_FLUSH);
+        }
+        out.resize(old_size + stream.total_out);
+        deflateEnd(&stream);
+        if (ret != Z_STREAM_END) {
+            throw std::runtime_error("gzip compression failed");
+        }
+        return;
+    }
+#endif
+#ifdef JOY_HAVE_ZSTD
+    if (compression == Compression::ZSTD) {
+        const size_t old_size = out.size();
+        out.resize(old_size + ZSTD_compressBound(data.size()));
+        size_t ret = ZSTD_compressCCtx(thread_cctx(), out.data() + old_size,
+                                       out.size() - old_size, data.data(), data.size(),
+                                       ZSTD_CLEVEL_DEFAULT);
+        if (ZSTD_isError(ret)) {
+            throw std::runtime_error(std::string("zstd compression failed: ") +
+                                     ZSTD_getErrorName(ret));
+        }
+        out.resize(old_size + ret);
+        return;
+    }
+#endif
+    (void)data;
+    (void)out;
+    check_compression(compression, "");
+    throw std::runtime_error("Unknown compression");
+}
+
+}  // namespace joy
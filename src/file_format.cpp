@@ -0,0 +1,198 @@
+#include "file_format.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#include "arrow_ipc.hpp"
+#include "joyc.hpp"
+#include "multi_file.hpp"
+#include "parquet.hpp"
+
+namespace joy {
+
+// ============================================================================
+// Format Selection
+// ============================================================================
+
+static bool has_extension(const std::string& filepath, const std::string& ext) {
+    return filepath.size() >= ext.size() &&
+           filepath.compare(filepath.size() - ext.size(), ext.size(), ext) == 0;
+}
+
+// Helper: Throw for a compressed file in a format other than CSV (the binary
+// formats are read in place from the mapping and cannot be streamed)
+static void check_compressed_csv(const std::string& filepath) {
+    if (compression_of(filepath) == Compression::NONE) {
+        return;
+    }
+    std::string inner = strip_compression(filepath);
+    for (const char* ext : {".joyc", ".parquet", ".arrow", ".feather", ".arrows"}) {
+        if (has_extension(inner, ext)) {
+            throw std::runtime_error("Only CSV files can be compressed: " + filepath);
+        }
+    }
+}
+
+// Helper: Throw if a typed file stores a declared column as another type
+// (columns the reader does not return may have been projected away)
+static std::unique_ptr<BatchReader> check_declared(std::unique_ptr<BatchReader> reader,
+                                                   const std::string& filepath,
+                                                   const std::vector<DeclaredColumn>* schema) {
+    if (!schema) {
+        return reader;
+    }
+    const auto& names = reader->column_names();
+    for (const auto& decl : *schema) {
+        auto it = std::find(names.begin(), names.end(), decl.name);
+        if (it == names.end())
+            continue;
+        ColumnType type = reader->column_types()[static_cast<size_t>(it - names.begin())];
+        if (type != decl.type) {
+            throw std::runtime_error("Column " + decl.name + " in " + filepath + " is " +
+                                     column_type_name(type) + ", but the schema declares " +
+                                     column_type_name(decl.type));
+        }
+    }
+    return reader;
+}
+
+std::unique_ptr<BatchReader> open_reader(
+    const std::string& filepath, ThreadPool* pool, const std::vector<std::string>* columns,
+    const std::vector<PhysicalOp::VectorizedFilterOp>* predicates,
+    const std::vector<DeclaredColumn>* schema) {
+    check_compressed_csv(filepath);
+    if (has_extension(filepath, ".joyc")) {
+        return check_declared(std::make_unique<JoycReader>(filepath, pool, columns), filepath,
+                              schema);
+    }
+    if (has_extension(filepath, ".parquet")) {
+        return check_declared(
+            std::make_unique<ParquetReader>(filepath, pool, columns, predicates), filepath,
+            schema);
+    }
+    if (has_extension(filepath, ".arrow") || has_extension(filepath, ".feather") ||
+        has_extension(filepath, ".arrows")) {
+        return check_declared(std::make_unique<ArrowReader>(filepath, pool, columns), filepath,
+                              schema);
+    }
+    return std::make_unique<CsvReader>(filepath, pool, columns, schema);
+}
+
+std::unique_ptr<BatchReader> open_scan(
+    const std::vector<std::string>& filepaths, ThreadPool* pool,
+    const std::vector<std::string>* columns,
+    const std::vector<PhysicalOp::VectorizedFilterOp>* predicates,
+    const std::vector<DeclaredColumn>* schema) {
+    std::vector<std::string> files;
+    for (const auto& pattern : filepaths) {
+        auto matches = expand_glob(pattern);
+        files.insert(files.end(), matches.begin(), matches.end());
+    }
+    if (files.size() == 1) {
+        return open_reader(files.front(), pool, columns, predicates, schema);
+    }
+    return std::make_unique<MultiFileReader>(files, pool, columns, predicates, schema);
+}
+
+std::unique_ptr<BatchWriter> open_writer(const std::string& filepath, ThreadPool* pool,
+                                         bool append) {
+    check_compressed_csv(filepath);
+    if (append) {
+        for (const char* ext : {".joyc", ".parquet", ".arrow", ".feather", ".arrows"}) {
+            if (has_extension(filepath, ext)) {
+                throw std::runtime_error("Only CSV files can be appended to: " + filepath);
+            }
+        }
+        return std::make_unique<CsvWriter>(filepath, pool, true);
+    }
+    if (has_extension(filepath, ".joyc")) {
+        return std::make_unique<JoycWriter>(filepath);
+    }
+    if (has_extension(filepath, ".parquet")) {
+        return std::make_unique<ParquetWriter>(filepath);
+    }
+    if (has_extension(filepath, ".arrow") || has_extension(filepath, ".feather")) {
+        return std::make_unique<ArrowWriter>(filepath, ArrowWriter::Format::FILE);
+    }
+    if (has_extension(filepath, ".arrows")) {
+        return std::make_unique<ArrowWriter>(filepath, ArrowWriter::Format::STREAM);
+    }
+    return std::make_unique<CsvWriter>(filepath, pool);
+}
+
+// ============================================================================
+// Statistics
+// ============================================================================
+
+// Helper: Three-way comparison of a bound with the literal, the way the filter
+// kernels compare (numbers of mixed types as doubles)
+// nullopt = not comparable (the predicate decides nothing about the block)
+static std::optional<int> compare_bound(const ColumnStats::Value& bound,
+                                        const std::variant<int64_t, double, std::string>& value) {
+    auto sign = [](const auto& a, const auto& b) { return a < b ? -1 : (b < a ? 1 : 0); };
+    if (const auto* s = std::get_if<std::string>(&bound)) {
+        if (const auto* v = std::get_if<std::string>(&value))
+            return sign(*s, *v);
+        return std::nullopt;
+    }
+    if (std::holds_alternative<std::string>(value)) {
+        return std::nullopt;
+    }
+    if (std::holds_alternative<int64_t>(bound) && std::holds_alternative<int64_t>(value)) {
+        return sign(std::get<int64_t>(bound), std::get<int64_t>(value));
+    }
+    auto as_double = [](const auto& v) {
+        return std::holds_alternative<int64_t>(v) ? static_cast<double>(std::get<int64_t>(v))
+                                                  : std::get<double>(v);
+    };
+    double b = as_double(bound);
+    double v = as_double(value);
+    if (std::isnan(b) || std::isnan(v)) {
+        return std::nullopt;
+    }
+    return sign(b, v);
+}
+
+bool may_match(const PhysicalOp::VectorizedFilterOp& predicate, const ColumnStats& stats) {
+    // Comparisons with NULL are never true
+    if (stats.null_count && *stats.null_count >= stats.num_rows) {
+        return false;
+    }
+    if (!stats.min || !stats.max) {
+        return true;
+    }
+    auto lo = compare_bound(*stats.min, predicate.value);
+    auto hi = compare_bound(*stats.max, predicate.value);
+    if (!lo || !hi) {
+        return true;
+    }
+    switch (predicate.op) {
+    case VectorOp::GT:
+        return *hi > 0;
+    case VectorOp::GTE:
+        return *hi >= 0;
+    case VectorOp::LT:
+        return *lo < 0;
+    case VectorOp::LTE:
+        return *lo <= 0;
+    case VectorOp::EQ:
+        return *lo <= 0 && *hi >= 0;
+    case VectorOp::NEQ:
+        // Only a block holding nothing but the literal fails; NaN (never in the
+        // range, always unequal) rules that out for doubles
+        return std::holds_alternative<double>(*stats.min) || *lo != 0 || *hi != 0;
+    case VectorOp::STARTS_WITH: {
+        // Values with the prefix sort between it and the next string without
+        // it, so the block must reach the prefix and not lie wholly past it
+        const auto* min = std::get_if<std::string>(&*stats.min);
+        const auto& prefix = std::get<std::string>(predicate.value);
+        return *hi >= 0 && (!min || min->compare(0, prefix.size(), prefix) <= 0);
+    }
+    default:
+        return true;  // No order to prune by
+    }
+    return true;
+}
+
+}  // namespace joy
@@ -0,0 +1,238 @@
+#include "hash_join.hpp"
+
+#include <algorithm>
+#include <limits>
+
+#include "file_format.hpp"
+#include "key_hash.hpp"
+#include "vm.hpp"  // For RuntimeError
+
+namespace joy {
+
+// Target size of one partition's slot array (fits in a typical L2 cache)
+constexpr size_t kPartitionBytes = 256 * 1024;
+constexpr int kMaxRadixBits = 12;
+
+// Probe batches smaller than this are not split across threads
+constexpr size_t kMinParallelProbeRows = 16 * 1024;
+
+constexpr uint64_t kTagMask = 0xffffffff00000000ULL;
+
+// Helper: Whether any key of row is NULL (such rows never match)
+static bool has_null_key(const std::vector<const Column*>& keys, size_t row) {
+    for (const Column* col : keys) {
+        if (col->is_null(row))
+            return true;
+    }
+    return false;
+}
+
+// Helper: Row indices grouped by partition (ascending within each), plus the
+// start of each partition's range: partition p is rows[offsets[p], offsets[p + 1])
+template <typename PartitionOf>
+static void radix_partition(const std::vector<uint64_t>& hashes, size_t num_partitions,
+                            PartitionOf partition_of, std::vector<uint32_t>& rows,
+                            std::vector<size_t>& offsets) {
+    offsets.assign(num_partitions + 1, 0);
+    for (uint64_t h : hashes)
+        offsets[partition_of(h) + 1]++;
+    for (size_t p = 0; p < num_partitions; ++p)
+        offsets[p + 1] += offsets[p];
+
+    std::vector<size_t> cursor(offsets.begin(), offsets.end() - 1);
+    rows.resize(hashes.size());
+    for (size_t r = 0; r < hashes.size(); ++r)
+        rows[cursor[partition_of(hashes[r])]++] = static_cast<uint32_t>(r);
+}
+
+// ============================================================================
+// Build
+// ============================================================================
+
+HashJoin::HashJoin(const PhysicalOp::JoinOp& op, ThreadPool* pool) : keys_(op.keys) {
+    auto reader = open_reader(op.filepath, pool, op.columns ? &*op.columns : nullptr);
+    reader->next_batch(build_, std::numeric_limits<size_t>::max());
+    Table chunk;
+    while (reader->next_batch(chunk, std::numeric_limits<size_t>::max())) {
+        build_.append(chunk);
+    }
+    inferred_ = reader->inferred_types();
+
+    if (build_.num_rows >= kNone) {
+        throw RuntimeError("Join input is too large: " + op.filepath);
+    }
+    for (const auto& key : keys_) {
+        const Column* col = build_.get_column(key);
+        if (!col) {
+            throw RuntimeError("Column not found in " + op.filepath + ": " + key);
+        }
+        build_keys_.push_back(col);
+    }
+    for (size_t c = 0; c < build_.columns.size(); ++c) {
+        if (std::find(keys_.begin(), keys_.end(), build_.columns[c].name) == keys_.end())
+            payload_.push_back(c);
+    }
+
+    // Enough partitions that each slot array (2 slots of 8 bytes per row) fits
+    const size_t n = build_.num_rows;
+    while (radix_bits_ < kMaxRadixBits && (n * 16 >> radix_bits_) > kPartitionBytes) {
+        radix_bits_++;
+    }
+    partitions_.resize(size_t{1} << radix_bits_);
+
+    std::vector<std::vector<uint64_t>> dict_hashes;
+    for (const Column* col : build_keys_)
+        dict_hashes.push_back(dictionary_hashes(*col));
+    std::vector<uint64_t> hashes;
+    hash_keys(build_keys_, dict_hashes, 0, n, hashes);
+
+    std::vector<uint32_t> rows;
+    std::vector<size_t> offsets;
+    radix_partition(
+        hashes, partitions_.size(), [this](uint64_t h) { return partition_of(h); }, rows,
+        offsets);
+
+    // Each partition only touches its own table and its own rows of next_
+    next_.assign(n, kNone);
+    auto build_partition = [&](size_t p) {
+        Partition& part = partitions_[p];
+        size_t count = offsets[p + 1] - offsets[p];
+        size_t num_slots = 16;
+        while (num_slots < count * 2)
+            num_slots *= 2;
+        part.slots.assign(num_slots, 0);
+        const size_t mask = num_slots - 1;
+
+        std::vector<uint32_t> tails;  // Per entry: last row of its chain
+        for (size_t i = offsets[p]; i < offsets[p + 1]; ++i) {
+            uint32_t row = rows[i];
+            if (has_null_key(build_keys_, row))
+                continue;
+            uint64_t hash = hashes[row];
+            uint64_t tag = hash & kTagMask;
+            for (size_t s = hash & mask;; s = (s + 1) & mask) {
+                uint64_t slot = part.slots[s];
+                if (slot == 0) {
+                    part.slots[s] = tag | (part.heads.size() + 1);
+                    part.heads.push_back(row);
+                    tails.push_back(row);
+                    break;
+                }
+                if ((slot & kTagMask) == tag) {
+                    size_t entry = (slot & ~kTagMask) - 1;
+                    if (keys_equal(build_keys_, part.heads[entry], build_keys_, row)) {
+                        next_[tails[entry]] = row;  // Rows arrive in file order
+                        tails[entry] = row;
+                        break;
+                    }
+                }
+            }
+        }
+    };
+    if (pool && partitions_.size() > 1) {
+        pool->parallel_for(partitions_.size(), build_partition);
+    } else {
+        for (size_t p = 0; p < partitions_.size(); ++p)
+            build_partition(p);
+    }
+}
+
+// ============================================================================
+// Probe
+// ============================================================================
+
+uint32_t HashJoin::find(const Partition& part, const std::vector<const Column*>& probe_keys,
+                        size_t row, uint64_t hash) const {
+    const size_t mask = part.slots.size() - 1;
+    const uint64_t tag = hash & kTagMask;
+    for (size_t s = hash & mask;; s = (s + 1) & mask) {
+        uint64_t slot = part.slots[s];
+        if (slot == 0)
+            return kNone;
+        if ((slot & kTagMask) == tag) {
+            uint32_t head = part.heads[(slot & ~kTagMask) - 1];
+            if (keys_equal(build_keys_, head, probe_keys, row))
+                return head;
+        }
+    }
+}
+
+std::vector<uint32_t> HashJoin::match(const Table& batch, ThreadPool* pool) const {
+    std::vector<const Column*> probe_keys;
+    bool comparable = true;  // Keys of different types never match
+    for (size_t k = 0; k < keys_.size(); ++k) {
+        const Column* col = batch.get_column(keys_[k]);
+        if (!col) {
+            throw RuntimeError("Column not found: " + keys_[k]);
+        }
+        comparable &= col->type == build_keys_[k]->type;
+        probe_keys.push_back(col);
+    }
+
+    const size_t n = batch.num_rows;
+    std::vector<uint32_t> matches(n, kNone);
+    if (!comparable || n == 0) {
+        return matches;
+    }
+
+    std::vector<std::vector<uint64_t>> dict_hashes;
+    for (const Column* col : probe_keys)
+        dict_hashes.push_back(dictionary_hashes(*col));
+    std::vector<uint64_t> hashes;
+    hash_keys(probe_keys, dict_hashes, 0, n, hashes);
+
+    std::vector<uint32_t> rows;
+    std::vector<size_t> offsets;
+    radix_partition(
+        hashes, partitions_.size(), [this](uint64_t h) { return partition_of(h); }, rows, offsets);
+
+    auto probe_partition = [&](size_t p) {
+        for (size_t i = offsets[p]; i < offsets[p + 1]; ++i) {
+            uint32_t row = rows[i];
+            if (!has_null_key(probe_keys, row))
+                matches[row] = find(partitions_[p], probe_keys, row, hashes[row]);
+        }
+    };
+    if (pool && partitions_.size() > 1 && n >= kMinParallelProbeRows) {
+        pool->parallel_for(partitions_.size(), probe_partition);
+    } else {
+        for (size_t p = 0; p < partitions_.size(); ++p)
+            probe_partition(p);
+    }
+    return matches;
+}
+
+bool HashJoin::emit(const Table& batch, const std::vector<uint32_t>& matches, Cursor& cursor,
+                    size_t max_rows, Table& out) const {
+    // Matching pairs in batch order (each chain is in file order)
+    std::vector<uint32_t> probe_rows;
+    std::vector<uint32_t> build_rows;
+    while (cursor.row < matches.size() && probe_rows.size() < max_rows) {
+        uint32_t b = cursor.build == kNone ? matches[cursor.row] : cursor.build;
+        for (; b != kNone && probe_rows.size() < max_rows; b = next_[b]) {
+            probe_rows.push_back(static_cast<uint32_t>(cursor.row));
+            build_rows.push_back(b);
+        }
+        if (b == kNone) {
+            cursor.row++;
+            cursor.build = kNone;
+        } else {
+            cursor.build = b;  // Row has more matches than fit
+        }
+    }
+
+    // Gather the batch's columns, then the file's other columns
+    out = batch.gather(probe_rows);
+    for (size_t c : payload_) {
+        const Column& col = build_.columns[c];
+        if (!batch.get_column(col.name))
+            out.add_column(col.gather(build_rows));
+    }
+
+    // Skip rows without matches so the last piece is not an empty one
+    while (cursor.row < matches.size() && cursor.build == kNone && matches[cursor.row] == kNone)
+        cursor.row++;
+    return cursor.row < matches.size();
+}
+
+}  // namespace joy
@@ -0,0 +1,675 @@
+#include "jit.hpp"
+
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+
+#include "vm.hpp"  // For RuntimeError
+
+#ifdef JOY_HAVE_JIT
+#include <llvm/ExecutionEngine/Orc/ExecutionUtils.h>
+#include <llvm/ExecutionEngine/Orc/JITTargetMachineBuilder.h>
+#include <llvm/ExecutionEngine/Orc/LLJIT.h>
+#include <llvm/ExecutionEngine/Orc/ThreadSafeModule.h>
+#include <llvm/IR/IRBuilder.h>
+#include <llvm/IR/LLVMContext.h>
+#include <llvm/IR/Module.h>
+#include <llvm/IR/Verifier.h>
+#include <llvm/Passes/PassBuilder.h>
+#include <llvm/Support/TargetSelect.h>
+#include <llvm/Target/TargetMachine.h>
+#endif
+
+namespace joy {
+
+// ============================================================================
+// Kernel ABI
+// ============================================================================
+// int64_t kernel(const void* const* columns, int64_t begin, int64_t n,
+//                const uint8_t* active, void* out_values, uint8_t* out_valid)
+//   columns: 2 pointers per input, the value buffer (bitmap words for BOOL)
+//            and the validity words
+//   returns: nonzero if a live row divided by zero (same rule as the interpreter)
+
+using KernelFn = int64_t (*)(const void* const*, int64_t, int64_t, const uint8_t*, void*,
+                             uint8_t*);
+
+struct JitKernel::Code {
+    KernelFn fn = nullptr;
+    std::function<void()> release;  // Frees the machine code
+    ~Code() {
+        if (release)
+            release();
+    }
+};
+
+JitKernel::~JitKernel() = default;
+
+bool JitKernel::matches(const Table& table) const {
+    for (size_t i = 0; i < columns_.size(); ++i) {
+        if (static_cast<size_t>(columns_[i]) >= table.columns.size() ||
+            table.columns[columns_[i]].type != column_types_[i] ||
+            table.columns[columns_[i]].size() < table.num_rows) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void JitKernel::evaluate(const Table& table, size_t begin, size_t n, const uint8_t* active,
+                         VectorSlot& result) const {
+    std::vector<const void*> pointers(2 * columns_.size());
+    for (size_t i = 0; i < columns_.size(); ++i) {
+        const Column& col = table.columns[columns_[i]];
+        switch (col.type) {
+        case ColumnType::INT64:
+            pointers[2 * i] = col.values<int64_t>().data();
+            break;
+        case ColumnType::DOUBLE:
+            pointers[2 * i] = col.values<double>().data();
+            break;
+        case ColumnType::BOOL:
+            pointers[2 * i] = std::get<Bitmap>(col.data).words();
+            break;
+        case ColumnType::STRING:
+            throw RuntimeError("JIT kernels do not read strings");
+        }
+        pointers[2 * i + 1] = col.validity.words();
+    }
+
+    result.type = result_type_;
+    result.valid.resize(n);
+    void* out = nullptr;
+    switch (result_type_) {
+    case ColumnType::INT64:
+        result.ints.resize(n);
+        out = result.ints.data();
+        break;
+    case ColumnType::DOUBLE:
+        result.doubles.resize(n);
+        out = result.doubles.data();
+        break;
+    case ColumnType::BOOL:
+        result.bools.resize(n);
+        out = result.bools.data();
+        break;
+    case ColumnType::STRING:
+        break;  // Never compiled
+    }
+    if (code_->fn(pointers.data(), static_cast<int64_t>(begin), static_cast<int64_t>(n), active,
+                  out, result.valid.data()) != 0) {
+        throw RuntimeError("Division by zero");
+    }
+}
+
+#ifdef JOY_HAVE_JIT
+
+// ============================================================================
+// Code Generation (bytecode -> LLVM IR)
+// ============================================================================
+// The loop body evaluates the stack machine symbolically: every stack entry
+// is an SSA (value, valid) pair, so the generated code has no stack at all.
+// The body is branch-free apart from reading the optional active mask, which
+// lets LLVM's loop vectorizer turn it into SIMD code for the host CPU
+
+namespace {
+
+class KernelBuilder {
+public:
+    KernelBuilder(llvm::LLVMContext& ctx, llvm::Module& module, const IRExpr& expr,
+                  const Table& table)
+        : ctx_(ctx), module_(module), builder_(ctx), expr_(expr), table_(table) {}
+
+    // Emit the kernel as function name; false if the expression needs the interpreter
+    bool build(const std::string& name, std::vector<int>& columns,
+               std::vector<ColumnType>& column_types);
+
+private:
+    struct Operand {
+        ColumnType type;
+        llvm::Value* value;  // i64, double or i1
+        llvm::Value* valid;  // i1
+    };
+
+    llvm::Value* bit(llvm::Value* words, llvm::Value* row);
+    llvm::Value* truthy(const Operand& x);
+    llvm::Value* active_row();
+    bool load_column(int index, std::vector<int>& columns, std::vector<ColumnType>& column_types);
+    bool emit(const IRExpr::Instruction& instr, std::vector<int>& columns,
+              std::vector<ColumnType>& column_types);
+    Operand pop() {
+        Operand x = stack_.back();
+        stack_.pop_back();
+        return x;
+    }
+
+    llvm::LLVMContext& ctx_;
+    llvm::Module& module_;
+    llvm::IRBuilder<> builder_;
+    const IRExpr& expr_;
+    const Table& table_;
+
+    llvm::Function* fn_ = nullptr;
+    llvm::Value* columns_arg_ = nullptr;
+    llvm::Value* active_arg_ = nullptr;
+    llvm::Value* error_ = nullptr;  // i64 alloca: any live division by zero
+    llvm::Value* i_ = nullptr;      // Loop counter (offset from begin)
+    llvm::Value* row_ = nullptr;    // begin + i
+    llvm::Value* active_ = nullptr;  // i1 for the current row, created on first use
+    std::map<int, size_t> inputs_;   // Table column -> kernel input
+    std::vector<Operand> stack_;
+};
+
+llvm::Value* KernelBuilder::bit(llvm::Value* words, llvm::Value* row) {
+    llvm::Type* i64 = builder_.getInt64Ty();
+    llvm::Value* word = builder_.CreateLoad(
+        i64, builder_.CreateInBoundsGEP(i64, words, builder_.CreateLShr(row, 6)));
+    llvm::Value* shifted = builder_.CreateLShr(word, builder_.CreateAnd(row, 63));
+    return builder_.CreateTrunc(shifted, builder_.getInt1Ty());
+}
+
+// NULL is false; ints are true when non-zero
+llvm::Value* KernelBuilder::truthy(const Operand& x) {
+    llvm::Value* value = x.type == ColumnType::BOOL
+                             ? x.value
+                             : builder_.CreateICmpNE(x.value, builder_.getInt64(0));
+    return builder_.CreateAnd(x.valid, value);
+}
+
+// active[i] != 0 (true if no mask was passed)
+llvm::Value* KernelBuilder::active_row() {
+    if (active_) {
+        return active_;
+    }
+    llvm::BasicBlock* from = builder_.GetInsertBlock();
+    llvm::BasicBlock* load = llvm::BasicBlock::Create(ctx_, "active.load", fn_);
+    llvm::BasicBlock* join = llvm::BasicBlock::Create(ctx_, "active.join", fn_);
+    builder_.CreateCondBr(builder_.CreateIsNull(active_arg_), join, load);
+
+    builder_.SetInsertPoint(load);
+    llvm::Value* mask = builder_.CreateLoad(
+        builder_.getInt8Ty(), builder_.CreateInBoundsGEP(builder_.getInt8Ty(), active_arg_, i_));
+    llvm::Value* loaded = builder_.CreateICmpNE(mask, builder_.getInt8(0));
+    builder_.CreateBr(join);
+
+    builder_.SetInsertPoint(join);
+    llvm::PHINode* phi = builder_.CreatePHI(builder_.getInt1Ty(), 2);
+    phi->addIncoming(builder_.getTrue(), from);
+    phi->addIncoming(loaded, load);
+    active_ = phi;
+    return active_;
+}
+
+bool KernelBuilder::load_column(int index, std::vector<int>& columns,
+                                std::vector<ColumnType>& column_types) {
+    const Column& col = table_.columns[index];
+    if (col.type == ColumnType::STRING) {
+        return false;
+    }
+    auto [it, inserted] = inputs_.emplace(index, columns.size());
+    if (inserted) {
+        columns.push_back(index);
+        column_types.push_back(col.type);
+    }
+
+    // Buffer pointers are reloaded per row; LLVM hoists them out of the loop
+    llvm::Type* ptr = builder_.getInt8PtrTy();
+    auto argument = [&](size_t k) {
+        return builder_.CreateLoad(
+            ptr, builder_.CreateInBoundsGEP(ptr, columns_arg_, builder_.getInt64(k)));
+    };
+    llvm::Value* values = argument(2 * it->second);
+    llvm::Value* validity =
+        builder_.CreateBitCast(argument(2 * it->second + 1), builder_.getInt64Ty()->getPointerTo());
+    llvm::Value* valid = bit(validity, row_);
+
+    switch (col.type) {
+    case ColumnType::INT64: {
+        llvm::Type* i64 = builder_.getInt64Ty();
+        llvm::Value* typed = builder_.CreateBitCast(values, i64->getPointerTo());
+        stack_.push_back({col.type,
+                          builder_.CreateLoad(i64, builder_.CreateInBoundsGEP(i64, typed, row_)),
+                          valid});
+        break;
+    }
+    case ColumnType::DOUBLE: {
+        llvm::Type* f64 = builder_.getDoubleTy();
+        llvm::Value* typed = builder_.CreateBitCast(values, f64->getPointerTo());
+        stack_.push_back({col.type,
+                          builder_.CreateLoad(f64, builder_.CreateInBoundsGEP(f64, typed, row_)),
+                          valid});
+        break;
+    }
+    case ColumnType::BOOL: {
+        llvm::Value* words = builder_.CreateBitCast(values, builder_.getInt64Ty()->getPointerTo());
+        stack_.push_back({col.type, bit(words, row_), valid});
+        break;
+    }
+    case ColumnType::STRING:
+        return false;
+    }
+    return true;
+}
+
+bool KernelBuilder::emit(const IRExpr::Instruction& instr, std::vector<int>& columns,
+                         std::vector<ColumnType>& column_types) {
+    using Op = IRExpr::OpCode;
+    auto& b = builder_;
+    llvm::Value* yes = b.getTrue();
+
+    // Arithmetic on two operands of type T: NULL op anything = NULL
+    auto arith = [&](ColumnType type, auto make) {
+        Operand rhs = pop();
+        Operand lhs = pop();
+        stack_.push_back({type, make(lhs.value, rhs.value), b.CreateAnd(lhs.valid, rhs.valid)});
+    };
+    // Comparisons are never NULL: NULL on either side is false
+    auto compare = [&](auto make) {
+        Operand rhs = pop();
+        Operand lhs = pop();
+        llvm::Value* valid = b.CreateAnd(lhs.valid, rhs.valid);
+        stack_.push_back(
+            {ColumnType::BOOL, b.CreateAnd(valid, make(lhs.value, rhs.value)), yes});
+    };
+    auto compare_const = [&](auto make, llvm::Value* literal) {
+        Operand lhs = pop();
+        stack_.push_back(
+            {ColumnType::BOOL, b.CreateAnd(lhs.valid, make(lhs.value, literal)), yes});
+    };
+    auto int_const = [&] { return b.getInt64(std::get<int64_t>(instr.operand)); };
+    auto double_const = [&] {
+        return llvm::ConstantFP::get(b.getDoubleTy(), std::get<double>(instr.operand));
+    };
+    using V = llvm::Value*;
+
+    switch (instr.op) {
+    case Op::PUSH_INT:
+        stack_.push_back({ColumnType::INT64, int_const(), yes});
+        return true;
+    case Op::PUSH_DOUBLE:
+        stack_.push_back({ColumnType::DOUBLE, double_const(), yes});
+        return true;
+    case Op::PUSH_BOOL:
+        stack_.push_back({ColumnType::BOOL, b.getInt1(std::get<bool>(instr.operand)), yes});
+        return true;
+    case Op::LOAD_COLUMN:
+        return load_column(std::get<int>(instr.operand), columns, column_types);
+
+    case Op::CAST_F64:
+        stack_.back().value = b.CreateSIToFP(stack_.back().value, b.getDoubleTy());
+        stack_.back().type = ColumnType::DOUBLE;
+        return true;
+
+    case Op::ADD_I64:
+        arith(ColumnType::INT64, [&](V x, V y) { return b.CreateAdd(x, y); });
+        return true;
+    case Op::SUB_I64:
+        arith(ColumnType::INT64, [&](V x, V y) { return b.CreateSub(x, y); });
+        return true;
+    case Op::MUL_I64:
+        arith(ColumnType::INT64, [&](V x, V y) { return b.CreateMul(x, y); });
+        return true;
+    case Op::ADD_F64:
+        arith(ColumnType::DOUBLE, [&](V x, V y) { return b.CreateFAdd(x, y); });
+        return true;
+    case Op::SUB_F64:
+        arith(ColumnType::DOUBLE, [&](V x, V y) { return b.CreateFSub(x, y); });
+        return true;
+    case Op::MUL_F64:
+        arith(ColumnType::DOUBLE, [&](V x, V y) { return b.CreateFMul(x, y); });
+        return true;
+
+    case Op::DIV_I64:
+    case Op::DIV_F64: {
+        // A zero divisor in a live, non-NULL row is an error; dead rows give 0
+        const bool ints = instr.op == Op::DIV_I64;
+        Operand rhs = pop();
+        Operand lhs = pop();
+        llvm::Value* valid = b.CreateAnd(lhs.valid, rhs.valid);
+        llvm::Value* live = b.CreateAnd(valid, active_row());
+        llvm::Value* zero = ints ? b.CreateICmpEQ(rhs.value, b.getInt64(0))
+                                 : b.CreateFCmpOEQ(rhs.value,
+                                                   llvm::ConstantFP::get(b.getDoubleTy(), 0.0));
+        llvm::Value* failed = b.CreateZExt(b.CreateAnd(zero, live), b.getInt64Ty());
+        b.CreateStore(b.CreateOr(b.CreateLoad(b.getInt64Ty(), error_), failed), error_);
+
+        llvm::Value* quotient;
+        if (ints) {
+            // Divide by 1 instead of 0 or -1 (INT64_MIN / -1 traps); -1 negates
+            llvm::Value* minus_one = b.CreateICmpEQ(rhs.value, b.getInt64(-1));
+            llvm::Value* divisor =
+                b.CreateSelect(b.CreateOr(zero, minus_one), b.getInt64(1), rhs.value);
+            quotient = b.CreateSelect(minus_one, b.CreateSub(b.getInt64(0), lhs.value),
+                                      b.CreateSDiv(lhs.value, divisor));
+        } else {
+            quotient = b.CreateFDiv(lhs.value, rhs.value);
+        }
+        llvm::Value* fallback = ints ? static_cast<llvm::Value*>(b.getInt64(0))
+                                     : llvm::ConstantFP::get(b.getDoubleTy(), 0.0);
+        quotient = b.CreateSelect(b.CreateAnd(live, b.CreateNot(zero)), quotient, fallback);
+        stack_.push_back({lhs.type, quotient, valid});
+        return true;
+    }
+
+    case Op::NEG_I64:
+        stack_.back().value = b.CreateNeg(stack_.back().value);
+        return true;
+    case Op::NEG_F64:
+        stack_.back().value = b.CreateFNeg(stack_.back().value);
+        return true;
+
+    case Op::EQ_I64:
+    case Op::EQ_BOOL:
+        compare([&](V x, V y) { return b.CreateICmpEQ(x, y); });
+        return true;
+    case Op::NEQ_I64:
+    case Op::NEQ_BOOL:
+        compare([&](V x, V y) { return b.CreateICmpNE(x, y); });
+        return true;
+    case Op::LT_I64:
+        compare([&](V x, V y) { return b.CreateICmpSLT(x, y); });
+        return true;
+    case Op::GT_I64:
+        compare([&](V x, V y) { return b.CreateICmpSGT(x, y); });
+        return true;
+    case Op::LTE_I64:
+        compare([&](V x, V y) { return b.CreateICmpSLE(x, y); });
+        return true;
+    case Op::GTE_I64:
+        compare([&](V x, V y) { return b.CreateICmpSGE(x, y); });
+        return true;
+    // Ordered comparisons, except !=, which is true for NaN (as in C++)
+    case Op::EQ_F64:
+        compare([&](V x, V y) { return b.CreateFCmpOEQ(x, y); });
+        return true;
+    case Op::NEQ_F64:
+        compare([&](V x, V y) { return b.CreateFCmpUNE(x, y); });
+        return true;
+    case Op::LT_F64:
+        compare([&](V x, V y) { return b.CreateFCmpOLT(x, y); });
+        return true;
+    case Op::GT_F64:
+        compare([&](V x, V y) { return b.CreateFCmpOGT(x, y); });
+        return true;
+    case Op::LTE_F64:
+        compare([&](V x, V y) { return b.CreateFCmpOLE(x, y); });
+        return true;
+    case Op::GTE_F64:
+        compare([&](V x, V y) { return b.CreateFCmpOGE(x, y); });
+        return true;
+
+    case Op::EQ_I64_CONST:
+        compare_const([&](V x, V y) { return b.CreateICmpEQ(x, y); }, int_const());
+        return true;
+    case Op::NEQ_I64_CONST:
+        compare_const([&](V x, V y) { return b.CreateICmpNE(x, y); }, int_const());
+        return true;
+    case Op::LT_I64_CONST:
+        compare_const([&](V x, V y) { return b.CreateICmpSLT(x, y); }, int_const());
+        return true;
+    case Op::GT_I64_CONST:
+        compare_const([&](V x, V y) { return b.CreateICmpSGT(x, y); }, int_const());
+        return true;
+    case Op::LTE_I64_CONST:
+        compare_const([&](V x, V y) { return b.CreateICmpSLE(x, y); }, int_const());
+        return true;
+    case Op::GTE_I64_CONST:
+        compare_const([&](V x, V y) { return b.CreateICmpSGE(x, y); }, int_const());
+        return true;
+    case Op::EQ_F64_CONST:
+        compare_const([&](V x, V y) { return b.CreateFCmpOEQ(x, y); }, double_const());
+        return true;
+    case Op::NEQ_F64_CONST:
+        compare_const([&](V x, V y) { return b.CreateFCmpUNE(x, y); }, double_const());
+        return true;
+    case Op::LT_F64_CONST:
+        compare_const([&](V x, V y) { return b.CreateFCmpOLT(x, y); }, double_const());
+        return true;
+    case Op::GT_F64_CONST:
+        compare_const([&](V x, V y) { return b.CreateFCmpOGT(x, y); }, double_const());
+        return true;
+    case Op::LTE_F64_CONST:
+        compare_const([&](V x, V y) { return b.CreateFCmpOLE(x, y); }, double_const());
+        return true;
+    case Op::GTE_F64_CONST:
+        compare_const([&](V x, V y) { return b.CreateFCmpOGE(x, y); }, double_const());
+        return true;
+
+    case Op::NOT: {
+        // NOT NULL is false
+        Operand x = pop();
+        llvm::Value* is_false = x.type == ColumnType::BOOL
+                                    ? b.CreateNot(x.value)
+                                    : b.CreateICmpEQ(x.value, b.getInt64(0));
+        stack_.push_back({ColumnType::BOOL, b.CreateAnd(x.valid, is_false), yes});
+        return true;
+    }
+    case Op::AND:
+    case Op::OR: {
+        Operand rhs = pop();
+        Operand lhs = pop();
+        llvm::Value* value = instr.op == Op::AND ? b.CreateAnd(truthy(lhs), truthy(rhs))
+                                                 : b.CreateOr(truthy(lhs), truthy(rhs));
+        stack_.push_back({ColumnType::BOOL, value, yes});
+        return true;
+    }
+
+    case Op::TERNARY: {
+        // Both branches are evaluated (as in the interpreters); select one
+        Operand f = pop();
+        Operand t = pop();
+        Operand cond = pop();
+        if (t.type != f.type) {
+            return false;
+        }
+        llvm::Value* take = truthy(cond);
+        stack_.push_back({t.type, b.CreateSelect(take, t.value, f.value),
+                          b.CreateSelect(take, t.valid, f.valid)});
+        return true;
+    }
+
+    default:
+        return false;  // Strings, and generic opcodes (row-dependent types)
+    }
+}
+
+bool KernelBuilder::build(const std::string& name, std::vector<int>& columns,
+                          std::vector<ColumnType>& column_types) {
+    if (!expr_.statically_typed || !expr_.type || *expr_.type == ColumnType::STRING) {
+        return false;
+    }
+    llvm::Type* i8 = builder_.getInt8Ty();
+    llvm::Type* i64 = builder_.getInt64Ty();
+    llvm::Type* ptr = builder_.getInt8PtrTy();
+    auto* type = llvm::FunctionType::get(
+        i64, {ptr->getPointerTo(), i64, i64, ptr, ptr, ptr}, false);
+    fn_ = llvm::Function::Create(type, llvm::Function::ExternalLinkage, name, module_);
+    for (unsigned arg : {3u, 4u, 5u}) {
+        fn_->addParamAttr(arg, llvm::Attribute::NoAlias);
+    }
+    columns_arg_ = fn_->getArg(0);
+    llvm::Value* begin = fn_->getArg(1);
+    llvm::Value* n = fn_->getArg(2);
+    active_arg_ = fn_->getArg(3);
+    llvm::Value* out_values = fn_->getArg(4);
+    llvm::Value* out_valid = fn_->getArg(5);
+
+    llvm::BasicBlock* entry = llvm::BasicBlock::Create(ctx_, "entry", fn_);
+    llvm::BasicBlock* loop = llvm::BasicBlock::Create(ctx_, "loop", fn_);
+    llvm::BasicBlock* exit = llvm::BasicBlock::Create(ctx_, "exit", fn_);
+
+    builder_.SetInsertPoint(entry);
+    error_ = builder_.CreateAlloca(i64);
+    builder_.CreateStore(builder_.getInt64(0), error_);
+    builder_.CreateCondBr(builder_.CreateICmpSGT(n, builder_.getInt64(0)), loop, exit);
+
+    builder_.SetInsertPoint(loop);
+    llvm::PHINode* i = builder_.CreatePHI(i64, 2);
+    i->addIncoming(builder_.getInt64(0), entry);
+    i_ = i;
+    row_ = builder_.CreateAdd(begin, i);
+    for (const auto& instr : expr_.instructions) {
+        if (!emit(instr, columns, column_types)) {
+            return false;
+        }
+    }
+    if (stack_.size() != 1 || stack_.back().type != *expr_.type) {
+        return false;
+    }
+
+    // Store the result; NULL rows hold the default value, like loaded columns
+    const Operand& result = stack_.back();
+    llvm::Value* value = result.value;
+    llvm::Type* value_type = value->getType();
+    if (result.type == ColumnType::BOOL) {
+        value = builder_.CreateZExt(value, i8);
+        value_type = i8;
+    }
+    value = builder_.CreateSelect(result.valid, value, llvm::Constant::getNullValue(value_type));
+    llvm::Value* typed_out = builder_.CreateBitCast(out_values, value_type->getPointerTo());
+    builder_.CreateStore(value, builder_.CreateInBoundsGEP(value_type, typed_out, i));
+    builder_.CreateStore(builder_.CreateZExt(result.valid, i8),
+                         builder_.CreateInBoundsGEP(i8, out_valid, i));
+
+    llvm::Value* next = builder_.CreateAdd(i, builder_.getInt64(1));
+    i->addIncoming(next, builder_.GetInsertBlock());
+    builder_.CreateCondBr(builder_.CreateICmpSLT(next, n), loop, exit);
+
+    builder_.SetInsertPoint(exit);
+    builder_.CreateRet(builder_.CreateLoad(i64, error_));
+    return !llvm::verifyFunction(*fn_);
+}
+
+}  // namespace
+
+// ============================================================================
+// Compilation (LLVM ORC)
+// ============================================================================
+
+struct ExpressionJit::Impl {
+    std::unique_ptr<llvm::orc::LLJIT> jit;
+    std::unique_ptr<llvm::TargetMachine> target;  // Drives the vectorizer's cost model
+    size_t next_kernel = 0;
+    std::mutex mutex;
+};
+
+ExpressionJit::ExpressionJit() : impl_(std::make_unique<Impl>()) {
+    static std::once_flag init;
+    static bool targets_ready = false;
+    std::call_once(init, [] {
+        targets_ready =
+            !llvm::InitializeNativeTarget() && !llvm::InitializeNativeTargetAsmPrinter();
+    });
+    if (!targets_ready) {
+        return;
+    }
+
+    auto host = llvm::orc::JITTargetMachineBuilder::detectHost();
+    if (!host) {
+        llvm::consumeError(host.takeError());
+        return;
+    }
+    host->setCodeGenOptLevel(llvm::CodeGenOpt::Aggressive);
+    auto target = host->createTargetMachine();
+    if (!target) {
+        llvm::consumeError(target.takeError());
+        return;
+    }
+    auto jit = llvm::orc::LLJITBuilder().setJITTargetMachineBuilder(std::move(*host)).create();
+    if (!jit) {
+        llvm::consumeError(jit.takeError());
+        return;
+    }
+    // Kernels may call libc (the optimizer turns store loops into memset)
+    auto process = llvm::orc::DynamicLibrarySearchGenerator::GetForCurrentProcess(
+        (*jit)->getDataLayout().getGlobalPrefix());
+    if (!process) {
+        llvm::consumeError(process.takeError());
+        return;
+    }
+    (*jit)->getMainJITDylib().addGenerator(std::move(*process));
+    impl_->target = std::move(*target);
+    impl_->jit = std::move(*jit);
+}
+
+ExpressionJit::~ExpressionJit() = default;
+
+bool ExpressionJit::available() const {
+    return impl_->jit != nullptr;
+}
+
+std::unique_ptr<JitKernel> ExpressionJit::compile(const IRExpr& expr, const Table& table) {
+    if (!available()) {
+        return nullptr;
+    }
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+
+    auto ctx = std::make_unique<llvm::LLVMContext>();
+    const std::string name = "joy_kernel_" + std::to_string(impl_->next_kernel++);
+    auto module = std::make_unique<llvm::Module>(name, *ctx);
+    module->setDataLayout(impl_->jit->getDataLayout());
+    module->setTargetTriple(impl_->target->getTargetTriple().str());
+
+    std::unique_ptr<JitKernel> kernel(new JitKernel());
+    KernelBuilder builder(*ctx, *module, expr, table);
+    if (!builder.build(name, kernel->columns_, kernel->column_types_)) {
+        return nullptr;
+    }
+
+    // Standard -O3 pipeline (includes loop and SLP vectorization)
+    {
+        llvm::LoopAnalysisManager lam;
+        llvm::FunctionAnalysisManager fam;
+        llvm::CGSCCAnalysisManager cgam;
+        llvm::ModuleAnalysisManager mam;
+        llvm::PassBuilder passes(impl_->target.get());
+        passes.registerModuleAnalyses(mam);
+        passes.registerCGSCCAnalyses(cgam);
+        passes.registerFunctionAnalyses(fam);
+        passes.registerLoopAnalyses(lam);
+        passes.crossRegisterProxies(lam, fam, cgam, mam);
+        passes.buildPerModuleDefaultPipeline(llvm::OptimizationLevel::O3).run(*module, mam);
+    }
+
+    auto tracker = impl_->jit->getMainJITDylib().createResourceTracker();
+    if (auto error = impl_->jit->addIRModule(
+            tracker, llvm::orc::ThreadSafeModule(std::move(module), std::move(ctx)))) {
+        llvm::consumeError(std::move(error));
+        return nullptr;
+    }
+    auto symbol = impl_->jit->lookup(name);
+    if (!symbol) {
+        llvm::consumeError(symbol.takeError());
+        llvm::consumeError(tracker->remove());
+        return nullptr;
+    }
+
+    kernel->code_ = std::make_unique<JitKernel::Code>();
+    kernel->code_->fn = reinterpret_cast<KernelFn>(symbol->getAddress());
+    kernel->code_->release = [tracker] { llvm::consumeError(tracker->remove()); };
+    kernel->result_type_ = *expr.type;
+    return kernel;
+}
+
+#else  // !JOY_HAVE_JIT
+
+// Built without LLVM: every expression stays on the interpreter
+
+struct ExpressionJit::Impl {};
+
+ExpressionJit::ExpressionJit() : impl_(std::make_unique<Impl>()) {}
+
+ExpressionJit::~ExpressionJit() = default;
+
+bool ExpressionJit::available() const {
+    return false;
+}
+
+std::unique_ptr<JitKernel> ExpressionJit::compile(const IRExpr&, const Table&) {
+    return nullptr;
+}
+
+#endif
+
+}  // namespace joy
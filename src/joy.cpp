@@ -0,0 +1,154 @@
+#include "joy.hpp"
+
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+
+#include "compiler.hpp"
+#include "lexer.hpp"
+#include "optimizer.hpp"
+#include "parser.hpp"
+
+namespace joy {
+
+// ============================================================================
+// Query
+// ============================================================================
+
+Query Query::compile(const std::string& source) {
+    Lexer lexer(source);
+    Parser parser(lexer.tokenize());
+    Program program = parser.parse();
+    ExecutionPlan plan = Optimizer().optimize(Compiler().compile(program));
+    return Query(std::make_shared<const ExecutionPlan>(std::move(plan)));
+}
+
+// ============================================================================
+// Table Input
+// ============================================================================
+
+TableReader::TableReader(Table table, const std::vector<DeclaredColumn>* schema)
+    : table_(std::move(table)), num_rows_(table_.num_rows) {
+    for (const auto& col : table_.columns) {
+        if (col.size() != num_rows_) {
+            throw std::runtime_error("Column " + col.name + " of the input table has " +
+                                     std::to_string(col.size()) + " rows instead of " +
+                                     std::to_string(num_rows_));
+        }
+        names_.push_back(col.name);
+        types_.push_back(col.type);
+        inferred_.push_back(true);
+    }
+    if (!schema) {
+        return;
+    }
+    for (const auto& decl : *schema) {
+        const Column* col = table_.get_column(decl.name);
+        if (!col) {
+            throw std::runtime_error("Column " + decl.name + " of the schema is not in the input");
+        }
+        if (col->type != decl.type) {
+            throw std::runtime_error("Column " + decl.name + " in the input is " +
+                                     column_type_name(col->type) + ", but the schema declares " +
+                                     column_type_name(decl.type));
+        }
+    }
+}
+
+bool TableReader::next_batch(Table& out, size_t max_rows) {
+    if (started_ && next_row_ >= num_rows_) {
+        return false;
+    }
+    started_ = true;
+    const size_t n = std::min(max_rows, num_rows_ - next_row_);
+    if (n == num_rows_) {
+        out = std::move(table_);  // The whole table is one batch: no copy
+    } else {
+        std::vector<uint32_t> rows(n);
+        std::iota(rows.begin(), rows.end(), static_cast<uint32_t>(next_row_));
+        out = table_.gather(rows);
+    }
+    next_row_ += n;
+    return true;
+}
+
+// ============================================================================
+// Session
+// ============================================================================
+
+// Helper: A WRITE's batches handed to a callback
+class CallbackWriter : public BatchWriter {
+public:
+    explicit CallbackWriter(const BatchCallback& callback) : callback_(callback) {}
+
+    void write(const Table& batch) override {
+        callback_(batch);
+    }
+
+private:
+    const BatchCallback& callback_;
+};
+
+// Helper: A reader the caller owns (the VM owns the readers it is given)
+class BorrowedReader : public BatchReader {
+public:
+    explicit BorrowedReader(BatchReader& reader) : reader_(reader) {}
+
+    bool next_batch(Table& out, size_t max_rows) override {
+        return reader_.next_batch(out, max_rows);
+    }
+    const std::vector<std::string>& column_names() const override {
+        return reader_.column_names();
+    }
+    const std::vector<ColumnType>& column_types() const override {
+        return reader_.column_types();
+    }
+    const std::vector<bool>& inferred_types() const override {
+        return reader_.inferred_types();
+    }
+
+private:
+    BatchReader& reader_;
+};
+
+void Session::execute(const Query& query, ExecutionIO io, const Outputs& outputs) {
+    std::vector<std::unique_ptr<CallbackWriter>> writers;
+    for (const auto& [filepath, callback] : outputs) {
+        writers.push_back(std::make_unique<CallbackWriter>(callback));
+        io.outputs[filepath] = writers.back().get();
+    }
+    vm_.execute(query.plan_, io);
+}
+
+void Session::run(const Query& query, const Outputs& outputs) {
+    execute(query, {}, outputs);
+}
+
+void Session::run(const Query& query, Table input, const Outputs& outputs) {
+    ExecutionIO io;
+    io.input = [&input](const PhysicalOp::ScanOp& scan, ThreadPool*) {
+        return std::make_unique<TableReader>(std::move(input),
+                                             scan.schema.empty() ? nullptr : &scan.schema);
+    };
+    execute(query, std::move(io), outputs);
+}
+
+void Session::run_csv(const Query& query, std::string_view csv, const Outputs& outputs) {
+    ExecutionIO io;
+    io.input = [csv](const PhysicalOp::ScanOp& scan, ThreadPool* pool) {
+        return std::make_unique<CsvReader>(csv, "CSV input", pool,
+                                           scan.columns ? &*scan.columns : nullptr,
+                                           scan.schema.empty() ? nullptr : &scan.schema);
+    };
+    execute(query, std::move(io), outputs);
+}
+
+void Session::run(const Query& query, BatchReader& input, const Outputs& outputs) {
+    ExecutionIO io;
+    io.input = [&input](const PhysicalOp::ScanOp&, ThreadPool*) {
+        return std::make_unique<BorrowedReader>(input);
+    };
+    execute(query, std::move(io), outputs);
+}
+
+}  // namespace joy
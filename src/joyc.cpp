@@ -0,0 +1,492 @@
+#include "joyc.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#include "thread_pool.hpp"
+
+namespace joy {
+
+constexpr char kJoycMagic[4] = {'J', 'O', 'Y', 'C'};
+constexpr size_t kJoycHeaderBytes = 8;    // Magic + version
+constexpr size_t kJoycTrailerBytes = 12;  // Footer offset + magic
+
+// Batches with fewer rows are decoded on the calling thread
+constexpr size_t kMinParallelDecodeRows = 16 * 1024;
+
+// Stored zone (INT64/DOUBLE buffer [2]): min and max as the column's type, null count
+constexpr size_t kJoycZoneBytes = 24;
+
+// Problem: the file path, or what is wrong once the reader is running
+[[noreturn]] static void corrupt(const std::string& what) {
+    throw std::runtime_error("Corrupt joyc file: " + what);
+}
+
+// Helper: Append a fixed-size value to a byte string (host byte order)
+template <typename T>
+static void put(std::string& out, T value) {
+    out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+// Helper: Bounds-checked reads from the footer
+struct FooterCursor {
+    const char* data;
+    size_t size;
+    const std::string& filepath;
+    size_t pos = 0;
+
+    template <typename T>
+    T get() {
+        if (size - pos < sizeof(T))
+            corrupt(filepath);
+        T value;
+        std::memcpy(&value, data + pos, sizeof(T));
+        pos += sizeof(T);
+        return value;
+    }
+
+    std::string_view bytes(size_t n) {
+        if (size - pos < n)
+            corrupt(filepath);
+        std::string_view s(data + pos, n);
+        pos += n;
+        return s;
+    }
+};
+
+// ============================================================================
+// Writer
+// ============================================================================
+
+JoycWriter::JoycWriter(const std::string& filepath)
+    : filepath_(filepath), file_(filepath, std::ios::binary) {
+    if (!file_) {
+        throw std::runtime_error("Cannot create file: " + filepath);
+    }
+    std::string header(kJoycMagic, sizeof(kJoycMagic));
+    put<uint32_t>(header, kJoycVersion);
+    file_.write(header.data(), static_cast<std::streamsize>(header.size()));
+    pos_ = header.size();
+}
+
+// A pipeline that fails part-way still leaves a readable file with the
+// chunks written so far
+JoycWriter::~JoycWriter() {
+    if (!closed_) {
+        try {
+            close();
+        } catch (...) {
+        }
+    }
+}
+
+JoycBuffer JoycWriter::write_buffer(const void* data, size_t size) {
+    static const char zeros[kJoycAlignment] = {};
+    size_t pad = (kJoycAlignment - pos_ % kJoycAlignment) % kJoycAlignment;
+    file_.write(zeros, static_cast<std::streamsize>(pad));
+    pos_ += pad;
+
+    JoycBuffer buf{pos_, size};
+    file_.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+    pos_ += size;
+    return buf;
+}
+
+// Each column is written as its in-memory buffers: no formatting, and
+// dictionary-encoded strings keep their dictionary and codes
+void JoycWriter::write(const Table& batch) {
+    if (!schema_known_) {
+        for (const auto& col : batch.columns)
+            columns_.push_back({col.name, col.type});
+        schema_known_ = true;
+    } else if (batch.columns.size() != columns_.size()) {
+        throw std::runtime_error("Cannot append tables with different schemas");
+    }
+    if (batch.num_rows == 0) {
+        return;
+    }
+
+    std::vector<JoycColumnChunk> chunk(columns_.size());
+    for (size_t c = 0; c < columns_.size(); ++c) {
+        const Column& col = batch.columns[c];
+        ColumnInfo& info = columns_[c];
+        if (col.type != info.type) {
+            throw std::runtime_error("Cannot append column " + col.name + ": type mismatch");
+        }
+        info.has_values |= col.validity.count() > 0;
+
+        JoycColumnChunk& out = chunk[c];
+        out.buffers[0] =
+            write_buffer(col.validity.words(), col.validity.num_words() * sizeof(uint64_t));
+        std::visit(
+            [&](const auto& data) {
+                using Vec = std::decay_t<decltype(data)>;
+                if constexpr (std::is_same_v<Vec, DictStrings> ||
+                              std::is_same_v<Vec, StringArena>) {
+                    // Offsets + bytes of the dictionary (DICT) or of the values (PLAIN)
+                    std::vector<uint64_t> offsets{0};
+                    std::string bytes;
+                    auto add = [&](std::string_view s) {
+                        bytes.append(s.data(), s.size());
+                        offsets.push_back(bytes.size());
+                    };
+                    if constexpr (std::is_same_v<Vec, DictStrings>) {
+                        out.encoding = JoycEncoding::DICT;
+                        for (size_t code = 0; code < data.dict->size(); ++code)
+                            add(data.dict->get(static_cast<int32_t>(code)));
+                    } else {
+                        for (size_t i = 0; i < data.size(); ++i)
+                            add(data.get(i));
+                    }
+                    out.buffers[1] =
+                        write_buffer(offsets.data(), offsets.size() * sizeof(uint64_t));
+                    out.buffers[2] = write_buffer(bytes.data(), bytes.size());
+                    if constexpr (std::is_same_v<Vec, DictStrings>) {
+                        out.buffers[3] =
+                            write_buffer(data.codes.data(), data.codes.size() * sizeof(int32_t));
+                    }
+                } else if constexpr (std::is_same_v<Vec, Bitmap>) {
+                    out.buffers[1] =
+                        write_buffer(data.words(), data.num_words() * sizeof(uint64_t));
+                } else {
+                    out.buffers[1] =
+                        write_buffer(data.data(), data.size() * sizeof(typename Vec::value_type));
+                    // Zone map of the chunk (the reader's, if it still fits)
+                    std::shared_ptr<const ZoneMap> built;
+                    const ZoneMap* zones = col.zone_map();
+                    if (!zones) {
+                        built = build_zone_map(col);
+                        zones = built.get();
+                    }
+                    std::string bytes;
+                    for (size_t z = 0; z < zones->num_zones(); ++z) {
+                        if constexpr (std::is_same_v<Vec, std::vector<int64_t>>) {
+                            put<int64_t>(bytes, zones->int_min[z]);
+                            put<int64_t>(bytes, zones->int_max[z]);
+                        } else {
+                            put<double>(bytes, zones->double_min[z]);
+                            put<double>(bytes, zones->double_max[z]);
+                        }
+                        put<uint64_t>(bytes, zones->null_counts[z]);
+                    }
+                    out.buffers[2] = write_buffer(bytes.data(), bytes.size());
+                }
+            },
+            col.data);
+    }
+    chunk_rows_.push_back(batch.num_rows);
+    chunks_.push_back(std::move(chunk));
+
+    if (!file_) {
+        throw std::runtime_error("Failed to write file: " + filepath_);
+    }
+}
+
+void JoycWriter::close() {
+    closed_ = true;
+
+    std::string footer;
+    put<uint32_t>(footer, static_cast<uint32_t>(columns_.size()));
+    for (const auto& info : columns_) {
+        put<uint32_t>(footer, static_cast<uint32_t>(info.name.size()));
+        footer += info.name;
+        put<uint8_t>(footer, static_cast<uint8_t>(info.type));
+        put<uint8_t>(footer, info.has_values ? 1 : 0);
+    }
+    put<uint64_t>(footer, chunks_.size());
+    for (size_t k = 0; k < chunks_.size(); ++k) {
+        put<uint64_t>(footer, chunk_rows_[k]);
+        for (const auto& col : chunks_[k]) {
+            put<uint8_t>(footer, static_cast<uint8_t>(col.encoding));
+            for (const auto& buf : col.buffers) {
+                put<uint64_t>(footer, buf.offset);
+                put<uint64_t>(footer, buf.size);
+            }
+        }
+    }
+    put<uint64_t>(footer, pos_);  // Footer offset
+    footer.append(kJoycMagic, sizeof(kJoycMagic));
+
+    file_.write(footer.data(), static_cast<std::streamsize>(footer.size()));
+    file_.close();
+    if (file_.fail()) {
+        throw std::runtime_error("Failed to write file: " + filepath_);
+    }
+}
+
+// ============================================================================
+// Reader
+// ============================================================================
+
+JoycReader::JoycReader(const std::string& filepath, ThreadPool* pool,
+                       const std::vector<std::string>* columns)
+    : file_(filepath), pool_(pool) {
+    const char* data = file_.data();
+    const size_t size = file_.size();
+    if (size < kJoycHeaderBytes + kJoycTrailerBytes ||
+        std::memcmp(data, kJoycMagic, sizeof(kJoycMagic)) != 0 ||
+        std::memcmp(data + size - sizeof(kJoycMagic), kJoycMagic, sizeof(kJoycMagic)) != 0) {
+        throw std::runtime_error("Not a joyc file: " + filepath);
+    }
+    uint32_t version;
+    std::memcpy(&version, data + sizeof(kJoycMagic), sizeof(version));
+    if (version != kJoycVersion && version != 1) {  // Version 1 has no zone maps
+        throw std::runtime_error("Unsupported joyc version " + std::to_string(version) + ": " +
+                                 filepath);
+    }
+    uint64_t footer_offset;
+    std::memcpy(&footer_offset, data + size - kJoycTrailerBytes, sizeof(footer_offset));
+    if (footer_offset < kJoycHeaderBytes || footer_offset > size - kJoycTrailerBytes) {
+        corrupt(filepath);
+    }
+    FooterCursor in{data + footer_offset, size - kJoycTrailerBytes - footer_offset, filepath};
+
+    // Schema
+    const uint32_t num_columns = in.get<uint32_t>();
+    std::vector<ColumnType> file_types;
+    for (uint32_t c = 0; c < num_columns; ++c) {
+        std::string name(in.bytes(in.get<uint32_t>()));
+        uint8_t type = in.get<uint8_t>();
+        bool has_values = in.get<uint8_t>() != 0;
+        if (type > static_cast<uint8_t>(ColumnType::BOOL)) {
+            corrupt(filepath);
+        }
+        file_types.push_back(static_cast<ColumnType>(type));
+        if (!columns || std::find(columns->begin(), columns->end(), name) != columns->end()) {
+            headers_.push_back(std::move(name));
+            fields_.push_back(c);
+            types_.push_back(file_types.back());
+            inferred_.push_back(has_values);
+        }
+    }
+
+    // Chunk directory: every buffer must lie in the data area, with the size
+    // its type and row count imply
+    const uint64_t num_chunks = in.get<uint64_t>();
+    for (uint64_t k = 0; k < num_chunks; ++k) {
+        Chunk chunk;
+        chunk.num_rows = in.get<uint64_t>();
+        const uint64_t rows = chunk.num_rows;
+        const uint64_t bitmap_bytes = (rows + 63) / 64 * sizeof(uint64_t);
+        for (uint32_t c = 0; c < num_columns; ++c) {
+            JoycColumnChunk col;
+            uint8_t encoding = in.get<uint8_t>();
+            if (encoding > static_cast<uint8_t>(JoycEncoding::DICT)) {
+                corrupt(filepath);
+            }
+            col.encoding = static_cast<JoycEncoding>(encoding);
+            for (auto& buf : col.buffers) {
+                buf.offset = in.get<uint64_t>();
+                buf.size = in.get<uint64_t>();
+                if (buf.offset % kJoycAlignment != 0 || buf.offset > footer_offset ||
+                    buf.size > footer_offset - buf.offset) {
+                    corrupt(filepath);
+                }
+                chunk.end = std::max(chunk.end, buf.offset + buf.size);
+            }
+
+            const auto& b = col.buffers;
+            bool valid = b[0].size == bitmap_bytes;
+            switch (file_types[c]) {
+            case ColumnType::INT64:
+            case ColumnType::DOUBLE:
+                valid &= col.encoding == JoycEncoding::PLAIN && b[1].size == rows * 8 &&
+                         (b[2].size == 0 ||
+                          b[2].size == (rows + kZoneRows - 1) / kZoneRows * kJoycZoneBytes);
+                break;
+            case ColumnType::BOOL:
+                valid &= col.encoding == JoycEncoding::PLAIN && b[1].size == bitmap_bytes;
+                break;
+            case ColumnType::STRING:
+                if (col.encoding == JoycEncoding::PLAIN) {
+                    valid &= b[1].size == (rows + 1) * sizeof(uint64_t);
+                } else {
+                    valid &= b[1].size >= sizeof(uint64_t) && b[1].size % sizeof(uint64_t) == 0 &&
+                             b[3].size == rows * sizeof(int32_t);
+                }
+                break;
+            }
+            if (!valid) {
+                corrupt(filepath);
+            }
+            chunk.columns.push_back(col);
+        }
+        chunk.dicts.resize(num_columns);
+        chunks_.push_back(std::move(chunk));
+    }
+}
+
+void JoycReader::append_rows(Column& col, Chunk& chunk, size_t field, size_t begin,
+                             size_t count) {
+    const JoycColumnChunk& src = chunk.columns[field];
+    const auto* validity = reinterpret_cast<const uint64_t*>(buffer(src.buffers[0]));
+    col.validity.append_bits(validity, begin, count);
+
+    switch (col.type) {
+    case ColumnType::INT64: {
+        const auto* values = reinterpret_cast<const int64_t*>(buffer(src.buffers[1]));
+        auto& dst = col.values<int64_t>();
+        dst.insert(dst.end(), values + begin, values + begin + count);
+        return;
+    }
+    case ColumnType::DOUBLE: {
+        const auto* values = reinterpret_cast<const double*>(buffer(src.buffers[1]));
+        auto& dst = col.values<double>();
+        dst.insert(dst.end(), values + begin, values + begin + count);
+        return;
+    }
+    case ColumnType::BOOL:
+        std::get<Bitmap>(col.data).append_bits(
+            reinterpret_cast<const uint64_t*>(buffer(src.buffers[1])), begin, count);
+        return;
+    case ColumnType::STRING:
+        break;
+    }
+
+    // Strings: offsets into a byte buffer, either of the values themselves
+    // (PLAIN) or of a dictionary indexed by per-row codes (DICT)
+    const auto* offsets = reinterpret_cast<const uint64_t*>(buffer(src.buffers[1]));
+    const char* bytes = buffer(src.buffers[2]);
+    auto string_at = [&](size_t i) {
+        if (offsets[i + 1] < offsets[i] || offsets[i + 1] > src.buffers[2].size)
+            corrupt("offsets out of range");
+        return std::string_view(bytes + offsets[i], offsets[i + 1] - offsets[i]);
+    };
+    auto present = [&](size_t r) { return (validity[r >> 6] >> (r & 63)) & 1; };
+    auto* dst_dict = std::get_if<DictStrings>(&col.data);
+    auto append = [&](size_t r, std::string_view s) {
+        if (dst_dict) {
+            if (present(r))
+                dst_dict->push_back(s);
+            else
+                dst_dict->push_null();
+        } else {
+            std::get<StringArena>(col.data).push_back(present(r) ? s : std::string_view());
+        }
+    };
+
+    if (src.encoding == JoycEncoding::PLAIN) {
+        for (size_t r = begin; r < begin + count; ++r)
+            append(r, string_at(r));
+        return;
+    }
+
+    auto& dict = chunk.dicts[field];
+    const size_t dict_size = src.buffers[1].size / sizeof(uint64_t) - 1;
+    if (!dict) {
+        dict = std::make_shared<StringDictionary>();
+        for (size_t code = 0; code < dict_size; ++code) {
+            if (dict->intern(string_at(code)) != static_cast<int32_t>(code))
+                corrupt("duplicate dictionary entry");
+        }
+    }
+    const auto* codes = reinterpret_cast<const int32_t*>(buffer(src.buffers[3]));
+    for (size_t r = begin; r < begin + count; ++r) {
+        if (present(r) && (codes[r] < 0 || static_cast<size_t>(codes[r]) >= dict_size))
+            corrupt("dictionary code out of range");
+    }
+
+    if (dst_dict && (dst_dict->dict == dict || dst_dict->codes.empty())) {
+        // Same dictionary: the codes are copied as they are
+        dst_dict->dict = dict;
+        for (size_t r = begin; r < begin + count; ++r)
+            dst_dict->codes.push_back(present(r) ? codes[r] : 0);
+        return;
+    }
+    for (size_t r = begin; r < begin + count; ++r)
+        append(r, present(r) ? dict->get(codes[r]) : std::string_view());
+}
+
+// Zones of a decoded batch column: a zone that lines up with a zone stored in
+// its chunk is copied, any other (batches cut mid-zone, version 1 files) is
+// computed from the values
+std::shared_ptr<const ZoneMap> JoycReader::zone_map(const Column& col, size_t field,
+                                                    const std::vector<Piece>& pieces) const {
+    auto zones = std::make_shared<ZoneMap>();
+    zones->resize(col.type, col.size());
+    size_t piece = 0;
+    size_t piece_start = 0;  // Batch row of the piece's first row
+    for (size_t z = 0; z < zones->num_zones(); ++z) {
+        const size_t begin = z * kZoneRows;
+        const size_t rows = std::min(kZoneRows, col.size() - begin);
+        while (begin >= piece_start + pieces[piece].count) {
+            piece_start += pieces[piece++].count;
+        }
+        const Chunk& chunk = chunks_[pieces[piece].chunk];
+        const JoycBuffer& stored = chunk.columns[field].buffers[2];
+        const size_t row = pieces[piece].begin + (begin - piece_start);  // Chunk row
+        if (stored.size == 0 || row % kZoneRows != 0 ||
+            begin + rows > piece_start + pieces[piece].count ||
+            rows != std::min<size_t>(kZoneRows, chunk.num_rows - row)) {
+            compute_zone(col, z, *zones);
+            continue;
+        }
+        const char* p = buffer(stored) + row / kZoneRows * kJoycZoneBytes;
+        if (col.type == ColumnType::INT64) {
+            std::memcpy(&zones->int_min[z], p, 8);
+            std::memcpy(&zones->int_max[z], p + 8, 8);
+        } else {
+            std::memcpy(&zones->double_min[z], p, 8);
+            std::memcpy(&zones->double_max[z], p + 8, 8);
+        }
+        uint64_t null_count;
+        std::memcpy(&null_count, p + 16, 8);
+        zones->null_counts[z] = static_cast<uint32_t>(std::min<uint64_t>(null_count, rows));
+    }
+    return zones;
+}
+
+bool JoycReader::next_batch(Table& out, size_t max_rows) {
+    if (started_ && chunk_ == chunks_.size()) {
+        return false;
+    }
+    started_ = true;
+
+    // Rows of the batch: a run of pieces, each a row range of one chunk
+    std::vector<Piece> pieces;
+    size_t rows = 0;
+    while (chunk_ < chunks_.size() && rows < max_rows) {
+        const Chunk& chunk = chunks_[chunk_];
+        size_t count = std::min<size_t>(chunk.num_rows - row_, max_rows - rows);
+        pieces.push_back({chunk_, row_, count});
+        rows += count;
+        row_ += count;
+        if (row_ == chunk.num_rows) {
+            chunk_++;
+            row_ = 0;
+        }
+    }
+
+    out = Table{};
+    out.num_rows = rows;
+    out.columns.resize(headers_.size());
+    auto decode_column = [&](size_t c) {
+        const size_t field = fields_[c];
+        bool dict = !pieces.empty() &&
+                    chunks_[pieces.front().chunk].columns[field].encoding == JoycEncoding::DICT;
+        Column col = dict ? Column::make_dict(headers_[c]) : Column::make(headers_[c], types_[c]);
+        col.reserve(rows);
+        for (const auto& piece : pieces)
+            append_rows(col, chunks_[piece.chunk], field, piece.begin, piece.count);
+        if (col.type == ColumnType::INT64 || col.type == ColumnType::DOUBLE) {
+            col.zones = zone_map(col, field, pieces);
+        }
+        out.columns[c] = std::move(col);
+    };
+    if (pool_ && headers_.size() > 1 && rows >= kMinParallelDecodeRows) {
+        pool_->parallel_for(headers_.size(), decode_column);
+    } else {
+        for (size_t c = 0; c < headers_.size(); ++c)
+            decode_column(c);
+    }
+
+    // Chunks are laid out in order, so everything before the current chunk is done
+    if (chunk_ > 0) {
+        chunks_[chunk_ - 1].dicts.clear();
+        file_.discard_before(chunks_[chunk_ - 1].end);
+    }
+    return true;
+}
+
+}  // namespace joy
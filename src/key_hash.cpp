@@ -0,0 +1,119 @@
+#include "key_hash.hpp"
+
+#include <cstring>
+#include <functional>
+#include <string_view>
+
+namespace joy {
+
+// ============================================================================
+// Hash Functions
+// ============================================================================
+
+static uint64_t mix(uint64_t h) {
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+static uint64_t combine(uint64_t seed, uint64_t value) {
+    return mix(seed ^ (value + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2)));
+}
+
+constexpr uint64_t kNullHash = 0x6a09e667f3bcc909ULL;
+
+static uint64_t hash_double(double d) {
+    if (d == 0.0)
+        d = 0.0;  // -0.0 == 0.0, so both must hash alike
+    uint64_t bits;
+    std::memcpy(&bits, &d, sizeof(bits));
+    return bits;
+}
+
+static uint64_t hash_string(std::string_view s) {
+    return std::hash<std::string_view>{}(s);
+}
+
+// ============================================================================
+// Key Hashing
+// ============================================================================
+
+std::vector<uint64_t> dictionary_hashes(const Column& col) {
+    std::vector<uint64_t> hashes;
+    if (const auto* dict = std::get_if<DictStrings>(&col.data)) {
+        hashes.reserve(dict->dict->size());
+        for (size_t c = 0; c < dict->dict->size(); ++c)
+            hashes.push_back(hash_string(dict->dict->get(static_cast<int32_t>(c))));
+    }
+    return hashes;
+}
+
+void hash_keys(const std::vector<const Column*>& keys,
+               const std::vector<std::vector<uint64_t>>& dict_hashes, size_t begin, size_t end,
+               std::vector<uint64_t>& out) {
+    out.assign(end - begin, 0);
+    for (size_t k = 0; k < keys.size(); ++k) {
+        const Column& col = *keys[k];
+        const auto* dict = std::get_if<DictStrings>(&col.data);
+        for (size_t r = begin; r < end; ++r) {
+            uint64_t h = 0;
+            if (col.is_null(r)) {
+                h = kNullHash;
+            } else {
+                switch (col.type) {
+                case ColumnType::INT64:
+                    h = static_cast<uint64_t>(col.values<int64_t>()[r]);
+                    break;
+                case ColumnType::DOUBLE:
+                    h = hash_double(col.values<double>()[r]);
+                    break;
+                case ColumnType::STRING:
+                    h = dict ? dict_hashes[k][dict->codes[r]] : hash_string(col.get_string(r));
+                    break;
+                case ColumnType::BOOL:
+                    h = col.get_bool(r) ? 1 : 0;
+                    break;
+                }
+            }
+            out[r - begin] = combine(out[r - begin], h);
+        }
+    }
+}
+
+bool keys_equal(const std::vector<const Column*>& keys_a, size_t a,
+                const std::vector<const Column*>& keys_b, size_t b) {
+    for (size_t k = 0; k < keys_a.size(); ++k) {
+        const Column& x = *keys_a[k];
+        const Column& y = *keys_b[k];
+        bool x_null = x.is_null(a);
+        bool y_null = y.is_null(b);
+        if (x_null || y_null) {
+            if (x_null != y_null)
+                return false;
+            continue;
+        }
+        bool equal = false;
+        switch (x.type) {
+        case ColumnType::INT64:
+            equal = x.values<int64_t>()[a] == y.values<int64_t>()[b];
+            break;
+        case ColumnType::DOUBLE:
+            equal = x.values<double>()[a] == y.values<double>()[b];
+            break;
+        case ColumnType::STRING:
+            equal = x.get_string(a) == y.get_string(b);
+            break;
+        case ColumnType::BOOL:
+            equal = x.get_bool(a) == y.get_bool(b);
+            break;
+        }
+        if (!equal)
+            return false;
+    }
+    return true;
+}
+
+}  // namespace joy
@@ -15,6 +15,12 @@ static const std::unordered_map<std::string, TokenType> keywords = {
     {"from", TokenType::FROM},       {"filter", TokenType::FILTER},
     {"select", TokenType::SELECT},   {"write", TokenType::WRITE},
     {"transform", TokenType::TRANSFORM}, {"not", TokenType::NOT},
+    {"and", TokenType::AND},         {"or", TokenType::OR},
+    {"group", TokenType::GROUP},     {"by", TokenType::BY},
+    {"aggregate", TokenType::AGGREGATE}, {"join", TokenType::JOIN},
+    {"on", TokenType::ON},           {"sort", TokenType::SORT},
+    {"limit", TokenType::LIMIT},     {"asc", TokenType::ASC},
+    {"desc", TokenType::DESC},       {"schema", TokenType::SCHEMA},
 };
 
 // ============================================================================
@@ -329,8 +335,32 @@ const char* token_type_to_string(TokenType type) {
         return "SELECT";
     case TokenType::WRITE:
         return "WRITE";
+    case TokenType::GROUP:
+        return "GROUP";
+    case TokenType::BY:
+        return "BY";
+    case TokenType::AGGREGATE:
+        return "AGGREGATE";
+    case TokenType::JOIN:
+        return "JOIN";
+    case TokenType::ON:
+        return "ON";
+    case TokenType::SORT:
+        return "SORT";
+    case TokenType::LIMIT:
+        return "LIMIT";
+    case TokenType::ASC:
+        return "ASC";
+    case TokenType::DESC:
+        return "DESC";
+    case TokenType::SCHEMA:
+        return "SCHEMA";
     case TokenType::NOT:
         return "NOT";
+    case TokenType::AND:
+        return "AND";
+    case TokenType::OR:
+        return "OR";
     case TokenType::IDENT:
         return "IDENT";
     case TokenType::NUMBER:
@@ -1,14 +1,48 @@
+#include <chrono>
+#include <cstdlib>
 #include <fstream>
 #include <iostream>
+#include <new>
 #include <sstream>
+#include <thread>
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
 
 #include "compiler.hpp"
-#include "lexer.hpp"
+#include "joy.hpp"
 #include "parser.hpp"
-#include "vm.hpp"
+#include "profile.hpp"
 
 using namespace joy;
 
+// Heap accounting for --analyze: every allocation goes through here and is
+// counted (by its usable size, which is also known when it is freed)
+#if defined(__GLIBC__)
+void* operator new(std::size_t size) {
+    void* p = std::malloc(size == 0 ? 1 : size);
+    if (!p) {
+        throw std::bad_alloc();
+    }
+    if (HeapStats::enabled()) {
+        HeapStats::record_alloc(malloc_usable_size(p));
+    }
+    return p;
+}
+
+void operator delete(void* p) noexcept {
+    if (p && HeapStats::enabled()) {
+        HeapStats::record_free(malloc_usable_size(p));
+    }
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    operator delete(p);
+}
+#endif
+
 // Read entire file into string
 std::string read_file(const std::string& filepath) {
     std::ifstream file(filepath);
@@ -22,35 +56,97 @@ std::string read_file(const std::string& filepath) {
     return buffer.str();
 }
 
+void print_usage() {
+    std::cerr << "Usage: joy [--batch-size N] [--threads N] [--sort-memory MB]\n"
+                 "           [--explain | --analyze] [--json] [--no-jit]\n"
+                 "           [--incremental CHECKPOINT [--follow]] <source_file.jy>\n";
+    std::cerr << "Example: joy process.jy\n";
+}
+
 int main(int argc, char* argv[]) {
-    if (argc != 2) {
-        std::cerr << "Usage: joy <source_file.jy>\n";
-        std::cerr << "Example: joy process.jy\n";
-        return 1;
+    VMOptions vm_options;
+    std::string source_file;
+    bool explain = false;
+    bool json = false;
+    bool follow = false;
+
+    // Parse command line: options first, then the program file
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--batch-size" && i + 1 < argc) {
+            char* end = nullptr;
+            vm_options.batch_size = std::strtoull(argv[++i], &end, 10);
+            if (*end != '\0') {
+                print_usage();
+                return 1;
+            }
+        } else if (arg == "--threads" && i + 1 < argc) {
+            char* end = nullptr;
+            vm_options.num_threads = std::strtoull(argv[++i], &end, 10);
+            if (*end != '\0') {
+                print_usage();
+                return 1;
+            }
+        } else if (arg == "--sort-memory" && i + 1 < argc) {
+            char* end = nullptr;
+            size_t megabytes = std::strtoull(argv[++i], &end, 10);
+            if (*end != '\0' || megabytes == 0) {
+                print_usage();
+                return 1;
+            }
+            vm_options.sort_memory = megabytes << 20;
+        } else if (arg == "--explain") {
+            explain = true;
+        } else if (arg == "--analyze") {
+            vm_options.analyze = true;
+        } else if (arg == "--json") {
+            json = true;
+        } else if (arg == "--no-jit") {
+            vm_options.jit = false;
+        } else if (arg == "--incremental" && i + 1 < argc) {
+            vm_options.checkpoint = argv[++i];
+        } else if (arg == "--follow") {
+            follow = true;
+        } else if (source_file.empty() && arg.rfind("--", 0) != 0) {
+            source_file = arg;
+        } else {
+            print_usage();
+            return 1;
+        }
     }
 
-    std::string source_file = argv[1];
+    if (source_file.empty() || (explain && vm_options.analyze) ||
+        (follow && (vm_options.checkpoint.empty() || explain || vm_options.analyze))) {
+        print_usage();
+        return 1;
+    }
 
     try {
         // 1. Read source code
         std::string source = read_file(source_file);
 
-        // 2. Lex
-        Lexer lexer(source);
-        auto tokens = lexer.tokenize();
-
-        // 3. Parse
-        Parser parser(std::move(tokens));
-        Program program = parser.parse();
+        // 2. Lex, parse, compile and optimize
+        Query query = Query::compile(source);
 
-        // 4. Compile
-        Compiler compiler;
-        ExecutionPlan plan = compiler.compile(program);
+        // --explain: show the plan without running it
+        if (explain) {
+            std::cout << (json ? explain_plan_json(query.plan()) : explain_plan(query.plan()));
+            return 0;
+        }
 
-        // 5. Execute
-        VM vm;
-        vm.execute(plan);
+        // 3. Execute (--follow: again every second, on the rows appended since)
+        Session session(vm_options);
+        session.run(query);
+        while (follow) {
+            std::this_thread::sleep_for(std::chrono::seconds(1));
+            session.run(query);
+        }
 
+        if (vm_options.analyze) {
+            const ExecutionProfile& profile = session.profile();
+            std::cout << (json ? format_profile_json(profile) : format_profile(profile));
+            return 0;
+        }
         std::cout << "Execution completed successfully.\n";
         return 0;
 
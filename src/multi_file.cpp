@@ -0,0 +1,297 @@
+#include "multi_file.hpp"
+
+#include <algorithm>
+#include <exception>
+#include <filesystem>
+#include <stdexcept>
+
+#include "file_format.hpp"
+
+namespace joy {
+
+// ============================================================================
+// Glob Expansion
+// ============================================================================
+
+static bool has_wildcard(std::string_view s) {
+    return s.find_first_of("*?[") != std::string_view::npos;
+}
+
+// Helper: Length of the pattern element at p ('?', a [...] class or a
+// literal character) if it matches c, else 0
+// Classes may be negated with ! or ^ and hold ranges (a-z); a ] right after
+// the opening bracket is a member; a [ without a closing ] is a literal
+static size_t match_element(std::string_view pattern, size_t p, char c) {
+    if (pattern[p] == '?') {
+        return 1;
+    }
+    if (pattern[p] == '[') {
+        size_t first = p + 1;
+        bool negate = first < pattern.size() && (pattern[first] == '!' || pattern[first] == '^');
+        if (negate)
+            ++first;
+        size_t end = pattern.find(']', first + 1);
+        if (end != std::string_view::npos) {
+            bool found = false;
+            for (size_t i = first; i < end; ++i) {
+                if (i + 2 < end && pattern[i + 1] == '-') {
+                    found |= c >= pattern[i] && c <= pattern[i + 2];
+                    i += 2;
+                } else {
+                    found |= c == pattern[i];
+                }
+            }
+            return found != negate ? end - p + 1 : 0;
+        }
+    }
+    return pattern[p] == c ? 1 : 0;
+}
+
+// Helper: Whether a file name matches a pattern (* matches any run of
+// characters, backtracking to the last * on a mismatch)
+// As in the shell, wildcards do not match a leading dot
+static bool glob_match(std::string_view pattern, std::string_view name) {
+    if (!name.empty() && name[0] == '.' && (pattern.empty() || pattern[0] != '.')) {
+        return false;
+    }
+    size_t p = 0;
+    size_t n = 0;
+    size_t star = std::string_view::npos;  // Pattern position after the last *
+    size_t star_n = 0;                     // Name position that * matched up to
+    while (n < name.size()) {
+        if (p < pattern.size() && pattern[p] == '*') {
+            star = ++p;
+            star_n = n;
+            continue;
+        }
+        size_t len = p < pattern.size() ? match_element(pattern, p, name[n]) : 0;
+        if (len > 0) {
+            p += len;
+            ++n;
+        } else if (star != std::string_view::npos) {
+            p = star;  // Let the last * absorb one more character
+            n = ++star_n;
+        } else {
+            return false;
+        }
+    }
+    while (p < pattern.size() && pattern[p] == '*')
+        ++p;
+    return p == pattern.size();
+}
+
+std::vector<std::string> expand_glob(const std::string& pattern) {
+    if (!has_wildcard(pattern)) {
+        return {pattern};
+    }
+    size_t slash = pattern.find_last_of('/');
+    std::string prefix = slash == std::string::npos ? "" : pattern.substr(0, slash + 1);
+    std::string name_pattern = pattern.substr(prefix.size());
+    if (has_wildcard(prefix)) {
+        throw std::runtime_error("Wildcards are only supported in file names: " + pattern);
+    }
+
+    std::vector<std::string> matches;
+    std::error_code ec;
+    std::filesystem::directory_iterator it(prefix.empty() ? "." : prefix, ec);
+    if (ec) {
+        throw std::runtime_error("Cannot open directory: " + (prefix.empty() ? "." : prefix));
+    }
+    for (const auto& entry : it) {
+        std::string name = entry.path().filename().string();
+        if (entry.is_regular_file(ec) && glob_match(name_pattern, name)) {
+            matches.push_back(prefix + name);
+        }
+    }
+    if (matches.empty()) {
+        throw std::runtime_error("No files match: " + pattern);
+    }
+    std::sort(matches.begin(), matches.end());
+    return matches;
+}
+
+// ============================================================================
+// Schema Unification
+// ============================================================================
+
+// Every file is opened up front: the schema is needed before the first
+// batch, and a type conflict is better reported before any row is read
+MultiFileReader::MultiFileReader(const std::vector<std::string>& filepaths, ThreadPool* pool,
+                                 const std::vector<std::string>* columns,
+                                 const std::vector<PhysicalOp::VectorizedFilterOp>* predicates,
+                                 const std::vector<DeclaredColumn>* schema)
+    : pool_(pool) {
+    for (const auto& filepath : filepaths) {
+        Source source;
+        source.filepath = filepath;
+        std::error_code ec;
+        auto bytes = std::filesystem::file_size(filepath, ec);
+        if (compression_of(filepath) != Compression::NONE)
+            bytes *= kCompressionRatio;  // Its text is what gets held in memory
+        source.whole = !ec && bytes <= kWholeFileBytes;
+        // A small file is read on a single pool thread, so its reader gets no
+        // pool of its own
+        source.reader =
+            open_reader(filepath, source.whole ? nullptr : pool, columns, predicates, schema);
+        sources_.push_back(std::move(source));
+    }
+
+    // Columns in order of first appearance; types from files that have a
+    // non-NULL value (a column without any keeps the STRING default)
+    for (const auto& source : sources_) {
+        const auto& names = source.reader->column_names();
+        for (size_t i = 0; i < names.size(); ++i) {
+            ColumnType type = source.reader->column_types()[i];
+            bool inferred = source.reader->inferred_types()[i];
+            auto it = std::find(names_.begin(), names_.end(), names[i]);
+            if (it == names_.end()) {
+                names_.push_back(names[i]);
+                types_.push_back(type);
+                inferred_.push_back(inferred);
+                continue;
+            }
+            size_t c = static_cast<size_t>(it - names_.begin());
+            if (!inferred)
+                continue;
+            types_[c] = inferred_[c] ? widen_type(types_[c], type) : type;
+            inferred_[c] = true;
+        }
+    }
+
+    // CSV files parse their columns as the unified types; other formats keep
+    // their own types, which conform() can only widen from INT64 to DOUBLE
+    for (auto& source : sources_) {
+        const auto& names = source.reader->column_names();
+        std::vector<ColumnType> wanted;
+        for (size_t i = 0; i < names.size(); ++i) {
+            size_t c = static_cast<size_t>(
+                std::find(names_.begin(), names_.end(), names[i]) - names_.begin());
+            wanted.push_back(types_[c]);
+        }
+        if (auto* csv = dynamic_cast<CsvReader*>(source.reader.get())) {
+            csv->set_column_types(wanted);
+            continue;
+        }
+        for (size_t i = 0; i < names.size(); ++i) {
+            ColumnType type = source.reader->column_types()[i];
+            bool widens = type == ColumnType::INT64 && wanted[i] == ColumnType::DOUBLE;
+            if (type != wanted[i] && !widens && source.reader->inferred_types()[i]) {
+                throw std::runtime_error("Column " + names[i] + " in " + source.filepath +
+                                         " has a type that differs from the other files");
+            }
+        }
+    }
+}
+
+// ============================================================================
+// Reading
+// ============================================================================
+
+Table MultiFileReader::conform(Table batch) const {
+    Table out;
+    out.num_rows = batch.num_rows;
+    for (size_t c = 0; c < names_.size(); ++c) {
+        int idx = batch.get_column_index(names_[c]);
+        if (idx >= 0 && batch.columns[idx].type == types_[c]) {
+            out.add_column(std::move(batch.columns[idx]));
+            continue;
+        }
+
+        Column col = Column::make(names_[c], types_[c]);
+        if (idx >= 0 && types_[c] == ColumnType::DOUBLE &&
+            batch.columns[idx].type == ColumnType::INT64) {
+            // INT64 in this file, DOUBLE in another
+            const Column& ints = batch.columns[idx];
+            const auto& values = ints.values<int64_t>();
+            col.values<double>().assign(values.begin(), values.end());
+            col.validity = ints.validity;
+            col.zones = build_zone_map(col);
+        } else {
+            // Missing from this file (or NULL in every row): all NULL
+            col.reserve(batch.num_rows);
+            for (size_t i = 0; i < batch.num_rows; ++i)
+                col.append_null();
+        }
+        out.add_column(std::move(col));
+    }
+    return out;
+}
+
+void MultiFileReader::read_whole_files(size_t max_rows) {
+    size_t end = next_;
+    const size_t limit = next_ + (pool_ ? pool_->size() : 1);
+    while (end < sources_.size() && end < limit && sources_[end].whole)
+        ++end;
+
+    std::vector<std::vector<Table>> batches(end - next_);
+    std::vector<std::exception_ptr> errors(end - next_);
+    auto read = [&](size_t k) {
+        Source& source = sources_[next_ + k];
+        try {
+            Table batch;
+            while (source.reader->next_batch(batch, max_rows)) {
+                if (batch.num_rows > 0)
+                    batches[k].push_back(conform(std::move(batch)));
+                batch = Table{};
+            }
+        } catch (...) {
+            errors[k] = std::current_exception();
+        }
+        source.reader.reset();  // Unmaps the file
+    };
+    if (pool_ && batches.size() > 1) {
+        pool_->parallel_for(batches.size(), read);
+    } else {
+        for (size_t k = 0; k < batches.size(); ++k)
+            read(k);
+    }
+
+    // Report the first error in file order, as a sequential scan would
+    for (size_t k = 0; k < batches.size(); ++k) {
+        if (errors[k]) {
+            std::rethrow_exception(errors[k]);
+        }
+        for (auto& batch : batches[k])
+            ready_.push_back(std::move(batch));
+    }
+    next_ = end;
+}
+
+void MultiFileReader::read_streaming(size_t max_rows) {
+    Source& source = sources_[next_];
+    Table batch;
+    if (!source.reader->next_batch(batch, max_rows)) {
+        source.reader.reset();
+        ++next_;
+    } else if (batch.num_rows > 0) {
+        ready_.push_back(conform(std::move(batch)));
+    }
+}
+
+bool MultiFileReader::next_batch(Table& out, size_t max_rows) {
+    while (ready_.empty() && next_ < sources_.size()) {
+        if (sources_[next_].whole) {
+            read_whole_files(max_rows);
+        } else {
+            read_streaming(max_rows);
+        }
+    }
+
+    if (ready_.empty()) {
+        if (started_) {
+            return false;  // Input exhausted
+        }
+        // No file had rows: one empty batch carrying the schema
+        out = Table{};
+        for (size_t c = 0; c < names_.size(); ++c)
+            out.add_column(Column::make(names_[c], types_[c]));
+        started_ = true;
+        return true;
+    }
+    started_ = true;
+    out = std::move(ready_.front());
+    ready_.pop_front();
+    return true;
+}
+
+}  // namespace joy
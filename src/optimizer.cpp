@@ -0,0 +1,729 @@
+#include "optimizer.hpp"
+
+#include <algorithm>
+#include <type_traits>
+#include <variant>
+
+namespace joy {
+
+using OpCode = IRExpr::OpCode;
+
+// ============================================================================
+// Column References
+// ============================================================================
+
+static void expr_columns(const IRExpr& expr, std::set<std::string>& out) {
+    for (const auto& instr : expr.instructions) {
+        if (instr.op == OpCode::LOAD_COLUMN) {
+            if (const auto* name = std::get_if<std::string>(&instr.operand))
+                out.insert(*name);
+        }
+    }
+}
+
+static void node_columns(const PhysicalOp::FilterNode& node, std::set<std::string>& out) {
+    switch (node.kind) {
+    case PhysicalOp::FilterNode::Kind::COMPARE:
+        out.insert(node.compare.column_name);
+        if (node.compare.is_right_column)
+            out.insert(node.compare.right_column_name);
+        break;
+    case PhysicalOp::FilterNode::Kind::PREDICATE:
+        expr_columns(node.predicate, out);
+        break;
+    default:
+        for (const auto& child : node.children)
+            node_columns(child, out);
+        break;
+    }
+}
+
+std::set<std::string> referenced_columns(const PhysicalOp& op) {
+    std::set<std::string> out;
+    std::visit(
+        [&](const auto& op_data) {
+            using T = std::decay_t<decltype(op_data)>;
+
+            if constexpr (std::is_same_v<T, PhysicalOp::FilterOp>) {
+                expr_columns(op_data.predicate, out);
+            } else if constexpr (std::is_same_v<T, PhysicalOp::VectorizedFilterOp>) {
+                out.insert(op_data.column_name);
+                if (op_data.is_right_column)
+                    out.insert(op_data.right_column_name);
+            } else if constexpr (std::is_same_v<T, PhysicalOp::LogicalFilterOp>) {
+                node_columns(op_data.root, out);
+            } else if constexpr (std::is_same_v<T, PhysicalOp::ProjectOp>) {
+                out.insert(op_data.columns.begin(), op_data.columns.end());
+            } else if constexpr (std::is_same_v<T, PhysicalOp::TransformOp>) {
+                expr_columns(op_data.expression, out);
+            } else if constexpr (std::is_same_v<T, PhysicalOp::VectorizedTransformOp>) {
+                if (op_data.is_left_column)
+                    out.insert(op_data.left_column_name);
+                if (op_data.is_right_column)
+                    out.insert(op_data.right_column_name);
+            } else if constexpr (std::is_same_v<T, PhysicalOp::VectorizedTernaryTransformOp>) {
+                out.insert(op_data.condition.column_name);
+                if (op_data.condition.is_right_column)
+                    out.insert(op_data.condition.right_column_name);
+                if (op_data.is_true_column)
+                    out.insert(op_data.true_column_name);
+                if (op_data.is_false_column)
+                    out.insert(op_data.false_column_name);
+            } else if constexpr (std::is_same_v<T, PhysicalOp::JoinOp>) {
+                out.insert(op_data.keys.begin(), op_data.keys.end());
+            } else if constexpr (std::is_same_v<T, PhysicalOp::SortOp>) {
+                for (const auto& key : op_data.keys)
+                    out.insert(key.column);
+            } else if constexpr (std::is_same_v<T, PhysicalOp::AggregateOp>) {
+                out.insert(op_data.keys.begin(), op_data.keys.end());
+                for (const auto& agg : op_data.aggregates) {
+                    if (!agg.column.empty())
+                        out.insert(agg.column);
+                }
+            }
+            // SCAN and LIMIT read nothing; WRITE reads every column (see push_down_projection)
+        },
+        op.data);
+    return out;
+}
+
+// Helper: Column a transform operator adds or replaces (nullptr for other operators)
+static const std::string* produced_column(const PhysicalOp& op) {
+    if (const auto* t = std::get_if<PhysicalOp::TransformOp>(&op.data))
+        return &t->column_name;
+    if (const auto* t = std::get_if<PhysicalOp::VectorizedTransformOp>(&op.data))
+        return &t->column_name;
+    if (const auto* t = std::get_if<PhysicalOp::VectorizedTernaryTransformOp>(&op.data))
+        return &t->column_name;
+    return nullptr;
+}
+
+// Helper: Whether every name in names is one of columns
+static bool all_in(const std::set<std::string>& names, const std::vector<std::string>& columns) {
+    return std::all_of(names.begin(), names.end(), [&](const std::string& c) {
+        return std::find(columns.begin(), columns.end(), c) != columns.end();
+    });
+}
+
+static bool is_filter(const PhysicalOp& op) {
+    return std::holds_alternative<PhysicalOp::FilterOp>(op.data) ||
+           std::holds_alternative<PhysicalOp::VectorizedFilterOp>(op.data) ||
+           std::holds_alternative<PhysicalOp::LogicalFilterOp>(op.data);
+}
+
+// ============================================================================
+// Constant Folding
+// ============================================================================
+// Abstract interpretation over the stack, like the binder: each entry
+// records where its code starts and, if it is a constant, its value. An
+// operator whose operands are all constants is evaluated here with the row
+// interpreter's rules and its code replaced by a single PUSH. Anything the
+// row interpreter would reject (1 / 0, "a" + 1) is left alone so the usual
+// error is reported
+
+using Constant = std::variant<int64_t, double, std::string, bool>;
+
+static std::optional<Constant> as_constant(const IRExpr::Instruction& instr) {
+    switch (instr.op) {
+    case OpCode::PUSH_INT:
+        return std::get<int64_t>(instr.operand);
+    case OpCode::PUSH_DOUBLE:
+        return std::get<double>(instr.operand);
+    case OpCode::PUSH_STRING:
+        return std::get<std::string>(instr.operand);
+    case OpCode::PUSH_BOOL:
+        return std::get<bool>(instr.operand);
+    default:
+        return std::nullopt;
+    }
+}
+
+static IRExpr::Instruction push_constant(const Constant& value) {
+    return std::visit(
+        [](const auto& v) -> IRExpr::Instruction {
+            using T = std::decay_t<decltype(v)>;
+            if constexpr (std::is_same_v<T, int64_t>) {
+                return {OpCode::PUSH_INT, v};
+            } else if constexpr (std::is_same_v<T, double>) {
+                return {OpCode::PUSH_DOUBLE, v};
+            } else if constexpr (std::is_same_v<T, std::string>) {
+                return {OpCode::PUSH_STRING, v};
+            } else {
+                return {OpCode::PUSH_BOOL, v};
+            }
+        },
+        value);
+}
+
+// Helper: Boolean value of a constant (BOOL or INT64 only, as in NOT/AND/OR)
+static std::optional<bool> truthiness(const Constant& c) {
+    if (const auto* b = std::get_if<bool>(&c))
+        return *b;
+    if (const auto* i = std::get_if<int64_t>(&c))
+        return *i != 0;
+    return std::nullopt;
+}
+
+static bool is_numeric(const Constant& c) {
+    return std::holds_alternative<int64_t>(c) || std::holds_alternative<double>(c);
+}
+
+static double to_double(const Constant& c) {
+    if (const auto* i = std::get_if<int64_t>(&c))
+        return static_cast<double>(*i);
+    return std::get<double>(c);
+}
+
+template <typename T>
+static std::optional<Constant> fold_arith(OpCode op, T a, T b) {
+    if constexpr (std::is_integral_v<T>) {
+        // Overflowing INT64 results are left unfolded, for runtime to compute
+        T result;
+        switch (op) {
+        case OpCode::ADD:
+            if (__builtin_add_overflow(a, b, &result))
+                return std::nullopt;
+            return result;
+        case OpCode::SUB:
+            if (__builtin_sub_overflow(a, b, &result))
+                return std::nullopt;
+            return result;
+        case OpCode::MUL:
+            if (__builtin_mul_overflow(a, b, &result))
+                return std::nullopt;
+            return result;
+        default:
+            break;
+        }
+    }
+    switch (op) {
+    case OpCode::ADD:
+        return a + b;
+    case OpCode::SUB:
+        return a - b;
+    case OpCode::MUL:
+        return a * b;
+    default:
+        if (b == T{0})
+            return std::nullopt;  // Division by zero is reported at runtime
+        return divide(a, b);
+    }
+}
+
+template <typename T>
+static bool fold_compare(OpCode op, const T& a, const T& b) {
+    switch (op) {
+    case OpCode::EQ:
+        return a == b;
+    case OpCode::NEQ:
+        return a != b;
+    case OpCode::LT:
+        return a < b;
+    case OpCode::GT:
+        return a > b;
+    case OpCode::LTE:
+        return a <= b;
+    default:
+        return a >= b;
+    }
+}
+
+static std::optional<Constant> fold_binary(OpCode op, const Constant& a, const Constant& b) {
+    const auto* ai = std::get_if<int64_t>(&a);
+    const auto* bi = std::get_if<int64_t>(&b);
+
+    switch (op) {
+    case OpCode::ADD:
+    case OpCode::SUB:
+    case OpCode::MUL:
+    case OpCode::DIV:
+        if (ai && bi)
+            return fold_arith(op, *ai, *bi);
+        if (is_numeric(a) && is_numeric(b))
+            return fold_arith(op, to_double(a), to_double(b));
+        return std::nullopt;
+
+    case OpCode::EQ:
+    case OpCode::NEQ:
+    case OpCode::LT:
+    case OpCode::GT:
+    case OpCode::LTE:
+    case OpCode::GTE: {
+        bool equality = op == OpCode::EQ || op == OpCode::NEQ;
+        if (ai && bi)
+            return fold_compare(op, *ai, *bi);
+        if (is_numeric(a) && is_numeric(b))
+            return fold_compare(op, to_double(a), to_double(b));
+        const auto* as = std::get_if<std::string>(&a);
+        const auto* bs = std::get_if<std::string>(&b);
+        if (as && bs)
+            return fold_compare(op, *as, *bs);
+        const auto* ab = std::get_if<bool>(&a);
+        const auto* bb = std::get_if<bool>(&b);
+        if (equality && ab && bb)
+            return fold_compare(op, *ab, *bb);
+        return std::nullopt;
+    }
+
+    case OpCode::AND:
+    case OpCode::OR: {
+        auto at = truthiness(a);
+        auto bt = truthiness(b);
+        if (!at || !bt)
+            return std::nullopt;
+        return op == OpCode::AND ? (*at && *bt) : (*at || *bt);
+    }
+
+    default:
+        return std::nullopt;
+    }
+}
+
+static std::optional<Constant> fold_unary(const IRExpr::Instruction& instr, const Constant& a) {
+    const OpCode op = instr.op;
+    if (auto match = string_match_of(op)) {
+        const auto* s = std::get_if<std::string>(&a);
+        if (!s)
+            return std::nullopt;  // Left for the binder to report
+        return string_matches(*match, *s, std::get<std::string>(instr.operand));
+    }
+    if (op == OpCode::NEG) {
+        if (const auto* i = std::get_if<int64_t>(&a))
+            return -*i;
+        if (const auto* d = std::get_if<double>(&a))
+            return -*d;
+        return std::nullopt;
+    }
+    // NOT
+    auto t = truthiness(a);
+    if (!t)
+        return std::nullopt;
+    return !*t;
+}
+
+IRExpr Optimizer::fold_constants(const IRExpr& expr) {
+    struct Entry {
+        size_t start;                   // Index of the entry's first instruction
+        std::optional<Constant> value;  // Set if the entry is a constant
+    };
+    std::vector<IRExpr::Instruction> code;
+    std::vector<Entry> stack;
+
+    for (const auto& instr : expr.instructions) {
+        size_t arity = 0;
+        switch (instr.op) {
+        case OpCode::NEG:
+        case OpCode::NOT:
+        case OpCode::STARTS_WITH:
+        case OpCode::ENDS_WITH:
+        case OpCode::CONTAINS:
+        case OpCode::IEQUALS:
+            arity = 1;
+            break;
+        case OpCode::TERNARY:
+            arity = 3;
+            break;
+        case OpCode::PUSH_INT:
+        case OpCode::PUSH_DOUBLE:
+        case OpCode::PUSH_STRING:
+        case OpCode::PUSH_BOOL:
+        case OpCode::LOAD_COLUMN:
+            break;
+        default:
+            arity = 2;  // Unbound bytecode: every other opcode is binary
+            break;
+        }
+        if (stack.size() < arity) {
+            return expr;  // Malformed bytecode: leave it for the binder to report
+        }
+
+        if (arity == 0) {
+            stack.push_back({code.size(), as_constant(instr)});
+            code.push_back(instr);
+            continue;
+        }
+
+        if (instr.op == OpCode::TERNARY) {
+            Entry f = stack.back();
+            stack.pop_back();
+            Entry t = stack.back();
+            stack.pop_back();
+            Entry cond = stack.back();
+            stack.pop_back();
+
+            auto taken = cond.value ? truthiness(*cond.value) : std::nullopt;
+            if (!taken) {
+                code.push_back(instr);
+                stack.push_back({cond.start, std::nullopt});
+            } else if (*taken) {
+                // Keep only the true branch
+                code.erase(code.begin() + static_cast<std::ptrdiff_t>(f.start), code.end());
+                code.erase(code.begin() + static_cast<std::ptrdiff_t>(cond.start),
+                           code.begin() + static_cast<std::ptrdiff_t>(t.start));
+                stack.push_back({cond.start, t.value});
+            } else {
+                // Keep only the false branch
+                code.erase(code.begin() + static_cast<std::ptrdiff_t>(cond.start),
+                           code.begin() + static_cast<std::ptrdiff_t>(f.start));
+                stack.push_back({cond.start, f.value});
+            }
+            continue;
+        }
+
+        std::optional<Constant> folded;
+        size_t start;
+        if (arity == 1) {
+            Entry a = stack.back();
+            stack.pop_back();
+            start = a.start;
+            if (a.value)
+                folded = fold_unary(instr, *a.value);
+        } else {
+            Entry b = stack.back();
+            stack.pop_back();
+            Entry a = stack.back();
+            stack.pop_back();
+            start = a.start;
+            if (a.value && b.value)
+                folded = fold_binary(instr.op, *a.value, *b.value);
+        }
+
+        if (folded) {
+            code.resize(start);
+            code.push_back(push_constant(*folded));
+        } else {
+            code.push_back(instr);
+        }
+        stack.push_back({start, folded});
+    }
+
+    IRExpr result;
+    result.instructions = std::move(code);
+    return result;
+}
+
+// ============================================================================
+// Filter Rewrites After Folding
+// ============================================================================
+
+// Helper: Recognize [LOAD_COLUMN c, STARTS_WITH p] and the other string
+// predicates
+static std::optional<PhysicalOp::VectorizedFilterOp> as_vectorized_match(
+    const IRExpr::Instruction& load, const IRExpr::Instruction& match) {
+    PhysicalOp::VectorizedFilterOp result;
+    switch (match.op) {
+    case OpCode::STARTS_WITH:
+        result.op = VectorOp::STARTS_WITH;
+        break;
+    case OpCode::ENDS_WITH:
+        result.op = VectorOp::ENDS_WITH;
+        break;
+    case OpCode::CONTAINS:
+        result.op = VectorOp::CONTAINS;
+        break;
+    case OpCode::IEQUALS:
+        result.op = VectorOp::IEQUALS;
+        break;
+    default:
+        return std::nullopt;
+    }
+    result.column_name = std::get<std::string>(load.operand);
+    result.value = std::get<std::string>(match.operand);
+    return result;
+}
+
+// Helper: Recognize [LOAD_COLUMN c, PUSH v, CMP] (or the reversed operands),
+// [LOAD_COLUMN a, LOAD_COLUMN b, CMP] and string predicates on a column so
+// that a folded predicate can use the vectorized filter kernels
+static std::optional<PhysicalOp::VectorizedFilterOp> as_vectorized_compare(const IRExpr& expr) {
+    const auto& code = expr.instructions;
+    if (code.size() == 2 && code[0].op == OpCode::LOAD_COLUMN)
+        return as_vectorized_match(code[0], code[1]);
+    if (code.size() != 3)
+        return std::nullopt;
+
+    bool column_first = code[0].op == OpCode::LOAD_COLUMN;
+    const auto& load = column_first ? code[0] : code[1];
+    bool two_columns = column_first && code[1].op == OpCode::LOAD_COLUMN;
+    auto literal = as_constant(column_first ? code[1] : code[0]);
+    if (load.op != OpCode::LOAD_COLUMN ||
+        (!two_columns && (!literal || std::holds_alternative<bool>(*literal))))
+        return std::nullopt;
+
+    // Reversed operands flip the comparison: 30 < age → age > 30
+    VectorOp op;
+    switch (code[2].op) {
+    case OpCode::EQ:
+        op = VectorOp::EQ;
+        break;
+    case OpCode::NEQ:
+        op = VectorOp::NEQ;
+        break;
+    case OpCode::LT:
+        op = column_first ? VectorOp::LT : VectorOp::GT;
+        break;
+    case OpCode::GT:
+        op = column_first ? VectorOp::GT : VectorOp::LT;
+        break;
+    case OpCode::LTE:
+        op = column_first ? VectorOp::LTE : VectorOp::GTE;
+        break;
+    case OpCode::GTE:
+        op = column_first ? VectorOp::GTE : VectorOp::LTE;
+        break;
+    default:
+        return std::nullopt;
+    }
+
+    PhysicalOp::VectorizedFilterOp result;
+    result.column_name = std::get<std::string>(load.operand);
+    result.op = op;
+    if (two_columns) {
+        result.is_right_column = true;
+        result.right_column_name = std::get<std::string>(code[1].operand);
+        return result;
+    }
+    std::visit(
+        [&](const auto& v) {
+            if constexpr (!std::is_same_v<std::decay_t<decltype(v)>, bool>)
+                result.value = v;
+        },
+        *literal);
+    return result;
+}
+
+// Helper: Whether a folded predicate keeps every row (a true constant)
+static bool always_true(const IRExpr& predicate) {
+    if (predicate.instructions.size() != 1)
+        return false;
+    auto value = as_constant(predicate.instructions[0]);
+    return value && truthiness(*value) == true;
+}
+
+// Estimated fraction of rows for which a node is true
+// (there are no column statistics yet, so this is a rough guess by operator)
+static double estimated_selectivity(const PhysicalOp::FilterNode& node) {
+    using Kind = PhysicalOp::FilterNode::Kind;
+    switch (node.kind) {
+    case Kind::COMPARE:
+        switch (node.compare.op) {
+        case VectorOp::EQ:
+        case VectorOp::IEQUALS:
+            return 0.1;
+        case VectorOp::NEQ:
+            return 0.9;
+        default:
+            return 1.0 / 3.0;  // Range comparison
+        }
+    case Kind::PREDICATE:
+        return 0.5;
+    case Kind::AND: {
+        double s = 1.0;
+        for (const auto& child : node.children)
+            s *= estimated_selectivity(child);
+        return s;
+    }
+    case Kind::OR: {
+        double miss = 1.0;
+        for (const auto& child : node.children)
+            miss *= 1.0 - estimated_selectivity(child);
+        return 1.0 - miss;
+    }
+    }
+    return 0.5;
+}
+
+// Whether a node evaluates scalar bytecode (slower, and may raise errors)
+static bool has_predicate(const PhysicalOp::FilterNode& node) {
+    if (node.kind == PhysicalOp::FilterNode::Kind::PREDICATE)
+        return true;
+    for (const auto& child : node.children) {
+        if (has_predicate(child))
+            return true;
+    }
+    return false;
+}
+
+// Fold the predicates of a logical filter tree, then order each node's operands
+// so the cheapest, most decisive ones run first:
+//   AND - comparisons by increasing estimated selectivity (fewest rows kept)
+//   OR  - comparisons by decreasing estimated selectivity (most rows decided)
+// Operands containing scalar predicates run last, in their original order,
+// so an earlier operand can guard a later one: b != 0 and a / b > 2
+static void optimize_filter_node(Optimizer& optimizer, PhysicalOp::FilterNode& node) {
+    using Kind = PhysicalOp::FilterNode::Kind;
+    if (node.kind == Kind::PREDICATE) {
+        node.predicate = optimizer.fold_constants(node.predicate);
+        if (auto compare = as_vectorized_compare(node.predicate)) {
+            node.kind = Kind::COMPARE;
+            node.compare = std::move(*compare);
+            node.predicate = IRExpr{};
+        }
+        return;
+    }
+    if (node.kind == Kind::COMPARE) {
+        return;
+    }
+
+    for (auto& child : node.children) {
+        optimize_filter_node(optimizer, child);
+    }
+    bool conjunction = node.kind == Kind::AND;
+    std::stable_sort(node.children.begin(), node.children.end(),
+                     [conjunction](const auto& a, const auto& b) {
+                         bool a_scalar = has_predicate(a);
+                         bool b_scalar = has_predicate(b);
+                         if (a_scalar != b_scalar)
+                             return !a_scalar;
+                         if (a_scalar)
+                             return false;  // Keep scalar operands in source order
+                         double sa = estimated_selectivity(a);
+                         double sb = estimated_selectivity(b);
+                         return conjunction ? sa < sb : sa > sb;
+                     });
+}
+
+// ============================================================================
+// Plan Rewrites
+// ============================================================================
+
+ExecutionPlan Optimizer::optimize(const ExecutionPlan& plan) {
+    ExecutionPlan result = plan;
+    if (result.operators.empty() ||
+        !std::holds_alternative<PhysicalOp::ScanOp>(result.operators.front().data)) {
+        return result;  // The VM reports the malformed pipeline
+    }
+
+    fold_plan_constants(result);
+    push_down_filters(result);
+    fuse_top_n(result);
+    push_down_projection(result);
+    return result;
+}
+
+void Optimizer::fold_plan_constants(ExecutionPlan& plan) {
+    std::vector<PhysicalOp> rewritten;
+    for (auto& op : plan.operators) {
+        if (auto* filter = std::get_if<PhysicalOp::FilterOp>(&op.data)) {
+            filter->predicate = fold_constants(filter->predicate);
+            if (always_true(filter->predicate)) {
+                continue;  // filter 1 < 2 keeps every row
+            }
+            if (auto compare = as_vectorized_compare(filter->predicate)) {
+                op.type = OpType::VECTORIZED_FILTER;
+                op.data = std::move(*compare);
+            }
+        } else if (auto* logical = std::get_if<PhysicalOp::LogicalFilterOp>(&op.data)) {
+            optimize_filter_node(*this, logical->root);
+        } else if (auto* transform = std::get_if<PhysicalOp::TransformOp>(&op.data)) {
+            transform->expression = fold_constants(transform->expression);
+        }
+        rewritten.push_back(std::move(op));
+    }
+    plan.operators = std::move(rewritten);
+}
+
+// Move each filter up past operators that cannot change its result:
+//   - a transform whose output column the filter does not read
+//   - a select that keeps every column the filter reads
+//   - an aggregate, when the filter reads only group keys (each group is
+//     kept or dropped whole, so filtering its rows first is equivalent)
+//   - a sort without a limit (the surviving rows keep their relative order)
+// Filters never pass each other, a write, or the scan, so their relative
+// order and the rows that reach each write are unchanged
+void Optimizer::push_down_filters(ExecutionPlan& plan) {
+    auto& ops = plan.operators;
+    for (size_t i = 1; i < ops.size(); ++i) {
+        if (!is_filter(ops[i]))
+            continue;
+
+        std::set<std::string> reads = referenced_columns(ops[i]);
+        size_t pos = i;
+        while (pos > 1) {
+            const PhysicalOp& prev = ops[pos - 1];
+            bool can_pass = false;
+            if (const std::string* produced = produced_column(prev)) {
+                can_pass = reads.count(*produced) == 0;
+            } else if (const auto* project = std::get_if<PhysicalOp::ProjectOp>(&prev.data)) {
+                can_pass = all_in(reads, project->columns);
+            } else if (const auto* agg = std::get_if<PhysicalOp::AggregateOp>(&prev.data)) {
+                can_pass = !agg->keys.empty() && all_in(reads, agg->keys);
+            } else if (const auto* sort = std::get_if<PhysicalOp::SortOp>(&prev.data)) {
+                can_pass = !sort->limit;
+            }
+            if (!can_pass)
+                break;
+            std::swap(ops[pos - 1], ops[pos]);
+            --pos;
+        }
+    }
+}
+
+// A limit right after a sort (or another limit) is folded into it, so
+// "sort by x limit 10" keeps only the best 10 rows while reading its input
+// instead of sorting everything. Runs after filter pushdown, which can bring
+// a sort and a limit next to each other
+void Optimizer::fuse_top_n(ExecutionPlan& plan) {
+    std::vector<PhysicalOp> rewritten;
+    for (auto& op : plan.operators) {
+        const auto* limit = std::get_if<PhysicalOp::LimitOp>(&op.data);
+        if (limit && !rewritten.empty()) {
+            PhysicalOp& prev = rewritten.back();
+            if (auto* sort = std::get_if<PhysicalOp::SortOp>(&prev.data)) {
+                sort->limit = std::min(sort->limit.value_or(limit->count), limit->count);
+                continue;
+            }
+            if (auto* prev_limit = std::get_if<PhysicalOp::LimitOp>(&prev.data)) {
+                prev_limit->count = std::min(prev_limit->count, limit->count);
+                continue;
+            }
+        }
+        rewritten.push_back(std::move(op));
+    }
+    plan.operators = std::move(rewritten);
+}
+
+// Walk the plan backwards collecting the columns each point needs, then hand
+// the set needed after the scan to the scan:
+//   WRITE          - needs every column (nothing can be pruned above it)
+//   SELECT cols    - needs exactly cols, whatever came after it
+//   AGGREGATE      - needs its keys and inputs, whatever came after it
+//   TRANSFORM c    - needs what it reads plus what is needed after it, minus c
+//   FILTER, SORT   - needs what it reads plus what is needed after it
+//   JOIN           - needs its keys plus what is needed after it; the same
+//                    set (names the file lacks are ignored) is handed to the
+//                    join, since it cannot tell which side a name comes from
+void Optimizer::push_down_projection(ExecutionPlan& plan) {
+    auto& ops = plan.operators;
+    std::optional<std::set<std::string>> needed = std::set<std::string>{};  // nullopt = all
+
+    for (size_t i = ops.size(); i-- > 1;) {
+        PhysicalOp& op = ops[i];
+        if (std::holds_alternative<PhysicalOp::WriteOp>(op.data)) {
+            needed = std::nullopt;
+        } else if (const auto* project = std::get_if<PhysicalOp::ProjectOp>(&op.data)) {
+            needed = std::set<std::string>(project->columns.begin(), project->columns.end());
+        } else if (std::holds_alternative<PhysicalOp::AggregateOp>(op.data)) {
+            needed = referenced_columns(op);
+        } else if (std::holds_alternative<PhysicalOp::ScanOp>(op.data)) {
+            return;  // Not a valid pipeline; the VM reports it
+        } else if (auto* join = std::get_if<PhysicalOp::JoinOp>(&op.data)) {
+            if (needed) {
+                needed->insert(join->keys.begin(), join->keys.end());
+                join->columns = std::vector<std::string>(needed->begin(), needed->end());
+            }
+        } else if (needed) {
+            if (const std::string* produced = produced_column(op))
+                needed->erase(*produced);
+            auto reads = referenced_columns(op);
+            needed->insert(reads.begin(), reads.end());
+        }
+    }
+
+    if (needed) {
+        auto& scan = std::get<PhysicalOp::ScanOp>(ops.front().data);
+        scan.columns = std::vector<std::string>(needed->begin(), needed->end());
+    }
+}
+
+}  // namespace joy
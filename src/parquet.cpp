@@ -0,0 +1,1518 @@
+#include "parquet.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+#include <stdexcept>
+#include <string_view>
+
+#include "thread_pool.hpp"
+
+namespace joy {
+
+constexpr char kParquetMagic[4] = {'P', 'A', 'R', '1'};
+
+// Rows per data page written (a multiple of 64, so pages start on bitmap words)
+constexpr size_t kParquetPageRows = 64 * 1024;
+
+// String statistics longer than this are not written
+constexpr size_t kMaxStatBytes = 1024;
+
+// Enums of parquet.thrift
+enum PhysicalType : int32_t {
+    BOOLEAN = 0,
+    INT32 = 1,
+    INT64 = 2,
+    INT96 = 3,
+    FLOAT = 4,
+    DOUBLE = 5,
+    BYTE_ARRAY = 6,
+    FIXED_LEN_BYTE_ARRAY = 7
+};
+enum Repetition : int32_t { REQUIRED = 0, OPTIONAL = 1, REPEATED = 2 };
+enum Encoding : int32_t { PLAIN = 0, PLAIN_DICTIONARY = 2, RLE = 3, RLE_DICTIONARY = 8 };
+enum Codec : int32_t { UNCOMPRESSED = 0, SNAPPY = 1 };
+enum PageType : int32_t { DATA_PAGE = 0, DICTIONARY_PAGE = 2, DATA_PAGE_V2 = 3 };
+enum ConvertedType : int32_t { UTF8 = 0, DECIMAL = 5, UINT_8 = 11, UINT_16 = 12, UINT_32 = 13 };
+
+template <typename T>
+static T load(const uint8_t* p) {
+    T value;
+    std::memcpy(&value, p, sizeof(T));
+    return value;
+}
+
+template <typename T>
+static void put(std::string& out, T value) {
+    out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+static void put_varint(std::string& out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<char>((value & 0x7f) | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<char>(value));
+}
+
+// Helper: Read a ULEB128 varint, advancing p (false if truncated)
+static bool read_varint(const uint8_t*& p, const uint8_t* end, uint64_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (p == end)
+            return false;
+        uint8_t byte = *p++;
+        value |= uint64_t{byte & 0x7fu} << shift;
+        if (!(byte & 0x80))
+            return true;
+    }
+    return false;
+}
+
+// ============================================================================
+// Thrift Compact Protocol
+// ============================================================================
+// Parquet metadata is a tree of Thrift structs. Each field is a header byte
+// (field id delta from the previous field, and type) followed by its value;
+// integers are zigzag varints and a zero byte ends a struct
+
+enum ThriftType : uint8_t {
+    T_STOP = 0,
+    T_TRUE = 1,
+    T_FALSE = 2,
+    T_BYTE = 3,
+    T_I16 = 4,
+    T_I32 = 5,
+    T_I64 = 6,
+    T_DOUBLE = 7,
+    T_BINARY = 8,
+    T_LIST = 9,
+    T_SET = 10,
+    T_MAP = 11,
+    T_STRUCT = 12
+};
+
+class ThriftReader {
+public:
+    ThriftReader(const uint8_t* data, size_t size, const std::string& filepath)
+        : p_(data), begin_(data), end_(data + size), filepath_(filepath) {}
+
+    size_t consumed() const {
+        return static_cast<size_t>(p_ - begin_);
+    }
+
+    // Call on_field(id, type) for each field of a struct; it must read or
+    // skip the value
+    template <typename F>
+    void read_struct(F&& on_field) {
+        if (++depth_ > kMaxDepth)
+            corrupt();
+        int16_t last = 0;
+        while (true) {
+            uint8_t byte = read_byte();
+            if (byte == T_STOP)
+                break;
+            uint8_t type = byte & 0x0f;
+            int16_t delta = byte >> 4;
+            int16_t id = delta ? static_cast<int16_t>(last + delta)
+                               : static_cast<int16_t>(zigzag(varint()));
+            last = id;
+            bool_value_ = type == T_TRUE;
+            on_field(id, type);
+        }
+        depth_--;
+    }
+
+    // Call on_element(type) for each element of a list
+    template <typename F>
+    void read_list(uint8_t type, F&& on_element) {
+        if (type != T_LIST && type != T_SET)
+            corrupt();
+        uint8_t byte = read_byte();
+        uint64_t size = byte >> 4;
+        if (size == 15)
+            size = varint();
+        if (size > static_cast<uint64_t>(end_ - p_))
+            corrupt();  // Every element takes at least one byte
+        for (uint64_t i = 0; i < size; ++i)
+            on_element(static_cast<uint8_t>(byte & 0x0f));
+    }
+
+    int64_t integer(uint8_t type) {
+        if (type != T_I16 && type != T_I32 && type != T_I64)
+            corrupt();
+        return zigzag(varint());
+    }
+
+    bool boolean(uint8_t type) const {
+        return type == T_TRUE && bool_value_;
+    }
+
+    std::string_view binary(uint8_t type) {
+        if (type != T_BINARY)
+            corrupt();
+        uint64_t size = varint();
+        if (size > static_cast<uint64_t>(end_ - p_))
+            corrupt();
+        std::string_view s(reinterpret_cast<const char*>(p_), size);
+        p_ += size;
+        return s;
+    }
+
+    void skip(uint8_t type) {
+        switch (type) {
+        case T_TRUE:
+        case T_FALSE:
+            break;
+        case T_BYTE:
+            read_byte();
+            break;
+        case T_I16:
+        case T_I32:
+        case T_I64:
+            varint();
+            break;
+        case T_DOUBLE:
+            if (end_ - p_ < 8)
+                corrupt();
+            p_ += 8;
+            break;
+        case T_BINARY:
+            binary(type);
+            break;
+        case T_LIST:
+        case T_SET:
+            read_list(type, [&](uint8_t element) {
+                // Booleans in a collection take a byte each
+                element == T_TRUE || element == T_FALSE ? (void)read_byte() : skip(element);
+            });
+            break;
+        case T_MAP: {
+            uint64_t size = varint();
+            if (size > 0) {
+                uint8_t types = read_byte();
+                for (uint64_t i = 0; i < size; ++i) {
+                    skip(types >> 4);
+                    skip(types & 0x0f);
+                }
+            }
+            break;
+        }
+        case T_STRUCT:
+            read_struct([&](int16_t, uint8_t field) { skip(field); });
+            break;
+        default:
+            corrupt();
+        }
+    }
+
+private:
+    static constexpr int kMaxDepth = 64;
+
+    [[noreturn]] void corrupt() const {
+        throw std::runtime_error("Corrupt Parquet file: " + filepath_);
+    }
+
+    uint8_t read_byte() {
+        if (p_ == end_)
+            corrupt();
+        return *p_++;
+    }
+
+    uint64_t varint() {
+        uint64_t value;
+        if (!read_varint(p_, end_, value))
+            corrupt();
+        return value;
+    }
+
+    static int64_t zigzag(uint64_t n) {
+        return static_cast<int64_t>(n >> 1) ^ -static_cast<int64_t>(n & 1);
+    }
+
+    const uint8_t* p_;
+    const uint8_t* begin_;
+    const uint8_t* end_;
+    const std::string& filepath_;
+    bool bool_value_ = false;
+    int depth_ = 0;
+};
+
+class ThriftWriter {
+public:
+    void i32(int16_t id, int32_t value) {
+        header(id, T_I32);
+        put_varint(out_, zigzag(value));
+    }
+    void i64(int16_t id, int64_t value) {
+        header(id, T_I64);
+        put_varint(out_, zigzag(value));
+    }
+    void binary(int16_t id, std::string_view value) {
+        header(id, T_BINARY);
+        element_binary(value);
+    }
+
+    void begin_struct(int16_t id) {
+        header(id, T_STRUCT);
+        begin_element();
+    }
+    void end_struct() {
+        out_.push_back(T_STOP);
+        last_ = stack_.back();
+        stack_.pop_back();
+    }
+
+    void begin_list(int16_t id, uint8_t element_type, size_t size) {
+        header(id, T_LIST);
+        if (size < 15) {
+            out_.push_back(static_cast<char>(size << 4 | element_type));
+        } else {
+            out_.push_back(static_cast<char>(0xf0 | element_type));
+            put_varint(out_, size);
+        }
+    }
+    // List elements
+    void begin_element() {
+        stack_.push_back(last_);
+        last_ = 0;
+    }
+    void element_i32(int32_t value) {
+        put_varint(out_, zigzag(value));
+    }
+    void element_binary(std::string_view value) {
+        put_varint(out_, value.size());
+        out_.append(value.data(), value.size());
+    }
+    // A struct serialized by another writer
+    void raw(std::string_view bytes) {
+        out_.append(bytes.data(), bytes.size());
+    }
+
+    // End the outermost struct and return the bytes
+    std::string finish() {
+        out_.push_back(T_STOP);
+        return std::move(out_);
+    }
+
+private:
+    void header(int16_t id, uint8_t type) {
+        int delta = id - last_;
+        if (delta > 0 && delta <= 15) {
+            out_.push_back(static_cast<char>(delta << 4 | type));
+        } else {
+            out_.push_back(static_cast<char>(type));
+            put_varint(out_, zigzag(id));
+        }
+        last_ = id;
+    }
+
+    static uint64_t zigzag(int64_t n) {
+        return (static_cast<uint64_t>(n) << 1) ^ static_cast<uint64_t>(n >> 63);
+    }
+
+    std::string out_;
+    int16_t last_ = 0;
+    std::vector<int16_t> stack_;
+};
+
+// ============================================================================
+// Footer Metadata
+// ============================================================================
+
+struct SchemaElement {
+    int32_t type = -1;  // Physical type (-1 = group)
+    int32_t repetition = REQUIRED;
+    std::string name;
+    int32_t num_children = 0;
+    int32_t converted_type = -1;
+};
+
+struct ColumnChunkMeta {
+    int32_t codec = UNCOMPRESSED;
+    int64_t num_values = 0;
+    int64_t total_compressed_size = 0;
+    int64_t data_page_offset = 0;
+    int64_t dictionary_page_offset = -1;
+    bool external = false;  // Stored in another file
+    // Statistics (min_value / max_value, or the legacy min / max)
+    std::optional<std::string> min, max, legacy_min, legacy_max;
+    std::optional<int64_t> null_count;
+};
+
+struct RowGroupMeta {
+    int64_t num_rows = 0;
+    std::vector<ColumnChunkMeta> columns;
+};
+
+static SchemaElement read_schema_element(ThriftReader& in) {
+    SchemaElement e;
+    in.read_struct([&](int16_t id, uint8_t type) {
+        switch (id) {
+        case 1:
+            e.type = static_cast<int32_t>(in.integer(type));
+            break;
+        case 3:
+            e.repetition = static_cast<int32_t>(in.integer(type));
+            break;
+        case 4:
+            e.name = std::string(in.binary(type));
+            break;
+        case 5:
+            e.num_children = static_cast<int32_t>(in.integer(type));
+            break;
+        case 6:
+            e.converted_type = static_cast<int32_t>(in.integer(type));
+            break;
+        default:
+            in.skip(type);
+        }
+    });
+    return e;
+}
+
+static void read_statistics(ThriftReader& in, ColumnChunkMeta& meta) {
+    in.read_struct([&](int16_t id, uint8_t type) {
+        switch (id) {
+        case 1:
+            meta.legacy_max = std::string(in.binary(type));
+            break;
+        case 2:
+            meta.legacy_min = std::string(in.binary(type));
+            break;
+        case 3:
+            meta.null_count = in.integer(type);
+            break;
+        case 5:
+            meta.max = std::string(in.binary(type));
+            break;
+        case 6:
+            meta.min = std::string(in.binary(type));
+            break;
+        default:
+            in.skip(type);
+        }
+    });
+}
+
+static ColumnChunkMeta read_column_chunk(ThriftReader& in) {
+    ColumnChunkMeta meta;
+    in.read_struct([&](int16_t id, uint8_t type) {
+        if (id == 1) {
+            in.skip(type);
+            meta.external = true;  // file_path
+        } else if (id == 3 && type == T_STRUCT) {
+            in.read_struct([&](int16_t field, uint8_t field_type) {
+                switch (field) {
+                case 4:
+                    meta.codec = static_cast<int32_t>(in.integer(field_type));
+                    break;
+                case 5:
+                    meta.num_values = in.integer(field_type);
+                    break;
+                case 7:
+                    meta.total_compressed_size = in.integer(field_type);
+                    break;
+                case 9:
+                    meta.data_page_offset = in.integer(field_type);
+                    break;
+                case 11:
+                    meta.dictionary_page_offset = in.integer(field_type);
+                    break;
+                case 12:
+                    if (field_type != T_STRUCT)
+                        in.skip(field_type);
+                    else
+                        read_statistics(in, meta);
+                    break;
+                default:
+                    in.skip(field_type);
+                }
+            });
+        } else {
+            in.skip(type);
+        }
+    });
+    return meta;
+}
+
+static RowGroupMeta read_row_group(ThriftReader& in) {
+    RowGroupMeta group;
+    in.read_struct([&](int16_t id, uint8_t type) {
+        if (id == 1) {
+            in.read_list(type, [&](uint8_t) { group.columns.push_back(read_column_chunk(in)); });
+        } else if (id == 3) {
+            group.num_rows = in.integer(type);
+        } else {
+            in.skip(type);
+        }
+    });
+    return group;
+}
+
+struct PageHeader {
+    int32_t type = -1;
+    int32_t uncompressed_size = 0;
+    int32_t compressed_size = 0;
+    int32_t num_values = 0;
+    int32_t encoding = PLAIN;
+    int32_t def_levels_length = 0;  // DATA_PAGE_V2
+    int32_t rep_levels_length = 0;  // DATA_PAGE_V2
+    bool is_compressed = true;      // DATA_PAGE_V2
+};
+
+static PageHeader read_page_header(ThriftReader& in) {
+    PageHeader h;
+    in.read_struct([&](int16_t id, uint8_t type) {
+        switch (id) {
+        case 1:
+            h.type = static_cast<int32_t>(in.integer(type));
+            break;
+        case 2:
+            h.uncompressed_size = static_cast<int32_t>(in.integer(type));
+            break;
+        case 3:
+            h.compressed_size = static_cast<int32_t>(in.integer(type));
+            break;
+        case 5:  // DataPageHeader
+        case 7:  // DictionaryPageHeader
+        case 8:  // DataPageHeaderV2
+            in.read_struct([&](int16_t field, uint8_t field_type) {
+                if (field == 1) {
+                    h.num_values = static_cast<int32_t>(in.integer(field_type));
+                } else if (id != 8 && field == 2) {
+                    h.encoding = static_cast<int32_t>(in.integer(field_type));
+                } else if (id == 8 && field == 4) {
+                    h.encoding = static_cast<int32_t>(in.integer(field_type));
+                } else if (id == 8 && field == 5) {
+                    h.def_levels_length = static_cast<int32_t>(in.integer(field_type));
+                } else if (id == 8 && field == 6) {
+                    h.rep_levels_length = static_cast<int32_t>(in.integer(field_type));
+                } else if (id == 8 && field == 7) {
+                    h.is_compressed = in.boolean(field_type);
+                } else {
+                    in.skip(field_type);
+                }
+            });
+            break;
+        default:
+            in.skip(type);
+        }
+    });
+    return h;
+}
+
+// ============================================================================
+// Page Decoding
+// ============================================================================
+
+// Helper: Snappy-decompress in into out (false if malformed or not size bytes)
+// Snappy is a varint length followed by literals and back-references
+static bool snappy_decompress(const uint8_t* in, size_t in_size, size_t size, std::string& out) {
+    const uint8_t* p = in;
+    const uint8_t* end = in + in_size;
+    uint64_t length;
+    if (!read_varint(p, end, length) || length != size)
+        return false;
+    out.resize(size);
+    size_t op = 0;
+    while (p < end) {
+        uint8_t tag = *p++;
+        size_t len;
+        size_t offset;
+        if ((tag & 3) == 0) {
+            len = tag >> 2;
+            if (len >= 60) {
+                size_t bytes = len - 59;
+                if (static_cast<size_t>(end - p) < bytes)
+                    return false;
+                len = 0;
+                for (size_t i = 0; i < bytes; ++i)
+                    len |= size_t{p[i]} << (8 * i);
+                p += bytes;
+            }
+            len += 1;
+            if (static_cast<size_t>(end - p) < len || size - op < len)
+                return false;
+            std::memcpy(&out[op], p, len);
+            p += len;
+            op += len;
+            continue;
+        }
+        if ((tag & 3) == 1) {
+            if (p == end)
+                return false;
+            len = ((tag >> 2) & 7) + 4;
+            offset = (size_t{tag} >> 5) << 8 | *p++;
+        } else {
+            size_t bytes = (tag & 3) == 2 ? 2 : 4;
+            if (static_cast<size_t>(end - p) < bytes)
+                return false;
+            len = (tag >> 2) + 1;
+            offset = 0;
+            for (size_t i = 0; i < bytes; ++i)
+                offset |= size_t{p[i]} << (8 * i);
+            p += bytes;
+        }
+        if (offset == 0 || offset > op || size - op < len)
+            return false;
+        for (size_t i = 0; i < len; ++i, ++op)  // Byte by byte: the ranges may overlap
+            out[op] = out[op - offset];
+    }
+    return op == size;
+}
+
+// Helper: Decode an RLE / bit-packed hybrid run sequence of count values
+static bool decode_rle(const uint8_t* p, size_t size, int bit_width, size_t count,
+                       std::vector<uint32_t>& out) {
+    out.clear();
+    if (bit_width < 0 || bit_width > 32)
+        return false;
+    out.reserve(count);
+    const uint8_t* end = p + size;
+    const uint64_t mask = (uint64_t{1} << bit_width) - 1;
+    const size_t value_bytes = (static_cast<size_t>(bit_width) + 7) / 8;
+    while (out.size() < count) {
+        uint64_t header;
+        if (!read_varint(p, end, header))
+            return false;
+        if (header & 1) {
+            // Bit-packed: groups of 8 values, bit_width bytes per group
+            uint64_t groups = header >> 1;
+            if (groups > static_cast<uint64_t>(end - p) / std::max(bit_width, 1))
+                return false;
+            size_t bytes = static_cast<size_t>(groups) * static_cast<size_t>(bit_width);
+            size_t n = std::min<size_t>(groups * 8, count - out.size());
+            for (size_t i = 0; i < n; ++i) {
+                size_t bit = i * static_cast<size_t>(bit_width);
+                uint64_t word = 0;
+                std::memcpy(&word, p + bit / 8, std::min<size_t>(8, bytes - bit / 8));
+                out.push_back(static_cast<uint32_t>((word >> (bit & 7)) & mask));
+            }
+            p += bytes;
+        } else {
+            // RLE: one value repeated
+            if (static_cast<size_t>(end - p) < value_bytes)
+                return false;
+            uint32_t value = 0;
+            std::memcpy(&value, p, value_bytes);
+            p += value_bytes;
+            size_t n = std::min<uint64_t>(header >> 1, count - out.size());
+            out.insert(out.end(), n, value);
+        }
+    }
+    return true;
+}
+
+// Helper: Append count definition levels (max level 1) to validity
+// Returns the number of present values, or SIZE_MAX if malformed
+static size_t append_def_levels(const uint8_t* p, size_t size, size_t count, Bitmap& validity) {
+    const uint8_t* end = p + size;
+    size_t done = 0;
+    size_t present = 0;
+    std::vector<uint64_t> words;
+    while (done < count) {
+        uint64_t header;
+        if (!read_varint(p, end, header))
+            return SIZE_MAX;
+        if (header & 1) {
+            // Bit-packed with bit width 1: the bytes are bitmap bytes
+            uint64_t bytes = header >> 1;
+            if (bytes > static_cast<uint64_t>(end - p))
+                return SIZE_MAX;
+            size_t n = std::min<size_t>(bytes * 8, count - done);
+            words.assign((n + 63) / 64, 0);
+            std::memcpy(words.data(), p, (n + 7) / 8);
+            if (n % 64 != 0)
+                words.back() &= (uint64_t{1} << (n % 64)) - 1;
+            for (uint64_t w : words)
+                present += static_cast<size_t>(__builtin_popcountll(w));
+            validity.append_bits(words.data(), 0, n);
+            p += bytes;
+            done += n;
+        } else {
+            if (p == end || *p > 1)
+                return SIZE_MAX;
+            bool value = *p++ != 0;
+            size_t n = std::min<uint64_t>(header >> 1, count - done);
+            validity.resize(validity.size() + n, value);
+            present += value ? n : 0;
+            done += n;
+        }
+    }
+    return present;
+}
+
+// Values of a dictionary page
+struct PageDictionary {
+    bool loaded = false;
+    size_t size = 0;
+    std::vector<int64_t> ints;
+    std::vector<double> doubles;
+    std::shared_ptr<StringDictionary> strings;
+    std::vector<int32_t> codes;  // Per entry: code in strings
+};
+
+// ============================================================================
+// Reader
+// ============================================================================
+
+// Helper: A statistics value decoded for the column's Joy type
+static std::optional<ColumnStats::Value> stat_value(const std::optional<std::string>& raw,
+                                                    int32_t physical_type, bool is_unsigned) {
+    if (!raw) {
+        return std::nullopt;
+    }
+    const auto* p = reinterpret_cast<const uint8_t*>(raw->data());
+    switch (physical_type) {
+    case INT32:
+        if (raw->size() != 4)
+            return std::nullopt;
+        return is_unsigned ? int64_t{load<uint32_t>(p)} : int64_t{load<int32_t>(p)};
+    case INT64:
+        if (raw->size() != 8)
+            return std::nullopt;
+        return load<int64_t>(p);
+    case FLOAT:
+        if (raw->size() != 4)
+            return std::nullopt;
+        return static_cast<double>(load<float>(p));
+    case DOUBLE:
+        if (raw->size() != 8)
+            return std::nullopt;
+        return load<double>(p);
+    case BYTE_ARRAY:
+        return *raw;
+    default:
+        return std::nullopt;
+    }
+}
+
+ParquetReader::ParquetReader(const std::string& filepath, ThreadPool* pool,
+                             const std::vector<std::string>* columns,
+                             const std::vector<PhysicalOp::VectorizedFilterOp>* predicates)
+    : filepath_(filepath), file_(filepath), pool_(pool) {
+    const auto* data = reinterpret_cast<const uint8_t*>(file_.data());
+    const size_t size = file_.size();
+    auto corrupt = [&] { throw std::runtime_error("Corrupt Parquet file: " + filepath); };
+    if (size < 12 || std::memcmp(data, kParquetMagic, 4) != 0 ||
+        std::memcmp(data + size - 4, kParquetMagic, 4) != 0) {
+        throw std::runtime_error("Not a Parquet file: " + filepath);
+    }
+    const uint32_t footer_size = load<uint32_t>(data + size - 8);
+    if (footer_size > size - 12)
+        corrupt();
+    const uint64_t footer = size - 8 - footer_size;
+
+    std::vector<SchemaElement> schema;
+    std::vector<RowGroupMeta> groups;
+    ThriftReader in(data + footer, footer_size, filepath_);
+    in.read_struct([&](int16_t id, uint8_t type) {
+        if (id == 2) {
+            in.read_list(type, [&](uint8_t) { schema.push_back(read_schema_element(in)); });
+        } else if (id == 4) {
+            in.read_list(type, [&](uint8_t) { groups.push_back(read_row_group(in)); });
+        } else {
+            in.skip(type);
+        }
+    });
+    if (schema.empty())
+        corrupt();
+
+    // Schema: a root group whose children are the columns; each leaf (primitive
+    // element) has one column chunk per row group
+    std::vector<size_t> leaf_of;  // Per returned column
+    size_t next = 1;
+    size_t num_leaves = 0;
+    auto skip_subtree = [&](auto& self, int depth) -> void {
+        if (next >= schema.size() || depth > 64)
+            corrupt();
+        const SchemaElement& e = schema[next++];
+        if (e.num_children <= 0) {
+            num_leaves++;
+            return;
+        }
+        for (int32_t i = 0; i < e.num_children; ++i)
+            self(self, depth + 1);
+    };
+    for (int32_t i = 0; i < schema[0].num_children; ++i) {
+        if (next >= schema.size())
+            corrupt();
+        const SchemaElement e = schema[next];
+        const size_t leaf = num_leaves;
+        skip_subtree(skip_subtree, 0);
+        if (columns && std::find(columns->begin(), columns->end(), e.name) == columns->end()) {
+            continue;
+        }
+
+        Field field;
+        field.physical_type = e.type;
+        field.optional = e.repetition == OPTIONAL;
+        field.is_unsigned = e.converted_type == UINT_8 || e.converted_type == UINT_16 ||
+                            e.converted_type == UINT_32;
+        ColumnType type = ColumnType::INT64;
+        switch (e.num_children > 0 || e.repetition == REPEATED || e.converted_type == DECIMAL
+                    ? -1
+                    : e.type) {
+        case BOOLEAN:
+            type = ColumnType::BOOL;
+            break;
+        case INT32:
+        case INT64:
+            type = ColumnType::INT64;
+            break;
+        case FLOAT:
+        case DOUBLE:
+            type = ColumnType::DOUBLE;
+            break;
+        case BYTE_ARRAY:
+            type = ColumnType::STRING;
+            break;
+        default:
+            throw std::runtime_error("Unsupported Parquet type for column " + e.name + ": " +
+                                     filepath);
+        }
+        headers_.push_back(e.name);
+        types_.push_back(type);
+        inferred_.push_back(true);  // Declared by the schema
+        fields_.push_back(field);
+        leaf_of.push_back(leaf);
+    }
+
+    for (const auto& group : groups) {
+        if (group.columns.size() != num_leaves || group.num_rows < 0)
+            corrupt();
+        if (group.num_rows == 0)
+            continue;
+        if (static_cast<uint64_t>(group.num_rows) > UINT32_MAX) {
+            throw std::runtime_error("Parquet row group too large: " + filepath);
+        }
+
+        RowGroup rg;
+        rg.num_rows = static_cast<uint64_t>(group.num_rows);
+        for (size_t c = 0; c < fields_.size(); ++c) {
+            const ColumnChunkMeta& meta = group.columns[leaf_of[c]];
+            if (meta.external) {
+                throw std::runtime_error("Parquet column chunks in other files are not supported: " +
+                                         filepath);
+            }
+            Chunk chunk;
+            int64_t start = meta.data_page_offset;
+            if (meta.dictionary_page_offset > 0)
+                start = std::min(start, meta.dictionary_page_offset);
+            if (start < 4 || meta.total_compressed_size < 0 ||
+                static_cast<uint64_t>(start) > footer ||
+                static_cast<uint64_t>(meta.total_compressed_size) > footer - start)
+                corrupt();
+            chunk.offset = static_cast<uint64_t>(start);
+            chunk.size = static_cast<uint64_t>(meta.total_compressed_size);
+            chunk.num_values = meta.num_values;
+            chunk.codec = meta.codec;
+
+            // Legacy min / max used signed byte order, which is wrong for strings
+            // and unsigned integers
+            const Field& field = fields_[c];
+            bool legacy_ok = field.physical_type != BYTE_ARRAY && !field.is_unsigned;
+            const auto& min = meta.min ? meta.min : (legacy_ok ? meta.legacy_min : std::nullopt);
+            const auto& max = meta.max ? meta.max : (legacy_ok ? meta.legacy_max : std::nullopt);
+            chunk.stats.min = stat_value(min, field.physical_type, field.is_unsigned);
+            chunk.stats.max = stat_value(max, field.physical_type, field.is_unsigned);
+            if (meta.null_count && *meta.null_count >= 0)
+                chunk.stats.null_count = static_cast<uint64_t>(*meta.null_count);
+            chunk.stats.num_rows = rg.num_rows;
+            rg.chunks.push_back(std::move(chunk));
+        }
+
+        // Row groups where a filter cannot match are never read
+        bool skip = false;
+        for (size_t p = 0; predicates && p < predicates->size() && !skip; ++p) {
+            const auto& predicate = (*predicates)[p];
+            auto it = std::find(headers_.begin(), headers_.end(), predicate.column_name);
+            if (it != headers_.end())
+                skip = !may_match(predicate, rg.chunks[it - headers_.begin()].stats);
+        }
+        if (skip) {
+            skipped_++;
+            continue;
+        }
+        row_groups_.push_back(std::move(rg));
+    }
+}
+
+void ParquetReader::decode_chunk(const Chunk& chunk, size_t c, Column& col) const {
+    const Field& field = fields_[c];
+    const auto* data = reinterpret_cast<const uint8_t*>(file_.data());
+    auto corrupt = [&] { throw std::runtime_error("Corrupt Parquet file: " + filepath_); };
+
+    PageDictionary dict;
+    std::string decompressed;
+    std::vector<uint32_t> indices;
+    uint64_t pos = chunk.offset;
+    const uint64_t end = chunk.offset + chunk.size;
+    int64_t values_left = chunk.num_values;
+    while (values_left > 0) {
+        if (pos >= end)
+            corrupt();
+        ThriftReader in(data + pos, end - pos, filepath_);
+        PageHeader header = read_page_header(in);
+        pos += in.consumed();
+        if (header.compressed_size < 0 || header.uncompressed_size < 0 ||
+            static_cast<uint64_t>(header.compressed_size) > end - pos || header.num_values < 0)
+            corrupt();
+        const uint8_t* page = data + pos;
+        size_t page_size = static_cast<size_t>(header.compressed_size);
+        pos += page_size;
+        if (header.type != DATA_PAGE && header.type != DATA_PAGE_V2 &&
+            header.type != DICTIONARY_PAGE) {
+            continue;  // Index pages
+        }
+
+        // Definition levels ahead of the (possibly compressed) values (v2)
+        const uint8_t* levels = nullptr;
+        size_t levels_size = 0;
+        size_t uncompressed_size = static_cast<size_t>(header.uncompressed_size);
+        if (header.type == DATA_PAGE_V2) {
+            if (header.rep_levels_length != 0 || header.def_levels_length < 0 ||
+                static_cast<size_t>(header.def_levels_length) > page_size ||
+                static_cast<size_t>(header.def_levels_length) > uncompressed_size)
+                corrupt();
+            levels = page;
+            levels_size = static_cast<size_t>(header.def_levels_length);
+            page += levels_size;
+            page_size -= levels_size;
+            uncompressed_size -= levels_size;
+        }
+
+        const uint8_t* values = page;
+        size_t values_size = page_size;
+        bool compressed = header.type != DATA_PAGE_V2 || header.is_compressed;
+        if (compressed && chunk.codec == SNAPPY) {
+            if (!snappy_decompress(page, page_size, uncompressed_size, decompressed))
+                corrupt();
+            values = reinterpret_cast<const uint8_t*>(decompressed.data());
+            values_size = decompressed.size();
+        } else if (compressed && chunk.codec != UNCOMPRESSED) {
+            throw std::runtime_error("Unsupported Parquet compression codec " +
+                                     std::to_string(chunk.codec) + ": " + filepath_);
+        }
+
+        const size_t n = static_cast<size_t>(header.num_values);
+        if (header.type == DICTIONARY_PAGE) {
+            // PLAIN-encoded entries
+            dict = PageDictionary{};
+            dict.loaded = true;
+            dict.size = n;
+            size_t q = 0;
+            for (size_t i = 0; i < n; ++i) {
+                switch (field.physical_type) {
+                case INT32:
+                case INT64: {
+                    size_t width = field.physical_type == INT32 ? 4 : 8;
+                    if (values_size - q < width)
+                        corrupt();
+                    dict.ints.push_back(width == 8 ? load<int64_t>(values + q)
+                                        : field.is_unsigned
+                                            ? int64_t{load<uint32_t>(values + q)}
+                                            : int64_t{load<int32_t>(values + q)});
+                    q += width;
+                    break;
+                }
+                case FLOAT:
+                case DOUBLE: {
+                    size_t width = field.physical_type == FLOAT ? 4 : 8;
+                    if (values_size - q < width)
+                        corrupt();
+                    dict.doubles.push_back(width == 8 ? load<double>(values + q)
+                                                      : double{load<float>(values + q)});
+                    q += width;
+                    break;
+                }
+                case BYTE_ARRAY: {
+                    if (!dict.strings)
+                        dict.strings = std::make_shared<StringDictionary>();
+                    if (values_size - q < 4)
+                        corrupt();
+                    uint32_t len = load<uint32_t>(values + q);
+                    if (values_size - q - 4 < len)
+                        corrupt();
+                    dict.codes.push_back(dict.strings->intern(
+                        std::string_view(reinterpret_cast<const char*>(values + q + 4), len)));
+                    q += 4 + size_t{len};
+                    break;
+                }
+                default:
+                    corrupt();  // BOOLEAN columns have no dictionary
+                }
+            }
+            // A string chunk that starts with a dictionary stays dictionary-encoded
+            if (dict.strings && col.size() == 0) {
+                DictStrings strings;
+                strings.dict = dict.strings;
+                col.data = std::move(strings);
+            }
+            continue;
+        }
+
+        // Definition levels (v1: a 4-byte length, then the runs)
+        const size_t start = col.validity.size();
+        size_t present = n;
+        if (field.optional) {
+            if (header.type == DATA_PAGE) {
+                if (values_size < 4 || load<uint32_t>(values) > values_size - 4)
+                    corrupt();
+                levels_size = load<uint32_t>(values);
+                levels = values + 4;
+                values += 4 + levels_size;
+                values_size -= 4 + levels_size;
+            }
+            present = append_def_levels(levels, levels_size, n, col.validity);
+            if (present == SIZE_MAX)
+                corrupt();
+        } else {
+            col.validity.resize(start + n, true);
+        }
+        auto is_present = [&](size_t i) { return present == n || col.validity.get(start + i); };
+
+        // Values of the present rows; NULL rows get the column's default
+        if (header.encoding == PLAIN_DICTIONARY || header.encoding == RLE_DICTIONARY) {
+            if (!dict.loaded || values_size < 1 ||
+                !decode_rle(values + 1, values_size - 1, values[0], present, indices))
+                corrupt();
+            for (uint32_t index : indices) {
+                if (index >= dict.size)
+                    corrupt();
+            }
+            size_t j = 0;
+            switch (col.type) {
+            case ColumnType::INT64: {
+                auto& dst = col.values<int64_t>();
+                for (size_t i = 0; i < n; ++i)
+                    dst.push_back(is_present(i) ? dict.ints[indices[j++]] : 0);
+                break;
+            }
+            case ColumnType::DOUBLE: {
+                auto& dst = col.values<double>();
+                for (size_t i = 0; i < n; ++i)
+                    dst.push_back(is_present(i) ? dict.doubles[indices[j++]] : 0.0);
+                break;
+            }
+            case ColumnType::STRING:
+                if (auto* dst = std::get_if<DictStrings>(&col.data)) {
+                    const bool same = dst->dict == dict.strings;
+                    for (size_t i = 0; i < n; ++i) {
+                        if (!is_present(i))
+                            dst->push_null();
+                        else if (same)
+                            dst->codes.push_back(dict.codes[indices[j++]]);
+                        else
+                            dst->push_back(dict.strings->get(dict.codes[indices[j++]]));
+                    }
+                } else {
+                    auto& arena = std::get<StringArena>(col.data);
+                    for (size_t i = 0; i < n; ++i) {
+                        arena.push_back(is_present(i)
+                                            ? dict.strings->get(dict.codes[indices[j++]])
+                                            : std::string_view());
+                    }
+                }
+                break;
+            case ColumnType::BOOL:
+                corrupt();
+            }
+        } else if (header.encoding == PLAIN) {
+            switch (field.physical_type) {
+            case INT32:
+            case INT64: {
+                const size_t width = field.physical_type == INT32 ? 4 : 8;
+                if (values_size / width < present)
+                    corrupt();
+                auto& dst = col.values<int64_t>();
+                if (width == 8 && present == n) {
+                    size_t old = dst.size();
+                    dst.resize(old + n);
+                    std::memcpy(dst.data() + old, values, n * 8);
+                    break;
+                }
+                size_t j = 0;
+                for (size_t i = 0; i < n; ++i) {
+                    int64_t v = 0;
+                    if (is_present(i)) {
+                        const uint8_t* p = values + width * j++;
+                        v = width == 8          ? load<int64_t>(p)
+                            : field.is_unsigned ? int64_t{load<uint32_t>(p)}
+                                                : int64_t{load<int32_t>(p)};
+                    }
+                    dst.push_back(v);
+                }
+                break;
+            }
+            case FLOAT:
+            case DOUBLE: {
+                const size_t width = field.physical_type == FLOAT ? 4 : 8;
+                if (values_size / width < present)
+                    corrupt();
+                auto& dst = col.values<double>();
+                if (width == 8 && present == n) {
+                    size_t old = dst.size();
+                    dst.resize(old + n);
+                    std::memcpy(dst.data() + old, values, n * 8);
+                    break;
+                }
+                size_t j = 0;
+                for (size_t i = 0; i < n; ++i) {
+                    double v = 0.0;
+                    if (is_present(i)) {
+                        const uint8_t* p = values + width * j++;
+                        v = width == 8 ? load<double>(p) : double{load<float>(p)};
+                    }
+                    dst.push_back(v);
+                }
+                break;
+            }
+            case BOOLEAN: {
+                // Bit-packed, least significant bit first
+                if (values_size < (present + 7) / 8)
+                    corrupt();
+                auto& dst = std::get<Bitmap>(col.data);
+                size_t j = 0;
+                for (size_t i = 0; i < n; ++i) {
+                    bool v = false;
+                    if (is_present(i)) {
+                        v = (values[j >> 3] >> (j & 7)) & 1;
+                        j++;
+                    }
+                    dst.push_back(v);
+                }
+                break;
+            }
+            case BYTE_ARRAY: {
+                // Each value: 4-byte length, then the bytes
+                auto* dst_dict = std::get_if<DictStrings>(&col.data);
+                size_t q = 0;
+                for (size_t i = 0; i < n; ++i) {
+                    std::string_view s;
+                    if (is_present(i)) {
+                        if (values_size - q < 4)
+                            corrupt();
+                        uint32_t len = load<uint32_t>(values + q);
+                        if (values_size - q - 4 < len)
+                            corrupt();
+                        s = std::string_view(reinterpret_cast<const char*>(values + q + 4), len);
+                        q += 4 + size_t{len};
+                    }
+                    if (!dst_dict)
+                        std::get<StringArena>(col.data).push_back(s);
+                    else if (is_present(i))
+                        dst_dict->push_back(s);
+                    else
+                        dst_dict->push_null();
+                }
+                break;
+            }
+            default:
+                corrupt();
+            }
+        } else {
+            throw std::runtime_error("Unsupported Parquet encoding " +
+                                     std::to_string(header.encoding) + ": " + filepath_);
+        }
+        values_left -= static_cast<int64_t>(n);
+    }
+}
+
+bool ParquetReader::next_batch(Table& out, size_t max_rows) {
+    if (row_ == current_.num_rows && group_ < row_groups_.size()) {
+        // Decode the next row group, one column chunk per task
+        const RowGroup& rg = row_groups_[group_++];
+        Table decoded;
+        decoded.num_rows = rg.num_rows;
+        decoded.columns.resize(headers_.size());
+        auto decode_column = [&](size_t c) {
+            Column col = Column::make(headers_[c], types_[c]);
+            col.reserve(rg.num_rows);
+            decode_chunk(rg.chunks[c], c, col);
+            if (col.size() != rg.num_rows) {
+                throw std::runtime_error("Corrupt Parquet file: " + filepath_);
+            }
+            decoded.columns[c] = std::move(col);
+        };
+        if (pool_ && headers_.size() > 1) {
+            pool_->parallel_for(headers_.size(), decode_column);
+        } else {
+            for (size_t c = 0; c < headers_.size(); ++c)
+                decode_column(c);
+        }
+        current_ = std::move(decoded);
+        row_ = 0;
+    }
+
+    if (row_ == current_.num_rows) {
+        if (started_) {
+            return false;
+        }
+        // No rows at all: the first batch still carries the schema
+        started_ = true;
+        out = Table{};
+        for (size_t c = 0; c < headers_.size(); ++c)
+            out.add_column(Column::make(headers_[c], types_[c]));
+        return true;
+    }
+    started_ = true;
+
+    size_t count = std::min(max_rows, current_.num_rows - row_);
+    if (row_ == 0 && count == current_.num_rows) {
+        out = std::move(current_);
+        current_ = Table{};
+        return true;
+    }
+    std::vector<uint32_t> rows(count);
+    std::iota(rows.begin(), rows.end(), static_cast<uint32_t>(row_));
+    out = current_.gather(rows);
+    row_ += count;
+    return true;
+}
+
+// ============================================================================
+// Writer
+// ============================================================================
+
+static int32_t physical_type_of(ColumnType type) {
+    switch (type) {
+    case ColumnType::INT64:
+        return INT64;
+    case ColumnType::DOUBLE:
+        return DOUBLE;
+    case ColumnType::STRING:
+        return BYTE_ARRAY;
+    case ColumnType::BOOL:
+        return BOOLEAN;
+    }
+    return BYTE_ARRAY;
+}
+
+static void put_plain_string(std::string& out, std::string_view s) {
+    put<uint32_t>(out, static_cast<uint32_t>(s.size()));
+    out.append(s.data(), s.size());
+}
+
+// Helper: Append values as one bit-packed run of the RLE / bit-packed hybrid
+static void put_bit_packed(std::string& out, const std::vector<uint32_t>& values,
+                           int bit_width) {
+    const size_t groups = (values.size() + 7) / 8;
+    put_varint(out, groups << 1 | 1);
+    std::string packed(groups * static_cast<size_t>(bit_width), '\0');
+    for (size_t i = 0; i < values.size(); ++i) {
+        size_t bit = i * static_cast<size_t>(bit_width);
+        for (int b = 0; b < bit_width; ++b, ++bit) {
+            if ((values[i] >> b) & 1)
+                packed[bit / 8] = static_cast<char>(packed[bit / 8] | (1 << (bit % 8)));
+        }
+    }
+    out += packed;
+}
+
+ParquetWriter::ParquetWriter(const std::string& filepath)
+    : filepath_(filepath), file_(filepath, std::ios::binary) {
+    if (!file_) {
+        throw std::runtime_error("Cannot create file: " + filepath);
+    }
+    file_.write(kParquetMagic, sizeof(kParquetMagic));
+    pos_ = sizeof(kParquetMagic);
+}
+
+ParquetWriter::~ParquetWriter() {
+    if (!closed_) {
+        try {
+            close();
+        } catch (...) {
+        }
+    }
+}
+
+std::string ParquetWriter::write_chunk(const Column& col, size_t num_rows, uint64_t& bytes) {
+    const uint64_t chunk_start = pos_;
+    auto write_page = [&](int32_t type, const std::string& body, auto&& page_header) {
+        ThriftWriter header;
+        header.i32(1, type);
+        header.i32(2, static_cast<int32_t>(body.size()));  // Uncompressed
+        header.i32(3, static_cast<int32_t>(body.size()));
+        page_header(header);
+        std::string h = header.finish();
+        file_.write(h.data(), static_cast<std::streamsize>(h.size()));
+        file_.write(body.data(), static_cast<std::streamsize>(body.size()));
+        pos_ += h.size() + body.size();
+    };
+
+    // Dictionary-encoded strings: the dictionary page, then codes as indices
+    const auto* dict = std::get_if<DictStrings>(&col.data);
+    int bit_width = 1;
+    if (dict) {
+        std::string body;
+        const size_t dict_size = dict->dict->size();
+        for (size_t code = 0; code < dict_size; ++code)
+            put_plain_string(body, dict->dict->get(static_cast<int32_t>(code)));
+        write_page(DICTIONARY_PAGE, body, [&](ThriftWriter& h) {
+            h.begin_struct(7);
+            h.i32(1, static_cast<int32_t>(dict_size));
+            h.i32(2, PLAIN);
+            h.end_struct();
+        });
+        while (dict_size > (size_t{1} << bit_width))
+            bit_width++;
+    }
+
+    const uint64_t data_start = pos_;
+    const auto* words = reinterpret_cast<const char*>(col.validity.words());
+    for (size_t begin = 0; begin < num_rows; begin += kParquetPageRows) {
+        const size_t count = std::min(kParquetPageRows, num_rows - begin);
+        std::string body;
+
+        // Definition levels: one bit-packed run of the validity bits (1 = present)
+        std::string levels;
+        put_varint(levels, ((count + 7) / 8) << 1 | 1);
+        levels.append(words + begin / 8, (count + 7) / 8);
+        put<uint32_t>(body, static_cast<uint32_t>(levels.size()));
+        body += levels;
+
+        const bool all_present = col.validity.count() == col.size();
+        switch (col.type) {
+        case ColumnType::INT64:
+        case ColumnType::DOUBLE: {
+            const char* values = col.type == ColumnType::INT64
+                                     ? reinterpret_cast<const char*>(col.values<int64_t>().data())
+                                     : reinterpret_cast<const char*>(col.values<double>().data());
+            if (all_present) {
+                body.append(values + begin * 8, count * 8);
+                break;
+            }
+            for (size_t i = begin; i < begin + count; ++i) {
+                if (!col.is_null(i))
+                    body.append(values + i * 8, 8);
+            }
+            break;
+        }
+        case ColumnType::BOOL: {
+            const auto& bits = std::get<Bitmap>(col.data);
+            std::vector<uint32_t> packed;
+            for (size_t i = begin; i < begin + count; ++i) {
+                if (!col.is_null(i))
+                    packed.push_back(bits.get(i));
+            }
+            std::string plain((packed.size() + 7) / 8, '\0');
+            for (size_t j = 0; j < packed.size(); ++j) {
+                if (packed[j])
+                    plain[j / 8] = static_cast<char>(plain[j / 8] | (1 << (j % 8)));
+            }
+            body += plain;
+            break;
+        }
+        case ColumnType::STRING:
+            if (dict) {
+                std::vector<uint32_t> indices;
+                for (size_t i = begin; i < begin + count; ++i) {
+                    if (!col.is_null(i))
+                        indices.push_back(static_cast<uint32_t>(dict->codes[i]));
+                }
+                body.push_back(static_cast<char>(bit_width));
+                if (!indices.empty())
+                    put_bit_packed(body, indices, bit_width);
+            } else {
+                const auto& arena = std::get<StringArena>(col.data);
+                for (size_t i = begin; i < begin + count; ++i) {
+                    if (!col.is_null(i))
+                        put_plain_string(body, arena.get(i));
+                }
+            }
+            break;
+        }
+
+        write_page(DATA_PAGE, body, [&](ThriftWriter& h) {
+            h.begin_struct(5);
+            h.i32(1, static_cast<int32_t>(count));
+            h.i32(2, dict ? RLE_DICTIONARY : PLAIN);
+            h.i32(3, RLE);  // Definition levels
+            h.i32(4, RLE);  // Repetition levels
+            h.end_struct();
+        });
+    }
+    bytes = pos_ - chunk_start;
+
+    // Statistics over the present values
+    const size_t null_count = num_rows - col.validity.count();
+    std::optional<std::string> min, max;
+    auto plain_of = [](auto value) {
+        std::string s;
+        put(s, value);
+        return s;
+    };
+    switch (col.type) {
+    case ColumnType::INT64:
+    case ColumnType::DOUBLE:
+        std::visit(
+            [&](const auto& values) {
+                using Vec = std::decay_t<decltype(values)>;
+                if constexpr (std::is_same_v<Vec, std::vector<int64_t>> ||
+                              std::is_same_v<Vec, std::vector<double>>) {
+                    std::optional<typename Vec::value_type> lo, hi;
+                    for (size_t i = 0; i < num_rows; ++i) {
+                        auto v = values[i];
+                        if (col.is_null(i) || v != v)  // NaN is left out of the range
+                            continue;
+                        if (!lo || v < *lo)
+                            lo = v;
+                        if (!hi || v > *hi)
+                            hi = v;
+                    }
+                    if (lo) {
+                        min = plain_of(*lo);
+                        max = plain_of(*hi);
+                    }
+                }
+            },
+            col.data);
+        break;
+    case ColumnType::STRING: {
+        std::optional<std::string_view> lo, hi;
+        auto add = [&](std::string_view s) {
+            if (!lo || s < *lo)
+                lo = s;
+            if (!hi || s > *hi)
+                hi = s;
+        };
+        if (dict) {
+            std::vector<bool> used(dict->dict->size(), false);
+            for (size_t i = 0; i < num_rows; ++i) {
+                if (!col.is_null(i))
+                    used[static_cast<size_t>(dict->codes[i])] = true;
+            }
+            for (size_t code = 0; code < used.size(); ++code) {
+                if (used[code])
+                    add(dict->dict->get(static_cast<int32_t>(code)));
+            }
+        } else {
+            for (size_t i = 0; i < num_rows; ++i) {
+                if (!col.is_null(i))
+                    add(col.get_string(i));
+            }
+        }
+        if (lo && lo->size() <= kMaxStatBytes && hi->size() <= kMaxStatBytes) {
+            min = std::string(*lo);
+            max = std::string(*hi);
+        }
+        break;
+    }
+    case ColumnType::BOOL:
+        break;
+    }
+
+    ThriftWriter chunk;
+    chunk.i64(2, static_cast<int64_t>(chunk_start));  // file_offset
+    chunk.begin_struct(3);                            // ColumnMetaData
+    chunk.i32(1, physical_type_of(col.type));
+    chunk.begin_list(2, T_I32, dict ? 3 : 2);  // Encodings
+    chunk.element_i32(PLAIN);
+    chunk.element_i32(RLE);
+    if (dict)
+        chunk.element_i32(RLE_DICTIONARY);
+    chunk.begin_list(3, T_BINARY, 1);  // path_in_schema
+    chunk.element_binary(col.name);
+    chunk.i32(4, UNCOMPRESSED);
+    chunk.i64(5, static_cast<int64_t>(num_rows));
+    chunk.i64(6, static_cast<int64_t>(bytes));  // Uncompressed
+    chunk.i64(7, static_cast<int64_t>(bytes));
+    chunk.i64(9, static_cast<int64_t>(data_start));
+    if (dict)
+        chunk.i64(11, static_cast<int64_t>(chunk_start));
+    chunk.begin_struct(12);  // Statistics
+    chunk.i64(3, static_cast<int64_t>(null_count));
+    if (min) {
+        chunk.binary(5, *max);
+        chunk.binary(6, *min);
+    }
+    chunk.end_struct();
+    chunk.end_struct();
+    return chunk.finish();
+}
+
+void ParquetWriter::write(const Table& batch) {
+    if (!schema_known_) {
+        for (const auto& col : batch.columns)
+            schema_.emplace_back(col.name, col.type);
+        schema_known_ = true;
+    } else if (batch.columns.size() != schema_.size()) {
+        throw std::runtime_error("Cannot append tables with different schemas");
+    }
+    if (batch.num_rows == 0) {
+        return;
+    }
+
+    const uint64_t group_start = pos_;
+    std::vector<std::string> chunks;
+    uint64_t total_bytes = 0;
+    for (size_t c = 0; c < schema_.size(); ++c) {
+        const Column& col = batch.columns[c];
+        if (col.type != schema_[c].second) {
+            throw std::runtime_error("Cannot append column " + col.name + ": type mismatch");
+        }
+        uint64_t bytes = 0;
+        chunks.push_back(write_chunk(col, batch.num_rows, bytes));
+        total_bytes += bytes;
+    }
+
+    ThriftWriter group;
+    group.begin_list(1, T_STRUCT, chunks.size());
+    for (const auto& chunk : chunks)
+        group.raw(chunk);
+    group.i64(2, static_cast<int64_t>(total_bytes));
+    group.i64(3, static_cast<int64_t>(batch.num_rows));
+    group.i64(5, static_cast<int64_t>(group_start));
+    group.i64(6, static_cast<int64_t>(total_bytes));
+    row_groups_.push_back(group.finish());
+    num_rows_ += batch.num_rows;
+
+    if (!file_) {
+        throw std::runtime_error("Failed to write file: " + filepath_);
+    }
+}
+
+void ParquetWriter::close() {
+    closed_ = true;
+
+    ThriftWriter meta;
+    meta.i32(1, 1);  // version
+    meta.begin_list(2, T_STRUCT, schema_.size() + 1);
+    meta.begin_element();  // Root
+    meta.binary(4, "schema");
+    meta.i32(5, static_cast<int32_t>(schema_.size()));
+    meta.end_struct();
+    for (const auto& [name, type] : schema_) {
+        meta.begin_element();
+        meta.i32(1, physical_type_of(type));
+        meta.i32(3, OPTIONAL);
+        meta.binary(4, name);
+        if (type == ColumnType::STRING) {
+            meta.i32(6, UTF8);
+            meta.begin_struct(10);  // LogicalType: STRING
+            meta.begin_struct(1);
+            meta.end_struct();
+            meta.end_struct();
+        }
+        meta.end_struct();
+    }
+    meta.i64(3, static_cast<int64_t>(num_rows_));
+    meta.begin_list(4, T_STRUCT, row_groups_.size());
+    for (const auto& group : row_groups_)
+        meta.raw(group);
+    meta.binary(6, "joy");  // created_by
+    std::string footer = meta.finish();
+
+    put<uint32_t>(footer, static_cast<uint32_t>(footer.size()));
+    footer.append(kParquetMagic, sizeof(kParquetMagic));
+    file_.write(footer.data(), static_cast<std::streamsize>(footer.size()));
+    file_.close();
+    if (file_.fail()) {
+        throw std::runtime_error("Failed to write file: " + filepath_);
+    }
+}
+
+}  // namespace joy
@@ -27,7 +27,9 @@ Program Parser::parse_program() {
 
 // Parse a pipeline of operations
 // Grammar: pipeline ::= from_stmt operation*
-// where operation ::= filter_stmt | select_stmt | write_stmt
+// where operation ::= filter_stmt | select_stmt | transform_stmt | write_stmt
+//                   | group_stmt | aggregate_stmt | join_stmt | sort_stmt
+//                   | limit_stmt
 //
 // Example:
 //   from "data.csv"
@@ -50,6 +52,16 @@ std::vector<Stmt> Parser::parse_pipeline() {
             statements.push_back(parse_transform_stmt());
         } else if (check(TokenType::WRITE)) {
             statements.push_back(parse_write_stmt());
+        } else if (check(TokenType::GROUP)) {
+            statements.push_back(parse_group_stmt());
+        } else if (check(TokenType::AGGREGATE)) {
+            statements.push_back(parse_aggregate_stmt());
+        } else if (check(TokenType::JOIN)) {
+            statements.push_back(parse_join_stmt());
+        } else if (check(TokenType::SORT)) {
+            statements.push_back(parse_sort_stmt());
+        } else if (check(TokenType::LIMIT)) {
+            statements.push_back(parse_limit_stmt());
         } else {
             // Not a recognized statement, stop parsing pipeline
             break;
@@ -66,13 +78,45 @@ std::vector<Stmt> Parser::parse_pipeline() {
 // These methods consume tokens and build AST nodes
 
 // Parse: from "filepath.csv"
-// Grammar: from_stmt ::= FROM STRING
+// Grammar: from_stmt ::= FROM STRING ( "," STRING )* ( SCHEMA "(" IDENT IDENT ( "," IDENT IDENT )* ")" )?
+// Example: from "logs/2026-10-*.csv", "extra.csv" schema (id int, price double)
 Stmt Parser::parse_from_stmt() {
     consume(TokenType::FROM, "Expected 'from'");
-    Token filepath = consume(TokenType::STRING, "Expected string literal for file path");
+    FromStmt node;
+    do {
+        node.filepaths.push_back(
+            consume(TokenType::STRING, "Expected string literal for file path").lexeme);
+    } while (match(TokenType::COMMA));
+
+    if (match(TokenType::SCHEMA)) {
+        consume(TokenType::LPAREN, "Expected '(' after 'schema'");
+        do {
+            ColumnDecl decl;
+            decl.name = consume(TokenType::IDENT, "Expected column name").lexeme;
+            for (const auto& prior : node.schema) {
+                if (prior.name == decl.name) {
+                    error("Column '" + decl.name + "' is declared twice in the schema");
+                }
+            }
+            std::string type = consume(TokenType::IDENT, "Expected column type").lexeme;
+            if (type == "int" || type == "int64") {
+                decl.type = ValueType::Int;
+            } else if (type == "double") {
+                decl.type = ValueType::Double;
+            } else if (type == "string") {
+                decl.type = ValueType::String;
+            } else if (type == "bool") {
+                decl.type = ValueType::Bool;
+            } else {
+                error("Unknown column type '" + type + "' (expected int, double, string or bool)");
+            }
+            node.schema.push_back(std::move(decl));
+        } while (match(TokenType::COMMA));
+        consume(TokenType::RPAREN, "Expected ')' after schema");
+    }
 
     Stmt stmt;
-    stmt.node = FromStmt{filepath.lexeme};
+    stmt.node = std::move(node);
     return stmt;
 }
 
@@ -125,6 +169,142 @@ Stmt Parser::parse_write_stmt() {
     return stmt;
 }
 
+// Parse: group by key1, key2 aggregate agg1, agg2
+// Grammar: group_stmt ::= GROUP BY column_list ( AGGREGATE aggregate_list )?
+// Example: group by department aggregate sum(salary), count()
+// Without aggregates the output is the distinct key combinations
+Stmt Parser::parse_group_stmt() {
+    consume(TokenType::GROUP, "Expected 'group'");
+    consume(TokenType::BY, "Expected 'by' after 'group'");
+    auto keys = parse_column_list();
+
+    std::vector<AggregateCall> aggregates;
+    if (match(TokenType::AGGREGATE)) {
+        aggregates = parse_aggregate_list();
+    }
+
+    Stmt stmt;
+    stmt.node = GroupByStmt{std::move(keys), std::move(aggregates)};
+    return stmt;
+}
+
+// Parse: join "filepath.csv" on key1, key2
+// Grammar: join_stmt ::= JOIN STRING ON column_list
+// Example: join "departments.csv" on department
+Stmt Parser::parse_join_stmt() {
+    consume(TokenType::JOIN, "Expected 'join'");
+    Token filepath = consume(TokenType::STRING, "Expected string literal for file path");
+    consume(TokenType::ON, "Expected 'on' after join file path");
+    auto keys = parse_column_list();
+
+    Stmt stmt;
+    stmt.node = JoinStmt{filepath.lexeme, std::move(keys)};
+    return stmt;
+}
+
+// Parse: sort by key1 [asc|desc], key2 [asc|desc]
+// Grammar: sort_stmt ::= SORT BY sort_key ( "," sort_key )*
+//          sort_key  ::= IDENT ( ASC | DESC )?
+// Example: sort by salary desc, name
+Stmt Parser::parse_sort_stmt() {
+    consume(TokenType::SORT, "Expected 'sort'");
+    consume(TokenType::BY, "Expected 'by' after 'sort'");
+
+    SortStmt node;
+    do {
+        SortKey key;
+        key.column = consume(TokenType::IDENT, "Expected column name").lexeme;
+        if (match(TokenType::DESC)) {
+            key.descending = true;
+        } else {
+            match(TokenType::ASC);
+        }
+        node.keys.push_back(std::move(key));
+    } while (match(TokenType::COMMA));
+
+    Stmt stmt;
+    stmt.node = std::move(node);
+    return stmt;
+}
+
+// Parse: limit N
+// Grammar: limit_stmt ::= LIMIT NUMBER (a non-negative integer)
+// Example: limit 100
+Stmt Parser::parse_limit_stmt() {
+    consume(TokenType::LIMIT, "Expected 'limit'");
+    Token count = consume(TokenType::NUMBER, "Expected row count after 'limit'");
+    if (count.is_double) {
+        throw ParseError("Limit must be an integer", count.line, count.column);
+    }
+
+    Stmt stmt;
+    stmt.node = LimitStmt{count.int_value};
+    return stmt;
+}
+
+// Parse: aggregate agg1, agg2 (a single group over all rows)
+// Grammar: aggregate_stmt ::= AGGREGATE aggregate_list
+// Example: aggregate count(), avg(score)
+Stmt Parser::parse_aggregate_stmt() {
+    consume(TokenType::AGGREGATE, "Expected 'aggregate'");
+
+    Stmt stmt;
+    stmt.node = GroupByStmt{{}, parse_aggregate_list()};
+    return stmt;
+}
+
+// Grammar: aggregate_list ::= aggregate ( "," aggregate )*
+std::vector<AggregateCall> Parser::parse_aggregate_list() {
+    std::vector<AggregateCall> aggregates;
+    aggregates.push_back(parse_aggregate_call());
+    while (match(TokenType::COMMA)) {
+        aggregates.push_back(parse_aggregate_call());
+    }
+    return aggregates;
+}
+
+// Parse one aggregate, optionally named
+// Grammar: aggregate ::= ( IDENT "=" )? IDENT "(" IDENT? ")"
+// Examples: sum(salary), count(), headcount = count(), max_age = max(age)
+AggregateCall Parser::parse_aggregate_call() {
+    Token func = consume(TokenType::IDENT, "Expected aggregate function");
+    std::string alias;
+    if (match(TokenType::EQUAL)) {
+        alias = func.lexeme;
+        func = consume(TokenType::IDENT, "Expected aggregate function after '='");
+    }
+
+    AggregateCall call;
+    if (func.lexeme == "sum") {
+        call.func = AggregateFunc::Sum;
+    } else if (func.lexeme == "count") {
+        call.func = AggregateFunc::Count;
+    } else if (func.lexeme == "min") {
+        call.func = AggregateFunc::Min;
+    } else if (func.lexeme == "max") {
+        call.func = AggregateFunc::Max;
+    } else if (func.lexeme == "avg") {
+        call.func = AggregateFunc::Avg;
+    } else {
+        throw ParseError("Unknown aggregate function: " + func.lexeme, func.line, func.column);
+    }
+
+    consume(TokenType::LPAREN, "Expected '(' after aggregate function");
+    if (check(TokenType::IDENT)) {
+        call.column = advance().lexeme;
+    } else if (call.func != AggregateFunc::Count) {
+        error("Expected column name");  // Only count() takes no argument
+    }
+    consume(TokenType::RPAREN, "Expected ')' after aggregate argument");
+
+    if (!alias.empty()) {
+        call.output_name = alias;
+    } else {
+        call.output_name = call.column.empty() ? func.lexeme : func.lexeme + "_" + call.column;
+    }
+    return call;
+}
+
 // ============================================================================
 // Expression Parsers - Precedence Climbing
 // ============================================================================
@@ -146,10 +326,10 @@ std::unique_ptr<Expr> Parser::parse_expr() {
 }
 
 // Parse ternary conditional: condition ? true_value : false_value
-// Grammar: ternary ::= equality ("?" ternary ":" ternary)?
+// Grammar: ternary ::= or ("?" ternary ":" ternary)?
 // Right-associative: a ? b ? c : d : e  ==  a ? (b ? c : d) : e
 std::unique_ptr<Expr> Parser::parse_ternary() {
-    auto condition = parse_equality();
+    auto condition = parse_or();
 
     if (match(TokenType::QUESTION)) {
         auto true_branch = parse_ternary();   // Right-associative recursion
@@ -165,6 +345,34 @@ std::unique_ptr<Expr> Parser::parse_ternary() {
     return condition;
 }
 
+// Parse logical OR (lowest binary precedence)
+// Grammar: or ::= and ( "or" and )*
+// Example: department == "Ops" or salary > 100000
+std::unique_ptr<Expr> Parser::parse_or() {
+    auto expr = parse_and();
+
+    while (match(TokenType::OR)) {
+        auto right = parse_and();
+        expr = make_binary(BinaryOp::Or, std::move(expr), std::move(right));
+    }
+
+    return expr;
+}
+
+// Parse logical AND (binds tighter than OR)
+// Grammar: and ::= equality ( "and" equality )*
+// Example: age > 30 and age < 40
+std::unique_ptr<Expr> Parser::parse_and() {
+    auto expr = parse_equality();
+
+    while (match(TokenType::AND)) {
+        auto right = parse_equality();
+        expr = make_binary(BinaryOp::And, std::move(expr), std::move(right));
+    }
+
+    return expr;
+}
+
 // Parse equality operators: == !=
 // Grammar: equality ::= comparison ( ("==" | "!=") comparison )*
 // Example: age == 30, name != "Alice"
@@ -273,7 +481,7 @@ std::unique_ptr<Expr> Parser::parse_unary() {
 }
 
 // Parse primary expressions (atoms)
-// Grammar: primary ::= NUMBER | STRING | IDENT | "(" expr ")"
+// Grammar: primary ::= NUMBER | STRING | IDENT | call | "(" expr ")"
 // These are the "leaf nodes" of the expression tree
 std::unique_ptr<Expr> Parser::parse_primary() {
     // Number literal: 42 or 3.14
@@ -293,8 +501,12 @@ std::unique_ptr<Expr> Parser::parse_primary() {
     }
 
     // Identifier (column reference): age, name, etc.
+    // Followed by '(' it names a function instead
     if (match(TokenType::IDENT)) {
         Token token = previous();
+        if (check(TokenType::LPAREN)) {
+            return parse_call(token);
+        }
         return make_column_ref(token.lexeme);
     }
 
@@ -310,6 +522,36 @@ std::unique_ptr<Expr> Parser::parse_primary() {
     error("Expected expression");
 }
 
+// Parse a string predicate call (func is the name, already consumed)
+// Grammar: call ::= ("starts_with" | "ends_with" | "contains" | "iequals")
+//                   "(" expr "," STRING ")"
+// Example: contains(url, "/api/"), iequals(country, "de")
+std::unique_ptr<Expr> Parser::parse_call(const Token& func) {
+    StringMatchExpr call;
+    if (func.lexeme == "starts_with") {
+        call.func = StringFunc::StartsWith;
+    } else if (func.lexeme == "ends_with") {
+        call.func = StringFunc::EndsWith;
+    } else if (func.lexeme == "contains") {
+        call.func = StringFunc::Contains;
+    } else if (func.lexeme == "iequals") {
+        call.func = StringFunc::IEquals;
+    } else {
+        throw ParseError("Unknown function: " + func.lexeme, func.line, func.column);
+    }
+
+    consume(TokenType::LPAREN, "Expected '(' after function name");
+    call.subject = parse_expr();
+    consume(TokenType::COMMA, "Expected ',' after the first argument of " + func.lexeme);
+    // The pattern is a literal, so kernels can prepare it once per batch
+    call.pattern = consume(TokenType::STRING, "Expected a string literal pattern").lexeme;
+    consume(TokenType::RPAREN, "Expected ')' after function arguments");
+
+    auto expr = std::make_unique<Expr>();
+    expr->node = std::move(call);
+    return expr;
+}
+
 // ============================================================================
 // Helper: Parse Column List
 // ============================================================================
@@ -0,0 +1,485 @@
+#include "profile.hpp"
+
+#include <charconv>
+#include <cstdio>
+#include <sstream>
+
+namespace joy {
+
+// ============================================================================
+// Plan Description
+// ============================================================================
+
+static std::string format_double(double value) {
+    char buf[32];
+    auto result = std::to_chars(buf, buf + sizeof(buf), value);
+    return std::string(buf, result.ptr);
+}
+
+static std::string quote(const std::string& s) {
+    std::string out = "\"";
+    for (char c : s) {
+        if (c == '"' || c == '\\')
+            out.push_back('\\');
+        out.push_back(c);
+    }
+    return out + "\"";
+}
+
+template <typename... Ts>
+static std::string format_literal(const std::variant<Ts...>& value) {
+    return std::visit(
+        [](const auto& v) -> std::string {
+            using T = std::decay_t<decltype(v)>;
+            if constexpr (std::is_same_v<T, std::string>) {
+                return quote(v);
+            } else if constexpr (std::is_same_v<T, bool>) {
+                return v ? "true" : "false";
+            } else if constexpr (std::is_same_v<T, double>) {
+                return format_double(v);
+            } else {
+                return std::to_string(v);
+            }
+        },
+        value);
+}
+
+static const char* vector_op_symbol(VectorOp op) {
+    switch (op) {
+    case VectorOp::GT:
+        return ">";
+    case VectorOp::LT:
+        return "<";
+    case VectorOp::GTE:
+        return ">=";
+    case VectorOp::LTE:
+        return "<=";
+    case VectorOp::EQ:
+        return "==";
+    case VectorOp::NEQ:
+        return "!=";
+    default:
+        break;  // String predicates are calls (see describe_compare)
+    }
+    return "?";
+}
+
+static const char* arith_symbol(VectorArithOp op) {
+    switch (op) {
+    case VectorArithOp::ADD:
+        return "+";
+    case VectorArithOp::SUB:
+        return "-";
+    case VectorArithOp::MUL:
+        return "*";
+    case VectorArithOp::DIV:
+        return "/";
+    }
+    return "?";
+}
+
+static std::string join_names(const std::vector<std::string>& names) {
+    std::string out;
+    for (size_t i = 0; i < names.size(); ++i) {
+        out += (i > 0 ? ", " : "") + names[i];
+    }
+    return out;
+}
+
+// Infix symbol of a binary opcode (generic or typed), nullptr if not binary
+static const char* binary_symbol(IRExpr::OpCode op) {
+    using Op = IRExpr::OpCode;
+    switch (op) {
+    case Op::ADD:
+    case Op::ADD_I64:
+    case Op::ADD_F64:
+        return "+";
+    case Op::SUB:
+    case Op::SUB_I64:
+    case Op::SUB_F64:
+        return "-";
+    case Op::MUL:
+    case Op::MUL_I64:
+    case Op::MUL_F64:
+        return "*";
+    case Op::DIV:
+    case Op::DIV_I64:
+    case Op::DIV_F64:
+        return "/";
+    case Op::EQ:
+    case Op::EQ_I64:
+    case Op::EQ_F64:
+    case Op::EQ_STR:
+    case Op::EQ_BOOL:
+    case Op::EQ_I64_CONST:
+    case Op::EQ_F64_CONST:
+        return "==";
+    case Op::NEQ:
+    case Op::NEQ_I64:
+    case Op::NEQ_F64:
+    case Op::NEQ_STR:
+    case Op::NEQ_BOOL:
+    case Op::NEQ_I64_CONST:
+    case Op::NEQ_F64_CONST:
+        return "!=";
+    case Op::LT:
+    case Op::LT_I64:
+    case Op::LT_F64:
+    case Op::LT_STR:
+    case Op::LT_I64_CONST:
+    case Op::LT_F64_CONST:
+        return "<";
+    case Op::GT:
+    case Op::GT_I64:
+    case Op::GT_F64:
+    case Op::GT_STR:
+    case Op::GT_I64_CONST:
+    case Op::GT_F64_CONST:
+        return ">";
+    case Op::LTE:
+    case Op::LTE_I64:
+    case Op::LTE_F64:
+    case Op::LTE_STR:
+    case Op::LTE_I64_CONST:
+    case Op::LTE_F64_CONST:
+        return "<=";
+    case Op::GTE:
+    case Op::GTE_I64:
+    case Op::GTE_F64:
+    case Op::GTE_STR:
+    case Op::GTE_I64_CONST:
+    case Op::GTE_F64_CONST:
+        return ">=";
+    case Op::AND:
+        return "and";
+    case Op::OR:
+        return "or";
+    default:
+        return nullptr;
+    }
+}
+
+static bool is_const_compare(IRExpr::OpCode op) {
+    return op >= IRExpr::OpCode::EQ_I64_CONST && op <= IRExpr::OpCode::GTE_F64_CONST;
+}
+
+// Rebuild the expression tree by replaying the bytecode on a stack of strings
+std::string describe_expr(const IRExpr& expr) {
+    using Op = IRExpr::OpCode;
+    std::vector<std::string> stack;
+    auto pop = [&stack]() {
+        if (stack.empty())
+            return std::string("?");
+        std::string s = std::move(stack.back());
+        stack.pop_back();
+        return s;
+    };
+    for (const auto& inst : expr.instructions) {
+        switch (inst.op) {
+        case Op::PUSH_INT:
+        case Op::PUSH_DOUBLE:
+        case Op::PUSH_STRING:
+        case Op::PUSH_BOOL:
+            stack.push_back(format_literal(inst.operand));
+            break;
+        case Op::LOAD_COLUMN:
+            if (const auto* name = std::get_if<std::string>(&inst.operand))
+                stack.push_back(*name);
+            else
+                stack.push_back("#" + format_literal(inst.operand));  // Bound column index
+            break;
+        case Op::NEG:
+        case Op::NEG_I64:
+        case Op::NEG_F64:
+            stack.push_back("-" + pop());
+            break;
+        case Op::NOT:
+            stack.push_back("not " + pop());
+            break;
+        case Op::CAST_F64:
+            break;  // Numeric promotion is implicit in the source
+        case Op::STARTS_WITH:
+        case Op::ENDS_WITH:
+        case Op::CONTAINS:
+        case Op::IEQUALS:
+            stack.push_back(std::string(string_match_name(*string_match_of(inst.op))) + "(" +
+                            pop() + ", " + format_literal(inst.operand) + ")");
+            break;
+        case Op::TERNARY: {
+            std::string false_val = pop();
+            std::string true_val = pop();
+            std::string condition = pop();
+            stack.push_back("(" + condition + " ? " + true_val + " : " + false_val + ")");
+            break;
+        }
+        default:
+            if (const char* symbol = binary_symbol(inst.op)) {
+                std::string right =
+                    is_const_compare(inst.op) ? format_literal(inst.operand) : pop();
+                std::string left = pop();
+                stack.push_back("(" + left + " " + symbol + " " + right + ")");
+            } else {
+                stack.push_back("?");
+            }
+        }
+    }
+    std::string result = pop();
+    // The outermost parentheses add nothing
+    if (result.size() > 1 && result.front() == '(' && result.back() == ')') {
+        int depth = 0;
+        bool wraps = true;
+        for (size_t i = 0; i + 1 < result.size(); ++i) {
+            depth += result[i] == '(' ? 1 : (result[i] == ')' ? -1 : 0);
+            if (depth == 0) {
+                wraps = false;
+                break;
+            }
+        }
+        if (wraps)
+            result = result.substr(1, result.size() - 2);
+    }
+    return result;
+}
+
+static std::string describe_compare(const PhysicalOp::VectorizedFilterOp& op) {
+    if (auto match = string_match_of(op.op)) {
+        return std::string(string_match_name(*match)) + "(" + op.column_name + ", " +
+               format_literal(op.value) + ")";
+    }
+    std::string right = op.is_right_column ? op.right_column_name : format_literal(op.value);
+    return op.column_name + " " + vector_op_symbol(op.op) + " " + right;
+}
+
+static std::string describe_filter_node(const PhysicalOp::FilterNode& node) {
+    using Kind = PhysicalOp::FilterNode::Kind;
+    switch (node.kind) {
+    case Kind::COMPARE:
+        return describe_compare(node.compare);
+    case Kind::PREDICATE:
+        return "[scalar] " + describe_expr(node.predicate);
+    case Kind::AND:
+    case Kind::OR: {
+        std::string out;
+        for (size_t i = 0; i < node.children.size(); ++i) {
+            if (i > 0)
+                out += node.kind == Kind::AND ? " and " : " or ";
+            const auto& child = node.children[i];
+            bool nested = child.kind == Kind::AND || child.kind == Kind::OR;
+            out += nested ? "(" + describe_filter_node(child) + ")" : describe_filter_node(child);
+        }
+        return out;
+    }
+    }
+    return "";
+}
+
+const char* operator_name(const PhysicalOp& op) {
+    return std::visit(
+        [](const auto& data) -> const char* {
+            using T = std::decay_t<decltype(data)>;
+            if constexpr (std::is_same_v<T, PhysicalOp::ScanOp>)
+                return "SCAN";
+            else if constexpr (std::is_same_v<T, PhysicalOp::FilterOp>)
+                return "FILTER";
+            else if constexpr (std::is_same_v<T, PhysicalOp::VectorizedFilterOp>)
+                return "VECTORIZED_FILTER";
+            else if constexpr (std::is_same_v<T, PhysicalOp::LogicalFilterOp>)
+                return "LOGICAL_FILTER";
+            else if constexpr (std::is_same_v<T, PhysicalOp::ProjectOp>)
+                return "PROJECT";
+            else if constexpr (std::is_same_v<T, PhysicalOp::TransformOp>)
+                return "TRANSFORM";
+            else if constexpr (std::is_same_v<T, PhysicalOp::VectorizedTransformOp>)
+                return "VECTORIZED_TRANSFORM";
+            else if constexpr (std::is_same_v<T, PhysicalOp::VectorizedTernaryTransformOp>)
+                return "VECTORIZED_TERNARY_TRANSFORM";
+            else if constexpr (std::is_same_v<T, PhysicalOp::AggregateOp>)
+                return "AGGREGATE";
+            else if constexpr (std::is_same_v<T, PhysicalOp::JoinOp>)
+                return "JOIN";
+            else if constexpr (std::is_same_v<T, PhysicalOp::SortOp>)
+                return "SORT";
+            else if constexpr (std::is_same_v<T, PhysicalOp::LimitOp>)
+                return "LIMIT";
+            else
+                return "WRITE";
+        },
+        op.data);
+}
+
+std::string describe_operator(const PhysicalOp& op) {
+    return std::visit(
+        [](const auto& data) -> std::string {
+            using T = std::decay_t<decltype(data)>;
+            if constexpr (std::is_same_v<T, PhysicalOp::ScanOp>) {
+                std::string out;
+                for (const auto& path : data.filepaths)
+                    out += (out.empty() ? "" : ", ") + quote(path);
+                if (!data.schema.empty()) {
+                    out += " schema (";
+                    for (size_t i = 0; i < data.schema.size(); ++i) {
+                        out += (i > 0 ? ", " : "") + data.schema[i].name + " " +
+                               column_type_name(data.schema[i].type);
+                    }
+                    out += ")";
+                }
+                if (data.columns)
+                    out += " columns: " + join_names(*data.columns);
+                return out;
+            } else if constexpr (std::is_same_v<T, PhysicalOp::FilterOp>) {
+                return describe_expr(data.predicate);
+            } else if constexpr (std::is_same_v<T, PhysicalOp::VectorizedFilterOp>) {
+                return describe_compare(data);
+            } else if constexpr (std::is_same_v<T, PhysicalOp::LogicalFilterOp>) {
+                return describe_filter_node(data.root);
+            } else if constexpr (std::is_same_v<T, PhysicalOp::ProjectOp>) {
+                return join_names(data.columns);
+            } else if constexpr (std::is_same_v<T, PhysicalOp::TransformOp>) {
+                return data.column_name + " = " + describe_expr(data.expression);
+            } else if constexpr (std::is_same_v<T, PhysicalOp::VectorizedTransformOp>) {
+                std::string left =
+                    data.is_left_column ? data.left_column_name : format_literal(data.left_scalar);
+                std::string right = data.is_right_column ? data.right_column_name
+                                                         : format_literal(data.right_scalar);
+                return data.column_name + " = " + left + " " + arith_symbol(data.op) + " " + right;
+            } else if constexpr (std::is_same_v<T, PhysicalOp::VectorizedTernaryTransformOp>) {
+                std::string true_val =
+                    data.is_true_column ? data.true_column_name : format_literal(data.true_scalar);
+                std::string false_val = data.is_false_column ? data.false_column_name
+                                                             : format_literal(data.false_scalar);
+                return data.column_name + " = " + describe_compare(data.condition) + " ? " +
+                       true_val + " : " + false_val;
+            } else if constexpr (std::is_same_v<T, PhysicalOp::AggregateOp>) {
+                static const char* names[] = {"sum", "count", "min", "max", "avg"};
+                std::string out = data.keys.empty() ? "" : "by " + join_names(data.keys) + ": ";
+                for (size_t i = 0; i < data.aggregates.size(); ++i) {
+                    const auto& agg = data.aggregates[i];
+                    out += (i > 0 ? ", " : "") + agg.output_name + " = " +
+                           names[static_cast<int>(agg.op)] + "(" + agg.column + ")";
+                }
+                return out;
+            } else if constexpr (std::is_same_v<T, PhysicalOp::JoinOp>) {
+                std::string out = quote(data.filepath) + " on " + join_names(data.keys);
+                if (data.columns)
+                    out += " columns: " + join_names(*data.columns);
+                return out;
+            } else if constexpr (std::is_same_v<T, PhysicalOp::SortOp>) {
+                std::string out = "by ";
+                for (size_t i = 0; i < data.keys.size(); ++i) {
+                    out += (i > 0 ? ", " : "") + data.keys[i].column +
+                           (data.keys[i].descending ? " desc" : "");
+                }
+                if (data.limit)
+                    out += " top " + std::to_string(*data.limit);
+                return out;
+            } else if constexpr (std::is_same_v<T, PhysicalOp::LimitOp>) {
+                return std::to_string(data.count);
+            } else {
+                return quote(data.filepath);
+            }
+        },
+        op.data);
+}
+
+std::string explain_plan(const ExecutionPlan& plan) {
+    std::ostringstream out;
+    for (size_t i = 0; i < plan.operators.size(); ++i) {
+        const auto& op = plan.operators[i];
+        out << i << "  " << operator_name(op) << "  " << describe_operator(op) << "\n";
+    }
+    return out.str();
+}
+
+// Helper: A JSON string literal
+static std::string json_string(const std::string& s) {
+    std::string out = "\"";
+    for (unsigned char c : s) {
+        if (c == '"' || c == '\\') {
+            out.push_back('\\');
+            out.push_back(static_cast<char>(c));
+        } else if (c < 0x20) {
+            char buf[8];
+            std::snprintf(buf, sizeof(buf), "\\u%04x", c);
+            out += buf;
+        } else {
+            out.push_back(static_cast<char>(c));
+        }
+    }
+    return out + "\"";
+}
+
+std::string explain_plan_json(const ExecutionPlan& plan) {
+    std::ostringstream out;
+    out << "{\"operators\": [";
+    for (size_t i = 0; i < plan.operators.size(); ++i) {
+        const auto& op = plan.operators[i];
+        out << (i > 0 ? ", " : "") << "{\"index\": " << i
+            << ", \"operator\": " << json_string(operator_name(op))
+            << ", \"detail\": " << json_string(describe_operator(op)) << "}";
+    }
+    out << "]}\n";
+    return out.str();
+}
+
+// ============================================================================
+// Execution Profile
+// ============================================================================
+
+// Helper: Bytes as a short human-readable size
+static std::string format_bytes(uint64_t bytes) {
+    static const char* units[] = {"B", "KB", "MB", "GB", "TB"};
+    double value = static_cast<double>(bytes);
+    size_t unit = 0;
+    while (value >= 1024 && unit + 1 < std::size(units)) {
+        value /= 1024;
+        unit++;
+    }
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), unit == 0 ? "%.0f %s" : "%.1f %s", value, units[unit]);
+    return buf;
+}
+
+std::string format_profile(const ExecutionProfile& profile) {
+    std::ostringstream out;
+    char line[160];
+    std::snprintf(line, sizeof(line), "%-3s %-28s %10s %8s %12s %12s %10s %10s\n", "#",
+                  "operator", "time (ms)", "batches", "rows in", "rows out", "allocated", "peak");
+    out << line;
+    for (size_t i = 0; i < profile.operators.size(); ++i) {
+        const auto& op = profile.operators[i];
+        std::snprintf(line, sizeof(line), "%-3zu %-28s %10.2f %8llu %12llu %12llu %10s %10s", i,
+                      op.name.c_str(), op.seconds * 1000,
+                      static_cast<unsigned long long>(op.batches),
+                      static_cast<unsigned long long>(op.rows_in),
+                      static_cast<unsigned long long>(op.rows_out),
+                      format_bytes(op.bytes_allocated).c_str(),
+                      format_bytes(op.peak_bytes).c_str());
+        out << line << "  " << op.detail << "\n";
+    }
+    std::snprintf(line, sizeof(line), "Total: %.2f ms, %s allocated, peak %s\n",
+                  profile.seconds * 1000, format_bytes(profile.bytes_allocated).c_str(),
+                  format_bytes(profile.peak_bytes).c_str());
+    out << line;
+    return out.str();
+}
+
+std::string format_profile_json(const ExecutionProfile& profile) {
+    std::ostringstream out;
+    out << "{\"seconds\": " << format_double(profile.seconds)
+        << ", \"bytes_allocated\": " << profile.bytes_allocated
+        << ", \"peak_bytes\": " << profile.peak_bytes << ", \"operators\": [";
+    for (size_t i = 0; i < profile.operators.size(); ++i) {
+        const auto& op = profile.operators[i];
+        out << (i > 0 ? ", " : "") << "{\"index\": " << i
+            << ", \"operator\": " << json_string(op.name)
+            << ", \"detail\": " << json_string(op.detail)
+            << ", \"seconds\": " << format_double(op.seconds) << ", \"batches\": " << op.batches
+            << ", \"rows_in\": " << op.rows_in << ", \"rows_out\": " << op.rows_out
+            << ", \"bytes_allocated\": " << op.bytes_allocated
+            << ", \"peak_bytes\": " << op.peak_bytes << "}";
+    }
+    out << "]}\n";
+    return out.str();
+}
+
+}  // namespace joy
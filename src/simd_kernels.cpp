@@ -0,0 +1,546 @@
+#include "simd_kernels.hpp"
+
+#include <cstdlib>
+#include <cstring>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define JOY_SIMD_X86 1
+#include <immintrin.h>
+#elif defined(__aarch64__)
+#define JOY_SIMD_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace joy {
+
+// ============================================================================
+// Scalar Kernels (portable fallback, also used for tails)
+// ============================================================================
+
+template <CompareOp Op, typename T>
+static inline bool compare(T x, T v) {
+    if constexpr (Op == CompareOp::GT)
+        return x > v;
+    else if constexpr (Op == CompareOp::LT)
+        return x < v;
+    else if constexpr (Op == CompareOp::GTE)
+        return x >= v;
+    else if constexpr (Op == CompareOp::LTE)
+        return x <= v;
+    else if constexpr (Op == CompareOp::EQ)
+        return x == v;
+    else
+        return x != v;
+}
+
+// Pack the results for rows [begin, end) (at most 64) into one word
+template <CompareOp Op, typename T>
+static inline uint64_t scalar_bits(const T* data, size_t begin, size_t end, T value) {
+    uint64_t bits = 0;
+    for (size_t i = begin; i < end; ++i) {
+        bits |= static_cast<uint64_t>(compare<Op>(data[i], value)) << (i - begin);
+    }
+    return bits;
+}
+
+// ASCII lower case (other bytes unchanged)
+static inline char fold_case(char c) {
+    return c >= 'A' && c <= 'Z' ? static_cast<char>(c | 0x20) : c;
+}
+
+// Whether the middle bytes of a candidate match (its first and last byte
+// already do)
+static inline bool middle_matches(const char* candidate, const char* pattern, size_t len) {
+    return len <= 2 || std::memcmp(candidate + 1, pattern + 1, len - 2) == 0;
+}
+
+struct ScalarKernels {
+    template <CompareOp Op, typename T>
+    static void run(const T* data, size_t n, T value, uint64_t* out) {
+        const size_t full_words = n / 64;
+        for (size_t w = 0; w < full_words; ++w) {
+            out[w] = scalar_bits<Op>(data, w * 64, w * 64 + 64, value);
+        }
+        if (n % 64) {
+            out[full_words] = scalar_bits<Op>(data, full_words * 64, n, value);
+        }
+    }
+
+    template <CompareOp Op>
+    static void int64(const int64_t* data, size_t n, int64_t value, uint64_t* out) {
+        run<Op>(data, n, value, out);
+    }
+
+    template <CompareOp Op>
+    static void dbl(const double* data, size_t n, double value, uint64_t* out) {
+        run<Op>(data, n, value, out);
+    }
+
+    // memchr for the first byte, memcmp for the rest
+    static size_t find(const char* text, size_t size, size_t from, const char* pattern,
+                       size_t len) {
+        if (len > size)
+            return size;
+        const size_t last = size - len;  // Last position a match can start at
+        while (from <= last) {
+            const void* p = std::memchr(text + from, pattern[0], last - from + 1);
+            if (!p)
+                break;
+            const size_t pos = static_cast<size_t>(static_cast<const char*>(p) - text);
+            if (std::memcmp(text + pos + 1, pattern + 1, len - 1) == 0)
+                return pos;
+            from = pos + 1;
+        }
+        return size;
+    }
+
+    static bool iequals(const char* a, const char* b, size_t n) {
+        for (size_t i = 0; i < n; ++i) {
+            if (fold_case(a[i]) != fold_case(b[i]))
+                return false;
+        }
+        return true;
+    }
+};
+
+#if defined(JOY_SIMD_X86)
+
+// ============================================================================
+// x86 Kernels (compiled with per-function target attributes, so the rest of
+// the binary still runs on any x86-64 CPU)
+// ============================================================================
+
+// AVX-512: one compare yields an 8-bit mask; 8 of them fill a word
+struct Avx512Kernels {
+    // Predicates must be immediates, hence one literal per branch
+    // Ordered double predicates except NEQ, which is unordered like C++ != (NaN != x)
+    template <CompareOp Op>
+    __attribute__((target("avx512f"))) static inline __mmask8 compare_mask(__m512i v,
+                                                                            __m512i s) {
+        if constexpr (Op == CompareOp::GT)
+            return _mm512_cmp_epi64_mask(v, s, _MM_CMPINT_NLE);
+        else if constexpr (Op == CompareOp::LT)
+            return _mm512_cmp_epi64_mask(v, s, _MM_CMPINT_LT);
+        else if constexpr (Op == CompareOp::GTE)
+            return _mm512_cmp_epi64_mask(v, s, _MM_CMPINT_NLT);
+        else if constexpr (Op == CompareOp::LTE)
+            return _mm512_cmp_epi64_mask(v, s, _MM_CMPINT_LE);
+        else if constexpr (Op == CompareOp::EQ)
+            return _mm512_cmp_epi64_mask(v, s, _MM_CMPINT_EQ);
+        else
+            return _mm512_cmp_epi64_mask(v, s, _MM_CMPINT_NE);
+    }
+
+    template <CompareOp Op>
+    __attribute__((target("avx512f"))) static inline __mmask8 compare_mask(__m512d v,
+                                                                            __m512d s) {
+        if constexpr (Op == CompareOp::GT)
+            return _mm512_cmp_pd_mask(v, s, _CMP_GT_OQ);
+        else if constexpr (Op == CompareOp::LT)
+            return _mm512_cmp_pd_mask(v, s, _CMP_LT_OQ);
+        else if constexpr (Op == CompareOp::GTE)
+            return _mm512_cmp_pd_mask(v, s, _CMP_GE_OQ);
+        else if constexpr (Op == CompareOp::LTE)
+            return _mm512_cmp_pd_mask(v, s, _CMP_LE_OQ);
+        else if constexpr (Op == CompareOp::EQ)
+            return _mm512_cmp_pd_mask(v, s, _CMP_EQ_OQ);
+        else
+            return _mm512_cmp_pd_mask(v, s, _CMP_NEQ_UQ);
+    }
+
+    template <CompareOp Op>
+    __attribute__((target("avx512f"))) static void int64(const int64_t* data, size_t n,
+                                                         int64_t value, uint64_t* out) {
+        const __m512i s = _mm512_set1_epi64(value);
+        const size_t full_words = n / 64;
+        for (size_t w = 0; w < full_words; ++w) {
+            const int64_t* block = data + w * 64;
+            uint64_t bits = 0;
+            for (size_t k = 0; k < 8; ++k) {
+                __m512i v = _mm512_loadu_si512(block + k * 8);
+                bits |= static_cast<uint64_t>(compare_mask<Op>(v, s)) << (k * 8);
+            }
+            out[w] = bits;
+        }
+        if (n % 64) {
+            out[full_words] = scalar_bits<Op>(data, full_words * 64, n, value);
+        }
+    }
+
+    template <CompareOp Op>
+    __attribute__((target("avx512f"))) static void dbl(const double* data, size_t n,
+                                                       double value, uint64_t* out) {
+        const __m512d s = _mm512_set1_pd(value);
+        const size_t full_words = n / 64;
+        for (size_t w = 0; w < full_words; ++w) {
+            const double* block = data + w * 64;
+            uint64_t bits = 0;
+            for (size_t k = 0; k < 8; ++k) {
+                __m512d v = _mm512_loadu_pd(block + k * 8);
+                bits |= static_cast<uint64_t>(compare_mask<Op>(v, s)) << (k * 8);
+            }
+            out[w] = bits;
+        }
+        if (n % 64) {
+            out[full_words] = scalar_bits<Op>(data, full_words * 64, n, value);
+        }
+    }
+};
+
+// AVX2: 4 lanes per compare, mask extracted with movemask; 16 fill a word
+// INT64 only has > and ==, so the other predicates swap operands or invert
+struct Avx2Kernels {
+    template <CompareOp Op>
+    __attribute__((target("avx2"))) static void int64(const int64_t* data, size_t n,
+                                                      int64_t value, uint64_t* out) {
+        constexpr bool invert =
+            Op == CompareOp::GTE || Op == CompareOp::LTE || Op == CompareOp::NEQ;
+        const __m256i s = _mm256_set1_epi64x(value);
+        const size_t full_words = n / 64;
+        for (size_t w = 0; w < full_words; ++w) {
+            const int64_t* block = data + w * 64;
+            uint64_t bits = 0;
+            for (size_t k = 0; k < 16; ++k) {
+                __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block + k * 4));
+                __m256i m;
+                if constexpr (Op == CompareOp::GT || Op == CompareOp::LTE)
+                    m = _mm256_cmpgt_epi64(v, s);
+                else if constexpr (Op == CompareOp::LT || Op == CompareOp::GTE)
+                    m = _mm256_cmpgt_epi64(s, v);
+                else
+                    m = _mm256_cmpeq_epi64(v, s);
+                bits |= static_cast<uint64_t>(_mm256_movemask_pd(_mm256_castsi256_pd(m)))
+                        << (k * 4);
+            }
+            out[w] = invert ? ~bits : bits;
+        }
+        if (n % 64) {
+            out[full_words] = scalar_bits<Op>(data, full_words * 64, n, value);
+        }
+    }
+
+    template <CompareOp Op>
+    __attribute__((target("avx2"))) static inline __m256d compare_mask(__m256d v, __m256d s) {
+        if constexpr (Op == CompareOp::GT)
+            return _mm256_cmp_pd(v, s, _CMP_GT_OQ);
+        else if constexpr (Op == CompareOp::LT)
+            return _mm256_cmp_pd(v, s, _CMP_LT_OQ);
+        else if constexpr (Op == CompareOp::GTE)
+            return _mm256_cmp_pd(v, s, _CMP_GE_OQ);
+        else if constexpr (Op == CompareOp::LTE)
+            return _mm256_cmp_pd(v, s, _CMP_LE_OQ);
+        else if constexpr (Op == CompareOp::EQ)
+            return _mm256_cmp_pd(v, s, _CMP_EQ_OQ);
+        else
+            return _mm256_cmp_pd(v, s, _CMP_NEQ_UQ);
+    }
+
+    template <CompareOp Op>
+    __attribute__((target("avx2"))) static void dbl(const double* data, size_t n, double value,
+                                                    uint64_t* out) {
+        const __m256d s = _mm256_set1_pd(value);
+        const size_t full_words = n / 64;
+        for (size_t w = 0; w < full_words; ++w) {
+            const double* block = data + w * 64;
+            uint64_t bits = 0;
+            for (size_t k = 0; k < 16; ++k) {
+                __m256d v = _mm256_loadu_pd(block + k * 4);
+                __m256d m = compare_mask<Op>(v, s);
+                bits |= static_cast<uint64_t>(_mm256_movemask_pd(m)) << (k * 4);
+            }
+            out[w] = bits;
+        }
+        if (n % 64) {
+            out[full_words] = scalar_bits<Op>(data, full_words * 64, n, value);
+        }
+    }
+
+    // 32 candidate positions per step: the bytes at each position and len - 1
+    // bytes later are compared with the pattern's first and last byte
+    __attribute__((target("avx2"))) static size_t find(const char* text, size_t size,
+                                                       size_t from, const char* pattern,
+                                                       size_t len) {
+        if (len > size)
+            return size;
+        const size_t last = size - len;
+        const __m256i first = _mm256_set1_epi8(pattern[0]);
+        const __m256i final = _mm256_set1_epi8(pattern[len - 1]);
+        size_t pos = from;
+        for (; pos + 32 <= last + 1; pos += 32) {
+            __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(text + pos));
+            __m256i b =
+                _mm256_loadu_si256(reinterpret_cast<const __m256i*>(text + pos + len - 1));
+            uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(
+                _mm256_and_si256(_mm256_cmpeq_epi8(a, first), _mm256_cmpeq_epi8(b, final))));
+            while (mask) {
+                const size_t candidate = pos + static_cast<size_t>(__builtin_ctz(mask));
+                if (middle_matches(text + candidate, pattern, len))
+                    return candidate;
+                mask &= mask - 1;
+            }
+        }
+        return ScalarKernels::find(text, size, pos, pattern, len);
+    }
+
+    // Letters are folded by setting bit 5 where a byte is in 'A'..'Z' (bytes
+    // from 0x80 are negative as signed chars, so never in range)
+    __attribute__((target("avx2"))) static inline __m256i fold(__m256i x) {
+        const __m256i upper = _mm256_and_si256(_mm256_cmpgt_epi8(x, _mm256_set1_epi8('A' - 1)),
+                                               _mm256_cmpgt_epi8(_mm256_set1_epi8('Z' + 1), x));
+        return _mm256_or_si256(x, _mm256_and_si256(upper, _mm256_set1_epi8(0x20)));
+    }
+
+    __attribute__((target("avx2"))) static bool iequals(const char* a, const char* b,
+                                                        size_t n) {
+        size_t i = 0;
+        for (; i + 32 <= n; i += 32) {
+            __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+            __m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+            if (_mm256_movemask_epi8(_mm256_cmpeq_epi8(fold(x), fold(y))) != -1)
+                return false;
+        }
+        return ScalarKernels::iequals(a + i, b + i, n - i);
+    }
+};
+
+#endif  // JOY_SIMD_X86
+
+#if defined(JOY_SIMD_NEON)
+
+// ============================================================================
+// NEON Kernels (AArch64: 2 lanes per compare; 32 fill a word)
+// ============================================================================
+
+struct NeonKernels {
+    // Collapse a 2-lane all-ones/all-zeros mask into 2 bits
+    static inline uint64_t lane_bits(uint64x2_t m) {
+        return (vgetq_lane_u64(m, 0) & 1) | ((vgetq_lane_u64(m, 1) & 1) << 1);
+    }
+
+    template <CompareOp Op>
+    static void int64(const int64_t* data, size_t n, int64_t value, uint64_t* out) {
+        const int64x2_t s = vdupq_n_s64(value);
+        const size_t full_words = n / 64;
+        for (size_t w = 0; w < full_words; ++w) {
+            const int64_t* block = data + w * 64;
+            uint64_t bits = 0;
+            for (size_t k = 0; k < 32; ++k) {
+                int64x2_t v = vld1q_s64(block + k * 2);
+                uint64x2_t m;
+                if constexpr (Op == CompareOp::GT)
+                    m = vcgtq_s64(v, s);
+                else if constexpr (Op == CompareOp::LT)
+                    m = vcltq_s64(v, s);
+                else if constexpr (Op == CompareOp::GTE)
+                    m = vcgeq_s64(v, s);
+                else if constexpr (Op == CompareOp::LTE)
+                    m = vcleq_s64(v, s);
+                else
+                    m = vceqq_s64(v, s);
+                bits |= lane_bits(m) << (k * 2);
+            }
+            out[w] = Op == CompareOp::NEQ ? ~bits : bits;
+        }
+        if (n % 64) {
+            out[full_words] = scalar_bits<Op>(data, full_words * 64, n, value);
+        }
+    }
+
+    template <CompareOp Op>
+    static void dbl(const double* data, size_t n, double value, uint64_t* out) {
+        const float64x2_t s = vdupq_n_f64(value);
+        const size_t full_words = n / 64;
+        for (size_t w = 0; w < full_words; ++w) {
+            const double* block = data + w * 64;
+            uint64_t bits = 0;
+            for (size_t k = 0; k < 32; ++k) {
+                float64x2_t v = vld1q_f64(block + k * 2);
+                uint64x2_t m;
+                if constexpr (Op == CompareOp::GT)
+                    m = vcgtq_f64(v, s);
+                else if constexpr (Op == CompareOp::LT)
+                    m = vcltq_f64(v, s);
+                else if constexpr (Op == CompareOp::GTE)
+                    m = vcgeq_f64(v, s);
+                else if constexpr (Op == CompareOp::LTE)
+                    m = vcleq_f64(v, s);
+                else
+                    m = vceqq_f64(v, s);  // NEQ inverts the (ordered) EQ mask
+                bits |= lane_bits(m) << (k * 2);
+            }
+            out[w] = Op == CompareOp::NEQ ? ~bits : bits;
+        }
+        if (n % 64) {
+            out[full_words] = scalar_bits<Op>(data, full_words * 64, n, value);
+        }
+    }
+
+    // As the AVX2 search, 16 positions per step; the byte mask is narrowed
+    // to 4 bits per lane (NEON has no movemask)
+    static size_t find(const char* text, size_t size, size_t from, const char* pattern,
+                       size_t len) {
+        if (len > size)
+            return size;
+        const size_t last = size - len;
+        const uint8x16_t first = vdupq_n_u8(static_cast<uint8_t>(pattern[0]));
+        const uint8x16_t final = vdupq_n_u8(static_cast<uint8_t>(pattern[len - 1]));
+        size_t pos = from;
+        for (; pos + 16 <= last + 1; pos += 16) {
+            uint8x16_t a = vld1q_u8(reinterpret_cast<const uint8_t*>(text + pos));
+            uint8x16_t b = vld1q_u8(reinterpret_cast<const uint8_t*>(text + pos + len - 1));
+            uint8x16_t eq = vandq_u8(vceqq_u8(a, first), vceqq_u8(b, final));
+            uint64_t mask =
+                vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(eq), 4)), 0);
+            while (mask) {
+                const size_t candidate = pos + static_cast<size_t>(__builtin_ctzll(mask)) / 4;
+                if (middle_matches(text + candidate, pattern, len))
+                    return candidate;
+                mask &= ~(uint64_t{0xF} << (__builtin_ctzll(mask) & ~3));
+            }
+        }
+        return ScalarKernels::find(text, size, pos, pattern, len);
+    }
+
+    static inline uint8x16_t fold(uint8x16_t x) {
+        const uint8x16_t upper =
+            vandq_u8(vcgeq_u8(x, vdupq_n_u8('A')), vcleq_u8(x, vdupq_n_u8('Z')));
+        return vorrq_u8(x, vandq_u8(upper, vdupq_n_u8(0x20)));
+    }
+
+    static bool iequals(const char* a, const char* b, size_t n) {
+        size_t i = 0;
+        for (; i + 16 <= n; i += 16) {
+            uint8x16_t x = vld1q_u8(reinterpret_cast<const uint8_t*>(a + i));
+            uint8x16_t y = vld1q_u8(reinterpret_cast<const uint8_t*>(b + i));
+            if (vminvq_u8(vceqq_u8(fold(x), fold(y))) != 0xFF)
+                return false;
+        }
+        return ScalarKernels::iequals(a + i, b + i, n - i);
+    }
+};
+
+#endif  // JOY_SIMD_NEON
+
+// ============================================================================
+// Runtime Dispatch
+// ============================================================================
+
+using Int64Kernel = void (*)(const int64_t*, size_t, int64_t, uint64_t*);
+using DoubleKernel = void (*)(const double*, size_t, double, uint64_t*);
+using FindKernel = size_t (*)(const char*, size_t, size_t, const char*, size_t);
+using IEqualsKernel = bool (*)(const char*, const char*, size_t);
+
+// One entry per CompareOp, in enum order
+struct KernelTable {
+    SimdLevel level;
+    Int64Kernel int64[6];
+    DoubleKernel dbl[6];
+    FindKernel find;
+    IEqualsKernel iequals;
+};
+
+// K supplies the numeric kernels, S the string kernels
+template <typename K, typename S = K>
+static KernelTable make_table(SimdLevel level) {
+    return {level,
+            {&K::template int64<CompareOp::GT>, &K::template int64<CompareOp::LT>,
+             &K::template int64<CompareOp::GTE>, &K::template int64<CompareOp::LTE>,
+             &K::template int64<CompareOp::EQ>, &K::template int64<CompareOp::NEQ>},
+            {&K::template dbl<CompareOp::GT>, &K::template dbl<CompareOp::LT>,
+             &K::template dbl<CompareOp::GTE>, &K::template dbl<CompareOp::LTE>,
+             &K::template dbl<CompareOp::EQ>, &K::template dbl<CompareOp::NEQ>},
+            &S::find,
+            &S::iequals};
+}
+
+// Best level this CPU supports
+static SimdLevel detect_simd_level() {
+#if defined(JOY_SIMD_X86)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f"))
+        return SimdLevel::AVX512;
+    if (__builtin_cpu_supports("avx2"))
+        return SimdLevel::AVX2;
+#elif defined(JOY_SIMD_NEON)
+    return SimdLevel::NEON;
+#endif
+    return SimdLevel::SCALAR;
+}
+
+// Apply the JOY_SIMD override when it names a level the CPU supports
+static SimdLevel choose_simd_level() {
+    SimdLevel best = detect_simd_level();
+    const char* env = std::getenv("JOY_SIMD");
+    if (!env)
+        return best;
+    if (std::strcmp(env, "scalar") == 0)
+        return SimdLevel::SCALAR;
+    if (std::strcmp(env, "avx2") == 0 && (best == SimdLevel::AVX2 || best == SimdLevel::AVX512))
+        return SimdLevel::AVX2;
+    if (std::strcmp(env, "avx512") == 0 && best == SimdLevel::AVX512)
+        return SimdLevel::AVX512;
+    if (std::strcmp(env, "neon") == 0 && best == SimdLevel::NEON)
+        return SimdLevel::NEON;
+    return best;
+}
+
+static KernelTable build_table(SimdLevel level) {
+    switch (level) {
+#if defined(JOY_SIMD_X86)
+    case SimdLevel::AVX512:
+        return make_table<Avx512Kernels, Avx2Kernels>(level);
+    case SimdLevel::AVX2:
+        return make_table<Avx2Kernels>(level);
+#endif
+#if defined(JOY_SIMD_NEON)
+    case SimdLevel::NEON:
+        return make_table<NeonKernels>(level);
+#endif
+    default:
+        return make_table<ScalarKernels>(SimdLevel::SCALAR);
+    }
+}
+
+// Resolved once (thread-safe static initialization), then a plain table lookup
+static const KernelTable& kernels() {
+    static const KernelTable table = build_table(choose_simd_level());
+    return table;
+}
+
+SimdLevel active_simd_level() {
+    return kernels().level;
+}
+
+const char* simd_level_name(SimdLevel level) {
+    switch (level) {
+    case SimdLevel::SCALAR:
+        return "scalar";
+    case SimdLevel::AVX2:
+        return "avx2";
+    case SimdLevel::AVX512:
+        return "avx512";
+    case SimdLevel::NEON:
+        return "neon";
+    }
+    return "scalar";
+}
+
+void simd_compare_int64(CompareOp op, const int64_t* data, size_t n, int64_t value,
+                        uint64_t* out) {
+    kernels().int64[static_cast<size_t>(op)](data, n, value, out);
+}
+
+void simd_compare_double(CompareOp op, const double* data, size_t n, double value,
+                         uint64_t* out) {
+    kernels().dbl[static_cast<size_t>(op)](data, n, value, out);
+}
+
+size_t simd_find(const char* text, size_t size, size_t from, const char* pattern, size_t len) {
+    return kernels().find(text, size, from, pattern, len);
+}
+
+bool simd_iequals(const char* a, const char* b, size_t n) {
+    return kernels().iequals(a, b, n);
+}
+
+}  // namespace joy
@@ -0,0 +1,554 @@
+#include "sort.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <numeric>
+#include <string>
+
+#include "vm.hpp"  // For RuntimeError
+
+namespace joy {
+
+using SortKey = PhysicalOp::SortOp::Key;
+
+// Rows per block of a spilled run (a run being merged holds one block in memory)
+constexpr size_t kSpillBlockRows = 4096;
+
+// Larger limits are run as a full sort whose output is cut off, since the
+// heap would hold most of the input anyway
+constexpr size_t kMaxTopNRows = size_t{1} << 20;
+
+// Top-N: kept_ is compacted once it holds twice the limit (and at least this many rows)
+constexpr size_t kMinCompactRows = 1024;
+
+// Batches gathered through a permutation are split by column across threads
+// once they have this many rows
+constexpr size_t kMinParallelGatherRows = 16 * 1024;
+
+// ============================================================================
+// Row Comparison
+// ============================================================================
+
+static std::vector<const Column*> key_columns(const Table& table,
+                                              const std::vector<size_t>& indices) {
+    std::vector<const Column*> cols;
+    for (size_t idx : indices)
+        cols.push_back(&table.columns[idx]);
+    return cols;
+}
+
+template <typename T>
+static int three_way(const T& a, const T& b) {
+    return (b < a) - (a < b);
+}
+
+// Helper: Compare row a of cols_a with row b of cols_b on the sort keys
+// (cols_x[k] is the column of key k): < 0 if a sorts first, > 0 if b does
+static int compare_rows(const std::vector<SortKey>& keys, const std::vector<const Column*>& cols_a,
+                        size_t a, const std::vector<const Column*>& cols_b, size_t b) {
+    for (size_t k = 0; k < keys.size(); ++k) {
+        const Column& x = *cols_a[k];
+        const Column& y = *cols_b[k];
+        bool x_null = x.is_null(a);
+        bool y_null = y.is_null(b);
+        if (x_null || y_null) {
+            if (x_null != y_null)
+                return x_null ? 1 : -1;  // NULLs last in either direction
+            continue;
+        }
+        int c = 0;
+        switch (x.type) {
+        case ColumnType::INT64:
+            c = three_way(x.values<int64_t>()[a], y.values<int64_t>()[b]);
+            break;
+        case ColumnType::DOUBLE:
+            c = three_way(x.values<double>()[a], y.values<double>()[b]);
+            break;
+        case ColumnType::STRING:
+            c = three_way(x.get_string(a), y.get_string(b));
+            break;
+        case ColumnType::BOOL:
+            c = three_way(x.get_bool(a), y.get_bool(b));
+            break;
+        }
+        if (c != 0)
+            return keys[k].descending ? -c : c;
+    }
+    return 0;
+}
+
+// ============================================================================
+// Radix Sort
+// ============================================================================
+
+// Order-preserving unsigned encodings (a < b ⇔ encode(a) < encode(b))
+static uint64_t encode_int(int64_t v) {
+    return static_cast<uint64_t>(v) ^ (uint64_t{1} << 63);
+}
+
+static uint64_t encode_double(double d) {
+    if (d == 0.0)
+        d = 0.0;  // -0.0 == 0.0, so both must encode alike
+    uint64_t bits;
+    std::memcpy(&bits, &d, sizeof(bits));
+    return (bits >> 63) ? ~bits : bits | (uint64_t{1} << 63);
+}
+
+// Helper: Position of every dictionary entry in ascending string order
+static std::vector<uint64_t> dictionary_ranks(const StringDictionary& dict) {
+    std::vector<int32_t> codes(dict.size());
+    std::iota(codes.begin(), codes.end(), 0);
+    std::sort(codes.begin(), codes.end(),
+              [&](int32_t a, int32_t b) { return dict.get(a) < dict.get(b); });
+    std::vector<uint64_t> ranks(dict.size());
+    for (size_t r = 0; r < codes.size(); ++r)
+        ranks[codes[r]] = r;
+    return ranks;
+}
+
+// Helper: Stable LSD radix sort of perm by keys (keys[i] belongs to perm[i]),
+// one byte per pass; a byte that is the same in every key needs no pass
+static void radix_sort(std::vector<uint64_t>& keys, std::vector<uint32_t>& perm) {
+    const size_t n = keys.size();
+    std::vector<size_t> counts(8 * 256, 0);
+    for (uint64_t key : keys) {
+        for (int b = 0; b < 8; ++b)
+            counts[b * 256 + ((key >> (8 * b)) & 0xff)]++;
+    }
+
+    std::vector<uint64_t> tmp_keys(n);
+    std::vector<uint32_t> tmp_perm(n);
+    for (int b = 0; b < 8; ++b) {
+        size_t* count = &counts[b * 256];
+        if (std::find(count, count + 256, n) != count + 256)
+            continue;
+        size_t offset = 0;
+        for (int d = 0; d < 256; ++d) {
+            size_t c = count[d];
+            count[d] = offset;
+            offset += c;
+        }
+        const int shift = 8 * b;
+        for (size_t i = 0; i < n; ++i) {
+            size_t dst = count[(keys[i] >> shift) & 0xff]++;
+            tmp_keys[dst] = keys[i];
+            tmp_perm[dst] = perm[i];
+        }
+        keys.swap(tmp_keys);
+        perm.swap(tmp_perm);
+    }
+}
+
+// Helper: Stable sort of perm by one key column, NULLs last
+static void sort_by_key(std::vector<uint32_t>& perm, const Column& col, bool descending) {
+    const auto* dict = std::get_if<DictStrings>(&col.data);
+    if (col.type == ColumnType::STRING && !dict) {
+        auto value = [&](uint32_t r) {
+            return col.is_null(r) ? std::string_view() : col.get_string(r);
+        };
+        std::stable_sort(perm.begin(), perm.end(), [&](uint32_t a, uint32_t b) {
+            return descending ? value(b) < value(a) : value(a) < value(b);
+        });
+    } else {
+        std::vector<uint64_t> ranks;
+        if (dict)
+            ranks = dictionary_ranks(*dict->dict);
+        std::vector<uint64_t> keys(perm.size());
+        for (size_t i = 0; i < perm.size(); ++i) {
+            uint32_t r = perm[i];
+            uint64_t key = 0;
+            if (!col.is_null(r)) {
+                switch (col.type) {
+                case ColumnType::INT64:
+                    key = encode_int(col.values<int64_t>()[r]);
+                    break;
+                case ColumnType::DOUBLE:
+                    key = encode_double(col.values<double>()[r]);
+                    break;
+                case ColumnType::STRING:
+                    key = ranks[dict->codes[r]];
+                    break;
+                case ColumnType::BOOL:
+                    key = col.get_bool(r) ? 1 : 0;
+                    break;
+                }
+            }
+            keys[i] = descending ? ~key : key;
+        }
+        radix_sort(keys, perm);
+    }
+
+    if (col.validity.count() != col.size()) {
+        std::stable_partition(perm.begin(), perm.end(),
+                              [&](uint32_t r) { return !col.is_null(r); });
+    }
+}
+
+// Helper: Permutation that puts the rows of table in sorted order
+// LSD over the keys too: sorting stably by the least significant key first
+// leaves the rows ordered by all of them
+static std::vector<uint32_t> sort_permutation(const Table& table, const std::vector<SortKey>& keys,
+                                              const std::vector<size_t>& key_indices) {
+    if (table.num_rows >= std::numeric_limits<uint32_t>::max()) {
+        throw RuntimeError("Too many rows to sort in one batch");
+    }
+    std::vector<uint32_t> perm(table.num_rows);
+    std::iota(perm.begin(), perm.end(), 0);
+    for (size_t k = keys.size(); k-- > 0;)
+        sort_by_key(perm, table.columns[key_indices[k]], keys[k].descending);
+    return perm;
+}
+
+// Helper: Rows of table in the order given, one column per task
+static Table gather_rows(const Table& table, const std::vector<uint32_t>& rows, ThreadPool* pool) {
+    Table out;
+    out.num_rows = rows.size();
+    out.columns.resize(table.columns.size());
+    auto gather_column = [&](size_t c) { out.columns[c] = table.columns[c].gather(rows); };
+    if (pool && table.columns.size() > 1 && rows.size() >= kMinParallelGatherRows) {
+        pool->parallel_for(table.columns.size(), gather_column);
+    } else {
+        for (size_t c = 0; c < table.columns.size(); ++c)
+            gather_column(c);
+    }
+    return out;
+}
+
+// Helper: Approximate memory held by the rows of a table
+static size_t approx_bytes(const Table& table) {
+    size_t bytes = 0;
+    for (const auto& col : table.columns) {
+        bytes += col.size() / 8;  // Validity
+        std::visit(
+            [&](const auto& data) {
+                using Vec = std::decay_t<decltype(data)>;
+                if constexpr (std::is_same_v<Vec, StringArena>) {
+                    bytes += data.num_bytes() + data.size() * sizeof(size_t);
+                } else if constexpr (std::is_same_v<Vec, DictStrings>) {
+                    bytes += data.size() * sizeof(int32_t);
+                } else if constexpr (std::is_same_v<Vec, Bitmap>) {
+                    bytes += data.size() / 8;
+                } else {
+                    bytes += data.size() * sizeof(typename Vec::value_type);
+                }
+            },
+            col.data);
+    }
+    return bytes;
+}
+
+// ============================================================================
+// Spilled Runs
+// ============================================================================
+// A run is a sequence of blocks in an anonymous temporary file (deleted when
+// closed). A block is its row count, then for every column the validity
+// words followed by the values; STRING values are one uint32 length per row
+// followed by the bytes. Blocks are read back with StringArena columns
+
+struct Sorter::Run {
+    std::FILE* file = nullptr;
+    size_t blocks_left = 0;
+    Table block;  // Block being merged
+    std::vector<const Column*> key_cols;
+    size_t row = 0;  // Next row of block
+
+    ~Run() {
+        if (file)
+            std::fclose(file);
+    }
+};
+
+static void write_bytes(std::FILE* file, const void* data, size_t n) {
+    if (n > 0 && std::fwrite(data, 1, n, file) != n) {
+        throw RuntimeError("Failed to write sort run to temporary file");
+    }
+}
+
+static void read_bytes(std::FILE* file, void* data, size_t n) {
+    if (n > 0 && std::fread(data, 1, n, file) != n) {
+        throw RuntimeError("Failed to read sort run from temporary file");
+    }
+}
+
+static void write_block(std::FILE* file, const Table& block) {
+    uint64_t rows = block.num_rows;
+    write_bytes(file, &rows, sizeof(rows));
+    for (const auto& col : block.columns) {
+        write_bytes(file, col.validity.words(), col.validity.num_words() * sizeof(uint64_t));
+        std::visit(
+            [&](const auto& data) {
+                using Vec = std::decay_t<decltype(data)>;
+                if constexpr (std::is_same_v<Vec, StringArena> ||
+                              std::is_same_v<Vec, DictStrings>) {
+                    std::vector<uint32_t> lengths(rows, 0);
+                    std::string bytes;
+                    for (size_t i = 0; i < rows; ++i) {
+                        if (col.is_null(i))
+                            continue;
+                        std::string_view s = data.get(i);
+                        lengths[i] = static_cast<uint32_t>(s.size());
+                        bytes.append(s.data(), s.size());
+                    }
+                    write_bytes(file, lengths.data(), lengths.size() * sizeof(uint32_t));
+                    write_bytes(file, bytes.data(), bytes.size());
+                } else if constexpr (std::is_same_v<Vec, Bitmap>) {
+                    write_bytes(file, data.words(), data.num_words() * sizeof(uint64_t));
+                } else {
+                    write_bytes(file, data.data(), data.size() * sizeof(typename Vec::value_type));
+                }
+            },
+            col.data);
+    }
+}
+
+static Table read_block(std::FILE* file, const Table& schema) {
+    uint64_t rows;
+    read_bytes(file, &rows, sizeof(rows));
+    Table block;
+    block.num_rows = rows;
+    for (const auto& like : schema.columns) {
+        Column col = Column::make(like.name, like.type);
+        col.validity.resize(rows);
+        read_bytes(file, col.validity.words(), col.validity.num_words() * sizeof(uint64_t));
+        switch (col.type) {
+        case ColumnType::INT64: {
+            auto& values = col.values<int64_t>();
+            values.resize(rows);
+            read_bytes(file, values.data(), rows * sizeof(int64_t));
+            break;
+        }
+        case ColumnType::DOUBLE: {
+            auto& values = col.values<double>();
+            values.resize(rows);
+            read_bytes(file, values.data(), rows * sizeof(double));
+            break;
+        }
+        case ColumnType::BOOL: {
+            auto& bits = std::get<Bitmap>(col.data);
+            bits.resize(rows);
+            read_bytes(file, bits.words(), bits.num_words() * sizeof(uint64_t));
+            break;
+        }
+        case ColumnType::STRING: {
+            std::vector<uint32_t> lengths(rows);
+            read_bytes(file, lengths.data(), rows * sizeof(uint32_t));
+            std::string bytes(std::accumulate(lengths.begin(), lengths.end(), size_t{0}), '\0');
+            read_bytes(file, bytes.data(), bytes.size());
+            auto& arena = std::get<StringArena>(col.data);
+            arena.reserve(rows);
+            size_t offset = 0;
+            for (uint32_t len : lengths) {
+                arena.push_back(std::string_view(bytes.data() + offset, len));
+                offset += len;
+            }
+            break;
+        }
+        }
+        block.add_column(std::move(col));
+    }
+    return block;
+}
+
+// ============================================================================
+// Sorter
+// ============================================================================
+
+Sorter::Sorter(const PhysicalOp::SortOp& op, size_t memory_limit)
+    : op_(op), memory_limit_(memory_limit), top_n_(op.limit && *op.limit <= kMaxTopNRows) {}
+
+Sorter::~Sorter() = default;
+
+void Sorter::init(const Table& batch) {
+    initialized_ = true;
+    for (const auto& key : op_.keys) {
+        int idx = batch.get_column_index(key.column);
+        if (idx < 0) {
+            throw RuntimeError("Column not found: " + key.column);
+        }
+        key_indices_.push_back(static_cast<size_t>(idx));
+    }
+    for (const auto& col : batch.columns) {
+        schema_.add_column(Column::make(col.name, col.type));
+        if (top_n_)
+            kept_.add_column(Column::make_like(col));
+    }
+}
+
+void Sorter::consume(const Table& batch, ThreadPool* pool) {
+    if (!initialized_) {
+        init(batch);
+    }
+    if (top_n_) {
+        consume_top_n(batch);
+        return;
+    }
+    if (batch.num_rows == 0) {
+        return;
+    }
+
+    if (buffer_.num_rows == 0) {
+        buffer_ = batch;
+    } else {
+        buffer_.append(batch);
+    }
+    buffer_bytes_ += approx_bytes(batch);
+    if (buffer_bytes_ >= memory_limit_) {
+        spill(pool);
+    }
+}
+
+void Sorter::spill(ThreadPool* pool) {
+    if (buffer_.num_rows == 0) {
+        return;
+    }
+    auto run = std::make_unique<Run>();
+    run->file = std::tmpfile();
+    if (!run->file) {
+        throw RuntimeError("Could not create a temporary file for sorting");
+    }
+
+    std::vector<uint32_t> order = sort_permutation(buffer_, op_.keys, key_indices_);
+    for (size_t begin = 0; begin < order.size(); begin += kSpillBlockRows) {
+        size_t end = std::min(begin + kSpillBlockRows, order.size());
+        std::vector<uint32_t> rows(order.begin() + begin, order.begin() + end);
+        write_block(run->file, gather_rows(buffer_, rows, pool));
+        run->blocks_left++;
+    }
+    std::rewind(run->file);
+
+    runs_.push_back(std::move(run));
+    buffer_ = Table{};
+    buffer_bytes_ = 0;
+}
+
+void Sorter::consume_top_n(const Table& batch) {
+    const size_t limit = *op_.limit;
+    if (limit == 0) {
+        return;
+    }
+
+    std::vector<const Column*> batch_keys = key_columns(batch, key_indices_);
+    std::vector<const Column*> kept_keys = key_columns(kept_, key_indices_);
+    // Heap order: the front is the row that sorts last (ties: the later row)
+    auto before = [&](uint32_t a, uint32_t b) {
+        int c = compare_rows(op_.keys, kept_keys, a, kept_keys, b);
+        return c < 0 || (c == 0 && a < b);
+    };
+
+    for (size_t row = 0; row < batch.num_rows; ++row) {
+        if (heap_.size() == limit) {
+            // On a tie the kept row wins, since it came first
+            if (compare_rows(op_.keys, batch_keys, row, kept_keys, heap_.front()) >= 0)
+                continue;
+            std::pop_heap(heap_.begin(), heap_.end(), before);
+            heap_.pop_back();
+        }
+        for (size_t c = 0; c < batch.columns.size(); ++c)
+            kept_.columns[c].append_from(batch.columns[c], row);
+        heap_.push_back(static_cast<uint32_t>(kept_.num_rows++));
+        std::push_heap(heap_.begin(), heap_.end(), before);
+
+        if (kept_.num_rows >= std::max(2 * limit, kMinCompactRows)) {
+            compact_top_n();
+            kept_keys = key_columns(kept_, key_indices_);
+        }
+    }
+}
+
+void Sorter::compact_top_n() {
+    // Keeping the survivors in input order keeps the heap's tie-breaks valid
+    std::vector<uint32_t> rows = heap_;
+    std::sort(rows.begin(), rows.end());
+    kept_ = kept_.gather(rows);
+    for (auto& entry : heap_)
+        entry = static_cast<uint32_t>(std::lower_bound(rows.begin(), rows.end(), entry) -
+                                      rows.begin());
+}
+
+void Sorter::finish(ThreadPool* pool) {
+    finished_ = true;
+    if (top_n_) {
+        std::vector<const Column*> kept_keys = key_columns(kept_, key_indices_);
+        std::sort_heap(heap_.begin(), heap_.end(), [&](uint32_t a, uint32_t b) {
+            int c = compare_rows(op_.keys, kept_keys, a, kept_keys, b);
+            return c < 0 || (c == 0 && a < b);
+        });
+        buffer_ = std::move(kept_);
+        order_ = std::move(heap_);
+        return;
+    }
+
+    if (runs_.empty()) {
+        if (buffer_.columns.empty())
+            buffer_ = schema_;  // No rows at all
+        order_ = sort_permutation(buffer_, op_.keys, key_indices_);
+        if (op_.limit && order_.size() > *op_.limit)
+            order_.resize(*op_.limit);
+        return;
+    }
+
+    spill(pool);
+    for (size_t r = 0; r < runs_.size(); ++r) {
+        Run& run = *runs_[r];
+        run.block = read_block(run.file, schema_);
+        run.blocks_left--;
+        run.key_cols = key_columns(run.block, key_indices_);
+        merge_heap_.push_back(r);
+    }
+    std::make_heap(merge_heap_.begin(), merge_heap_.end(),
+                   [this](size_t a, size_t b) { return run_after(a, b); });
+}
+
+bool Sorter::run_after(size_t a, size_t b) const {
+    const Run& x = *runs_[a];
+    const Run& y = *runs_[b];
+    int c = compare_rows(op_.keys, x.key_cols, x.row, y.key_cols, y.row);
+    return c > 0 || (c == 0 && a > b);
+}
+
+bool Sorter::next_batch(Table& out, size_t max_rows, ThreadPool* pool) {
+    if (!finished_) {
+        finish(pool);
+    }
+
+    if (runs_.empty()) {
+        size_t end = emitted_ + std::min(max_rows, order_.size() - emitted_);
+        std::vector<uint32_t> rows(order_.begin() + emitted_, order_.begin() + end);
+        out = gather_rows(buffer_, rows, pool);
+        emitted_ = end;
+        return emitted_ < order_.size();
+    }
+
+    // k-way merge: the heap's front is the run whose current row sorts first
+    auto after = [this](size_t a, size_t b) { return run_after(a, b); };
+
+    const size_t limit = op_.limit.value_or(std::numeric_limits<size_t>::max());
+    out = Table{};
+    for (const auto& col : schema_.columns)
+        out.add_column(Column::make(col.name, col.type));
+    while (out.num_rows < max_rows && emitted_ < limit && !merge_heap_.empty()) {
+        std::pop_heap(merge_heap_.begin(), merge_heap_.end(), after);
+        Run& run = *runs_[merge_heap_.back()];
+        for (size_t c = 0; c < out.columns.size(); ++c)
+            out.columns[c].append_from(run.block.columns[c], run.row);
+        out.num_rows++;
+        emitted_++;
+
+        if (++run.row == run.block.num_rows) {
+            if (run.blocks_left == 0) {
+                merge_heap_.pop_back();  // Run exhausted
+                continue;
+            }
+            run.block = read_block(run.file, schema_);
+            run.blocks_left--;
+            run.key_cols = key_columns(run.block, key_indices_);
+            run.row = 0;
+        }
+        std::push_heap(merge_heap_.begin(), merge_heap_.end(), after);
+    }
+    return emitted_ < limit && !merge_heap_.empty();
+}
+
+}  // namespace joy
@@ -1,40 +1,279 @@
 #include "table.hpp"
 
 #include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
 #include <fstream>
+#include <exception>
+#include <iterator>
+#include <limits>
 #include <sstream>
 #include <stdexcept>
+#include <unordered_set>
+
+#include "thread_pool.hpp"
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 namespace joy {
 
+// ============================================================================
+// Bitmap Implementation
+// ============================================================================
+
+// Resize to n bits; new bits take value, bits past n are cleared
+void Bitmap::resize(size_t n, bool value) {
+    size_t old_size = size_;
+    words_.resize((n + 63) / 64, 0);
+    size_ = n;
+    if (value && n > old_size) {
+        // Fill the partial word of the old size, then whole words
+        for (size_t i = old_size; i < n && (i & 63) != 0; ++i)
+            set(i, true);
+        for (size_t w = (old_size + 63) / 64; w < words_.size(); ++w)
+            words_[w] = ~uint64_t{0};
+    }
+    clear_tail();
+}
+
+void Bitmap::append(const Bitmap& other) {
+    if ((size_ & 63) == 0) {
+        // Word-aligned: copy whole words
+        words_.insert(words_.end(), other.words_.begin(), other.words_.end());
+        size_ += other.size_;
+        return;
+    }
+    append_bits(other.words(), 0, other.size_);
+}
+
+void Bitmap::append_bits(const uint64_t* words, size_t begin, size_t count) {
+    const size_t start = size_;
+    resize(start + count);
+    for (size_t i = 0; i < count;) {
+        const size_t s = begin + i;
+        const size_t d = start + i;
+        const size_t s_bit = s & 63;
+        // Bits that fit in the rest of the destination word
+        const size_t n = std::min(64 - (d & 63), count - i);
+        uint64_t bits = words[s >> 6] >> s_bit;
+        if (s_bit != 0 && s_bit + n > 64)
+            bits |= words[(s >> 6) + 1] << (64 - s_bit);
+        if (n < 64)
+            bits &= (uint64_t{1} << n) - 1;
+        words_[d >> 6] |= bits << (d & 63);
+        i += n;
+    }
+}
+
+size_t Bitmap::count() const {
+    size_t total = 0;
+    for (uint64_t word : words_)
+        total += static_cast<size_t>(__builtin_popcountll(word));
+    return total;
+}
+
+Bitmap& Bitmap::operator|=(const Bitmap& other) {
+    for (size_t w = 0; w < words_.size(); ++w)
+        words_[w] |= other.words_[w];
+    return *this;
+}
+
+Bitmap& Bitmap::subtract(const Bitmap& other) {
+    for (size_t w = 0; w < words_.size(); ++w)
+        words_[w] &= ~other.words_[w];
+    return *this;
+}
+
+void Bitmap::clear_tail() {
+    if (size_ & 63)
+        words_.back() &= (uint64_t{1} << (size_ & 63)) - 1;
+}
+
+// ============================================================================
+// String Storage Implementation
+// ============================================================================
+
+void StringArena::append(const StringArena& other) {
+    size_t base = bytes_.size();
+    bytes_.append(other.bytes_);
+    offsets_.reserve(offsets_.size() + other.size());
+    for (size_t i = 1; i < other.offsets_.size(); ++i)
+        offsets_.push_back(base + other.offsets_[i]);
+}
+
+// Linear probing over a power-of-two table; the load factor stays <= 1/2
+int32_t StringDictionary::find(std::string_view s) const {
+    if (slots_.empty())
+        return kNotFound;
+    size_t mask = slots_.size() - 1;
+    for (size_t slot = std::hash<std::string_view>{}(s) & mask;; slot = (slot + 1) & mask) {
+        int32_t code = slots_[slot];
+        if (code == kNotFound || get(code) == s)
+            return code;
+    }
+}
+
+int32_t StringDictionary::intern(std::string_view s) {
+    if ((size() + 1) * 2 > slots_.size())
+        rehash(std::max<size_t>(16, slots_.size() * 2));
+
+    size_t mask = slots_.size() - 1;
+    size_t slot = std::hash<std::string_view>{}(s) & mask;
+    for (; slots_[slot] != kNotFound; slot = (slot + 1) & mask) {
+        if (get(slots_[slot]) == s)
+            return slots_[slot];
+    }
+    int32_t code = static_cast<int32_t>(size());
+    values_.push_back(s);
+    slots_[slot] = code;
+    return code;
+}
+
+void StringDictionary::rehash(size_t num_slots) {
+    slots_.assign(num_slots, kNotFound);
+    size_t mask = num_slots - 1;
+    for (size_t code = 0; code < size(); ++code) {
+        size_t slot = std::hash<std::string_view>{}(values_.get(code)) & mask;
+        while (slots_[slot] != kNotFound)
+            slot = (slot + 1) & mask;
+        slots_[slot] = static_cast<int32_t>(code);
+    }
+}
+
+void DictStrings::push_back(std::string_view s) {
+    if (dict.use_count() > 1)
+        dict = std::make_shared<StringDictionary>(*dict);  // Copy on write
+    codes.push_back(dict->intern(s));
+}
+
+// ============================================================================
+// Zone Maps
+// ============================================================================
+
+void ZoneMap::resize(ColumnType type, size_t rows) {
+    num_rows = rows;
+    const size_t zones = (rows + kZoneRows - 1) / kZoneRows;
+    null_counts.assign(zones, 0);
+    if (type == ColumnType::INT64) {
+        int_min.assign(zones, 0);
+        int_max.assign(zones, 0);
+    } else {
+        double_min.assign(zones, 0.0);
+        double_max.assign(zones, 0.0);
+    }
+}
+
+// One pass over the zone's values: NULL slots are replaced by the identity
+// of min / max, so the loop has no branches
+void compute_zone(const Column& col, size_t z, ZoneMap& zones) {
+    const size_t begin = z * kZoneRows;
+    const size_t end = std::min(begin + kZoneRows, col.size());
+    size_t valid = 0;
+    for (size_t i = begin; i < end; ++i)
+        valid += col.validity.get(i);
+    zones.null_counts[z] = static_cast<uint32_t>(end - begin - valid);
+
+    auto scan = [&](const auto* values, auto& min_out, auto& max_out) {
+        using T = std::decay_t<decltype(*values)>;
+        T lo = std::numeric_limits<T>::max();
+        T hi = std::numeric_limits<T>::lowest();
+        bool nan = false;
+        for (size_t i = begin; i < end; ++i) {
+            const bool present = col.validity.get(i);
+            const T x = values[i];
+            lo = present && x < lo ? x : lo;
+            hi = present && x > hi ? x : hi;
+            if constexpr (std::is_floating_point_v<T>)
+                nan |= present && std::isnan(x);
+        }
+        if (valid == 0) {
+            lo = hi = T{};
+        }
+        if constexpr (std::is_floating_point_v<T>) {
+            if (nan)
+                lo = hi = std::numeric_limits<T>::quiet_NaN();
+        }
+        min_out[z] = lo;
+        max_out[z] = hi;
+    };
+    if (col.type == ColumnType::INT64) {
+        scan(col.values<int64_t>().data(), zones.int_min, zones.int_max);
+    } else {
+        scan(col.values<double>().data(), zones.double_min, zones.double_max);
+    }
+}
+
+std::shared_ptr<const ZoneMap> build_zone_map(const Column& col) {
+    if (col.type != ColumnType::INT64 && col.type != ColumnType::DOUBLE) {
+        return nullptr;
+    }
+    auto zones = std::make_shared<ZoneMap>();
+    zones->resize(col.type, col.size());
+    for (size_t z = 0; z < zones->num_zones(); ++z)
+        compute_zone(col, z, *zones);
+    return zones;
+}
+
 // ============================================================================
 // Column Implementation with NULL support
 // ============================================================================
 // Column stores data in a columnar (column-major) layout for cache efficiency
-// Uses std::variant with std::optional vectors for NULL support (SQL-style)
-// std::nullopt represents NULL values (empty CSV cells, etc.)
-// This design enables future vectorization (SIMD) optimizations
+// Values live in one contiguous typed buffer and NULLs in a separate packed
+// validity bitmap (like Apache Arrow), which keeps INT64/DOUBLE columns at
+// 8 bytes + 1 bit per value and lets kernels run branch-free SIMD loops
+// NULL slots (empty CSV cells, etc.) hold a default value in the buffer
+
+// Create an empty column, selecting the storage alternative for its type
+// This is necessary because std::variant needs an active alternative
+Column Column::make(const std::string& name, ColumnType type) {
+    Column col;
+    col.name = name;
+    col.type = type;
+    switch (type) {
+    case ColumnType::INT64:
+        col.data = std::vector<int64_t>{};
+        break;
+    case ColumnType::DOUBLE:
+        col.data = std::vector<double>{};
+        break;
+    case ColumnType::STRING:
+        col.data = StringArena{};
+        break;
+    case ColumnType::BOOL:
+        col.data = Bitmap{};
+        break;
+    }
+    return col;
+}
 
-// Get number of values in this column
-// Uses std::visit to polymorphically call size() on whichever vector type is active
-size_t Column::size() const {
-    return std::visit([](const auto& vec) { return vec.size(); }, data);
+Column Column::make_dict(const std::string& name) {
+    Column col;
+    col.name = name;
+    col.type = ColumnType::STRING;
+    col.data = DictStrings{};
+    return col;
+}
+
+Column Column::make_like(const Column& src) {
+    if (!src.is_dict_encoded())
+        return make(src.name, src.type);
+    Column col = make_dict(src.name);
+    std::get<DictStrings>(col.data).dict = std::get<DictStrings>(src.data).dict;
+    return col;
 }
 
 // Pre-allocate space for n values (optimization for bulk loading)
 // Reduces allocations when we know the final size in advance
 void Column::reserve(size_t n) {
     std::visit([n](auto& vec) { vec.reserve(n); }, data);
-}
-
-// Check if value at index is NULL
-// Returns true if the value is std::nullopt (SQL NULL)
-bool Column::is_null(size_t idx) const {
-    return std::visit(
-        [idx](const auto& vec) {
-            return !vec[idx].has_value();  // true if nullopt
-        },
-        data);
+    validity.reserve(n);
 }
 
 // Type-specific getters: Extract value at index
@@ -43,19 +282,29 @@ bool Column::is_null(size_t idx) const {
 // Example: calling get_int() on a string column or NULL value will throw
 
 int64_t Column::get_int(size_t idx) const {
-    return std::get<std::vector<std::optional<int64_t>>>(data)[idx].value();
+    if (is_null(idx))
+        throw std::bad_optional_access();
+    return std::get<std::vector<int64_t>>(data)[idx];
 }
 
 double Column::get_double(size_t idx) const {
-    return std::get<std::vector<std::optional<double>>>(data)[idx].value();
+    if (is_null(idx))
+        throw std::bad_optional_access();
+    return std::get<std::vector<double>>(data)[idx];
 }
 
-const std::string& Column::get_string(size_t idx) const {
-    return std::get<std::vector<std::optional<std::string>>>(data)[idx].value();
+std::string_view Column::get_string(size_t idx) const {
+    if (is_null(idx))
+        throw std::bad_optional_access();
+    if (auto* dict = std::get_if<DictStrings>(&data))
+        return dict->get(idx);
+    return std::get<StringArena>(data).get(idx);
 }
 
 bool Column::get_bool(size_t idx) const {
-    return std::get<std::vector<std::optional<bool>>>(data)[idx].value();
+    if (is_null(idx))
+        throw std::bad_optional_access();
+    return std::get<Bitmap>(data).get(idx);
 }
 
 // Type-specific appenders: Add value to end of column
@@ -63,20 +312,171 @@ bool Column::get_bool(size_t idx) const {
 // Accepts std::optional - std::nullopt represents NULL
 
 void Column::append_int(std::optional<int64_t> val) {
-    std::get<std::vector<std::optional<int64_t>>>(data).push_back(val);
+    std::get<std::vector<int64_t>>(data).push_back(val.value_or(0));
+    validity.push_back(val.has_value());
 }
 
 void Column::append_double(std::optional<double> val) {
-    std::get<std::vector<std::optional<double>>>(data).push_back(val);
+    std::get<std::vector<double>>(data).push_back(val.value_or(0.0));
+    validity.push_back(val.has_value());
 }
 
-void Column::append_string(std::optional<std::string> val) {
-    // Use move semantics to avoid copying the string
-    std::get<std::vector<std::optional<std::string>>>(data).push_back(std::move(val));
+void Column::append_string(std::optional<std::string_view> val) {
+    // Bytes are copied into the arena (or dictionary), so views may be transient
+    if (auto* dict = std::get_if<DictStrings>(&data)) {
+        if (val.has_value())
+            dict->push_back(*val);
+        else
+            dict->push_null();
+    } else {
+        std::get<StringArena>(data).push_back(val.value_or(std::string_view{}));
+    }
+    validity.push_back(val.has_value());
 }
 
 void Column::append_bool(std::optional<bool> val) {
-    std::get<std::vector<std::optional<bool>>>(data).push_back(val);
+    std::get<Bitmap>(data).push_back(val.value_or(false));
+    validity.push_back(val.has_value());
+}
+
+void Column::append_null() {
+    std::visit(
+        [](auto& vec) {
+            using Vec = std::decay_t<decltype(vec)>;
+            if constexpr (std::is_same_v<Vec, DictStrings>) {
+                vec.push_null();
+            } else {
+                vec.push_back({});
+            }
+        },
+        data);
+    validity.push_back(false);
+}
+
+void Column::append_from(const Column& src, size_t row) {
+    if (src.is_null(row)) {
+        append_null();
+        return;
+    }
+    switch (type) {
+    case ColumnType::INT64:
+        append_int(src.values<int64_t>()[row]);
+        break;
+    case ColumnType::DOUBLE:
+        append_double(src.values<double>()[row]);
+        break;
+    case ColumnType::STRING: {
+        auto* dst_dict = std::get_if<DictStrings>(&data);
+        auto* src_dict = std::get_if<DictStrings>(&src.data);
+        if (dst_dict && src_dict && dst_dict->dict == src_dict->dict) {
+            // Same dictionary: copy the code, no hashing or byte copies
+            dst_dict->codes.push_back(src_dict->codes[row]);
+            validity.push_back(true);
+        } else {
+            append_string(src.get_string(row));
+        }
+        break;
+    }
+    case ColumnType::BOOL:
+        append_bool(std::get<Bitmap>(src.data).get(row));
+        break;
+    }
+}
+
+// Helper: Call fn(i) for every set bit i, lowest first (skips zero words)
+template <typename Fn>
+static void for_each_set_bit(const Bitmap& bits, Fn fn) {
+    const uint64_t* words = bits.words();
+    for (size_t w = 0; w < bits.num_words(); ++w) {
+        for (uint64_t word = words[w]; word != 0; word &= word - 1) {
+            fn(w * 64 + static_cast<size_t>(__builtin_ctzll(word)));
+        }
+    }
+}
+
+// Typed gather loops - one per storage alternative, no per-row type dispatch
+Column Column::gather(const Bitmap& selection) const {
+    Column out = make_like(*this);
+    const size_t count = selection.count();
+    out.reserve(count);
+    std::visit(
+        [&](const auto& src) {
+            using Vec = std::decay_t<decltype(src)>;
+            auto& dst = std::get<Vec>(out.data);
+            if constexpr (std::is_same_v<Vec, DictStrings>) {
+                for_each_set_bit(selection, [&](size_t i) { dst.codes.push_back(src.codes[i]); });
+            } else if constexpr (std::is_same_v<Vec, Bitmap> || std::is_same_v<Vec, StringArena>) {
+                for_each_set_bit(selection, [&](size_t i) { dst.push_back(src.get(i)); });
+            } else {
+                for_each_set_bit(selection, [&](size_t i) { dst.push_back(src[i]); });
+            }
+        },
+        data);
+    for_each_set_bit(selection, [&](size_t i) { out.validity.push_back(validity.get(i)); });
+    return out;
+}
+
+Column Column::gather(const std::vector<uint32_t>& rows) const {
+    Column out = make_like(*this);
+    out.reserve(rows.size());
+    std::visit(
+        [&](const auto& src) {
+            using Vec = std::decay_t<decltype(src)>;
+            auto& dst = std::get<Vec>(out.data);
+            if constexpr (std::is_same_v<Vec, DictStrings>) {
+                for (uint32_t i : rows)
+                    dst.codes.push_back(src.codes[i]);
+            } else if constexpr (std::is_same_v<Vec, Bitmap> || std::is_same_v<Vec, StringArena>) {
+                for (uint32_t i : rows)
+                    dst.push_back(src.get(i));
+            } else {
+                for (uint32_t i : rows)
+                    dst.push_back(src[i]);
+            }
+        },
+        data);
+    for (uint32_t i : rows)
+        out.validity.push_back(validity.get(i));
+    return out;
+}
+
+// Helper: Append all rows of a STRING column src to dst (validity excluded)
+// Dictionaries are merged by remapping src's codes, each unique value once
+static void append_strings(Column& dst, const Column& src) {
+    auto* dst_dict = std::get_if<DictStrings>(&dst.data);
+    auto* src_dict = std::get_if<DictStrings>(&src.data);
+    if (dst_dict && src_dict) {
+        if (dst_dict->dict == src_dict->dict) {
+            dst_dict->codes.insert(dst_dict->codes.end(), src_dict->codes.begin(),
+                                   src_dict->codes.end());
+            return;
+        }
+        if (dst_dict->dict.use_count() > 1)
+            dst_dict->dict = std::make_shared<StringDictionary>(*dst_dict->dict);
+        std::vector<int32_t> remap(src_dict->dict->size());
+        for (size_t code = 0; code < remap.size(); ++code)
+            remap[code] = dst_dict->dict->intern(src_dict->dict->get(static_cast<int32_t>(code)));
+        dst_dict->codes.reserve(dst_dict->codes.size() + src_dict->codes.size());
+        for (size_t i = 0; i < src_dict->codes.size(); ++i)
+            dst_dict->codes.push_back(src.is_null(i) ? 0 : remap[src_dict->codes[i]]);
+        return;
+    }
+    if (!dst_dict && !src_dict) {
+        std::get<StringArena>(dst.data).append(std::get<StringArena>(src.data));
+        return;
+    }
+    // Mixed encodings: re-encode each value into dst's representation
+    for (size_t i = 0; i < src.size(); ++i) {
+        std::string_view v = src.is_null(i) ? std::string_view{} : src.get_string(i);
+        if (dst_dict) {
+            if (src.is_null(i))
+                dst_dict->push_null();
+            else
+                dst_dict->push_back(v);
+        } else {
+            std::get<StringArena>(dst.data).push_back(v);
+        }
+    }
 }
 
 // ============================================================================
@@ -130,9 +530,11 @@ void Table::add_column(Column col) {
 // Create new table with subset of columns (SELECT operation)
 // Example: table.project({"name", "age"}) returns table with only those columns
 // Copies column data (could be optimized with shared pointers)
-Table Table::project(const std::vector<std::string>& cols) const {
+// With a selection, only selected rows of the requested columns are copied,
+// so a filtered batch is materialized and projected in one pass
+Table Table::project(const std::vector<std::string>& cols, const Bitmap* selection) const {
     Table result;
-    result.num_rows = num_rows;  // Same number of rows
+    result.num_rows = selection ? selection->count() : num_rows;
 
     // Copy each requested column
     for (const auto& col_name : cols) {
@@ -140,290 +542,952 @@ Table Table::project(const std::vector<std::string>& cols) const {
         if (!col) {
             throw std::runtime_error("Column not found: " + col_name);
         }
-        result.columns.push_back(*col);  // Copy column data
+        result.columns.push_back(selection ? col->gather(*selection) : *col);  // Copy column data
     }
 
     return result;
 }
 
+// Materialize a selection (late materialization: filters only narrow a
+// selection vector, and rows are copied once when physical data is needed)
+Table Table::gather(const Bitmap& selection) const {
+    Table result;
+    result.num_rows = selection.count();
+    for (const auto& col : columns) {
+        result.columns.push_back(col.gather(selection));
+    }
+    return result;
+}
+
+Table Table::gather(const std::vector<uint32_t>& rows) const {
+    Table result;
+    result.num_rows = rows.size();
+    for (const auto& col : columns) {
+        result.columns.push_back(col.gather(rows));
+    }
+    return result;
+}
+
+// Append rows of another table with the same schema (column order and types)
+// Used to stitch batches back together, e.g. parallel CSV ranges
+void Table::append(const Table& other) {
+    if (other.columns.size() != columns.size()) {
+        throw std::runtime_error("Cannot append tables with different schemas");
+    }
+    for (size_t i = 0; i < columns.size(); ++i) {
+        if (columns[i].type != other.columns[i].type) {
+            throw std::runtime_error("Cannot append column " + other.columns[i].name +
+                                     ": type mismatch");
+        }
+        if (columns[i].type == ColumnType::STRING) {
+            append_strings(columns[i], other.columns[i]);
+        } else {
+            std::visit(
+                [&](auto& dst) {
+                    using Vec = std::decay_t<decltype(dst)>;
+                    if constexpr (std::is_same_v<Vec, StringArena> ||
+                                  std::is_same_v<Vec, DictStrings>) {
+                        // STRING handled above
+                    } else {
+                        const auto& src = std::get<Vec>(other.columns[i].data);
+                        if constexpr (std::is_same_v<Vec, Bitmap>) {
+                            dst.append(src);
+                        } else {
+                            dst.insert(dst.end(), src.begin(), src.end());
+                        }
+                    }
+                },
+                columns[i].data);
+        }
+        columns[i].validity.append(other.columns[i].validity);
+    }
+    num_rows += other.num_rows;
+}
+
 // ============================================================================
 // CSV I/O Implementation
 // ============================================================================
 // Simple CSV parser with automatic type inference
-// Limitations: No quoted fields with commas, no escape sequences
-// Good enough for MVP, could use a proper CSV library (like csv-parser) later
+// Fields may be quoted to hold commas and quotes ("a, ""b""" reads as a, "b"),
+// as the writer quotes them; a quoted field cannot span lines (the writer
+// refuses line breaks, so whatever it writes reads back)
+//
+// The reader memory-maps the file and tokenizes it in place: fields are
+// string_view slices of the mapping, and numbers are parsed with
+// std::from_chars straight into the column buffers (no per-row copies)
 
-// Helper: Split string by delimiter (handles trailing empty fields)
-// Example: split("a,b,c", ',') -> ["a", "b", "c"]
-// Example: split("a,b,", ',') -> ["a", "b", ""]  (important for NULL handling)
-static std::vector<std::string> split(const std::string& s, char delim) {
-    std::vector<std::string> result;
-    size_t start = 0;
-    size_t end = s.find(delim);
+// ----------------------------------------------------------------------------
+// MappedFile - read-only memory mapping of a whole file
+// ----------------------------------------------------------------------------
 
-    while (end != std::string::npos) {
-        result.push_back(s.substr(start, end - start));
-        start = end + 1;
-        end = s.find(delim, start);
+MappedFile::MappedFile(const std::string& filepath) {
+#if defined(_WIN32)
+    // No mmap: fall back to reading the file into an owned buffer
+    std::ifstream file(filepath, std::ios::binary);
+    if (!file) {
+        throw std::runtime_error("Cannot open file: " + filepath);
+    }
+    fallback_.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    data_ = fallback_.data();
+    size_ = fallback_.size();
+#else
+    int fd = ::open(filepath.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot open file: " + filepath);
     }
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+        ::close(fd);
+        throw std::runtime_error("Cannot stat file: " + filepath);
+    }
+    size_ = static_cast<size_t>(st.st_size);
+    if (size_ > 0) {
+        void* addr = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (addr == MAP_FAILED) {
+            ::close(fd);
+            throw std::runtime_error("Cannot map file: " + filepath);
+        }
+        ::madvise(addr, size_, MADV_SEQUENTIAL);  // Hint: read front to back
+        data_ = static_cast<const char*>(addr);
+    }
+    ::close(fd);  // The mapping stays valid after the descriptor is closed
+#endif
+}
 
-    // Add the last field (or empty string if line ends with delimiter)
-    result.push_back(s.substr(start));
+MappedFile::~MappedFile() {
+#if !defined(_WIN32)
+    if (data_ && size_ > 0 && !borrowed_) {
+        ::munmap(const_cast<char*>(data_), size_);
+    }
+#endif
+}
 
-    return result;
+void MappedFile::discard_before(size_t end) {
+#if !defined(_WIN32)
+    static const size_t page_size = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+    size_t aligned_end = end / page_size * page_size;
+    if (data_ && !borrowed_ && aligned_end > discarded_) {
+        ::madvise(const_cast<char*>(data_) + discarded_, aligned_end - discarded_, MADV_DONTNEED);
+        discarded_ = aligned_end;
+    }
+#else
+    (void)end;
+#endif
 }
 
+// ----------------------------------------------------------------------------
+// Tokenizer helpers (all operate on views into the mapped file)
+// ----------------------------------------------------------------------------
+
 // Helper: Remove leading and trailing whitespace
 // Example: trim("  hello  ") -> "hello"
-static std::string trim(const std::string& s) {
+static std::string_view trim(std::string_view s) {
     auto start = s.find_first_not_of(" \t\r\n");
-    if (start == std::string::npos)
-        return "";  // All whitespace
+    if (start == std::string_view::npos)
+        return {};  // All whitespace
     auto end = s.find_last_not_of(" \t\r\n");
     return s.substr(start, end - start + 1);
 }
 
-// Helper: Infer column type from first NON-NULL data value
-// Strategy: Try int64 -> double -> string (most specific to least)
-// This is heuristic-based and can be wrong (e.g., "123" might be a product code)
-// Empty values (NULL) don't influence type inference
-// Future: Could sample multiple rows or use schema file
-static ColumnType infer_type(const std::vector<std::string>& values) {
-    // Find first non-empty value for type inference
-    for (const auto& val : values) {
-        std::string v = trim(val);
-        if (v.empty())
-            continue;  // Skip NULL values
-
-        // Try to parse as int64
-        try {
-            size_t pos;
-            std::stoll(v, &pos);
-            if (pos == v.size()) {  // Entire string was parsed
-                return ColumnType::INT64;
-            }
-        } catch (...) {
-        }  // Not an integer
+// Helper: Return the line starting at pos (without '\n') and advance pos past it
+static std::string_view next_line(const char* data, size_t size, size_t& pos) {
+    const char* begin = data + pos;
+    const void* nl = std::memchr(begin, '\n', size - pos);
+    size_t len = nl ? static_cast<size_t>(static_cast<const char*>(nl) - begin) : size - pos;
+    pos += nl ? len + 1 : len;
+    return std::string_view(begin, len);
+}
 
-        // Try to parse as double
-        try {
-            size_t pos;
-            std::stod(v, &pos);
-            if (pos == v.size()) {  // Entire string was parsed
-                return ColumnType::DOUBLE;
-            }
-        } catch (...) {
-        }  // Not a double
+// Helper: Split off the quoted field at the start of line (see next_field)
+// The field is a view into line unless it holds doubled quotes, which are
+// unescaped into scratch
+static void next_quoted_field(std::string_view& line, bool& done, std::string_view& field,
+                              std::string& scratch) {
+    const std::string_view original = line;
+    const size_t start = line.find('"') + 1;  // Past the opening quote
+    size_t pos = start;
+    bool escaped = false;
+    while (true) {
+        size_t quote = line.find('"', pos);
+        if (quote == std::string_view::npos) {
+            throw std::runtime_error("Unterminated quoted field in CSV line: " +
+                                     std::string(original));
+        }
+        if (quote + 1 < line.size() && line[quote + 1] == '"') {
+            escaped = true;  // "" inside quotes is one quote
+            pos = quote + 2;
+            continue;
+        }
+        field = line.substr(start, quote - start);
+        pos = quote + 1;
+        break;
+    }
+    if (escaped) {
+        scratch.clear();
+        for (size_t i = 0; i < field.size(); ++i) {
+            scratch.push_back(field[i]);
+            if (field[i] == '"')
+                ++i;  // Skip the second quote of the pair
+        }
+        field = scratch;
+    }
 
-        // If first non-empty value isn't numeric, it's string
-        return ColumnType::STRING;
+    // Only blanks may follow the closing quote before the separator
+    while (pos < line.size() && (line[pos] == ' ' || line[pos] == '\t' || line[pos] == '\r'))
+        ++pos;
+    if (pos == line.size()) {
+        done = true;
+    } else if (line[pos] == ',') {
+        line.remove_prefix(pos + 1);
+    } else {
+        throw std::runtime_error("Unexpected text after a quoted field in CSV line: " +
+                                 std::string(original));
     }
+}
+
+// Helper: Split off the next comma-separated field of line (handles trailing
+// empty fields: "a,b," yields "a", "b", "" - important for NULL handling)
+// A field starting with a quote (after blanks) runs to its closing quote;
+// scratch holds it if it had to be unescaped (until the next call)
+// Returns false when the line has no fields left
+static bool next_field(std::string_view& line, bool& done, std::string_view& field,
+                       std::string& scratch) {
+    if (done)
+        return false;
+    size_t first = line.find_first_not_of(" \t");
+    if (first != std::string_view::npos && line[first] == '"') {
+        next_quoted_field(line, done, field, scratch);
+        return true;
+    }
+    size_t comma = line.find(',');
+    if (comma == std::string_view::npos) {
+        field = line;
+        done = true;  // Last field of the line
+    } else {
+        field = line.substr(0, comma);
+        line.remove_prefix(comma + 1);
+    }
+    return true;
+}
+
+// Helper: Parse an int64 prefix like std::stoll (optional sign, then digits)
+// Returns the number of characters consumed, 0 if no number, or throws on overflow
+static size_t parse_int64(std::string_view v, int64_t& out) {
+    const char* first = v.data();
+    const char* last = v.data() + v.size();
+    if (first != last && *first == '+')
+        ++first;  // from_chars rejects an explicit '+'
+    auto [ptr, ec] = std::from_chars(first, last, out);
+    if (ec == std::errc::result_out_of_range)
+        throw std::out_of_range("int64 out of range");
+    if (ec != std::errc())
+        return 0;
+    return static_cast<size_t>(ptr - v.data());
+}
+
+// Helper: Parse a double prefix like std::stod
+static size_t parse_double(std::string_view v, double& out) {
+    const char* first = v.data();
+    const char* last = v.data() + v.size();
+    if (first != last && *first == '+')
+        ++first;
+    auto [ptr, ec] = std::from_chars(first, last, out);
+    if (ec == std::errc::result_out_of_range)
+        throw std::out_of_range("double out of range");
+    if (ec != std::errc())
+        return 0;
+    return static_cast<size_t>(ptr - v.data());
+}
+
+// Helper: Infer column type from a single NON-NULL (already trimmed) value
+// Strategy: Try int64 -> double -> string (most specific to least)
+// This is heuristic-based and can be wrong (e.g., "123" might be a product code,
+// which a schema clause can declare as a string)
+// Callers widen a column's type over the non-empty values of a sample, so
+// empty values (NULL) don't influence type inference
+static ColumnType infer_type(std::string_view v) {
+    // Try to parse as int64 (entire string must be consumed)
+    try {
+        int64_t i;
+        if (parse_int64(v, i) == v.size()) {
+            return ColumnType::INT64;
+        }
+    } catch (...) {
+    }  // Not an integer (or out of range)
+
+    // Try to parse as double
+    try {
+        double d;
+        if (parse_double(v, d) == v.size()) {
+            return ColumnType::DOUBLE;
+        }
+    } catch (...) {
+    }  // Not a double
 
-    // All values are empty (NULL) - default to string
+    // If first non-empty value isn't numeric, it's string
     return ColumnType::STRING;
 }
 
-// Helper: Parse string value and append to column (SQL NULL support)
+const char* column_type_name(ColumnType type) {
+    switch (type) {
+    case ColumnType::INT64:
+        return "int64";
+    case ColumnType::DOUBLE:
+        return "double";
+    case ColumnType::STRING:
+        return "string";
+    case ColumnType::BOOL:
+        return "bool";
+    }
+    return "string";
+}
+
+ColumnType widen_type(ColumnType a, ColumnType b) {
+    if (a == b) {
+        return a;
+    }
+    bool numeric = (a == ColumnType::INT64 || a == ColumnType::DOUBLE) &&
+                   (b == ColumnType::INT64 || b == ColumnType::DOUBLE);
+    return numeric ? ColumnType::DOUBLE : ColumnType::STRING;
+}
+
+// Helper: Parse a field and append it to column (SQL NULL support)
 // Handles type coercion (string -> typed value)
 // Empty cells become NULL (std::nullopt) - SQL semantics
-// Throws if value cannot be parsed according to column type
-static void append_value(Column& col, const std::string& value) {
-    std::string v = trim(value);
+// Throws if value cannot be parsed according to column type; for a column
+// typed from the sample (declared = false) the error names the schema clause
+static void append_value(Column& col, std::string_view value, bool declared) {
+    std::string_view v = trim(value);
 
     // SQL NULL semantics: empty cells are NULL
     if (v.empty()) {
-        switch (col.type) {
-        case ColumnType::INT64:
-            col.append_int(std::nullopt);
-            break;
-        case ColumnType::DOUBLE:
-            col.append_double(std::nullopt);
-            break;
-        case ColumnType::STRING:
-            col.append_string(std::nullopt);
-            break;
-        case ColumnType::BOOL:
-            col.append_bool(std::nullopt);
-            break;
-        }
+        col.append_null();
         return;
     }
 
     // Non-empty values: parse according to column type
+    // The whole value must parse: "3.7" in an INT64 column is an error, not 3
     try {
         switch (col.type) {
-        case ColumnType::INT64:
-            col.append_int(std::stoll(v));
+        case ColumnType::INT64: {
+            int64_t parsed;
+            if (parse_int64(v, parsed) != v.size())
+                throw std::invalid_argument("not an integer");
+            col.append_int(parsed);
             break;
-        case ColumnType::DOUBLE:
-            col.append_double(std::stod(v));
+        }
+        case ColumnType::DOUBLE: {
+            double parsed;
+            if (parse_double(v, parsed) != v.size())
+                throw std::invalid_argument("not a number");
+            col.append_double(parsed);
             break;
+        }
         case ColumnType::STRING:
             col.append_string(v);
             break;
         case ColumnType::BOOL:
-            // "true" or "1" -> true, anything else -> false
-            col.append_bool(v == "true" || v == "1");
+            // Only "true"/"1" and "false"/"0"
+            if (v == "true" || v == "1") {
+                col.append_bool(true);
+            } else if (v == "false" || v == "0") {
+                col.append_bool(false);
+            } else {
+                throw std::invalid_argument("not a bool");
+            }
             break;
         }
     } catch (const std::exception& e) {
         // Type coercion failed (e.g., "abc" in INT64 column)
-        throw std::runtime_error("Failed to parse value '" + value + "' for column " + col.name);
+        std::string message =
+            "Failed to parse value '" + std::string(value) + "' for column " + col.name;
+        if (!declared) {
+            // The sample fixed the type before this row was read
+            message += " (its type was inferred from the first " +
+                       std::to_string(kTypeSampleRows) +
+                       " rows; declare it in a schema clause to read wider values)";
+        }
+        throw std::runtime_error(message);
     }
 }
 
-// Read CSV file into a Table
+// Decompressed bytes a compressed CSV reader asks for at a time
+constexpr size_t kStreamChunkBytes = 1024 * 1024;
+
+// Helper: Call fn on each line of a decompressed file after the header,
+// until fn returns false; only the current chunk is held in memory
+template <typename Fn>
+static void for_each_line(Decompressor& stream, Fn fn) {
+    std::string chunk;
+    size_t pos = 0;
+    bool header = true;
+    bool eof = false;
+    while (true) {
+        if (!std::memchr(chunk.data() + pos, '\n', chunk.size() - pos)) {
+            if (!eof) {
+                // Keep the partial line and append the next chunk
+                chunk.erase(0, pos);
+                pos = 0;
+                size_t old_size = chunk.size();
+                chunk.resize(old_size + kStreamChunkBytes);
+                size_t n = stream.read(chunk.data() + old_size, kStreamChunkBytes);
+                chunk.resize(old_size + n);
+                eof = n == 0;
+                continue;
+            }
+            if (pos == chunk.size())
+                return;
+        }
+        std::string_view line = next_line(chunk.data(), chunk.size(), pos);
+        if (!header && !fn(line))
+            return;
+        header = false;
+    }
+}
+
+// Helper: Find the end of the first max_rows non-blank lines starting at pos
+// Only looks for newlines (memchr), which is far cheaper than tokenizing
+static size_t skip_rows(const char* data, size_t size, size_t pos, size_t max_rows) {
+    size_t rows = 0;
+    while (rows < max_rows && pos < size) {
+        const void* nl = std::memchr(data + pos, '\n', size - pos);
+        size_t end = nl ? static_cast<size_t>(static_cast<const char*>(nl) - data) : size;
+        if (end > pos)
+            rows++;  // Blank lines don't count as rows
+        pos = nl ? end + 1 : size;
+    }
+    return pos;
+}
+
+// Helper: Move offset forward to the start of the next line
+static size_t align_to_line(const char* data, size_t size, size_t offset) {
+    if (offset >= size)
+        return size;
+    const void* nl = std::memchr(data + offset, '\n', size - offset);
+    return nl ? static_cast<size_t>(static_cast<const char*>(nl) - data) + 1 : size;
+}
+
+// Helper: Parse the rows in bytes [begin, end) and append them to out
+// field_columns maps each CSV field to its column of out (-1 = skip the field);
+// declared marks the columns of out whose type the schema gave
+// Returns 0 on success, or the 1-based row (within the range) whose field
+// count does not match the header
+static size_t parse_range(const char* data, size_t begin, size_t end,
+                          const std::vector<int>& field_columns,
+                          const std::vector<bool>& declared, Table& out) {
+    const size_t num_columns = field_columns.size();
+    std::string scratch;  // Unescaped quoted fields
+    size_t pos = begin;
+    while (pos < end) {
+        std::string_view line = next_line(data, end, pos);
+        if (line.empty())
+            continue;  // Skip blank lines
+
+        // Tokenize in place, appending each field to its column as we go
+        std::string_view field;
+        bool done = false;
+        size_t col_idx = 0;
+        while (next_field(line, done, field, scratch)) {
+            if (col_idx == num_columns) {
+                col_idx++;  // Too many fields
+                break;
+            }
+            if (field_columns[col_idx] >= 0) {
+                size_t out_idx = static_cast<size_t>(field_columns[col_idx]);
+                append_value(out.columns[out_idx], field, declared[out_idx]);
+            }
+            col_idx++;
+        }
+        out.num_rows++;
+        // Verify every row has the header's column count
+        if (col_idx != num_columns) {
+            return out.num_rows;
+        }
+    }
+    return 0;
+}
+
+// Open a CSV file for batch-at-a-time reading
 // Process:
-//   1. Read header row -> column names
-//   2. Read first data row -> infer types
-//   3. Create columns with appropriate types
-//   4. Parse all rows and append to columns
-Table read_csv(const std::string& filepath) {
-    std::ifstream file(filepath);
-    if (!file) {
-        throw std::runtime_error("Cannot open file: " + filepath);
+//   1. Map the file and read header row -> column names (only the requested
+//      columns are kept; the rest are skipped while tokenizing)
+//   2. Declared columns take the schema's type; the others are inferred in a
+//      pre-pass over the first kTypeSampleRows rows (nothing is buffered; a
+//      compressed file is decompressed a second time for this pass), which
+//      also samples the leading rows to choose each STRING column's encoding
+//   3. Leave pos_ at the first data row; next_batch() then parses on demand
+CsvReader::CsvReader(const std::string& filepath, ThreadPool* pool,
+                     const std::vector<std::string>* columns,
+                     const std::vector<DeclaredColumn>* schema)
+    : pool_(pool) {
+    Compression compression = compression_of(filepath);
+    if (compression == Compression::NONE) {
+        file_ = std::make_unique<MappedFile>(filepath);
+    } else {
+        stream_ = open_decompressor(filepath, compression, pool);
+        fill_window(1);  // The header
     }
+    read_header(filepath, columns, schema);
+}
 
-    Table table;
-    std::string line;
+CsvReader::CsvReader(std::string_view text, const std::string& name, ThreadPool* pool,
+                     const std::vector<std::string>* columns,
+                     const std::vector<DeclaredColumn>* schema)
+    : file_(std::make_unique<MappedFile>(text)), pool_(pool) {
+    read_header(name, columns, schema);
+}
+
+void CsvReader::read_header(const std::string& filepath, const std::vector<std::string>* columns,
+                            const std::vector<DeclaredColumn>* schema) {
+    const char* data = text().data();
+    const size_t size = text().size();
 
     // Read header row (first line contains column names)
-    if (!std::getline(file, line)) {
+    if (size == 0) {
         throw std::runtime_error("Empty CSV file");
     }
+    std::string_view header_line = next_line(data, size, pos_);
+    std::string_view field;
+    std::string scratch;
+    bool done = false;
+    std::vector<std::string> fields;  // Every name in the header
+    while (next_field(header_line, done, field, scratch)) {
+        std::string name(trim(field));  // Clean up column names
+        bool wanted = !columns || std::find(columns->begin(), columns->end(), name) !=
+                                      columns->end();
+        field_columns_.push_back(wanted ? static_cast<int>(headers_.size()) : -1);
+        fields.push_back(name);
+        if (wanted) {
+            headers_.push_back(std::move(name));
+        }
+    }
 
-    std::vector<std::string> headers = split(line, ',');
-    for (auto& header : headers) {
-        header = trim(header);  // Clean up column names
+    // Declared columns are parsed as the schema says, even if entirely NULL
+    types_.assign(headers_.size(), ColumnType::STRING);
+    inferred_.assign(headers_.size(), false);
+    declared_.assign(headers_.size(), false);
+    if (schema) {
+        for (const auto& decl : *schema) {
+            if (std::find(fields.begin(), fields.end(), decl.name) == fields.end()) {
+                throw std::runtime_error("Column " + decl.name + " of the schema is not in " +
+                                         filepath);
+            }
+            auto it = std::find(headers_.begin(), headers_.end(), decl.name);
+            if (it == headers_.end())
+                continue;  // Not read by the pipeline
+            size_t col_idx = static_cast<size_t>(it - headers_.begin());
+            types_[col_idx] = decl.type;
+            inferred_[col_idx] = true;
+            declared_[col_idx] = true;
+        }
     }
 
-    // Collect all data rows first to infer types from non-NULL values
-    std::vector<std::vector<std::string>> all_rows;
-    while (std::getline(file, line)) {
+    // Infer the other columns' types from the first kTypeSampleRows rows:
+    // each non-NULL value widens its column's type (INT64 -> DOUBLE -> STRING)
+    // as it is seen. Columns without a value in the sample default to STRING
+    // The first kEncodingSampleRows rows are also sampled to pick each STRING
+    // column's encoding: few distinct values -> dictionary, else arena
+    // With every column declared and none a STRING, there is no pre-pass
+    const bool infer = std::find(declared_.begin(), declared_.end(), false) != declared_.end();
+    const bool any_string =
+        std::find(types_.begin(), types_.end(), ColumnType::STRING) != types_.end();
+    const size_t sample_rows = infer ? kTypeSampleRows : any_string ? kEncodingSampleRows : 0;
+    std::vector<std::unordered_set<std::string>> distinct(headers_.size());
+    std::vector<size_t> non_null(headers_.size(), 0);
+    size_t sampled = 0;
+    // Returns false once the pre-pass has seen enough
+    auto scan_line = [&](std::string_view line) {
         if (line.empty())
-            continue;  // Skip blank lines
-        all_rows.push_back(split(line, ','));
+            return true;  // Skip blank lines
+        bool sampling = sampled++ < kEncodingSampleRows;
+        done = false;
+        for (size_t field_idx = 0;
+             field_idx < field_columns_.size() && next_field(line, done, field, scratch);
+             ++field_idx) {
+            if (field_columns_[field_idx] < 0)
+                continue;  // Not read by the pipeline
+            size_t col_idx = static_cast<size_t>(field_columns_[field_idx]);
+            std::string_view v = trim(field);
+            if (v.empty())
+                continue;  // Skip NULL values
+            if (sampling) {
+                distinct[col_idx].emplace(v);
+                non_null[col_idx]++;
+            }
+            if (declared_[col_idx] || (inferred_[col_idx] && types_[col_idx] == ColumnType::STRING))
+                continue;  // Nothing left to widen to
+            ColumnType type = infer_type(v);
+            types_[col_idx] = inferred_[col_idx] ? widen_type(types_[col_idx], type) : type;
+            inferred_[col_idx] = true;
+        }
+        return sampled < sample_rows;
+    };
+    if (sample_rows == 0) {
+        // Every type is known and no column needs an encoding
+    } else if (stream_) {
+        // Its own pass over the start of the file: the window is not grown
+        // to hold rows the pre-pass reads
+        auto prepass = open_decompressor(filepath, compression_of(filepath));
+        for_each_line(*prepass, scan_line);
+    } else {
+        size_t scan_pos = pos_;
+        while (scan_pos < size && scan_line(next_line(data, size, scan_pos))) {
+        }
     }
 
-    if (all_rows.empty()) {
-        // File has header but no data rows
-        // Create empty string columns with NULL support
-        for (const auto& header : headers) {
-            Column col;
-            col.name = header;
-            col.type = ColumnType::STRING;
-            col.data = std::vector<std::optional<std::string>>{};
-            table.add_column(std::move(col));
-        }
-        return table;
+    // Dictionary-encode when values repeat on average 4+ times in the sample
+    dict_encoded_.assign(headers_.size(), false);
+    for (size_t col_idx = 0; col_idx < headers_.size(); ++col_idx) {
+        dict_encoded_[col_idx] = types_[col_idx] == ColumnType::STRING &&
+                                 non_null[col_idx] > 0 &&
+                                 distinct[col_idx].size() * 4 <= non_null[col_idx];
     }
+}
 
-    // Verify all rows have same column count
-    for (size_t row = 0; row < all_rows.size(); ++row) {
-        if (all_rows[row].size() != headers.size()) {
-            throw std::runtime_error("Column count mismatch in CSV at row " +
-                                     std::to_string(row + 2));
+void CsvReader::set_column_types(const std::vector<ColumnType>& types) {
+    for (size_t col_idx = 0; col_idx < types_.size(); ++col_idx) {
+        if (types[col_idx] == types_[col_idx])
+            continue;
+        types_[col_idx] = types[col_idx];
+        inferred_[col_idx] = true;
+        dict_encoded_[col_idx] = false;
+    }
+}
+
+void CsvReader::resume(size_t offset) {
+    const char* data = file_->data();
+    const size_t size = file_->size();
+    if (offset > pos_ && offset <= size) {
+        pos_ = offset;
+    }
+    size_t end = size;
+    while (end > pos_ && data[end - 1] != '\n')
+        --end;
+    end_ = end;
+}
+
+void CsvReader::fill_window(size_t rows) {
+    window_.erase(0, pos_);
+    pos_ = 0;
+    size_t found = 0;
+    size_t scanned = 0;  // Window bytes already counted
+    while (true) {
+        while (found < rows) {
+            const void* nl = std::memchr(window_.data() + scanned, '\n', window_.size() - scanned);
+            if (!nl)
+                break;
+            size_t end = static_cast<size_t>(static_cast<const char*>(nl) - window_.data());
+            if (end > scanned)
+                found++;  // Blank lines don't count as rows (as in skip_rows)
+            scanned = end + 1;
         }
+        if (found >= rows || stream_done_)
+            return;
+        size_t old_size = window_.size();
+        window_.resize(old_size + kStreamChunkBytes);
+        size_t n = stream_->read(window_.data() + old_size, kStreamChunkBytes);
+        window_.resize(old_size + n);
+        stream_done_ = n == 0;
     }
+}
 
-    // Infer types from all values in each column (skip NULLs)
-    for (size_t col_idx = 0; col_idx < headers.size(); ++col_idx) {
-        Column col;
-        col.name = headers[col_idx];
+// Cut the next byte ranges and parse them (in parallel when a pool is set)
+// Streaming (finite max_rows): each range holds exactly max_rows rows
+// Whole file (max_rows = SIZE_MAX): the rest of the file is split evenly by bytes
+void CsvReader::parse_ranges(size_t max_rows) {
+    const char* data = text().data();
+    const size_t size = text().size();
+    const size_t num_ranges = pool_ ? pool_->size() : 1;
 
-        // Collect all values for this column
-        std::vector<std::string> column_values;
-        for (const auto& row : all_rows) {
-            column_values.push_back(row[col_idx]);
+    std::vector<std::pair<size_t, size_t>> ranges;
+    if (max_rows == std::numeric_limits<size_t>::max()) {
+        size_t chunk = (size - pos_ + num_ranges - 1) / num_ranges;
+        while (pos_ < size) {
+            size_t end = align_to_line(data, size, pos_ + chunk - 1);
+            ranges.emplace_back(pos_, end);
+            pos_ = end;
+        }
+    } else {
+        while (ranges.size() < num_ranges && pos_ < size) {
+            size_t end = skip_rows(data, size, pos_, max_rows);
+            ranges.emplace_back(pos_, end);
+            pos_ = end;
         }
+    }
+    if (ranges.empty()) {
+        ranges.emplace_back(size, size);  // Empty batch carrying the schema
+    }
 
-        col.type = infer_type(column_values);  // Infer from non-NULL values
+    // Parse every range into its own table
+    std::vector<Table> tables(ranges.size());
+    std::vector<size_t> bad_rows(ranges.size(), 0);
+    std::vector<std::exception_ptr> errors(ranges.size());
+    auto parse = [&](size_t k) {
+        Table& table = tables[k];
+        for (size_t col_idx = 0; col_idx < headers_.size(); ++col_idx) {
+            table.add_column(dict_encoded_[col_idx]
+                                 ? Column::make_dict(headers_[col_idx])
+                                 : Column::make(headers_[col_idx], types_[col_idx]));
+            if (max_rows != std::numeric_limits<size_t>::max())
+                table.columns.back().reserve(max_rows);
+        }
+        try {
+            bad_rows[k] =
+                parse_range(data, ranges[k].first, ranges[k].second, field_columns_, declared_,
+                            table);
+            for (auto& col : table.columns)
+                col.zones = build_zone_map(col);
+        } catch (...) {
+            errors[k] = std::current_exception();
+        }
+    };
+    if (pool_) {
+        pool_->parallel_for(ranges.size(), parse);
+    } else {
+        parse(0);
+    }
 
-        // Initialize variant with the appropriate std::optional vector type
-        // This is necessary because std::variant needs an active alternative
-        switch (col.type) {
-        case ColumnType::INT64:
-            col.data = std::vector<std::optional<int64_t>>{};
-            break;
-        case ColumnType::DOUBLE:
-            col.data = std::vector<std::optional<double>>{};
-            break;
-        case ColumnType::STRING:
-            col.data = std::vector<std::optional<std::string>>{};
-            break;
-        case ColumnType::BOOL:
-            col.data = std::vector<std::optional<bool>>{};
-            break;
+    // Stitch in file order, reporting the first error as a sequential reader would
+    for (size_t k = 0; k < ranges.size(); ++k) {
+        if (errors[k]) {
+            std::rethrow_exception(errors[k]);
+        }
+        if (bad_rows[k]) {
+            throw std::runtime_error("Column count mismatch in CSV at row " +
+                                     std::to_string(row_number_ + bad_rows[k]));
         }
+        row_number_ += tables[k].num_rows;
+        ready_.push_back(std::move(tables[k]));
+    }
 
-        table.add_column(std::move(col));
+    if (file_) {
+        file_->discard_before(pos_);  // Parsed bytes are never looked at again
     }
+}
 
-    // Parse all rows (already collected for type inference)
-    for (const auto& row : all_rows) {
-        for (size_t col_idx = 0; col_idx < row.size(); ++col_idx) {
-            append_value(table.columns[col_idx], row[col_idx]);
+// Hand out the next parsed batch, parsing a new wave of ranges when needed
+bool CsvReader::next_batch(Table& out, size_t max_rows) {
+    if (ready_.empty()) {
+        if (stream_) {
+            // Text for one range per thread
+            size_t num_ranges = pool_ ? pool_->size() : 1;
+            size_t limit = std::numeric_limits<size_t>::max() / num_ranges;
+            fill_window(max_rows > limit ? std::numeric_limits<size_t>::max()
+                                         : max_rows * num_ranges);
+        }
+        if (started_ && pos_ >= text().size()) {
+            return false;  // Input exhausted
         }
-        table.num_rows++;
+        parse_ranges(max_rows);
     }
+    started_ = true;
 
-    return table;
+    out = std::move(ready_.front());
+    ready_.pop_front();
+    return true;
 }
 
-// Write Table to CSV file (SQL NULL support)
-// Format: header row, then data rows
-// NULL values are written as empty cells
-// No quoting (assumes values don't contain commas)
-void write_csv(const std::string& filepath, const Table& table) {
-    std::ofstream file(filepath);
-    if (!file) {
-        throw std::runtime_error("Cannot create file: " + filepath);
+// Read CSV file into a Table
+// Convenience wrapper around CsvReader that loads the whole file at once
+// Parallel ranges are concatenated back into a single table
+Table read_csv(const std::string& filepath, ThreadPool* pool) {
+    CsvReader reader(filepath, pool);
+    Table table;
+    reader.next_batch(table, std::numeric_limits<size_t>::max());
+    Table chunk;
+    while (reader.next_batch(chunk, std::numeric_limits<size_t>::max())) {
+        table.append(chunk);
     }
+    return table;
+}
 
-    // Write header row (column names)
-    for (size_t i = 0; i < table.columns.size(); ++i) {
-        if (i > 0)
-            file << ",";  // Comma separator between columns
-        file << table.columns[i].name;
+// Rows formatted per task when writing CSV (large enough that each range's
+// buffer is one big write)
+constexpr size_t kCsvWriteRows = 16 * 1024;
+
+// Helper: Append a CSV field, quoted if it holds a separator or quote
+// Quotes inside a quoted field are doubled (RFC 4180)
+// The reader splits rows at every newline, so a line break is an error
+// rather than a file that does not read back
+static void append_csv_field(std::string& out, std::string_view s, const std::string& column) {
+    auto special = [](char c) { return c == ',' || c == '"' || c == '\n' || c == '\r'; };
+    if (std::none_of(s.begin(), s.end(), special)) {
+        out.append(s.data(), s.size());
+        return;
+    }
+    if (s.find_first_of("\r\n") != std::string_view::npos) {
+        throw std::runtime_error("Cannot write a line break in a CSV field of column " + column);
+    }
+    out.push_back('"');
+    for (char c : s) {
+        if (c == '"')
+            out.push_back('"');
+        out.push_back(c);
     }
-    file << "\n";
+    out.push_back('"');
+}
 
-    // Write data rows
-    // Outer loop: rows (traditional row-wise iteration)
-    // Inner loop: columns
-    // Even though data is stored column-wise, we write row-wise for CSV format
-    for (size_t row = 0; row < table.num_rows; ++row) {
+// Helper: Append rows [begin, end) of table as CSV lines
+// Numbers go through std::to_chars: locale-independent, and doubles print
+// as the shortest text that reads back to the same value
+static void format_csv_rows(const Table& table, size_t begin, size_t end, std::string& out) {
+    char buf[32];
+    for (size_t row = begin; row < end; ++row) {
         for (size_t col_idx = 0; col_idx < table.columns.size(); ++col_idx) {
             if (col_idx > 0)
-                file << ",";
+                out.push_back(',');
 
             const Column& col = table.columns[col_idx];
 
             // SQL NULL semantics: NULL values write as empty cells
             if (col.is_null(row)) {
-                // Write nothing (empty cell)
                 continue;
             }
 
-            // Format value based on column type
             switch (col.type) {
-            case ColumnType::INT64:
-                file << col.get_int(row);
+            case ColumnType::INT64: {
+                auto result = std::to_chars(buf, buf + sizeof(buf), col.get_int(row));
+                out.append(buf, result.ptr);
                 break;
-            case ColumnType::DOUBLE:
-                file << col.get_double(row);
+            }
+            case ColumnType::DOUBLE: {
+                auto result = std::to_chars(buf, buf + sizeof(buf), col.get_double(row));
+                out.append(buf, result.ptr);
                 break;
+            }
             case ColumnType::STRING:
-                file << col.get_string(row);
-                // TODO: Quote strings containing commas
+                append_csv_field(out, col.get_string(row), col.name);
                 break;
             case ColumnType::BOOL:
-                file << (col.get_bool(row) ? "true" : "false");
+                out.append(col.get_bool(row) ? "true" : "false");
                 break;
             }
         }
-        file << "\n";
+        out.push_back('\n');
     }
 }
 
+// Open a CSV file for batch-at-a-time writing
+CsvWriter::CsvWriter(const std::string& filepath, ThreadPool* pool, bool append)
+    : filepath_(filepath),
+      file_(filepath, append ? std::ios::binary | std::ios::app : std::ios::binary),
+      pool_(pool), compression_(compression_of(filepath)) {
+    if (!file_) {
+        throw std::runtime_error("Cannot create file: " + filepath);
+    }
+    check_compression(compression_, filepath);
+    std::error_code ec;
+    header_written_ = append && std::filesystem::file_size(filepath, ec) > 0 && !ec;
+}
+
+// A pipeline that fails part-way still leaves a complete compressed stream
+CsvWriter::~CsvWriter() {
+    if (!closed_) {
+        try {
+            close();
+        } catch (...) {
+        }
+    }
+}
+
+void CsvWriter::emit(const std::string& text) {
+    if (compression_ == Compression::NONE) {
+        file_.write(text.data(), static_cast<std::streamsize>(text.size()));
+        return;
+    }
+    pending_ += text;
+    const size_t wave = pool_ ? pool_->size() : 1;
+    if (pending_.size() >= wave * kCompressBlockBytes) {
+        write_blocks(pending_.size() / kCompressBlockBytes);
+    }
+}
+
+void CsvWriter::write_blocks(size_t num_blocks) {
+    blocks_.resize(num_blocks);
+    auto compress = [&](size_t k) {
+        size_t begin = k * kCompressBlockBytes;
+        size_t len = std::min(kCompressBlockBytes, pending_.size() - begin);
+        blocks_[k].clear();
+        compress_block(compression_, std::string_view(pending_).substr(begin, len), blocks_[k]);
+    };
+    if (pool_ && num_blocks > 1) {
+        pool_->parallel_for(num_blocks, compress);
+    } else {
+        for (size_t k = 0; k < num_blocks; ++k)
+            compress(k);
+    }
+    for (const auto& block : blocks_) {
+        file_.write(block.data(), static_cast<std::streamsize>(block.size()));
+    }
+    pending_.erase(0, std::min(pending_.size(), num_blocks * kCompressBlockBytes));
+}
+
+// Append a batch to the CSV file (SQL NULL support)
+// Format: header row (first batch only), then data rows
+// NULL values are written as empty cells
+void CsvWriter::write(const Table& table) {
+    // Write header row (column names)
+    if (!header_written_) {
+        std::string header;
+        for (size_t i = 0; i < table.columns.size(); ++i) {
+            if (i > 0)
+                header.push_back(',');  // Comma separator between columns
+            append_csv_field(header, table.columns[i].name, table.columns[i].name);
+        }
+        header.push_back('\n');
+        emit(header);
+        header_written_ = true;
+    }
+
+    // Write data rows
+    // Even though data is stored column-wise, we write row-wise for CSV format:
+    // each range of rows is formatted into its own buffer, then the buffers
+    // are written in row order
+    // are written in row order. Ranges go in waves of a few per thread, so a
+    // huge batch never has all of its text in memory at once
+    const size_t num_ranges = (table.num_rows + kCsvWriteRows - 1) / kCsvWriteRows;
+    const size_t wave = pool_ ? 2 * pool_->size() : 1;
+    buffers_.resize(std::min(num_ranges, wave));
+    for (size_t first = 0; first < num_ranges; first += wave) {
+        const size_t count = std::min(wave, num_ranges - first);
+        auto format_range = [&](size_t r) {
+            std::string& out = buffers_[r];
+            out.clear();
+            size_t begin = (first + r) * kCsvWriteRows;
+            format_csv_rows(table, begin, std::min(table.num_rows, begin + kCsvWriteRows), out);
+        };
+        if (count > 1) {
+            pool_->parallel_for(count, format_range);
+        } else {
+            format_range(0);
+        }
+        for (size_t r = 0; r < count; ++r) {
+            emit(buffers_[r]);
+        }
+    }
+
+    if (!file_) {
+        throw std::runtime_error("Failed to write file: " + filepath_);
+    }
+}
+
+// Compress the text still pending and flush the file
+void CsvWriter::close() {
+    closed_ = true;
+    if (!pending_.empty()) {
+        write_blocks((pending_.size() + kCompressBlockBytes - 1) / kCompressBlockBytes);
+    }
+    file_.close();
+    if (file_.fail()) {
+        throw std::runtime_error("Failed to write file: " + filepath_);
+    }
+}
+
+// Write Table to CSV file
+void write_csv(const std::string& filepath, const Table& table, ThreadPool* pool) {
+    CsvWriter writer(filepath, pool);
+    writer.write(table);
+    writer.close();
+}
+
 }  // namespace joy
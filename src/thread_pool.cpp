@@ -0,0 +1,204 @@
+#include "thread_pool.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <memory>
+
+namespace joy {
+
+// ============================================================================
+// Thread Pool Implementation
+// ============================================================================
+
+ThreadPool::ThreadPool(size_t num_threads) {
+    if (num_threads == 0) {
+        num_threads = std::thread::hardware_concurrency();
+        if (num_threads == 0)
+            num_threads = 1;  // hardware_concurrency() may be unknown
+    }
+    // The calling thread participates in parallel_for, so spawn one fewer
+    for (size_t i = 1; i < num_threads; ++i) {
+        workers_.emplace_back([this] { worker_loop(); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    cv_.notify_all();
+    for (auto& worker : workers_) {
+        worker.join();
+    }
+}
+
+// Worker: pop tasks until the pool shuts down
+void ThreadPool::worker_loop() {
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [this] { return stopping_ || !tasks_.empty(); });
+            if (stopping_ && tasks_.empty())
+                return;
+            task = std::move(tasks_.front());
+            tasks_.pop_front();
+        }
+        task();
+    }
+}
+
+// Fork/join loop: workers and the caller claim indices from a shared counter
+// The caller only returns once every index has finished running
+void ThreadPool::parallel_for(size_t n, const std::function<void(size_t)>& fn) {
+    if (n == 0)
+        return;
+    if (workers_.empty() || n == 1) {
+        for (size_t i = 0; i < n; ++i)
+            fn(i);
+        return;
+    }
+
+    // Shared with helper tasks, which may start after the loop is already done
+    struct State {
+        std::atomic<size_t> next{0};
+        std::atomic<bool> failed{false};
+        size_t finished = 0;
+        std::exception_ptr error;
+        std::mutex mutex;
+        std::condition_variable done;
+    };
+    auto state = std::make_shared<State>();
+    const auto* body = &fn;  // Only dereferenced for claimed indices (< n)
+
+    auto run = [state, body, n] {
+        size_t i;
+        while ((i = state->next.fetch_add(1)) < n) {
+            std::exception_ptr error;
+            if (!state->failed.load()) {
+                try {
+                    (*body)(i);
+                } catch (...) {
+                    error = std::current_exception();
+                    state->failed.store(true);
+                }
+            }
+            std::lock_guard<std::mutex> lock(state->mutex);
+            if (error && !state->error)
+                state->error = error;
+            if (++state->finished == n)
+                state->done.notify_all();
+        }
+    };
+
+    size_t helpers = std::min(workers_.size(), n - 1);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (size_t h = 0; h < helpers; ++h)
+            tasks_.emplace_back(run);
+    }
+    cv_.notify_all();
+
+    run();  // Caller works too
+
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->done.wait(lock, [&] { return state->finished == n; });
+    if (state->error)
+        std::rethrow_exception(state->error);
+}
+
+// Work stealing: one deque of indices per thread. Tasks are coarse (e.g. a
+// morsel of rows), so a mutex per deque is cheap next to the work
+void ThreadPool::parallel_for_stealing(size_t n,
+                                       const std::function<void(size_t, size_t)>& fn) {
+    if (n == 0)
+        return;
+    if (workers_.empty() || n == 1) {
+        for (size_t i = 0; i < n; ++i)
+            fn(0, i);
+        return;
+    }
+
+    struct Queue {
+        std::mutex mutex;
+        std::deque<size_t> indices;
+    };
+    struct State {
+        explicit State(size_t threads) : queues(threads) {}
+        std::vector<Queue> queues;
+        std::atomic<size_t> next_worker{1};  // 0 is the caller
+        std::atomic<bool> failed{false};
+        size_t finished = 0;
+        std::exception_ptr error;
+        std::mutex mutex;
+        std::condition_variable done;
+    };
+    const size_t threads = std::min(size(), n);
+    auto state = std::make_shared<State>(threads);
+    for (size_t t = 0; t < threads; ++t) {
+        for (size_t i = t * n / threads; i < (t + 1) * n / threads; ++i)
+            state->queues[t].indices.push_back(i);
+    }
+    const auto* body = &fn;  // Only dereferenced for claimed indices
+
+    // Next index for thread self: its own front, else another thread's back
+    auto claim = [state, threads](size_t self, size_t& index) {
+        for (size_t k = 0; k < threads; ++k) {
+            Queue& queue = state->queues[(self + k) % threads];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            if (queue.indices.empty())
+                continue;
+            if (k == 0) {
+                index = queue.indices.front();
+                queue.indices.pop_front();
+            } else {
+                index = queue.indices.back();
+                queue.indices.pop_back();
+            }
+            return true;
+        }
+        return false;
+    };
+    auto run = [state, body, claim, n](size_t self) {
+        size_t i;
+        while (claim(self, i)) {
+            std::exception_ptr error;
+            if (!state->failed.load()) {
+                try {
+                    (*body)(self, i);
+                } catch (...) {
+                    error = std::current_exception();
+                    state->failed.store(true);
+                }
+            }
+            std::lock_guard<std::mutex> lock(state->mutex);
+            if (error && !state->error)
+                state->error = error;
+            if (++state->finished == n)
+                state->done.notify_all();
+        }
+    };
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (size_t h = 1; h < threads; ++h) {
+            tasks_.emplace_back([state, run, threads] {
+                size_t self = state->next_worker.fetch_add(1);
+                if (self < threads)
+                    run(self);
+            });
+        }
+    }
+    cv_.notify_all();
+
+    run(0);  // Caller works too
+
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->done.wait(lock, [&] { return state->finished == n; });
+    if (state->error)
+        std::rethrow_exception(state->error);
+}
+
+}  // namespace joy
@@ -1,229 +1,502 @@
 #include "vectorized_ops.hpp"
 
 #include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <type_traits>
 
 namespace joy {
 
 // ============================================================================
-// Vectorized GT Operations
+// Comparison Kernel Family
 // ============================================================================
-
-SelectionVector vec_gt_int64(const Column& col, int64_t value) {
-    const auto& data = std::get<std::vector<std::optional<int64_t>>>(col.data);
-    SelectionVector result(data.size());
-
-    for (size_t i = 0; i < data.size(); ++i) {
-        result[i] = data[i].has_value() && data[i].value() > value;
+// Every comparison runs the same loop:
+//   1. Evaluate the comparator on 64 consecutive rows and pack the results
+//      into a word (no NULL checks, no branches - compilers vectorize this loop)
+//   2. AND the word with the rows that may match: valid in every operand
+//      and active
+// The comparator, the operand readers and the NULL check are template
+// parameters, so each combination compiles to its own loop. with_comparator
+// and with_row_mask turn the runtime choices into those parameters
+
+// Comparator for op, fixed at compile time
+// Mixed INT64/DOUBLE operands compare as DOUBLE, like the scalar VM
+template <CompareOp Op>
+struct Comparator {
+    template <typename L, typename R>
+    bool operator()(L l, R r) const {
+        using C = std::common_type_t<L, R>;
+        const C a = static_cast<C>(l);
+        const C b = static_cast<C>(r);
+        if constexpr (Op == CompareOp::GT)
+            return a > b;
+        else if constexpr (Op == CompareOp::LT)
+            return a < b;
+        else if constexpr (Op == CompareOp::GTE)
+            return a >= b;
+        else if constexpr (Op == CompareOp::LTE)
+            return a <= b;
+        else if constexpr (Op == CompareOp::EQ)
+            return a == b;
+        else
+            return a != b;
     }
+};
 
-    return result;
-}
-
-SelectionVector vec_gt_double(const Column& col, double value) {
-    const auto& data = std::get<std::vector<std::optional<double>>>(col.data);
-    SelectionVector result(data.size());
-
-    for (size_t i = 0; i < data.size(); ++i) {
-        result[i] = data[i].has_value() && data[i].value() > value;
+template <typename Fn>
+static auto with_comparator(CompareOp op, Fn&& fn) {
+    switch (op) {
+    case CompareOp::GT:
+        return fn(Comparator<CompareOp::GT>{});
+    case CompareOp::LT:
+        return fn(Comparator<CompareOp::LT>{});
+    case CompareOp::GTE:
+        return fn(Comparator<CompareOp::GTE>{});
+    case CompareOp::LTE:
+        return fn(Comparator<CompareOp::LTE>{});
+    case CompareOp::EQ:
+        return fn(Comparator<CompareOp::EQ>{});
+    case CompareOp::NEQ:
+    default:
+        return fn(Comparator<CompareOp::NEQ>{});
     }
-
-    return result;
 }
 
-SelectionVector vec_gt_string(const Column& col, const std::string& value) {
-    const auto& data = std::get<std::vector<std::optional<std::string>>>(col.data);
-    SelectionVector result(data.size());
-
-    for (size_t i = 0; i < data.size(); ++i) {
-        result[i] = data[i].has_value() && data[i].value() > value;
+// Rows of word w that may match: valid in both operands and active
+// Without CheckNulls (no operand holds a NULL) validity is never read
+template <bool CheckNulls>
+struct RowMask {
+    const uint64_t* left_valid;
+    const uint64_t* right_valid;  // nullptr for a scalar operand
+    const uint64_t* live;         // nullptr = every row is active
+
+    uint64_t operator()(size_t w) const {
+        uint64_t mask = ~uint64_t{0};
+        if constexpr (CheckNulls) {
+            mask = left_valid[w];
+            if (right_valid)
+                mask &= right_valid[w];
+        }
+        if (live)
+            mask &= live[w];
+        return mask;
     }
+};
 
-    return result;
+static bool has_nulls(const Column& col) {
+    return col.validity.count() != col.size();
 }
 
-// ============================================================================
-// Vectorized LT Operations
-// ============================================================================
-
-SelectionVector vec_lt_int64(const Column& col, int64_t value) {
-    const auto& data = std::get<std::vector<std::optional<int64_t>>>(col.data);
-    SelectionVector result(data.size());
-
-    for (size_t i = 0; i < data.size(); ++i) {
-        result[i] = data[i].has_value() && data[i].value() < value;
+// right = nullptr when the other operand is a scalar
+template <typename Fn>
+static SelectionVector with_row_mask(const Column& left, const Column* right,
+                                     const SelectionVector* active, Fn&& fn) {
+    const uint64_t* live = active ? active->words() : nullptr;
+    if (has_nulls(left) || (right && has_nulls(*right))) {
+        return fn(RowMask<true>{left.validity.words(),
+                                right ? right->validity.words() : nullptr, live});
     }
-
-    return result;
+    return fn(RowMask<false>{nullptr, nullptr, live});
 }
 
-SelectionVector vec_lt_double(const Column& col, double value) {
-    const auto& data = std::get<std::vector<std::optional<double>>>(col.data);
-    SelectionVector result(data.size());
+// Words whose mask is zero are skipped without evaluating pred
+template <typename Mask, typename Pred>
+static SelectionVector pack_kernel(size_t n, Mask mask_of, Pred pred) {
+    SelectionVector result(n);
+    uint64_t* out = result.words();
+
+    const size_t full_words = n / 64;
+    for (size_t w = 0; w < full_words; ++w) {
+        const uint64_t mask = mask_of(w);
+        if (mask == 0)
+            continue;  // Nothing selectable in these 64 rows
+        const size_t base = w * 64;
+        uint64_t bits = 0;
+        for (size_t b = 0; b < 64; ++b) {
+            bits |= static_cast<uint64_t>(pred(base + b)) << b;
+        }
+        out[w] = bits & mask;
+    }
 
-    for (size_t i = 0; i < data.size(); ++i) {
-        result[i] = data[i].has_value() && data[i].value() < value;
+    // Tail (fewer than 64 rows)
+    if (n % 64) {
+        const uint64_t mask = mask_of(full_words);
+        uint64_t bits = 0;
+        for (size_t i = full_words * 64; mask != 0 && i < n; ++i) {
+            bits |= static_cast<uint64_t>(pred(i)) << (i % 64);
+        }
+        out[full_words] = bits & mask;
     }
 
     return result;
 }
 
-SelectionVector vec_lt_string(const Column& col, const std::string& value) {
-    const auto& data = std::get<std::vector<std::optional<std::string>>>(col.data);
-    SelectionVector result(data.size());
-
-    for (size_t i = 0; i < data.size(); ++i) {
-        result[i] = data[i].has_value() && data[i].value() < value;
+// Operand readers: row i of a value buffer, of a STRING column, or a
+// scalar that ignores the row
+template <typename T>
+struct Values {
+    const T* data;
+    T operator()(size_t i) const {
+        return data[i];
     }
+};
 
-    return result;
-}
+template <typename T>
+struct Constant {
+    T value;
+    T operator()(size_t) const {
+        return value;
+    }
+};
 
-// ============================================================================
-// Vectorized GTE Operations
-// ============================================================================
+struct DictReader {
+    const int32_t* codes;
+    const StringDictionary* dict;
+    std::string_view operator()(size_t i) const {
+        return dict->get(codes[i]);
+    }
+};
 
-SelectionVector vec_gte_int64(const Column& col, int64_t value) {
-    const auto& data = std::get<std::vector<std::optional<int64_t>>>(col.data);
-    SelectionVector result(data.size());
+struct ArenaReader {
+    const StringArena* arena;
+    std::string_view operator()(size_t i) const {
+        return arena->get(i);
+    }
+};
 
-    for (size_t i = 0; i < data.size(); ++i) {
-        result[i] = data[i].has_value() && data[i].value() >= value;
+template <typename Fn>
+static SelectionVector with_string_reader(const Column& col, Fn&& fn) {
+    if (const auto* dict = std::get_if<DictStrings>(&col.data)) {
+        return fn(DictReader{dict->codes.data(), dict->dict.get()});
     }
+    return fn(ArenaReader{&std::get<StringArena>(col.data)});
+}
 
-    return result;
+// The family: left(i) op right(i) for every row that may match
+// left_col / right_col supply the validity (right_col = nullptr for a scalar)
+template <typename Left, typename Right>
+static SelectionVector compare_kernel(CompareOp op, const Column& left_col,
+                                      const Column* right_col, const SelectionVector* active,
+                                      Left left, Right right) {
+    return with_comparator(op, [&](auto cmp) {
+        return with_row_mask(left_col, right_col, active, [&](auto mask) {
+            return pack_kernel(left_col.size(), mask,
+                               [=](size_t i) { return cmp(left(i), right(i)); });
+        });
+    });
 }
 
-SelectionVector vec_gte_double(const Column& col, double value) {
-    const auto& data = std::get<std::vector<std::optional<double>>>(col.data);
-    SelectionVector result(data.size());
+// Zone map check: how many non-NULL rows of a zone with values in [lo, hi]
+// can satisfy x op value (NaN bounds or literal: undecided)
+enum class ZoneMatch { NONE, SOME, ALL };
 
-    for (size_t i = 0; i < data.size(); ++i) {
-        result[i] = data[i].has_value() && data[i].value() >= value;
+template <typename T>
+static ZoneMatch classify_zone(CompareOp op, T lo, T hi, T value) {
+    if constexpr (std::is_floating_point_v<T>) {
+        if (std::isnan(lo) || std::isnan(hi) || std::isnan(value))
+            return ZoneMatch::SOME;
     }
-
-    return result;
+    auto decide = [](bool none, bool all) {
+        return none ? ZoneMatch::NONE : (all ? ZoneMatch::ALL : ZoneMatch::SOME);
+    };
+    switch (op) {
+    case CompareOp::GT:
+        return decide(hi <= value, lo > value);
+    case CompareOp::GTE:
+        return decide(hi < value, lo >= value);
+    case CompareOp::LT:
+        return decide(lo >= value, hi < value);
+    case CompareOp::LTE:
+        return decide(lo > value, hi <= value);
+    case CompareOp::EQ:
+        return decide(value < lo || value > hi, lo == value && hi == value);
+    case CompareOp::NEQ:
+        return decide(lo == value && hi == value, value < lo || value > hi);
+    }
+    return ZoneMatch::SOME;
 }
 
-SelectionVector vec_gte_string(const Column& col, const std::string& value) {
-    const auto& data = std::get<std::vector<std::optional<std::string>>>(col.data);
-    SelectionVector result(data.size());
-
-    for (size_t i = 0; i < data.size(); ++i) {
-        result[i] = data[i].has_value() && data[i].value() >= value;
+// INT64 column vs INT64 scalar and DOUBLE vs DOUBLE: instead of the family's
+// loop, a hand-vectorized kernel (AVX-512/AVX2/NEON, picked at startup) writes
+// the selection words, then one AND per word with validity
+// (and active). Evaluating every row is cheaper here than skipping words
+//
+// With a zone map, zones whose bounds decide the comparison are not
+// evaluated: NONE leaves their words zero, ALL copies validity (and active)
+template <typename T>
+static SelectionVector numeric_compare_kernel(const Column& col, CompareOp op, T value,
+                                              const SelectionVector* active) {
+    const size_t n = col.size();
+    SelectionVector result(n);
+    uint64_t* out = result.words();
+    const uint64_t* valid = col.validity.words();
+
+    // Compare rows [begin, end) (begin is a multiple of 64)
+    auto compare = [&](size_t begin, size_t end) {
+        if constexpr (std::is_same_v<T, int64_t>) {
+            simd_compare_int64(op, col.values<int64_t>().data() + begin, end - begin, value,
+                               out + begin / 64);
+        } else {
+            simd_compare_double(op, col.values<double>().data() + begin, end - begin, value,
+                                out + begin / 64);
+        }
+    };
+
+    const ZoneMap* zones = col.zone_map();
+    if (!zones) {
+        compare(0, n);
+    } else {
+        for (size_t z = 0; z < zones->num_zones(); ++z) {
+            const size_t begin = z * kZoneRows;
+            const size_t end = std::min(begin + kZoneRows, n);
+            ZoneMatch match = ZoneMatch::NONE;  // A zone of NULLs matches nothing
+            if (zones->null_counts[z] < end - begin) {
+                if constexpr (std::is_same_v<T, int64_t>) {
+                    match = classify_zone(op, zones->int_min[z], zones->int_max[z], value);
+                } else {
+                    match = classify_zone(op, zones->double_min[z], zones->double_max[z], value);
+                }
+            }
+            if (match == ZoneMatch::SOME) {
+                compare(begin, end);
+            } else if (match == ZoneMatch::ALL) {
+                std::fill(out + begin / 64, out + (end + 63) / 64, ~uint64_t{0});
+            }
+        }
+        result.clear_tail();
     }
 
+    for (size_t w = 0; w < result.num_words(); ++w) {
+        out[w] &= valid[w];
+    }
+    if (active) {
+        const uint64_t* live = active->words();
+        for (size_t w = 0; w < result.num_words(); ++w) {
+            out[w] &= live[w];
+        }
+    }
     return result;
 }
 
 // ============================================================================
-// Vectorized LTE Operations
+// Column op Scalar
 // ============================================================================
 
-SelectionVector vec_lte_int64(const Column& col, int64_t value) {
-    const auto& data = std::get<std::vector<std::optional<int64_t>>>(col.data);
-    SelectionVector result(data.size());
-
-    for (size_t i = 0; i < data.size(); ++i) {
-        result[i] = data[i].has_value() && data[i].value() <= value;
-    }
-
-    return result;
+SelectionVector vec_compare_int64(CompareOp op, const Column& col, int64_t value,
+                                  const SelectionVector* active) {
+    return numeric_compare_kernel(col, op, value, active);
 }
 
-SelectionVector vec_lte_double(const Column& col, double value) {
-    const auto& data = std::get<std::vector<std::optional<double>>>(col.data);
-    SelectionVector result(data.size());
-
-    for (size_t i = 0; i < data.size(); ++i) {
-        result[i] = data[i].has_value() && data[i].value() <= value;
+SelectionVector vec_compare_double(CompareOp op, const Column& col, double value,
+                                   const SelectionVector* active) {
+    if (col.type == ColumnType::DOUBLE) {
+        return numeric_compare_kernel(col, op, value, active);
     }
-
-    return result;
+    return compare_kernel(op, col, nullptr, active, Values<int64_t>{col.values<int64_t>().data()},
+                          Constant<double>{value});
 }
 
-SelectionVector vec_lte_string(const Column& col, const std::string& value) {
-    const auto& data = std::get<std::vector<std::optional<std::string>>>(col.data);
-    SelectionVector result(data.size());
+// Dictionary columns compare each unique value once and look the result up
+// by code; equality compares codes with the literal's single code
+// (kNotFound never matches, so EQ selects nothing and NEQ selects every
+// non-NULL row). Arena columns compare each row's bytes in place
+SelectionVector vec_compare_string(CompareOp op, const Column& col, const std::string& value,
+                                   const SelectionVector* active) {
+    const std::string_view literal = value;
+    const auto* dict = std::get_if<DictStrings>(&col.data);
+    if (!dict) {
+        return compare_kernel(op, col, nullptr, active,
+                              ArenaReader{&std::get<StringArena>(col.data)},
+                              Constant<std::string_view>{literal});
+    }
 
-    for (size_t i = 0; i < data.size(); ++i) {
-        result[i] = data[i].has_value() && data[i].value() <= value;
+    const int32_t* codes = dict->codes.data();
+    if (op == CompareOp::EQ || op == CompareOp::NEQ) {
+        return compare_kernel(op, col, nullptr, active, Values<int32_t>{codes},
+                              Constant<int32_t>{dict->dict->find(literal)});
     }
 
-    return result;
+    // NULL slots hold code 0, so the table always has at least one entry
+    std::vector<uint8_t> matches(std::max<size_t>(dict->dict->size(), 1), 0);
+    with_comparator(op, [&](auto cmp) {
+        for (size_t code = 0; code < dict->dict->size(); ++code) {
+            matches[code] = cmp(dict->dict->get(static_cast<int32_t>(code)), literal);
+        }
+    });
+    const uint8_t* table = matches.data();
+    return with_row_mask(col, nullptr, active, [&](auto mask) {
+        return pack_kernel(col.size(), mask,
+                           [codes, table](size_t i) { return table[codes[i]] != 0; });
+    });
 }
 
 // ============================================================================
-// Vectorized EQ Operations
+// String Predicates
 // ============================================================================
 
-SelectionVector vec_eq_int64(const Column& col, int64_t value) {
-    const auto& data = std::get<std::vector<std::optional<int64_t>>>(col.data);
-    SelectionVector result(data.size());
-
-    for (size_t i = 0; i < data.size(); ++i) {
-        result[i] = data[i].has_value() && data[i].value() == value;
+const char* string_match_name(StringMatch match) {
+    switch (match) {
+    case StringMatch::PREFIX:
+        return "starts_with";
+    case StringMatch::SUFFIX:
+        return "ends_with";
+    case StringMatch::CONTAINS:
+        return "contains";
+    case StringMatch::IEQUALS:
+    default:
+        return "iequals";
     }
-
-    return result;
 }
 
-SelectionVector vec_eq_double(const Column& col, double value) {
-    const auto& data = std::get<std::vector<std::optional<double>>>(col.data);
-    SelectionVector result(data.size());
-
-    for (size_t i = 0; i < data.size(); ++i) {
-        result[i] = data[i].has_value() && data[i].value() == value;
+bool string_matches(StringMatch match, std::string_view value, std::string_view pattern) {
+    switch (match) {
+    case StringMatch::PREFIX:
+        return value.substr(0, pattern.size()) == pattern;
+    case StringMatch::SUFFIX:
+        return value.size() >= pattern.size() &&
+               value.substr(value.size() - pattern.size()) == pattern;
+    case StringMatch::CONTAINS:
+        return pattern.empty() || simd_find(value.data(), value.size(), 0, pattern.data(),
+                                            pattern.size()) != value.size();
+    case StringMatch::IEQUALS:
+    default:
+        return value.size() == pattern.size() &&
+               simd_iequals(value.data(), pattern.data(), pattern.size());
     }
-
-    return result;
 }
 
-SelectionVector vec_eq_string(const Column& col, const std::string& value) {
-    const auto& data = std::get<std::vector<std::optional<std::string>>>(col.data);
-    SelectionVector result(data.size());
+// Helper: One byte per value of arena, 1 where it matches
+// contains searches the arena as a single text: a hit is mapped to its value
+// by binary search over the offsets and counts only if it ends inside that
+// value; either way the search resumes at the next value, since a later
+// start in the same value cannot fit either
+static std::vector<uint8_t> match_arena(StringMatch match, const StringArena& arena,
+                                        std::string_view pattern) {
+    const size_t n = arena.size();
+    const size_t len = pattern.size();
+    const char* bytes = arena.data();
+    const size_t* offsets = arena.offsets();
+    std::vector<uint8_t> matches(std::max<size_t>(n, 1), 0);
+
+    if (len == 0) {
+        for (size_t i = 0; i < n; ++i) {
+            matches[i] = match != StringMatch::IEQUALS || offsets[i + 1] == offsets[i];
+        }
+        return matches;
+    }
 
-    for (size_t i = 0; i < data.size(); ++i) {
-        result[i] = data[i].has_value() && data[i].value() == value;
+    if (match == StringMatch::CONTAINS) {
+        const size_t total = arena.num_bytes();
+        size_t pos = 0;
+        while ((pos = simd_find(bytes, total, pos, pattern.data(), len)) < total) {
+            const size_t row =
+                static_cast<size_t>(std::upper_bound(offsets + 1, offsets + n + 1, pos) -
+                                    (offsets + 1));
+            matches[row] = pos + len <= offsets[row + 1];
+            pos = offsets[row + 1];
+        }
+        return matches;
     }
 
-    return result;
+    // Length prefilter, then the byte nearest the anchor before the rest
+    for (size_t i = 0; i < n; ++i) {
+        const size_t size = offsets[i + 1] - offsets[i];
+        const char* value = bytes + offsets[i];
+        switch (match) {
+        case StringMatch::PREFIX:
+            matches[i] = size >= len && value[0] == pattern[0] &&
+                         std::memcmp(value, pattern.data(), len) == 0;
+            break;
+        case StringMatch::SUFFIX:
+            matches[i] = size >= len && value[size - 1] == pattern[len - 1] &&
+                         std::memcmp(value + size - len, pattern.data(), len) == 0;
+            break;
+        default:
+            matches[i] = size == len && simd_iequals(value, pattern.data(), len);
+            break;
+        }
+    }
+    return matches;
+}
+
+SelectionVector vec_match_string(StringMatch match, const Column& col, const std::string& pattern,
+                                 const SelectionVector* active) {
+    // Plain column: one entry per row; dictionary column: one per code
+    // (NULL slots hold code 0, so the dictionary table is never empty)
+    const auto* dict = std::get_if<DictStrings>(&col.data);
+    const std::vector<uint8_t> matches =
+        match_arena(match, dict ? dict->dict->values() : std::get<StringArena>(col.data),
+                    pattern);
+    const uint8_t* table = matches.data();
+    return with_row_mask(col, nullptr, active, [&](auto mask) {
+        if (dict) {
+            const int32_t* codes = dict->codes.data();
+            return pack_kernel(col.size(), mask,
+                               [codes, table](size_t i) { return table[codes[i]] != 0; });
+        }
+        return pack_kernel(col.size(), mask, [table](size_t i) { return table[i] != 0; });
+    });
 }
 
 // ============================================================================
-// Vectorized NEQ Operations
+// Column op Column
 // ============================================================================
 
-SelectionVector vec_neq_int64(const Column& col, int64_t value) {
-    const auto& data = std::get<std::vector<std::optional<int64_t>>>(col.data);
-    SelectionVector result(data.size());
+SelectionVector vec_compare_columns(CompareOp op, const Column& left, const Column& right,
+                                    const SelectionVector* active) {
+    const ColumnType lt = left.type;
+    const ColumnType rt = right.type;
 
-    for (size_t i = 0; i < data.size(); ++i) {
-        result[i] = data[i].has_value() && data[i].value() != value;
+    if (lt == ColumnType::INT64 && rt == ColumnType::INT64) {
+        return compare_kernel(op, left, &right, active,
+                              Values<int64_t>{left.values<int64_t>().data()},
+                              Values<int64_t>{right.values<int64_t>().data()});
     }
-
-    return result;
-}
-
-SelectionVector vec_neq_double(const Column& col, double value) {
-    const auto& data = std::get<std::vector<std::optional<double>>>(col.data);
-    SelectionVector result(data.size());
-
-    for (size_t i = 0; i < data.size(); ++i) {
-        result[i] = data[i].has_value() && data[i].value() != value;
+    if (lt == ColumnType::INT64 && rt == ColumnType::DOUBLE) {
+        return compare_kernel(op, left, &right, active,
+                              Values<int64_t>{left.values<int64_t>().data()},
+                              Values<double>{right.values<double>().data()});
+    }
+    if (lt == ColumnType::DOUBLE && rt == ColumnType::INT64) {
+        return compare_kernel(op, left, &right, active,
+                              Values<double>{left.values<double>().data()},
+                              Values<int64_t>{right.values<int64_t>().data()});
+    }
+    if (lt == ColumnType::DOUBLE && rt == ColumnType::DOUBLE) {
+        return compare_kernel(op, left, &right, active,
+                              Values<double>{left.values<double>().data()},
+                              Values<double>{right.values<double>().data()});
     }
 
-    return result;
-}
-
-SelectionVector vec_neq_string(const Column& col, const std::string& value) {
-    const auto& data = std::get<std::vector<std::optional<std::string>>>(col.data);
-    SelectionVector result(data.size());
-
-    for (size_t i = 0; i < data.size(); ++i) {
-        result[i] = data[i].has_value() && data[i].value() != value;
+    if (lt == ColumnType::BOOL) {
+        // Bit-packed on both sides: a word of equal bits is NOT (a XOR b)
+        const uint64_t* a = std::get<Bitmap>(left.data).words();
+        const uint64_t* b = std::get<Bitmap>(right.data).words();
+        const uint64_t flip = op == CompareOp::EQ ? ~uint64_t{0} : 0;
+        return with_row_mask(left, &right, active, [&](auto mask) {
+            SelectionVector result(left.size());
+            uint64_t* out = result.words();
+            for (size_t w = 0; w < result.num_words(); ++w) {
+                out[w] = (a[w] ^ b[w] ^ flip) & mask(w);
+            }
+            result.clear_tail();
+            return result;
+        });
     }
 
-    return result;
+    // STRING: columns sharing a dictionary compare codes for equality
+    const auto* left_dict = std::get_if<DictStrings>(&left.data);
+    const auto* right_dict = std::get_if<DictStrings>(&right.data);
+    if (left_dict && right_dict && left_dict->dict == right_dict->dict &&
+        (op == CompareOp::EQ || op == CompareOp::NEQ)) {
+        return compare_kernel(op, left, &right, active, Values<int32_t>{left_dict->codes.data()},
+                              Values<int32_t>{right_dict->codes.data()});
+    }
+    return with_string_reader(left, [&](auto l) {
+        return with_string_reader(right, [&](auto r) {
+            return compare_kernel(op, left, &right, active, l, r);
+        });
+    });
 }
 
 // ============================================================================
@@ -231,193 +504,210 @@ SelectionVector vec_neq_string(const Column& col, const std::string& value) {
 // ============================================================================
 // These create new columns with computed values
 // NULL propagation: NULL in any operand produces NULL in result
-
-// Helper: Apply binary operation to two values
-template <typename T>
-std::optional<T> apply_arith_op(VectorArithOp op, std::optional<T> left, std::optional<T> right) {
-    // NULL propagation
-    if (!left.has_value() || !right.has_value()) {
-        return std::nullopt;
-    }
-
-    T l = left.value();
-    T r = right.value();
-
+//   → result validity = left validity AND right validity (word at a time)
+// The value loop itself ignores NULLs (their slots hold 0)
+
+// Helper: Column op Column with NULL propagation through the validity bitmaps
+// get_left/get_right abstract over column and scalar operands
+template <typename T, typename LeftFn, typename RightFn>
+static Column arith_kernel(VectorArithOp op, size_t n, LeftFn get_left, RightFn get_right,
+                           const Bitmap* left_valid, const Bitmap* right_valid,
+                           ColumnType type) {
+    Column result = Column::make("", type);
+    auto& out = result.values<T>();
+    out.resize(n);
+
+    // Dispatch on op outside the loop so each loop body is a single operation
     switch (op) {
     case VectorArithOp::ADD:
-        return l + r;
+        for (size_t i = 0; i < n; ++i)
+            out[i] = get_left(i) + get_right(i);
+        break;
     case VectorArithOp::SUB:
-        return l - r;
+        for (size_t i = 0; i < n; ++i)
+            out[i] = get_left(i) - get_right(i);
+        break;
     case VectorArithOp::MUL:
-        return l * r;
+        for (size_t i = 0; i < n; ++i)
+            out[i] = get_left(i) * get_right(i);
+        break;
     case VectorArithOp::DIV:
-        // Division by zero returns NULL (SQL semantics)
-        if (r == 0) {
-            return std::nullopt;
+        // Zero divisors (including NULL slots) produce 0 and are marked NULL below
+        for (size_t i = 0; i < n; ++i) {
+            T r = get_right(i);
+            out[i] = r == 0 ? T{0} : divide(get_left(i), r);
         }
-        return l / r;
+        break;
     }
-    return std::nullopt;  // Unreachable
-}
 
-// Column op Column (INT64)
-Column vec_arith_int64(VectorArithOp op, const Column& left, const Column& right) {
-    const auto& left_data = std::get<std::vector<std::optional<int64_t>>>(left.data);
-    const auto& right_data = std::get<std::vector<std::optional<int64_t>>>(right.data);
-
-    Column result;
-    result.type = ColumnType::INT64;
-    result.data = std::vector<std::optional<int64_t>>();
-    auto& result_data = std::get<std::vector<std::optional<int64_t>>>(result.data);
-    result_data.reserve(left_data.size());
+    // Validity: AND of the operand bitmaps (scalars are never NULL)
+    result.validity.resize(n, true);
+    uint64_t* valid = result.validity.words();
+    for (size_t w = 0; w < result.validity.num_words(); ++w) {
+        uint64_t word = valid[w];
+        if (left_valid)
+            word &= left_valid->words()[w];
+        if (right_valid)
+            word &= right_valid->words()[w];
+        valid[w] = word;
+    }
 
-    for (size_t i = 0; i < left_data.size(); ++i) {
-        result_data.push_back(apply_arith_op(op, left_data[i], right_data[i]));
+    // Division by zero returns NULL (SQL semantics)
+    if (op == VectorArithOp::DIV) {
+        for (size_t i = 0; i < n; ++i) {
+            if (get_right(i) == 0)
+                result.validity.set(i, false);
+        }
     }
 
     return result;
 }
 
+// Column op Column (INT64)
+Column vec_arith_int64(VectorArithOp op, const Column& left, const Column& right) {
+    const int64_t* l = left.values<int64_t>().data();
+    const int64_t* r = right.values<int64_t>().data();
+    return arith_kernel<int64_t>(
+        op, left.size(), [l](size_t i) { return l[i]; }, [r](size_t i) { return r[i]; },
+        &left.validity, &right.validity, ColumnType::INT64);
+}
+
 // Column op Column (DOUBLE)
 Column vec_arith_double(VectorArithOp op, const Column& left, const Column& right) {
-    const auto& left_data = std::get<std::vector<std::optional<double>>>(left.data);
-    const auto& right_data = std::get<std::vector<std::optional<double>>>(right.data);
-
-    Column result;
-    result.type = ColumnType::DOUBLE;
-    result.data = std::vector<std::optional<double>>();
-    auto& result_data = std::get<std::vector<std::optional<double>>>(result.data);
-    result_data.reserve(left_data.size());
-
-    for (size_t i = 0; i < left_data.size(); ++i) {
-        result_data.push_back(apply_arith_op(op, left_data[i], right_data[i]));
-    }
-
-    return result;
+    const double* l = left.values<double>().data();
+    const double* r = right.values<double>().data();
+    return arith_kernel<double>(
+        op, left.size(), [l](size_t i) { return l[i]; }, [r](size_t i) { return r[i]; },
+        &left.validity, &right.validity, ColumnType::DOUBLE);
 }
 
 // Column op Scalar (INT64)
 Column vec_arith_int64_scalar(VectorArithOp op, const Column& col, int64_t scalar) {
-    const auto& col_data = std::get<std::vector<std::optional<int64_t>>>(col.data);
-
-    Column result;
-    result.type = ColumnType::INT64;
-    result.data = std::vector<std::optional<int64_t>>();
-    auto& result_data = std::get<std::vector<std::optional<int64_t>>>(result.data);
-    result_data.reserve(col_data.size());
-
-    for (size_t i = 0; i < col_data.size(); ++i) {
-        result_data.push_back(apply_arith_op(op, col_data[i], std::optional<int64_t>(scalar)));
-    }
-
-    return result;
+    const int64_t* c = col.values<int64_t>().data();
+    return arith_kernel<int64_t>(
+        op, col.size(), [c](size_t i) { return c[i]; }, [scalar](size_t) { return scalar; },
+        &col.validity, nullptr, ColumnType::INT64);
 }
 
 // Column op Scalar (DOUBLE)
 Column vec_arith_double_scalar(VectorArithOp op, const Column& col, double scalar) {
-    const auto& col_data = std::get<std::vector<std::optional<double>>>(col.data);
-
-    Column result;
-    result.type = ColumnType::DOUBLE;
-    result.data = std::vector<std::optional<double>>();
-    auto& result_data = std::get<std::vector<std::optional<double>>>(result.data);
-    result_data.reserve(col_data.size());
-
-    for (size_t i = 0; i < col_data.size(); ++i) {
-        result_data.push_back(apply_arith_op(op, col_data[i], std::optional<double>(scalar)));
-    }
-
-    return result;
+    const double* c = col.values<double>().data();
+    return arith_kernel<double>(
+        op, col.size(), [c](size_t i) { return c[i]; }, [scalar](size_t) { return scalar; },
+        &col.validity, nullptr, ColumnType::DOUBLE);
 }
 
 // Scalar op Column (INT64)
 Column vec_arith_scalar_int64(VectorArithOp op, int64_t scalar, const Column& col) {
-    const auto& col_data = std::get<std::vector<std::optional<int64_t>>>(col.data);
-
-    Column result;
-    result.type = ColumnType::INT64;
-    result.data = std::vector<std::optional<int64_t>>();
-    auto& result_data = std::get<std::vector<std::optional<int64_t>>>(result.data);
-    result_data.reserve(col_data.size());
-
-    for (size_t i = 0; i < col_data.size(); ++i) {
-        result_data.push_back(apply_arith_op(op, std::optional<int64_t>(scalar), col_data[i]));
-    }
-
-    return result;
+    const int64_t* c = col.values<int64_t>().data();
+    return arith_kernel<int64_t>(
+        op, col.size(), [scalar](size_t) { return scalar; }, [c](size_t i) { return c[i]; },
+        nullptr, &col.validity, ColumnType::INT64);
 }
 
 // Scalar op Column (DOUBLE)
 Column vec_arith_scalar_double(VectorArithOp op, double scalar, const Column& col) {
-    const auto& col_data = std::get<std::vector<std::optional<double>>>(col.data);
-
-    Column result;
-    result.type = ColumnType::DOUBLE;
-    result.data = std::vector<std::optional<double>>();
-    auto& result_data = std::get<std::vector<std::optional<double>>>(result.data);
-    result_data.reserve(col_data.size());
-
-    for (size_t i = 0; i < col_data.size(); ++i) {
-        result_data.push_back(apply_arith_op(op, std::optional<double>(scalar), col_data[i]));
-    }
-
-    return result;
+    const double* c = col.values<double>().data();
+    return arith_kernel<double>(
+        op, col.size(), [scalar](size_t) { return scalar; }, [c](size_t i) { return c[i]; },
+        nullptr, &col.validity, ColumnType::DOUBLE);
 }
 
 // ============================================================================
 // Vectorized Select/Blend Operations (for ternary)
 // ============================================================================
+// Values are blended element-wise; validity is blended word-wise:
+//   valid = (cond AND true_valid) OR (NOT cond AND false_valid)
+
+// Helper: Blend the validity bitmaps of the two branches
+static void blend_validity(const SelectionVector& condition, const Column& true_col,
+                           const Column& false_col, Column& result) {
+    result.validity.resize(condition.size());
+    const uint64_t* cond = condition.words();
+    const uint64_t* t = true_col.validity.words();
+    const uint64_t* f = false_col.validity.words();
+    uint64_t* out = result.validity.words();
+    for (size_t w = 0; w < result.validity.num_words(); ++w) {
+        out[w] = (cond[w] & t[w]) | (~cond[w] & f[w]);
+    }
+    result.validity.clear_tail();
+}
 
-Column vec_select_int64(const SelectionVector& condition, const Column& true_col,
-                        const Column& false_col) {
-    const auto& true_data = std::get<std::vector<std::optional<int64_t>>>(true_col.data);
-    const auto& false_data = std::get<std::vector<std::optional<int64_t>>>(false_col.data);
+ColumnType select_result_type(ColumnType type, ColumnType branch) {
+    if (type == ColumnType::STRING || branch == ColumnType::STRING)
+        return ColumnType::STRING;
+    if (type == ColumnType::DOUBLE || branch == ColumnType::DOUBLE)
+        return ColumnType::DOUBLE;
+    return type;
+}
 
-    Column result;
-    result.type = ColumnType::INT64;
-    result.data = std::vector<std::optional<int64_t>>();
-    auto& result_data = std::get<std::vector<std::optional<int64_t>>>(result.data);
+template <typename T>
+static Column select_kernel(const SelectionVector& condition, const Column& true_col,
+                            const Column& false_col, ColumnType type) {
+    const auto& true_data = true_col.values<T>();
+    const auto& false_data = false_col.values<T>();
+
+    Column result = Column::make("", type);
+    auto& result_data = result.values<T>();
     result_data.reserve(condition.size());
 
     for (size_t i = 0; i < condition.size(); ++i) {
         result_data.push_back(condition[i] ? true_data[i] : false_data[i]);
     }
+    blend_validity(condition, true_col, false_col, result);
 
     return result;
 }
 
+Column vec_select_int64(const SelectionVector& condition, const Column& true_col,
+                        const Column& false_col) {
+    return select_kernel<int64_t>(condition, true_col, false_col, ColumnType::INT64);
+}
+
 Column vec_select_double(const SelectionVector& condition, const Column& true_col,
                          const Column& false_col) {
-    const auto& true_data = std::get<std::vector<std::optional<double>>>(true_col.data);
-    const auto& false_data = std::get<std::vector<std::optional<double>>>(false_col.data);
-
-    Column result;
-    result.type = ColumnType::DOUBLE;
-    result.data = std::vector<std::optional<double>>();
-    auto& result_data = std::get<std::vector<std::optional<double>>>(result.data);
-    result_data.reserve(condition.size());
-
-    for (size_t i = 0; i < condition.size(); ++i) {
-        result_data.push_back(condition[i] ? true_data[i] : false_data[i]);
-    }
-
-    return result;
+    return select_kernel<double>(condition, true_col, false_col, ColumnType::DOUBLE);
 }
 
+// Strings: two dictionary columns blend codes into a merged dictionary (the
+// false side's values are interned once each); otherwise values are copied
+// into an arena. NULL slots contribute an empty value
 Column vec_select_string(const SelectionVector& condition, const Column& true_col,
                          const Column& false_col) {
-    const auto& true_data = std::get<std::vector<std::optional<std::string>>>(true_col.data);
-    const auto& false_data = std::get<std::vector<std::optional<std::string>>>(false_col.data);
+    const auto* true_dict = std::get_if<DictStrings>(&true_col.data);
+    const auto* false_dict = std::get_if<DictStrings>(&false_col.data);
 
     Column result;
-    result.type = ColumnType::STRING;
-    result.data = std::vector<std::optional<std::string>>();
-    auto& result_data = std::get<std::vector<std::optional<std::string>>>(result.data);
-    result_data.reserve(condition.size());
-
-    for (size_t i = 0; i < condition.size(); ++i) {
-        result_data.push_back(condition[i] ? true_data[i] : false_data[i]);
+    if (true_dict && false_dict) {
+        result = Column::make_like(true_col);
+        result.name.clear();
+        auto& out = std::get<DictStrings>(result.data);
+        std::vector<int32_t> false_codes(std::max<size_t>(false_dict->dict->size(), 1), 0);
+        if (false_dict->dict != true_dict->dict) {
+            out.dict = std::make_shared<StringDictionary>(*true_dict->dict);
+            for (size_t code = 0; code < false_dict->dict->size(); ++code) {
+                false_codes[code] =
+                    out.dict->intern(false_dict->dict->get(static_cast<int32_t>(code)));
+            }
+        } else {
+            for (size_t code = 0; code < false_codes.size(); ++code)
+                false_codes[code] = static_cast<int32_t>(code);
+        }
+        out.codes.reserve(condition.size());
+        for (size_t i = 0; i < condition.size(); ++i) {
+            out.codes.push_back(condition[i] ? true_dict->codes[i]
+                                             : false_codes[false_dict->codes[i]]);
+        }
+    } else {
+        result = Column::make("", ColumnType::STRING);
+        auto& out = std::get<StringArena>(result.data);
+        out.reserve(condition.size());
+        for (size_t i = 0; i < condition.size(); ++i) {
+            const Column& src = condition[i] ? true_col : false_col;
+            out.push_back(src.is_null(i) ? std::string_view{} : src.get_string(i));
+        }
     }
+    blend_validity(condition, true_col, false_col, result);
 
     return result;
 }
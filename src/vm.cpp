@@ -1,8 +1,18 @@
 #include "vm.hpp"
 
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <functional>
 #include <iostream>
+#include <limits>
+#include <optional>
 #include <variant>
 
+#include "batch_interpreter.hpp"
+#include "binder.hpp"
+#include "file_format.hpp"
+#include "multi_file.hpp"
 #include "vectorized_ops.hpp"
 
 namespace joy {
@@ -36,7 +46,7 @@ bool Value::is_double() const {
 }
 
 bool Value::is_string() const {
-    return std::holds_alternative<std::string>(data);
+    return std::holds_alternative<std::string_view>(data);
 }
 
 bool Value::is_bool() const {
@@ -55,8 +65,8 @@ double Value::as_double() const {
     return std::get<double>(data);
 }
 
-const std::string& Value::as_string() const {
-    return std::get<std::string>(data);
+std::string_view Value::as_string() const {
+    return std::get<std::string_view>(data);
 }
 
 bool Value::as_bool() const {
@@ -78,8 +88,8 @@ Value Value::make_double(double val) {
     return Value{val};
 }
 
-Value Value::make_string(std::string val) {
-    return Value{std::move(val)};  // Move to avoid copy
+Value Value::make_string(std::string_view val) {
+    return Value{val};  // A view: the caller keeps the bytes alive
 }
 
 Value Value::make_bool(bool val) {
@@ -89,58 +99,614 @@ Value Value::make_bool(bool val) {
 // ============================================================================
 // VM Implementation - The Execution Engine
 // ============================================================================
-// The VM executes a pipeline of physical operators sequentially
-// Each operator transforms current_table_ and passes it to the next operator
+// The VM executes a pipeline of physical operators
+// The SCAN operator produces the input as a stream of fixed-size row batches;
+// every other operator transforms current_table_ (the current batch) and
+// passes it to the next operator
 // This is a "pipeline" execution model (like Unix pipes)
 //
-// Execution flow:
-//   SCAN → loads data into current_table_
-//   FILTER → evaluates predicate, keeps matching rows
-//   PROJECT → selects subset of columns
-//   WRITE → outputs current_table_ to file
+// Execution flow (repeated for every batch):
+//   SCAN → loads next batch into current_table_
+//   FILTER → evaluates predicate, narrows the selection vector (no copies)
+//   PROJECT → selects subset of columns (copying only selected rows)
+//   WRITE → appends current_table_ to file
+//
+// Late materialization: chained filters only AND bits into selection_, and
+// each later filter skips rows that are already rejected. Rows are gathered
+// once, when PROJECT, TRANSFORM or WRITE needs physical data
+//
+// Peak memory therefore depends on the batch size rather than the file size,
+// and output is produced before the input has been fully read
 
-// Main execution entry point
-// Executes operators sequentially - each operator modifies current_table_
-// Pipeline model: data flows through operators like water through pipes
-void VM::execute(const ExecutionPlan& plan) {
+// Helper: Operators that keep every batch and produce their output at the end
+static bool is_pipeline_breaker(const PhysicalOp& op) {
+    return std::holds_alternative<PhysicalOp::AggregateOp>(op.data) ||
+           std::holds_alternative<PhysicalOp::SortOp>(op.data);
+}
+
+// Helper: End of the streaming operators after the scan, which only look at
+// their own batch and can run on any thread (filters, projections, transforms)
+// Sinks, limits, joins and pipeline breakers need the batches in input order
+static size_t streaming_end(const ExecutionPlan& plan) {
+    size_t end = 1;
+    while (end < plan.operators.size()) {
+        const auto& data = plan.operators[end].data;
+        if (!std::holds_alternative<PhysicalOp::FilterOp>(data) &&
+            !std::holds_alternative<PhysicalOp::VectorizedFilterOp>(data) &&
+            !std::holds_alternative<PhysicalOp::LogicalFilterOp>(data) &&
+            !std::holds_alternative<PhysicalOp::ProjectOp>(data) &&
+            !std::holds_alternative<PhysicalOp::TransformOp>(data) &&
+            !std::holds_alternative<PhysicalOp::VectorizedTransformOp>(data) &&
+            !std::holds_alternative<PhysicalOp::VectorizedTernaryTransformOp>(data)) {
+            break;
+        }
+        ++end;
+    }
+    return end;
+}
+
+// Helper: First limit of the stage starting at begin (nullptr if none)
+// Once it has passed its rows, the rest of the stage's input can be skipped
+static const PhysicalOp::LimitOp* stage_limit(const ExecutionPlan& plan, size_t begin) {
+    for (size_t i = begin; i < plan.operators.size(); ++i) {
+        if (const auto* limit = std::get_if<PhysicalOp::LimitOp>(&plan.operators[i].data))
+            return limit;
+        if (is_pipeline_breaker(plan.operators[i]))
+            break;
+    }
+    return nullptr;
+}
+
+// Helper: The column-vs-literal comparisons every row must pass, from the
+// filters directly after the scan (a reader may skip blocks of rows where one
+// of them matches nothing)
+static std::vector<PhysicalOp::VectorizedFilterOp> scan_predicates(const ExecutionPlan& plan) {
+    std::vector<PhysicalOp::VectorizedFilterOp> predicates;
+    for (size_t i = 1; i < plan.operators.size(); ++i) {
+        const auto& data = plan.operators[i].data;
+        if (const auto* filter = std::get_if<PhysicalOp::VectorizedFilterOp>(&data)) {
+            if (!filter->is_right_column)
+                predicates.push_back(*filter);
+        } else if (const auto* logical = std::get_if<PhysicalOp::LogicalFilterOp>(&data)) {
+            if (logical->root.kind != PhysicalOp::FilterNode::Kind::AND)
+                continue;
+            for (const auto& child : logical->root.children) {
+                if (child.kind == PhysicalOp::FilterNode::Kind::COMPARE &&
+                    !child.compare.is_right_column)
+                    predicates.push_back(child.compare);
+            }
+        } else if (!std::holds_alternative<PhysicalOp::FilterOp>(data)) {
+            break;  // Later operators may redefine the columns
+        }
+    }
+    return predicates;
+}
+
+// Helper: Throw unless every operator handles each row on its own and once,
+// so the output of an incremental run can be appended to the earlier output
+static void check_incremental(const ExecutionPlan& plan) {
     for (const auto& op : plan.operators) {
-        // Pattern match on operator type and dispatch to appropriate handler
-        std::visit(
-            [this](const auto& op_data) {
-                using T = std::decay_t<decltype(op_data)>;
-
-                if constexpr (std::is_same_v<T, PhysicalOp::ScanOp>) {
-                    execute_scan(op_data);
-                } else if constexpr (std::is_same_v<T, PhysicalOp::FilterOp>) {
-                    execute_filter(op_data);
-                } else if constexpr (std::is_same_v<T, PhysicalOp::VectorizedFilterOp>) {
-                    execute_vectorized_filter(op_data);
-                } else if constexpr (std::is_same_v<T, PhysicalOp::ProjectOp>) {
-                    execute_project(op_data);
-                } else if constexpr (std::is_same_v<T, PhysicalOp::TransformOp>) {
-                    execute_transform(op_data);
-                } else if constexpr (std::is_same_v<T, PhysicalOp::VectorizedTransformOp>) {
-                    execute_vectorized_transform(op_data);
-                } else if constexpr (std::is_same_v<T, PhysicalOp::VectorizedTernaryTransformOp>) {
-                    execute_vectorized_ternary_transform(op_data);
-                } else if constexpr (std::is_same_v<T, PhysicalOp::WriteOp>) {
-                    execute_write(op_data);
-                }
-            },
-            op.data);
+        if (is_pipeline_breaker(op) || std::holds_alternative<PhysicalOp::LimitOp>(op.data)) {
+            throw RuntimeError(std::string("Incremental runs cannot use ") + operator_name(op) +
+                               " (it needs all rows, not just the new ones)");
+        }
+    }
+}
+
+// Helper: A writer owned by the caller (see ExecutionIO::outputs)
+class BorrowedWriter : public BatchWriter {
+public:
+    explicit BorrowedWriter(BatchWriter& writer) : writer_(writer) {}
+
+    void write(const Table& batch) override {
+        writer_.write(batch);
+    }
+    void close() override {
+        writer_.close();
+    }
+
+private:
+    BatchWriter& writer_;
+};
+
+// Helper: Throw unless every output the caller supplies replaces a WRITE
+static void check_outputs(const ExecutionPlan& plan, const ExecutionIO& io) {
+    for (const auto& [filepath, writer] : io.outputs) {
+        bool found = std::any_of(plan.operators.begin(), plan.operators.end(), [&](const auto& op) {
+            const auto* write = std::get_if<PhysicalOp::WriteOp>(&op.data);
+            return write && write->filepath == filepath;
+        });
+        if (!found) {
+            throw RuntimeError("The pipeline does not write \"" + filepath + "\"");
+        }
+    }
+}
+
+void VM::execute(const ExecutionPlan& plan, const ExecutionIO& io) {
+    execute_plan(plan, io, nullptr);
+}
+
+void VM::execute(const std::shared_ptr<const ExecutionPlan>& plan, const ExecutionIO& io) {
+    execute_plan(*plan, io, plan);
+}
+
+// Main execution entry point
+// Pulls batches from the SCAN at the head of the plan and runs the remaining
+// operators on each batch in order
+// reused: plan itself when the caller runs it repeatedly (see execute)
+void VM::execute_plan(const ExecutionPlan& plan, const ExecutionIO& io,
+                      const std::shared_ptr<const ExecutionPlan>& reused) {
+    if (plan.operators.empty()) {
+        return;
+    }
+
+    const auto* scan = std::get_if<PhysicalOp::ScanOp>(&plan.operators.front().data);
+    if (!scan) {
+        throw RuntimeError("Pipeline must start with a scan");
+    }
+    check_outputs(plan, io);
+    if (!options_.checkpoint.empty() && (io.input || !io.outputs.empty())) {
+        throw RuntimeError("Incremental runs read and write files, not caller-supplied data");
+    }
+
+    // Reset per-execution state (a VM may execute several plans)
+    const auto started = std::chrono::steady_clock::now();
+    profile_ = ExecutionProfile{};
+    if (options_.analyze) {
+        HeapStats::enable(true);
+        heap_base_ = HeapStats::in_use();
+        for (const auto& op : plan.operators)
+            profile_.operators.push_back({operator_name(op), describe_operator(op)});
+    }
+    const uint64_t allocated_before = HeapStats::allocated();
+    writers_.clear();
+    aggregates_.clear();
+    joins_.clear();
+    sorts_.clear();
+    limits_.clear();
+    checkpoint_.reset();
+    if (io.input) {
+        reader_ = io.input(*scan, pool_.get());
+    } else if (options_.checkpoint.empty()) {
+        execute_scan(*scan, scan_predicates(plan));
+    } else {
+        check_incremental(plan);
+        resume_scan(*scan, scan_predicates(plan));
+    }
+
+    // Joined files are read and indexed up front (the binder needs their schemas)
+    std::vector<std::unique_ptr<HashJoin>> joins;
+    std::vector<Schema> join_inputs;
+    for (size_t i = 0; i < plan.operators.size(); ++i) {
+        if (const auto* join = std::get_if<PhysicalOp::JoinOp>(&plan.operators[i].data)) {
+            const ProfileMark mark = profile_start();
+            joins.push_back(std::make_unique<HashJoin>(*join, pool_.get()));
+            profile_stop(i, mark, 0, 0, false);
+            const Table& build = joins.back()->build_table();
+            Schema build_schema;
+            for (size_t i = 0; i < build.columns.size(); ++i) {
+                build_schema.names.push_back(build.columns[i].name);
+                build_schema.types.push_back(
+                    joins.back()->inferred_types()[i]
+                        ? std::optional<ColumnType>(build.columns[i].type)
+                        : std::nullopt);
+            }
+            join_inputs.push_back(std::move(build_schema));
+        }
+    }
+
+    // Bind the plan to the input schema: column references become indices,
+    // opcodes become typed, and type errors surface before any row is read
+    Schema schema;
+    schema.names = reader_->column_names();
+    for (size_t i = 0; i < schema.names.size(); ++i) {
+        schema.types.push_back(reader_->inferred_types()[i]
+                                   ? std::optional<ColumnType>(reader_->column_types()[i])
+                                   : std::nullopt);
+    }
+    // A plan that is run repeatedly keeps its bound form while the schema
+    // does (JIT kernels are keyed by the bound plan's expressions, so they
+    // only survive with it)
+    const bool has_join = !joins.empty();
+    if (!reused || has_join || bound_source_ != reused || bound_names_ != schema.names ||
+        bound_types_ != schema.types) {
+        jit_kernels_.clear();
+        bound_source_.reset();
+        bound_names_ = schema.names;
+        bound_types_ = schema.types;
+        bound_ = Binder().bind(plan, std::move(schema), std::move(join_inputs));
+        bound_source_ = has_join ? nullptr : reused;
+    }
+    const ExecutionPlan& bound = bound_;
+    size_t next_join = 0;
+    for (const auto& op : bound.operators) {
+        if (const auto* join = std::get_if<PhysicalOp::JoinOp>(&op.data)) {
+            joins_[join] = std::move(joins[next_join++]);
+        }
+    }
+    if (checkpoint_) {
+        resume_writers(bound);
+    }
+    for (const auto& op : bound.operators) {
+        const auto* write = std::get_if<PhysicalOp::WriteOp>(&op.data);
+        auto it = write ? io.outputs.find(write->filepath) : io.outputs.end();
+        if (it != io.outputs.end()) {
+            writers_[write] = std::make_unique<BorrowedWriter>(*it->second);
+        }
+    }
+
+    // Pipeline breakers (AGGREGATE, SORT) split the plan into stages: every
+    // scan batch runs up to the first breaker, which absorbs it; once the input
+    // is exhausted each breaker's result flows through the next stage in turn
+    // A stage stops pulling input once its limit (if any) has passed its rows
+    auto limit_reached = [this](const PhysicalOp::LimitOp* limit) {
+        return limit && limits_.count(limit) && limits_.at(limit) == 0;
+    };
+    const PhysicalOp::LimitOp* scan_limit = stage_limit(bound, 1);
+    const size_t parallel_end = streaming_end(bound);
+    if (pool_->size() > 1 && parallel_end > 1) {
+        execute_morsels(bound, parallel_end, [&] { return limit_reached(scan_limit); });
+    } else {
+        while (!limit_reached(scan_limit)) {
+            const ProfileMark mark = profile_start();
+            if (!next_batch())
+                break;
+            profile_stop(0, mark, 0, current_table_.num_rows);
+            run_pipeline(bound, 1);
+        }
+    }
+    if (checkpoint_) {
+        checkpoint_->offset = static_cast<CsvReader&>(*reader_).offset();
+    }
+    reader_.reset();
+
+    const size_t max_rows =
+        options_.batch_size == 0 ? std::numeric_limits<size_t>::max() : options_.batch_size;
+    for (size_t i = 1; i < bound.operators.size(); ++i) {
+        const auto& data = bound.operators[i].data;
+        if (const auto* agg = std::get_if<PhysicalOp::AggregateOp>(&data)) {
+            const ProfileMark mark = profile_start();
+            current_table_ = aggregates_.at(agg)->finish();
+            profile_stop(i, mark, 0, current_table_.num_rows, false);
+            selection_.reset();
+            aggregates_.erase(agg);
+            run_pipeline(bound, i + 1);
+        } else if (const auto* sort = std::get_if<PhysicalOp::SortOp>(&data)) {
+            Sorter& sorter = *sorts_.at(sort);
+            const PhysicalOp::LimitOp* limit = stage_limit(bound, i + 1);
+            bool more;
+            do {
+                const ProfileMark mark = profile_start();
+                more = sorter.next_batch(current_table_, max_rows, pool_.get());
+                profile_stop(i, mark, 0, current_table_.num_rows, false);
+                selection_.reset();
+                run_pipeline(bound, i + 1);
+            } while (more && !limit_reached(limit));
+            sorts_.erase(sort);
+        }
+    }
+
+    aggregates_.clear();
+    joins_.clear();
+    sorts_.clear();
+    for (auto& [op, writer] : writers_) {
+        writer->close();  // Flushes output files (.joyc writes its footer)
+    }
+    writers_.clear();
+
+    // Saved only once the output is complete: a run that fails before this
+    // point is repeated in full by the next one
+    if (checkpoint_) {
+        checkpoint_->outputs.clear();
+        for (const auto& op : bound.operators) {
+            if (const auto* write = std::get_if<PhysicalOp::WriteOp>(&op.data)) {
+                checkpoint_->outputs.emplace_back(write->filepath,
+                                                  std::filesystem::file_size(write->filepath));
+            }
+        }
+        save_checkpoint(options_.checkpoint, *checkpoint_);
+    }
+
+    if (options_.analyze) {
+        HeapStats::enable(false);
+        profile_.seconds =
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+        profile_.bytes_allocated = HeapStats::allocated() - allocated_before;
+        for (const auto& op : profile_.operators)
+            profile_.peak_bytes = std::max(profile_.peak_bytes, op.peak_bytes);
+    }
+}
+
+void VM::run_pipeline(const ExecutionPlan& plan, size_t begin, size_t end) {
+    end = std::min(end, plan.operators.size());
+    for (size_t i = begin; i < end; ++i) {
+        const PhysicalOp& op = plan.operators[i];
+        if (const auto* join = std::get_if<PhysicalOp::JoinOp>(&op.data)) {
+            execute_join(*join, plan, i);  // Runs the rest of the pipeline itself
+            return;
+        }
+        const ProfileMark mark = profile_start();
+        const uint64_t rows_in = options_.analyze ? selected_rows() : 0;
+        execute_op(op);
+        if (options_.analyze) {
+            profile_stop(i, mark, rows_in, is_pipeline_breaker(op) ? 0 : selected_rows());
+        }
+        if (is_pipeline_breaker(op)) {
+            return;
+        }
     }
 }
 
+// Morsels per worker in each round: enough for stealing to even out morsels
+// that filter very differently, few enough to bound the rows held in memory
+constexpr size_t kMorselsPerWorker = 2;
+
+// Morsel-driven scan stage, in rounds:
+//   1. Read a round of batches (morsels) from the scan (the reader itself
+//      decodes on the pool)
+//   2. Workers run operators [1, end) on the morsels, stealing from each
+//      other when their own morsels run out; each keeps its selection
+//   3. The rest of the pipeline consumes the results in input order on this
+//      thread, so WRITE output, LIMIT and the breakers' first-row order match
+//      a single-threaded run (breakers parallelize internally)
+void VM::execute_morsels(const ExecutionPlan& plan, size_t end,
+                         const std::function<bool()>& limit_reached) {
+    while (workers_.size() < pool_->size()) {
+        workers_.push_back(std::unique_ptr<VM>(new VM(this)));
+    }
+    for (auto& worker : workers_) {
+        worker->profile_.operators = profile_.operators;  // Names only; counts are zero
+        worker->heap_base_ = heap_base_;
+    }
+
+    const size_t round = kMorselsPerWorker * workers_.size();
+    std::vector<Table> morsels(round);
+    std::vector<std::optional<SelectionVector>> selections(round);
+    bool more = true;
+    while (more && !limit_reached()) {
+        size_t count = 0;
+        while (count < round) {
+            const ProfileMark mark = profile_start();
+            more = next_batch();
+            if (!more)
+                break;
+            profile_stop(0, mark, 0, current_table_.num_rows);
+            morsels[count++] = std::move(current_table_);
+        }
+
+        pool_->parallel_for_stealing(count, [&](size_t w, size_t i) {
+            VM& worker = *workers_[w];
+            worker.current_table_ = std::move(morsels[i]);
+            worker.selection_.reset();
+            worker.run_pipeline(plan, 1, end);
+            morsels[i] = std::move(worker.current_table_);
+            selections[i] = std::move(worker.selection_);
+        });
+
+        for (size_t i = 0; i < count && !limit_reached(); ++i) {
+            current_table_ = std::move(morsels[i]);
+            selection_ = std::move(selections[i]);
+            run_pipeline(plan, end);
+        }
+    }
+
+    // Worker time is CPU time summed over threads
+    for (auto& worker : workers_) {
+        for (size_t i = 0; i < worker->profile_.operators.size(); ++i) {
+            OperatorProfile& to = profile_.operators[i];
+            const OperatorProfile& from = worker->profile_.operators[i];
+            to.seconds += from.seconds;
+            to.batches += from.batches;
+            to.rows_in += from.rows_in;
+            to.rows_out += from.rows_out;
+            to.bytes_allocated += from.bytes_allocated;
+            to.peak_bytes = std::max(to.peak_bytes, from.peak_bytes);
+        }
+        worker->profile_ = ExecutionProfile{};
+        worker->current_table_ = Table{};
+        worker->selection_.reset();
+    }
+}
+
+VM::ProfileMark VM::profile_start() const {
+    if (!options_.analyze) {
+        return {};
+    }
+    if (parent_) {
+        HeapStats::reset_thread_peak();
+        return {std::chrono::steady_clock::now(), HeapStats::thread_allocated(),
+                HeapStats::in_use(), HeapStats::thread_in_use()};
+    }
+    HeapStats::reset_peak();
+    return {std::chrono::steady_clock::now(), HeapStats::allocated(), HeapStats::in_use()};
+}
+
+// Heap figures: the main VM runs one operator at a time (any pool tasks it
+// starts work for that operator), so the process counters are its own.
+// Workers run operators concurrently and count on their own thread: the
+// bytes they allocate, and a peak of the heap in use when the operator
+// started plus the most this thread held on top of that
+
+void VM::profile_stop(size_t index, const ProfileMark& mark, uint64_t rows_in, uint64_t rows_out,
+                      bool count_batch) {
+    if (!options_.analyze) {
+        return;
+    }
+    OperatorProfile& op = profile_.operators[index];
+    const auto elapsed = std::chrono::steady_clock::now() - mark.start;
+    op.seconds += std::chrono::duration<double>(elapsed).count();
+    op.batches += count_batch ? 1 : 0;
+    op.rows_in += rows_in;
+    op.rows_out += rows_out;
+    int64_t peak;
+    if (parent_) {
+        op.bytes_allocated += HeapStats::thread_allocated() - mark.allocated;
+        peak = mark.in_use + (HeapStats::thread_peak() - mark.thread_in_use) - heap_base_;
+    } else {
+        op.bytes_allocated += HeapStats::allocated() - mark.allocated;
+        peak = HeapStats::peak() - heap_base_;
+    }
+    peak = std::max<int64_t>(0, peak);
+    op.peak_bytes = std::max(op.peak_bytes, static_cast<uint64_t>(peak));
+}
+
+size_t VM::selected_rows() const {
+    return selection_ ? selection_->count() : current_table_.num_rows;
+}
+
+// Run a single operator on the current batch
+void VM::execute_op(const PhysicalOp& op) {
+    // Pattern match on operator type and dispatch to appropriate handler
+    std::visit(
+        [this](const auto& op_data) {
+            using T = std::decay_t<decltype(op_data)>;
+
+            if constexpr (std::is_same_v<T, PhysicalOp::ScanOp>) {
+                throw RuntimeError("Scan is only supported at the start of a pipeline");
+            } else if constexpr (std::is_same_v<T, PhysicalOp::FilterOp>) {
+                execute_filter(op_data);
+            } else if constexpr (std::is_same_v<T, PhysicalOp::VectorizedFilterOp>) {
+                execute_vectorized_filter(op_data);
+            } else if constexpr (std::is_same_v<T, PhysicalOp::LogicalFilterOp>) {
+                execute_logical_filter(op_data);
+            } else if constexpr (std::is_same_v<T, PhysicalOp::ProjectOp>) {
+                execute_project(op_data);
+            } else if constexpr (std::is_same_v<T, PhysicalOp::TransformOp>) {
+                execute_transform(op_data);
+            } else if constexpr (std::is_same_v<T, PhysicalOp::VectorizedTransformOp>) {
+                execute_vectorized_transform(op_data);
+            } else if constexpr (std::is_same_v<T, PhysicalOp::VectorizedTernaryTransformOp>) {
+                execute_vectorized_ternary_transform(op_data);
+            } else if constexpr (std::is_same_v<T, PhysicalOp::AggregateOp>) {
+                execute_aggregate(op_data);
+            } else if constexpr (std::is_same_v<T, PhysicalOp::JoinOp>) {
+                throw RuntimeError("Join must run through run_pipeline");
+            } else if constexpr (std::is_same_v<T, PhysicalOp::SortOp>) {
+                execute_sort(op_data);
+            } else if constexpr (std::is_same_v<T, PhysicalOp::LimitOp>) {
+                execute_limit(op_data);
+            } else if constexpr (std::is_same_v<T, PhysicalOp::WriteOp>) {
+                execute_write(op_data);
+            }
+        },
+        op.data);
+}
+
 // ============================================================================
 // Physical Operator Implementations
 // ============================================================================
 // Each operator takes current_table_ as input and produces new current_table_
 
-// SCAN operator: Load CSV file into current_table_
+// SCAN operator: Open the input file(s) (CSV, .joyc, Parquet or Arrow) as a batch stream
+// The reader decodes several batches' worth of rows at once on the thread pool
 // This is the data source - first operator in every pipeline
 // Example: from "employees.csv"
-void VM::execute_scan(const PhysicalOp::ScanOp& op) {
-    current_table_ = read_csv(op.filepath);
+void VM::execute_scan(const PhysicalOp::ScanOp& op,
+                      const std::vector<PhysicalOp::VectorizedFilterOp>& predicates) {
+    reader_ = open_scan(op.filepaths, pool_.get(), op.columns ? &*op.columns : nullptr,
+                        &predicates, op.schema.empty() ? nullptr : &op.schema);
+}
+
+// Incremental runs read one uncompressed CSV file from the checkpoint's offset
+// up to its last complete line, parsing the columns as the first run did
+void VM::resume_scan(const PhysicalOp::ScanOp& op,
+                     const std::vector<PhysicalOp::VectorizedFilterOp>& predicates) {
+    auto files = op.filepaths.size() == 1 ? expand_glob(op.filepaths.front())
+                                          : std::vector<std::string>{};
+    if (files.size() != 1 || compression_of(files.front()) != Compression::NONE) {
+        throw RuntimeError("Incremental runs read a single uncompressed CSV file");
+    }
+    const std::string& filepath = files.front();
+    checkpoint_ = load_checkpoint(options_.checkpoint);
+    if (checkpoint_ && checkpoint_->filepath != filepath) {
+        throw RuntimeError("Checkpoint " + options_.checkpoint + " is for " +
+                           checkpoint_->filepath + ", not " + filepath);
+    }
+    std::string header;
+    std::ifstream file(filepath, std::ios::binary);
+    std::getline(file, header);
+    if (checkpoint_ && file && header != checkpoint_->header) {
+        throw RuntimeError("The header of " + filepath + " changed since checkpoint " +
+                           options_.checkpoint + " was saved");
+    }
+
+    // Declared types take precedence over the checkpointed ones
+    std::vector<DeclaredColumn> schema = op.schema;
+    if (checkpoint_) {
+        for (const auto& saved : checkpoint_->schema) {
+            auto declared = [&](const DeclaredColumn& d) { return d.name == saved.name; };
+            if (std::none_of(op.schema.begin(), op.schema.end(), declared))
+                schema.push_back(saved);
+        }
+    }
+    reader_ = open_reader(filepath, pool_.get(), op.columns ? &*op.columns : nullptr,
+                          &predicates, schema.empty() ? nullptr : &schema);
+    auto* csv = dynamic_cast<CsvReader*>(reader_.get());
+    if (!csv) {
+        throw RuntimeError("Incremental runs read a single uncompressed CSV file");
+    }
+
+    if (!checkpoint_) {
+        checkpoint_ = ScanCheckpoint{};
+        checkpoint_->filepath = filepath;
+        checkpoint_->header = header;
+    }
+    csv->resume(checkpoint_->offset);
+
+    // Remember the types of the columns read this time for the next run
+    const auto& names = csv->column_names();
+    std::vector<DeclaredColumn> types;
+    for (const auto& saved : checkpoint_->schema) {
+        if (std::find(names.begin(), names.end(), saved.name) == names.end())
+            types.push_back(saved);
+    }
+    for (size_t i = 0; i < names.size(); ++i) {
+        if (csv->inferred_types()[i])
+            types.push_back({names[i], csv->column_types()[i]});
+    }
+    checkpoint_->schema = std::move(types);
+}
+
+// Outputs the checkpoint does not know are started over; the others lose
+// anything a failed run appended after the checkpoint was saved
+void VM::resume_writers(const ExecutionPlan& plan) {
+    for (const auto& op : plan.operators) {
+        const auto* write = std::get_if<PhysicalOp::WriteOp>(&op.data);
+        if (!write)
+            continue;
+        uint64_t saved = 0;
+        for (const auto& [filepath, bytes] : checkpoint_->outputs) {
+            if (filepath == write->filepath)
+                saved = bytes;
+        }
+        std::error_code ec;
+        auto size = std::filesystem::file_size(write->filepath, ec);
+        if (!ec && size > saved) {
+            std::filesystem::resize_file(write->filepath, saved);
+        }
+        writers_[write] = open_writer(write->filepath, pool_.get(), true);
+    }
+}
+
+// Load the next batch from the scan into current_table_
+// Returns false when the input is exhausted
+bool VM::next_batch() {
+    size_t max_rows =
+        options_.batch_size == 0 ? std::numeric_limits<size_t>::max() : options_.batch_size;
+    selection_.reset();  // A fresh batch starts with every row selected
+    return reader_->next_batch(current_table_, max_rows);
+}
+
+// Gather the selected rows into current_table_ and drop the selection
+// A selection that kept every row is dropped without copying
+void VM::materialize() {
+    if (!selection_) {
+        return;
+    }
+    if (selection_->count() != current_table_.num_rows) {
+        current_table_ = current_table_.gather(*selection_);
+    }
+    selection_.reset();
 }
 
 // FILTER operator: Keep only rows where predicate evaluates to true
@@ -148,334 +714,290 @@ void VM::execute_scan(const PhysicalOp::ScanOp& op) {
 // Example: filter age > 30
 //
 // Strategy:
-//   1. Create empty result table with same column structure
-//   2. For each row in input:
+//   1. For each row still selected by earlier filters:
 //      a. Evaluate predicate bytecode for this row
-//      b. If true, copy row to result
-//   3. Replace current_table_ with result
+//      b. If true, set the row's bit in the result selection
+//   2. Replace selection_ with the result (rows are gathered later)
 void VM::execute_filter(const PhysicalOp::FilterOp& op) {
-    Table result;
+    // Narrow the selection (rows are not copied here)
+    selection_ = filter_predicate(op.predicate, selection_ ? &*selection_ : nullptr);
+}
 
-    // Step 1: Create result table with same column schema (but empty data)
-    // Result columns support NULL values (std::optional)
-    for (const auto& col : current_table_.columns) {
-        Column new_col;
-        new_col.name = col.name;
-        new_col.type = col.type;
+// Rows of active (nullptr = all rows) for which predicate is true
+SelectionVector VM::filter_predicate(const IRExpr& predicate, const SelectionVector* active) {
+    SelectionVector result(current_table_.num_rows);
+
+    // Native kernel for hot expressions, else the batch interpreter
+    const JitKernel* kernel = jit_kernel(predicate);
+    BatchInterpreter batch(predicate, current_table_);
+    const bool supported = kernel || batch.supported();
+    const ColumnType type = kernel ? kernel->result_type() : batch.result_type();
+    if (supported && (type == ColumnType::BOOL || type == ColumnType::INT64)) {
+        // Vector-at-a-time: evaluate chunks of rows, skipping chunks in
+        // which every row was already rejected
+        std::vector<uint8_t> live_rows(kEvalBatchSize);
+        for (size_t begin = 0; begin < current_table_.num_rows; begin += kEvalBatchSize) {
+            size_t n = std::min(kEvalBatchSize, current_table_.num_rows - begin);
+            const uint8_t* live = nullptr;
+            if (active) {
+                bool any = false;
+                for (size_t i = 0; i < n; ++i) {
+                    live_rows[i] = active->get(begin + i);
+                    any |= live_rows[i] != 0;
+                }
+                if (!any)
+                    continue;
+                live = live_rows.data();
+            }
 
-        // Initialize empty vector of the appropriate optional type
-        // We don't know final size yet, so start empty
-        switch (col.type) {
-        case ColumnType::INT64:
-            new_col.data = std::vector<std::optional<int64_t>>{};
-            break;
-        case ColumnType::DOUBLE:
-            new_col.data = std::vector<std::optional<double>>{};
-            break;
-        case ColumnType::STRING:
-            new_col.data = std::vector<std::optional<std::string>>{};
-            break;
-        case ColumnType::BOOL:
-            new_col.data = std::vector<std::optional<bool>>{};
-            break;
+            // NULL predicate = false; ints are true when non-zero
+            if (kernel) {
+                kernel->evaluate(current_table_, begin, n, live, jit_result_);
+            }
+            const VectorSlot& pred = kernel ? jit_result_ : batch.evaluate(begin, n, live);
+            for (size_t i = 0; i < n; ++i) {
+                bool keep = pred.valid[i] && (pred.type == ColumnType::BOOL ? pred.bools[i] != 0
+                                                                             : pred.ints[i] != 0);
+                if (keep && (!live || live[i])) {
+                    result.set(begin + i, true);
+                }
+            }
         }
+    } else {
+        // Row-at-a-time fallback for predicates the batch interpreter cannot
+        // run (values without a static type): evaluate each row still selected
+        for (size_t row = 0; row < current_table_.num_rows; ++row) {
+            if (active && !active->get(row)) {
+                continue;  // Already rejected by an earlier filter
+            }
 
-        result.add_column(std::move(new_col));
-    }
-
-    // Step 2: Evaluate predicate for each row
-    // This is ROW-AT-A-TIME execution (not vectorized yet)
-    // Future optimization: evaluate in batches of 1000 rows
-    for (size_t row = 0; row < current_table_.num_rows; ++row) {
-        // Evaluate the predicate bytecode for this specific row
-        // eval_expr is the stack-based bytecode interpreter
-        Value predicate_result = eval_expr(op.predicate, row);
-
-        // Convert result to boolean
-        // SQL NULL semantics: NULL in filter predicate is treated as false
-        // Allows both bool and int (0 = false, non-zero = true)
-        bool keep_row = false;
-        if (predicate_result.is_null()) {
-            keep_row = false;  // NULL predicate = false (row not included)
-        } else if (predicate_result.is_bool()) {
-            keep_row = predicate_result.as_bool();
-        } else if (predicate_result.is_int()) {
-            keep_row = predicate_result.as_int() != 0;
-        } else {
-            throw RuntimeError("Filter predicate must return boolean");
-        }
+            // Evaluate the predicate bytecode for this specific row
+            // eval_expr is the stack-based bytecode interpreter
+            Value predicate_result = eval_expr(predicate, row);
+
+            // Convert result to boolean
+            // SQL NULL semantics: NULL in filter predicate is treated as false
+            // Allows both bool and int (0 = false, non-zero = true)
+            bool keep_row = false;
+            if (predicate_result.is_null()) {
+                keep_row = false;  // NULL predicate = false (row not included)
+            } else if (predicate_result.is_bool()) {
+                keep_row = predicate_result.as_bool();
+            } else if (predicate_result.is_int()) {
+                keep_row = predicate_result.as_int() != 0;
+            } else {
+                throw RuntimeError("Filter predicate must return boolean");
+            }
 
-        // Step 2b: If predicate is true, copy this row to result
-        if (keep_row) {
-            // Copy each column's value for this row (handle NULL values)
-            for (size_t col_idx = 0; col_idx < current_table_.columns.size(); ++col_idx) {
-                const Column& src_col = current_table_.columns[col_idx];
-                Column& dst_col = result.columns[col_idx];
-
-                // Check if value is NULL
-                if (src_col.is_null(row)) {
-                    // Copy NULL value
-                    switch (src_col.type) {
-                    case ColumnType::INT64:
-                        dst_col.append_int(std::nullopt);
-                        break;
-                    case ColumnType::DOUBLE:
-                        dst_col.append_double(std::nullopt);
-                        break;
-                    case ColumnType::STRING:
-                        dst_col.append_string(std::nullopt);
-                        break;
-                    case ColumnType::BOOL:
-                        dst_col.append_bool(std::nullopt);
-                        break;
-                    }
-                } else {
-                    // Copy non-NULL value
-                    switch (src_col.type) {
-                    case ColumnType::INT64:
-                        dst_col.append_int(src_col.get_int(row));
-                        break;
-                    case ColumnType::DOUBLE:
-                        dst_col.append_double(src_col.get_double(row));
-                        break;
-                    case ColumnType::STRING:
-                        dst_col.append_string(src_col.get_string(row));
-                        break;
-                    case ColumnType::BOOL:
-                        dst_col.append_bool(src_col.get_bool(row));
-                        break;
-                    }
-                }
+            if (keep_row) {
+                result.set(row, true);
             }
-            result.num_rows++;
         }
     }
 
-    // Step 3: Replace current table with filtered result
-    current_table_ = std::move(result);
+    return result;
 }
 
 // VECTORIZED_FILTER operator: Filter using column-at-a-time operations
 // Much faster than row-at-a-time for simple comparisons
 // Example: filter age > 30 → processes entire age column at once
 void VM::execute_vectorized_filter(const PhysicalOp::VectorizedFilterOp& op) {
+    // Handle empty tables - nothing to filter
+    if (current_table_.num_rows == 0) {
+        return;  // Table is already empty, nothing to do
+    }
+
+    // Narrow the selection (rows are not copied here)
+    selection_ = filter_compare(op, selection_ ? &*selection_ : nullptr);
+}
+
+// Helper: The kernels' spelling of a comparison operator
+static CompareOp compare_op(VectorOp op) {
+    switch (op) {
+    case VectorOp::GT:
+        return CompareOp::GT;
+    case VectorOp::LT:
+        return CompareOp::LT;
+    case VectorOp::GTE:
+        return CompareOp::GTE;
+    case VectorOp::LTE:
+        return CompareOp::LTE;
+    case VectorOp::EQ:
+        return CompareOp::EQ;
+    case VectorOp::NEQ:
+    default:
+        break;
+    }
+    return CompareOp::NEQ;
+}
+
+// Rows of active (nullptr = all rows) for which the comparison is true
+// Rows rejected by earlier filters stay rejected (and may be skipped)
+SelectionVector VM::filter_compare(const PhysicalOp::VectorizedFilterOp& op,
+                                   const SelectionVector* active) {
     // Find the column
     const Column* col = current_table_.get_column(op.column_name);
     if (!col) {
         throw RuntimeError("Column not found: " + op.column_name);
     }
-
-    // Handle empty tables - nothing to filter
-    if (current_table_.num_rows == 0) {
-        return;  // Table is already empty, nothing to do
+    if (auto match = string_match_of(op.op)) {
+        if (col->type != ColumnType::STRING) {
+            throw RuntimeError("String function on non-string column: " + op.column_name);
+        }
+        return vec_match_string(*match, *col, std::get<std::string>(op.value), active);
     }
+    const CompareOp cmp = compare_op(op.op);
 
-    // Call appropriate vectorized comparison based on column type and operation
-    SelectionVector selection;
+    // Column op column: numbers of either type (INT64 vs DOUBLE compares as
+    // DOUBLE), strings, or booleans for == and !=
+    if (op.is_right_column) {
+        const Column* right = current_table_.get_column(op.right_column_name);
+        if (!right) {
+            throw RuntimeError("Column not found: " + op.right_column_name);
+        }
+        bool numeric = col->type == ColumnType::INT64 || col->type == ColumnType::DOUBLE;
+        bool right_numeric = right->type == ColumnType::INT64 || right->type == ColumnType::DOUBLE;
+        bool equality = cmp == CompareOp::EQ || cmp == CompareOp::NEQ;
+        if (!(numeric && right_numeric) && (col->type != right->type ||
+                                            (col->type == ColumnType::BOOL && !equality))) {
+            throw RuntimeError("Cannot compare incompatible types");
+        }
+        return vec_compare_columns(cmp, *col, *right, active);
+    }
 
-    // Dispatch to type-specific vectorized operations
-    // Handle numeric type promotion: INT64 <-> DOUBLE
+    // Column op scalar, with INT64 <-> DOUBLE promotion as in scalar execution
     if (col->type == ColumnType::INT64) {
-        if (std::holds_alternative<int64_t>(op.value)) {
-            // INT64 column + INT64 literal (exact match)
-            int64_t value = std::get<int64_t>(op.value);
-            switch (op.op) {
-            case VectorOp::GT:
-                selection = vec_gt_int64(*col, value);
-                break;
-            case VectorOp::LT:
-                selection = vec_lt_int64(*col, value);
-                break;
-            case VectorOp::GTE:
-                selection = vec_gte_int64(*col, value);
-                break;
-            case VectorOp::LTE:
-                selection = vec_lte_int64(*col, value);
-                break;
-            case VectorOp::EQ:
-                selection = vec_eq_int64(*col, value);
-                break;
-            case VectorOp::NEQ:
-                selection = vec_neq_int64(*col, value);
-                break;
-            }
-        } else if (std::holds_alternative<double>(op.value)) {
-            // INT64 column + DOUBLE literal: Promote int column to double for comparison
-            // This matches scalar execution behavior
-            double value = std::get<double>(op.value);
-            // Convert INT64 column to double on-the-fly for comparison
-            const auto& int_data = std::get<std::vector<std::optional<int64_t>>>(col->data);
-            selection.resize(int_data.size());
-            for (size_t i = 0; i < int_data.size(); ++i) {
-                if (!int_data[i].has_value()) {
-                    selection[i] = false;
-                    continue;
-                }
-                double promoted_val = static_cast<double>(int_data[i].value());
-                switch (op.op) {
-                case VectorOp::GT:
-                    selection[i] = promoted_val > value;
-                    break;
-                case VectorOp::LT:
-                    selection[i] = promoted_val < value;
-                    break;
-                case VectorOp::GTE:
-                    selection[i] = promoted_val >= value;
-                    break;
-                case VectorOp::LTE:
-                    selection[i] = promoted_val <= value;
-                    break;
-                case VectorOp::EQ:
-                    selection[i] = promoted_val == value;
-                    break;
-                case VectorOp::NEQ:
-                    selection[i] = promoted_val != value;
-                    break;
-                }
-            }
-        } else {
-            throw RuntimeError("Type mismatch: INT64 column requires numeric value");
+        if (const auto* value = std::get_if<int64_t>(&op.value)) {
+            return vec_compare_int64(cmp, *col, *value, active);
         }
+        if (const auto* value = std::get_if<double>(&op.value)) {
+            return vec_compare_double(cmp, *col, *value, active);
+        }
+        throw RuntimeError("Type mismatch: INT64 column requires numeric value");
     } else if (col->type == ColumnType::DOUBLE) {
-        // DOUBLE column accepts both DOUBLE and INT64 literals
-        double value;
-        if (std::holds_alternative<double>(op.value)) {
-            value = std::get<double>(op.value);
-        } else if (std::holds_alternative<int64_t>(op.value)) {
-            // Promote INT64 literal to DOUBLE
-            value = static_cast<double>(std::get<int64_t>(op.value));
-        } else {
-            throw RuntimeError("Type mismatch: DOUBLE column requires numeric value");
+        if (const auto* value = std::get_if<double>(&op.value)) {
+            return vec_compare_double(cmp, *col, *value, active);
         }
-
-        switch (op.op) {
-        case VectorOp::GT:
-            selection = vec_gt_double(*col, value);
-            break;
-        case VectorOp::LT:
-            selection = vec_lt_double(*col, value);
-            break;
-        case VectorOp::GTE:
-            selection = vec_gte_double(*col, value);
-            break;
-        case VectorOp::LTE:
-            selection = vec_lte_double(*col, value);
-            break;
-        case VectorOp::EQ:
-            selection = vec_eq_double(*col, value);
-            break;
-        case VectorOp::NEQ:
-            selection = vec_neq_double(*col, value);
-            break;
+        if (const auto* value = std::get_if<int64_t>(&op.value)) {
+            return vec_compare_double(cmp, *col, static_cast<double>(*value), active);
         }
+        throw RuntimeError("Type mismatch: DOUBLE column requires numeric value");
     } else if (col->type == ColumnType::STRING) {
-        if (!std::holds_alternative<std::string>(op.value)) {
-            throw RuntimeError("Type mismatch: column is STRING but value is not");
-        }
-        const std::string& value = std::get<std::string>(op.value);
-        switch (op.op) {
-        case VectorOp::GT:
-            selection = vec_gt_string(*col, value);
-            break;
-        case VectorOp::LT:
-            selection = vec_lt_string(*col, value);
-            break;
-        case VectorOp::GTE:
-            selection = vec_gte_string(*col, value);
-            break;
-        case VectorOp::LTE:
-            selection = vec_lte_string(*col, value);
-            break;
-        case VectorOp::EQ:
-            selection = vec_eq_string(*col, value);
-            break;
-        case VectorOp::NEQ:
-            selection = vec_neq_string(*col, value);
-            break;
+        if (const auto* value = std::get_if<std::string>(&op.value)) {
+            return vec_compare_string(cmp, *col, *value, active);
         }
-    } else {
-        throw RuntimeError("Unsupported column type for vectorized filter");
+        throw RuntimeError("Type mismatch: column is STRING but value is not");
     }
+    throw RuntimeError("Unsupported column type for vectorized filter");
+}
 
-    // Build result table with matching rows (same approach as scalar filter)
-    Table result;
-
-    // Create empty result columns with same schema
-    for (const auto& src_col : current_table_.columns) {
-        Column new_col;
-        new_col.name = src_col.name;
-        new_col.type = src_col.type;
+// LOGICAL_FILTER operator: Filter by an and/or tree of predicates
+// Example: filter age > 30 and (department == "Ops" or salary > 150000)
+// Each node only evaluates the rows that can still change the outcome
+void VM::execute_logical_filter(const PhysicalOp::LogicalFilterOp& op) {
+    if (current_table_.num_rows == 0) {
+        return;
+    }
+    selection_ = filter_node(op.root, selection_ ? &*selection_ : nullptr);
+}
 
-        switch (src_col.type) {
-        case ColumnType::INT64:
-            new_col.data = std::vector<std::optional<int64_t>>{};
-            break;
-        case ColumnType::DOUBLE:
-            new_col.data = std::vector<std::optional<double>>{};
-            break;
-        case ColumnType::STRING:
-            new_col.data = std::vector<std::optional<std::string>>{};
-            break;
-        case ColumnType::BOOL:
-            new_col.data = std::vector<std::optional<bool>>{};
-            break;
+// Rows of active (nullptr = all rows) for which node is true
+//   AND - each child sees only the rows every earlier child kept
+//         (intersection by refinement; stops once nothing is left)
+//   OR  - each child sees only the rows no earlier child accepted
+//         (union; stops once every row is accepted)
+SelectionVector VM::filter_node(const PhysicalOp::FilterNode& node,
+                                const SelectionVector* active) {
+    switch (node.kind) {
+    case PhysicalOp::FilterNode::Kind::COMPARE:
+        return filter_compare(node.compare, active);
+    case PhysicalOp::FilterNode::Kind::PREDICATE:
+        return filter_predicate(node.predicate, active);
+    case PhysicalOp::FilterNode::Kind::AND: {
+        std::optional<SelectionVector> kept;
+        for (const auto& child : node.children) {
+            kept = filter_node(child, kept ? &*kept : active);
+            if (kept->count() == 0)
+                break;
         }
-
-        result.add_column(std::move(new_col));
-    }
-
-    // Copy rows that passed the filter
-    for (size_t row = 0; row < current_table_.num_rows; ++row) {
-        if (selection[row]) {
-            // Copy this row
-            for (size_t col_idx = 0; col_idx < current_table_.columns.size(); ++col_idx) {
-                const Column& src_col = current_table_.columns[col_idx];
-                Column& dst_col = result.columns[col_idx];
-
-                if (src_col.is_null(row)) {
-                    switch (src_col.type) {
-                    case ColumnType::INT64:
-                        dst_col.append_int(std::nullopt);
-                        break;
-                    case ColumnType::DOUBLE:
-                        dst_col.append_double(std::nullopt);
-                        break;
-                    case ColumnType::STRING:
-                        dst_col.append_string(std::nullopt);
-                        break;
-                    case ColumnType::BOOL:
-                        dst_col.append_bool(std::nullopt);
-                        break;
-                    }
-                } else {
-                    switch (src_col.type) {
-                    case ColumnType::INT64:
-                        dst_col.append_int(src_col.get_int(row));
-                        break;
-                    case ColumnType::DOUBLE:
-                        dst_col.append_double(src_col.get_double(row));
-                        break;
-                    case ColumnType::STRING:
-                        dst_col.append_string(src_col.get_string(row));
-                        break;
-                    case ColumnType::BOOL:
-                        dst_col.append_bool(src_col.get_bool(row));
-                        break;
-                    }
-                }
-            }
-            result.num_rows++;
+        return std::move(*kept);
+    }
+    case PhysicalOp::FilterNode::Kind::OR: {
+        SelectionVector accepted(current_table_.num_rows);
+        SelectionVector undecided =
+            active ? *active : SelectionVector(current_table_.num_rows, true);
+        for (const auto& child : node.children) {
+            SelectionVector hits = filter_node(child, &undecided);
+            accepted |= hits;
+            undecided.subtract(hits);
+            if (undecided.count() == 0)
+                break;
         }
+        return accepted;
     }
-
-    current_table_ = std::move(result);
+    }
+    throw RuntimeError("Invalid filter node");
 }
 
 // PROJECT operator: Select subset of columns
 // Example: select name, age
 // Delegates to table.project() which does the actual work
 void VM::execute_project(const PhysicalOp::ProjectOp& op) {
-    current_table_ = current_table_.project(op.columns);
+    // Gathers the selected rows of just the projected columns
+    current_table_ = current_table_.project(op.columns, selection_ ? &*selection_ : nullptr);
+    selection_.reset();
+}
+
+// Helper: Whether a batch result of type from can be stored in a column of
+// type to (the same coercions the row-at-a-time path applies)
+static bool can_store(ColumnType to, ColumnType from) {
+    if (to == ColumnType::INT64 || to == ColumnType::DOUBLE) {
+        return from == ColumnType::INT64 || from == ColumnType::DOUBLE;
+    }
+    return to == from;
+}
+
+// Helper: Append the first n rows of a batch result slot to col
+static void append_slot(Column& col, const VectorSlot& slot, size_t n) {
+    switch (col.type) {
+    case ColumnType::INT64: {
+        auto& out = col.values<int64_t>();
+        if (slot.type == ColumnType::INT64) {
+            out.insert(out.end(), slot.ints.begin(), slot.ints.begin() + n);
+        } else {
+            for (size_t i = 0; i < n; ++i)
+                out.push_back(slot.valid[i] ? static_cast<int64_t>(slot.doubles[i]) : 0);
+        }
+        break;
+    }
+    case ColumnType::DOUBLE: {
+        auto& out = col.values<double>();
+        if (slot.type == ColumnType::DOUBLE) {
+            out.insert(out.end(), slot.doubles.begin(), slot.doubles.begin() + n);
+        } else {
+            for (size_t i = 0; i < n; ++i)
+                out.push_back(static_cast<double>(slot.ints[i]));
+        }
+        break;
+    }
+    case ColumnType::STRING:
+        for (size_t i = 0; i < n; ++i) {
+            if (slot.valid[i])
+                col.append_string(slot.strings[i]);
+            else
+                col.append_null();
+        }
+        return;  // append_string/append_null maintain validity
+    case ColumnType::BOOL: {
+        auto& out = std::get<Bitmap>(col.data);
+        for (size_t i = 0; i < n; ++i)
+            out.push_back(slot.bools[i] != 0);
+        break;
+    }
+    }
+    for (size_t i = 0; i < n; ++i) {
+        col.validity.push_back(slot.valid[i] != 0);
+    }
 }
 
 // TRANSFORM operator: Add or update column with expression result
@@ -483,123 +1005,80 @@ void VM::execute_project(const PhysicalOp::ProjectOp& op) {
 // Example: transform gain_class = gain > 1000 ? "high" : "low"
 //
 // Strategy:
-//   1. Evaluate expression for first row to infer result type
-//   2. Create column with inferred type
-//   3. Evaluate and append for each row (including first)
+//   1. Take the result type the binder fixed for the plan
+//   2. Create column with that type
+//   3. Evaluate and append for each row
 //   4. Replace existing column or add new one
+// Empty batches still get the (empty) column so every batch has the same schema
 void VM::execute_transform(const PhysicalOp::TransformOp& op) {
-    if (current_table_.num_rows == 0) {
-        // Empty table - nothing to transform
-        return;
-    }
+    materialize();  // Expressions are evaluated on physical rows
 
-    // Step 1: Evaluate first row to infer result type
-    Value first_val = eval_expr(op.expression, 0);
-
-    // Find first non-NULL value if first is NULL
-    Value type_sample = first_val;
-    if (type_sample.is_null() && current_table_.num_rows > 1) {
-        for (size_t i = 1; i < current_table_.num_rows; i++) {
-            type_sample = eval_expr(op.expression, i);
-            if (!type_sample.is_null()) {
-                break;
-            }
-        }
-    }
-
-    // Infer column type from first non-NULL value
-    ColumnType result_type;
-    if (type_sample.is_int()) {
-        result_type = ColumnType::INT64;
-    } else if (type_sample.is_double()) {
-        result_type = ColumnType::DOUBLE;
-    } else if (type_sample.is_string()) {
-        result_type = ColumnType::STRING;
-    } else if (type_sample.is_bool()) {
-        result_type = ColumnType::BOOL;
-    } else {
-        // All NULLs - default to STRING
-        result_type = ColumnType::STRING;
-    }
+    // Step 1: Result type (the same for every batch, whatever its values)
+    const ColumnType result_type = op.result_type;
 
     // Step 2: Create new column
-    Column new_col;
-    new_col.name = op.column_name;
-    new_col.type = result_type;
+    Column new_col = Column::make(op.column_name, result_type);
     new_col.reserve(current_table_.num_rows);
 
-    // Initialize column data storage
-    switch (result_type) {
-    case ColumnType::INT64:
-        new_col.data = std::vector<std::optional<int64_t>>();
-        break;
-    case ColumnType::DOUBLE:
-        new_col.data = std::vector<std::optional<double>>();
-        break;
-    case ColumnType::STRING:
-        new_col.data = std::vector<std::optional<std::string>>();
-        break;
-    case ColumnType::BOOL:
-        new_col.data = std::vector<std::optional<bool>>();
-        break;
-    }
-
-    // Step 3: Evaluate expression and populate column for each row
-    for (size_t i = 0; i < current_table_.num_rows; i++) {
-        // Reuse first_val for row 0 to avoid re-evaluation
-        Value val = (i == 0) ? first_val : eval_expr(op.expression, i);
+    // Step 3: Evaluate expression and populate column
+    // Chunks of rows through a native kernel (hot expressions) or the batch
+    // interpreter when the expression type-checks, otherwise row at a time
+    const JitKernel* kernel = jit_kernel(op.expression);
+    BatchInterpreter batch(op.expression, current_table_);
+    if (kernel && can_store(result_type, kernel->result_type())) {
+        for (size_t begin = 0; begin < current_table_.num_rows; begin += kEvalBatchSize) {
+            size_t n = std::min(kEvalBatchSize, current_table_.num_rows - begin);
+            kernel->evaluate(current_table_, begin, n, nullptr, jit_result_);
+            append_slot(new_col, jit_result_, n);
+        }
+    } else if (batch.supported() && can_store(result_type, batch.result_type())) {
+        for (size_t begin = 0; begin < current_table_.num_rows; begin += kEvalBatchSize) {
+            size_t n = std::min(kEvalBatchSize, current_table_.num_rows - begin);
+            append_slot(new_col, batch.evaluate(begin, n), n);
+        }
+    } else {
+        for (size_t i = 0; i < current_table_.num_rows; i++) {
+            Value val = eval_expr(op.expression, i);
 
-        if (val.is_null()) {
-            // Append NULL
-            switch (result_type) {
-            case ColumnType::INT64:
-                new_col.append_int(std::nullopt);
-                break;
-            case ColumnType::DOUBLE:
-                new_col.append_double(std::nullopt);
-                break;
-            case ColumnType::STRING:
-                new_col.append_string(std::nullopt);
-                break;
-            case ColumnType::BOOL:
-                new_col.append_bool(std::nullopt);
-                break;
-            }
-        } else {
-            // Append value with type coercion
-            switch (result_type) {
-            case ColumnType::INT64:
-                if (val.is_int()) {
-                    new_col.append_int(val.as_int());
-                } else if (val.is_double()) {
-                    new_col.append_int(static_cast<int64_t>(val.as_double()));
-                } else {
-                    throw RuntimeError("Type mismatch in transform");
-                }
-                break;
-            case ColumnType::DOUBLE:
-                if (val.is_double()) {
-                    new_col.append_double(val.as_double());
-                } else if (val.is_int()) {
-                    new_col.append_double(static_cast<double>(val.as_int()));
-                } else {
-                    throw RuntimeError("Type mismatch in transform");
-                }
-                break;
-            case ColumnType::STRING:
-                if (val.is_string()) {
-                    new_col.append_string(val.as_string());
-                } else {
-                    throw RuntimeError("Type mismatch in transform");
-                }
-                break;
-            case ColumnType::BOOL:
-                if (val.is_bool()) {
-                    new_col.append_bool(val.as_bool());
-                } else {
-                    throw RuntimeError("Type mismatch in transform");
+            if (val.is_null()) {
+                // Append NULL
+                new_col.append_null();
+            } else {
+                // Append value with type coercion
+                switch (result_type) {
+                case ColumnType::INT64:
+                    if (val.is_int()) {
+                        new_col.append_int(val.as_int());
+                    } else if (val.is_double()) {
+                        new_col.append_int(static_cast<int64_t>(val.as_double()));
+                    } else {
+                        throw RuntimeError("Type mismatch in transform");
+                    }
+                    break;
+                case ColumnType::DOUBLE:
+                    if (val.is_double()) {
+                        new_col.append_double(val.as_double());
+                    } else if (val.is_int()) {
+                        new_col.append_double(static_cast<double>(val.as_int()));
+                    } else {
+                        throw RuntimeError("Type mismatch in transform");
+                    }
+                    break;
+                case ColumnType::STRING:
+                    if (val.is_string()) {
+                        new_col.append_string(val.as_string());
+                    } else {
+                        throw RuntimeError("Type mismatch in transform");
+                    }
+                    break;
+                case ColumnType::BOOL:
+                    if (val.is_bool()) {
+                        new_col.append_bool(val.as_bool());
+                    } else {
+                        throw RuntimeError("Type mismatch in transform");
+                    }
+                    break;
                 }
-                break;
             }
         }
     }
@@ -616,7 +1095,18 @@ void VM::execute_transform(const PhysicalOp::TransformOp& op) {
 // VECTORIZED_TRANSFORM operator: Vectorized arithmetic on columns (FAST!)
 // Pattern: total = price * quantity, discounted = price * 0.9
 // Processes entire columns at once instead of row-by-row
+// Helper: An INT64 column's values as DOUBLE (same validity)
+static Column promote_to_double(const Column& col) {
+    Column promoted = Column::make(col.name, ColumnType::DOUBLE);
+    const auto& ints = col.values<int64_t>();
+    promoted.values<double>().assign(ints.begin(), ints.end());
+    promoted.validity = col.validity;
+    return promoted;
+}
+
 void VM::execute_vectorized_transform(const PhysicalOp::VectorizedTransformOp& op) {
+    materialize();
+
     // Get operand columns/scalars
     const Column* left_col = nullptr;
     const Column* right_col = nullptr;
@@ -665,25 +1155,29 @@ void VM::execute_vectorized_transform(const PhysicalOp::VectorizedTransformOp& o
             result = vec_arith_scalar_int64(op.op, scalar, *right_col);
         }
     } else {
-        // DOUBLE result type
-        // All operands must be DOUBLE (we promote INT64->DOUBLE if needed)
+        // DOUBLE result type: INT64 column operands are promoted first
+        // (a * b with an INT64 a and a DOUBLE b)
+        Column left_promoted;
+        Column right_promoted;
+        auto promote = [](const Column*& col, Column& promoted) {
+            if (!col || col->type == ColumnType::DOUBLE)
+                return;
+            if (col->type != ColumnType::INT64)
+                throw RuntimeError("Type mismatch in transform");
+            promoted = promote_to_double(*col);
+            col = &promoted;
+        };
+        promote(left_col, left_promoted);
+        promote(right_col, right_promoted);
+
         if (op.is_left_column && op.is_right_column) {
             result = vec_arith_double(op.op, *left_col, *right_col);
         } else if (op.is_left_column && !op.is_right_column) {
-            // Column op scalar - column MUST be DOUBLE for vectorized path
-            if (left_col->type != ColumnType::DOUBLE) {
-                throw RuntimeError(
-                    "Cannot vectorize: INT64 column with DOUBLE scalar (needs type coercion)");
-            }
             double scalar = std::holds_alternative<double>(op.right_scalar)
                                 ? std::get<double>(op.right_scalar)
                                 : static_cast<double>(std::get<int64_t>(op.right_scalar));
             result = vec_arith_double_scalar(op.op, *left_col, scalar);
         } else if (!op.is_left_column && op.is_right_column) {
-            if (right_col->type != ColumnType::DOUBLE) {
-                throw RuntimeError(
-                    "Cannot vectorize: DOUBLE scalar with INT64 column (needs type coercion)");
-            }
             double scalar = std::holds_alternative<double>(op.left_scalar)
                                 ? std::get<double>(op.left_scalar)
                                 : static_cast<double>(std::get<int64_t>(op.left_scalar));
@@ -706,123 +1200,73 @@ void VM::execute_vectorized_transform(const PhysicalOp::VectorizedTransformOp& o
 // Pattern: class = score > 90 ? "A" : "B"
 // Uses vectorized condition evaluation + blend operation
 void VM::execute_vectorized_ternary_transform(const PhysicalOp::VectorizedTernaryTransformOp& op) {
-    // Step 1: Evaluate condition vectorially (reuse vectorized filter logic)
-    const Column* cond_col = current_table_.get_column(op.condition.column_name);
-    if (!cond_col)
-        throw RuntimeError("Column not found: " + op.condition.column_name);
+    materialize();
 
-    SelectionVector selection;
-    // Call appropriate vectorized comparison based on column type and operator
-    if (cond_col->type == ColumnType::INT64) {
-        int64_t value = std::get<int64_t>(op.condition.value);
-        switch (op.condition.op) {
-        case VectorOp::GT:
-            selection = vec_gt_int64(*cond_col, value);
-            break;
-        case VectorOp::LT:
-            selection = vec_lt_int64(*cond_col, value);
-            break;
-        case VectorOp::GTE:
-            selection = vec_gte_int64(*cond_col, value);
-            break;
-        case VectorOp::LTE:
-            selection = vec_lte_int64(*cond_col, value);
-            break;
-        case VectorOp::EQ:
-            selection = vec_eq_int64(*cond_col, value);
-            break;
-        case VectorOp::NEQ:
-            selection = vec_neq_int64(*cond_col, value);
-            break;
-        }
-    } else if (cond_col->type == ColumnType::DOUBLE) {
-        double value = std::get<double>(op.condition.value);
-        switch (op.condition.op) {
-        case VectorOp::GT:
-            selection = vec_gt_double(*cond_col, value);
-            break;
-        case VectorOp::LT:
-            selection = vec_lt_double(*cond_col, value);
-            break;
-        case VectorOp::GTE:
-            selection = vec_gte_double(*cond_col, value);
-            break;
-        case VectorOp::LTE:
-            selection = vec_lte_double(*cond_col, value);
-            break;
-        case VectorOp::EQ:
-            selection = vec_eq_double(*cond_col, value);
-            break;
-        case VectorOp::NEQ:
-            selection = vec_neq_double(*cond_col, value);
-            break;
-        }
-    } else if (cond_col->type == ColumnType::STRING) {
-        std::string value = std::get<std::string>(op.condition.value);
-        switch (op.condition.op) {
-        case VectorOp::GT:
-            selection = vec_gt_string(*cond_col, value);
-            break;
-        case VectorOp::LT:
-            selection = vec_lt_string(*cond_col, value);
-            break;
-        case VectorOp::GTE:
-            selection = vec_gte_string(*cond_col, value);
-            break;
-        case VectorOp::LTE:
-            selection = vec_lte_string(*cond_col, value);
-            break;
-        case VectorOp::EQ:
-            selection = vec_eq_string(*cond_col, value);
-            break;
-        case VectorOp::NEQ:
-            selection = vec_neq_string(*cond_col, value);
-            break;
-        }
-    }
+    // Step 1: Evaluate condition vectorially (reuse vectorized filter logic)
+    // NULL and false conditions both take the false branch
+    SelectionVector selection = filter_compare(op.condition, nullptr);
 
     // Step 2: Materialize true/false columns
-    Column true_col, false_col;
+    // Column branches widen the literal-based result type (the binder has
+    // already done so when it knew their types)
+    ColumnType result_type = op.result_type;
+    auto widen = [&](bool is_column, const std::string& name) {
+        const Column* col = is_column ? current_table_.get_column(name) : nullptr;
+        if (col)
+            result_type = select_result_type(result_type, col->type);
+    };
+    widen(op.is_true_column, op.true_column_name);
+    widen(op.is_false_column, op.false_column_name);
     size_t num_rows = current_table_.num_rows;
 
-    // Helper to create constant column or get existing column
+    // Helper to create constant column or get existing column (INT64 values
+    // are promoted to a DOUBLE result)
     auto make_column = [&](bool is_column, const std::string& col_name,
-                           const std::variant<int64_t, double, std::string>& scalar,
-                           ColumnType type) -> Column {
+                           const std::variant<int64_t, double, std::string>& scalar) -> Column {
         if (is_column) {
             const Column* col = current_table_.get_column(col_name);
             if (!col)
                 throw RuntimeError("Column not found: " + col_name);
-            return *col;  // Copy
+            if (col->type == result_type)
+                return *col;  // Copy
+            if (col->type != ColumnType::INT64 || result_type != ColumnType::DOUBLE)
+                throw RuntimeError("Type mismatch in transform");
+            return promote_to_double(*col);
+        }
+
+        // Create constant column (every row valid)
+        Column col = Column::make("", result_type);
+        const auto* int_value = std::get_if<int64_t>(&scalar);
+        const auto* double_value = std::get_if<double>(&scalar);
+        const auto* string_value = std::get_if<std::string>(&scalar);
+        if (result_type == ColumnType::INT64 && int_value) {
+            col.values<int64_t>().assign(num_rows, *int_value);
+        } else if (result_type == ColumnType::DOUBLE && (int_value || double_value)) {
+            col.values<double>().assign(
+                num_rows, int_value ? static_cast<double>(*int_value) : *double_value);
+        } else if (result_type == ColumnType::STRING && string_value) {
+            // One-entry dictionary: every row holds code 0
+            col = Column::make_dict("");
+            auto& strings = std::get<DictStrings>(col.data);
+            strings.dict->intern(*string_value);
+            strings.codes.assign(num_rows, 0);
         } else {
-            // Create constant column
-            Column col;
-            col.type = type;
-            if (type == ColumnType::INT64) {
-                col.data = std::vector<std::optional<int64_t>>(
-                    num_rows, std::get<int64_t>(scalar));
-            } else if (type == ColumnType::DOUBLE) {
-                col.data = std::vector<std::optional<double>>(
-                    num_rows, std::get<double>(scalar));
-            } else if (type == ColumnType::STRING) {
-                col.data = std::vector<std::optional<std::string>>(
-                    num_rows, std::get<std::string>(scalar));
-            }
-            return col;
+            throw RuntimeError("Type mismatch in transform");
         }
+        col.validity.resize(num_rows, true);
+        return col;
     };
 
-    true_col = make_column(op.is_true_column, op.true_column_name, op.true_scalar, op.result_type);
-    false_col =
-        make_column(op.is_false_column, op.false_column_name, op.false_scalar, op.result_type);
+    Column true_col = make_column(op.is_true_column, op.true_column_name, op.true_scalar);
+    Column false_col = make_column(op.is_false_column, op.false_column_name, op.false_scalar);
 
     // Step 3: Blend based on selection vector
     Column result;
-    if (op.result_type == ColumnType::INT64) {
+    if (result_type == ColumnType::INT64) {
         result = vec_select_int64(selection, true_col, false_col);
-    } else if (op.result_type == ColumnType::DOUBLE) {
+    } else if (result_type == ColumnType::DOUBLE) {
         result = vec_select_double(selection, true_col, false_col);
-    } else if (op.result_type == ColumnType::STRING) {
+    } else if (result_type == ColumnType::STRING) {
         result = vec_select_string(selection, true_col, false_col);
     }
 
@@ -837,11 +1281,136 @@ void VM::execute_vectorized_ternary_transform(const PhysicalOp::VectorizedTernar
     }
 }
 
-// WRITE operator: Output current table to CSV file
-// This is the data sink - typically last operator in pipeline
+// Expressions run on the interpreter until they have evaluated kJitMinRows
+// rows (counting this batch), then compile once; a failed compile (no LLVM,
+// unsupported opcode) is not retried. Batches whose column types differ from
+// the ones the kernel was compiled for use the interpreter
+// Workers share the main VM's kernels (one compile per expression); the
+// compile runs outside shared_mutex_, so the other workers keep interpreting
+// instead of waiting for it
+const JitKernel* VM::jit_kernel(const IRExpr& expr) {
+    if (!options_.jit) {
+        return nullptr;
+    }
+    VM& owner = parent_ ? *parent_ : *this;
+    JitState* state;
+    {
+        std::lock_guard<std::mutex> lock(owner.shared_mutex_);
+        state = &owner.jit_kernels_[&expr];
+        state->rows += current_table_.num_rows;
+        if (state->attempted || state->rows < kJitMinRows) {
+            const JitKernel* kernel = state->kernel.get();
+            return kernel && kernel->matches(current_table_) ? kernel : nullptr;
+        }
+        state->attempted = true;  // This worker compiles it
+    }
+
+    std::unique_ptr<JitKernel> kernel;
+    {
+        std::lock_guard<std::mutex> lock(owner.jit_mutex_);
+        if (!owner.jit_) {
+            owner.jit_ = std::make_unique<ExpressionJit>();
+        }
+        kernel = owner.jit_->compile(expr, current_table_);
+    }
+    std::lock_guard<std::mutex> lock(owner.shared_mutex_);
+    state->kernel = std::move(kernel);  // Set once; never replaced during a run
+    const JitKernel* compiled = state->kernel.get();
+    return compiled && compiled->matches(current_table_) ? compiled : nullptr;
+}
+
+// WRITE operator: Append current batch to the output file (CSV or .joyc)
+// The file is created when the first batch arrives and closed after the last
 // Example: write "output.csv"
 void VM::execute_write(const PhysicalOp::WriteOp& op) {
-    write_csv(op.filepath, current_table_);
+    materialize();
+
+    auto& writer = writers_[&op];
+    if (!writer) {
+        writer = open_writer(op.filepath, pool_.get());
+    }
+    writer->write(current_table_);
+}
+
+// AGGREGATE operator: Add the current batch to the operator's hash table
+// Output is produced by execute() once all input has arrived (pipeline breaker)
+// Example: group by department aggregate sum(salary), count()
+void VM::execute_aggregate(const PhysicalOp::AggregateOp& op) {
+    materialize();
+
+    auto& agg = aggregates_[&op];
+    if (!agg) {
+        agg = std::make_unique<HashAggregate>(op, pool_->size());
+    }
+    agg->consume(current_table_, pool_.get());
+}
+
+// JOIN operator: Probe the joined file with the current batch
+// The file's hash table was built by execute() before the first batch
+// The matches can outnumber the batch's rows, so they are passed on to the
+// operators after the join (index + 1 onwards) in batches of at most
+// batch_size rows (always at least one batch, so the schema reaches them)
+// Example: join "departments.csv" on department
+void VM::execute_join(const PhysicalOp::JoinOp& op, const ExecutionPlan& plan, size_t index) {
+    ProfileMark mark = profile_start();
+    const uint64_t rows_in = options_.analyze ? selected_rows() : 0;
+    materialize();
+    const HashJoin& join = *joins_.at(&op);
+    Table probe = std::move(current_table_);
+    std::vector<uint32_t> matches = join.match(probe, pool_.get());
+    profile_stop(index, mark, rows_in, 0);
+
+    size_t max_rows =
+        options_.batch_size == 0 ? std::numeric_limits<size_t>::max() : options_.batch_size;
+    HashJoin::Cursor cursor;
+    bool more;
+    do {
+        mark = profile_start();
+        more = join.emit(probe, matches, cursor, max_rows, current_table_);
+        profile_stop(index, mark, 0, current_table_.num_rows, false);
+        selection_.reset();
+        run_pipeline(plan, index + 1);
+    } while (more);
+}
+
+// SORT operator: Add the current batch to the operator's sort buffer (or,
+// for sort ... limit N, to its top-N heap)
+// Output is produced by execute() once all input has arrived (pipeline breaker)
+// Example: sort by salary desc
+void VM::execute_sort(const PhysicalOp::SortOp& op) {
+    materialize();
+
+    auto& sorter = sorts_[&op];
+    if (!sorter) {
+        sorter = std::make_unique<Sorter>(op, options_.sort_memory);
+    }
+    sorter->consume(current_table_, pool_.get());
+}
+
+// LIMIT operator: Pass rows until count have gone through, then none
+// Rows past the limit are only deselected, not copied
+// Example: limit 100
+void VM::execute_limit(const PhysicalOp::LimitOp& op) {
+    size_t& remaining = limits_.try_emplace(&op, op.count).first->second;
+    const size_t rows = selection_ ? selection_->count() : current_table_.num_rows;
+    if (rows <= remaining) {
+        remaining -= rows;
+        return;
+    }
+
+    if (!selection_) {
+        SelectionVector first(remaining, true);
+        first.resize(current_table_.num_rows);
+        selection_ = std::move(first);
+    } else {
+        // Keep the first `remaining` selected rows
+        size_t kept = 0;
+        for (size_t i = 0; i < selection_->size(); ++i) {
+            if (selection_->get(i) && kept++ >= remaining)
+                selection_->set(i, false);
+        }
+    }
+    remaining = 0;
 }
 
 // ============================================================================
@@ -857,12 +1426,57 @@ void VM::execute_write(const PhysicalOp::WriteOp& op) {
 //
 // Example: age + 5
 //   Bytecode: [LOAD_COLUMN "age", PUSH_INT 5, ADD]
+//   Bound:    [LOAD_COLUMN 1, PUSH_INT 5, ADD_I64]   (age is column 1, INT64)
 //   Execution:
 //     Stack: []
-//     LOAD_COLUMN "age" → Stack: [42]         (if age column has value 42)
+//     LOAD_COLUMN 1     → Stack: [42]         (if age column has value 42)
 //     PUSH_INT 5        → Stack: [42, 5]
-//     ADD               → Stack: [47]         (pop 42 and 5, push 42+5)
+//     ADD_I64           → Stack: [47]         (pop 42 and 5, push 42+5)
 //     Result: 47
+//
+// Generic opcodes (ADD, LT, ...) remain only where the binder could not
+// determine operand types; they check types per row
+
+// Helper: Boolean value of a logical operand (NULL is false, ints C-style)
+static bool truthy(const Value& v, const char* op_name) {
+    if (v.is_null())
+        return false;
+    if (v.is_bool())
+        return v.as_bool();
+    if (v.is_int())
+        return v.as_int() != 0;
+    throw RuntimeError(std::string("Cannot apply ") + op_name + " to non-boolean value");
+}
+
+// Helper: Typed binary arithmetic (a op b replaces a; NULL propagates)
+template <typename T, typename Op>
+static void typed_arith(std::vector<Value>& stack, Op op) {
+    Value b = std::move(stack.back());
+    stack.pop_back();
+    Value& a = stack.back();
+    if (a.is_null() || b.is_null()) {
+        a = Value::make_null();
+    } else {
+        a = Value{op(std::get<T>(a.data), std::get<T>(b.data))};
+    }
+}
+
+// Helper: Typed comparison (NULL on either side is false)
+template <typename T, typename Cmp>
+static void typed_compare(std::vector<Value>& stack, Cmp cmp) {
+    Value b = std::move(stack.back());
+    stack.pop_back();
+    Value& a = stack.back();
+    bool result = !a.is_null() && !b.is_null() && cmp(std::get<T>(a.data), std::get<T>(b.data));
+    a = Value::make_bool(result);
+}
+
+// Helper: Typed comparison of the top of stack against a literal operand
+template <typename T, typename Cmp, typename Operand>
+static void compare_const(std::vector<Value>& stack, const Operand& operand, Cmp cmp) {
+    Value& a = stack.back();
+    a = Value::make_bool(!a.is_null() && cmp(std::get<T>(a.data), std::get<T>(operand)));
+}
 
 // Evaluate expression bytecode for a specific row
 // Returns the computed value (could be int, double, string, or bool)
@@ -888,6 +1502,7 @@ Value VM::eval_expr(const IRExpr& expr, size_t row_idx) {
             break;
 
         case IRExpr::OpCode::PUSH_STRING:
+            // A view of the literal in the bytecode (no copy per row)
             stack_.push_back(Value::make_string(std::get<std::string>(instr.operand)));
             break;
 
@@ -898,17 +1513,13 @@ Value VM::eval_expr(const IRExpr& expr, size_t row_idx) {
             // ================================================================
             // LOAD_COLUMN - Load value from current row (NULL support)
             // ================================================================
-            // Operand is column name (string)
-            // We look up the column, get the value at row_idx, push it
-            // Example: LOAD_COLUMN "age" when row_idx=2 loads age[2]
+            // Operand is the column index (resolved from the name by the binder)
+            // We get the value at row_idx from that column and push it
+            // Example: LOAD_COLUMN 1 (age) when row_idx=2 loads age[2]
             // SQL NULL semantics: if cell is NULL, push NULL value
 
         case IRExpr::OpCode::LOAD_COLUMN: {
-            std::string col_name = std::get<std::string>(instr.operand);
-            const Column* col = current_table_.get_column(col_name);
-            if (!col) {
-                throw RuntimeError("Column not found: " + col_name);
-            }
+            const Column* col = &current_table_.columns[std::get<int>(instr.operand)];
 
             // Check if value is NULL first
             if (col->is_null(row_idx)) {
@@ -1025,7 +1636,7 @@ Value VM::eval_expr(const IRExpr& expr, size_t row_idx) {
             else if (a.is_int() && b.is_int()) {
                 if (b.as_int() == 0)
                     throw RuntimeError("Division by zero");
-                stack_.push_back(Value::make_int(a.as_int() / b.as_int()));
+                stack_.push_back(Value::make_int(divide(a.as_int(), b.as_int())));
             } else if ((a.is_int() || a.is_double()) && (b.is_int() || b.is_double())) {
                 double a_val = a.is_double() ? a.as_double() : static_cast<double>(a.as_int());
                 double b_val = b.is_double() ? b.as_double() : static_cast<double>(b.as_int());
@@ -1279,6 +1890,52 @@ Value VM::eval_expr(const IRExpr& expr, size_t row_idx) {
             break;
         }
 
+            // ================================================================
+            // String Predicates - starts_with, ends_with, contains, iequals
+            // ================================================================
+            // Pops a string, pushes whether it matches the pattern operand
+
+        case IRExpr::OpCode::STARTS_WITH:
+        case IRExpr::OpCode::ENDS_WITH:
+        case IRExpr::OpCode::CONTAINS:
+        case IRExpr::OpCode::IEQUALS: {
+            Value a = stack_.back();
+            stack_.pop_back();
+
+            if (a.is_null()) {
+                stack_.push_back(Value::make_null());
+            } else if (a.is_string()) {
+                const auto& pattern = std::get<std::string>(instr.operand);
+                stack_.push_back(Value::make_bool(
+                    string_matches(*string_match_of(instr.op), a.as_string(), pattern)));
+            } else {
+                throw RuntimeError("String function on non-string value");
+            }
+            break;
+        }
+
+            // ================================================================
+            // Logical AND / OR - Boolean Combination
+            // ================================================================
+            // Both operands are evaluated (no short-circuit inside bytecode;
+            // a filter's top-level and/or is a LOGICAL_FILTER instead)
+            // NULL counts as false, as in filters
+
+        case IRExpr::OpCode::AND:
+        case IRExpr::OpCode::OR: {
+            Value b = stack_.back();
+            stack_.pop_back();
+            Value a = stack_.back();
+            stack_.pop_back();
+
+            const char* name = instr.op == IRExpr::OpCode::AND ? "AND" : "OR";
+            bool a_val = truthy(a, name);
+            bool b_val = truthy(b, name);
+            bool result = instr.op == IRExpr::OpCode::AND ? a_val && b_val : a_val || b_val;
+            stack_.push_back(Value::make_bool(result));
+            break;
+        }
+
         case IRExpr::OpCode::TERNARY: {
             // Stack has: [..., condition, true_val, false_val]
             // Pop in reverse order
@@ -1307,6 +1964,159 @@ Value VM::eval_expr(const IRExpr& expr, size_t row_idx) {
             stack_.push_back(cond_result ? true_val : false_val);
             break;
         }
+
+            // ================================================================
+            // Typed Instructions - Emitted by the Binder
+            // ================================================================
+            // Operand types were checked before execution, so these only
+            // handle NULL and skip the is_int()/is_double()/... dispatch
+
+        case IRExpr::OpCode::CAST_F64:
+            if (!stack_.back().is_null()) {
+                stack_.back() = Value::make_double(static_cast<double>(stack_.back().as_int()));
+            }
+            break;
+
+        case IRExpr::OpCode::ADD_I64:
+            typed_arith<int64_t>(stack_, [](int64_t a, int64_t b) { return a + b; });
+            break;
+        case IRExpr::OpCode::ADD_F64:
+            typed_arith<double>(stack_, [](double a, double b) { return a + b; });
+            break;
+        case IRExpr::OpCode::SUB_I64:
+            typed_arith<int64_t>(stack_, [](int64_t a, int64_t b) { return a - b; });
+            break;
+        case IRExpr::OpCode::SUB_F64:
+            typed_arith<double>(stack_, [](double a, double b) { return a - b; });
+            break;
+        case IRExpr::OpCode::MUL_I64:
+            typed_arith<int64_t>(stack_, [](int64_t a, int64_t b) { return a * b; });
+            break;
+        case IRExpr::OpCode::MUL_F64:
+            typed_arith<double>(stack_, [](double a, double b) { return a * b; });
+            break;
+        case IRExpr::OpCode::DIV_I64:
+            typed_arith<int64_t>(stack_, [](int64_t a, int64_t b) {
+                if (b == 0)
+                    throw RuntimeError("Division by zero");
+                return divide(a, b);
+            });
+            break;
+        case IRExpr::OpCode::DIV_F64:
+            typed_arith<double>(stack_, [](double a, double b) {
+                if (b == 0.0)
+                    throw RuntimeError("Division by zero");
+                return a / b;
+            });
+            break;
+        case IRExpr::OpCode::NEG_I64:
+            if (!stack_.back().is_null()) {
+                stack_.back() = Value::make_int(-stack_.back().as_int());
+            }
+            break;
+        case IRExpr::OpCode::NEG_F64:
+            if (!stack_.back().is_null()) {
+                stack_.back() = Value::make_double(-stack_.back().as_double());
+            }
+            break;
+
+        case IRExpr::OpCode::EQ_I64:
+            typed_compare<int64_t>(stack_, std::equal_to<>());
+            break;
+        case IRExpr::OpCode::NEQ_I64:
+            typed_compare<int64_t>(stack_, std::not_equal_to<>());
+            break;
+        case IRExpr::OpCode::LT_I64:
+            typed_compare<int64_t>(stack_, std::less<>());
+            break;
+        case IRExpr::OpCode::GT_I64:
+            typed_compare<int64_t>(stack_, std::greater<>());
+            break;
+        case IRExpr::OpCode::LTE_I64:
+            typed_compare<int64_t>(stack_, std::less_equal<>());
+            break;
+        case IRExpr::OpCode::GTE_I64:
+            typed_compare<int64_t>(stack_, std::greater_equal<>());
+            break;
+        case IRExpr::OpCode::EQ_F64:
+            typed_compare<double>(stack_, std::equal_to<>());
+            break;
+        case IRExpr::OpCode::NEQ_F64:
+            typed_compare<double>(stack_, std::not_equal_to<>());
+            break;
+        case IRExpr::OpCode::LT_F64:
+            typed_compare<double>(stack_, std::less<>());
+            break;
+        case IRExpr::OpCode::GT_F64:
+            typed_compare<double>(stack_, std::greater<>());
+            break;
+        case IRExpr::OpCode::LTE_F64:
+            typed_compare<double>(stack_, std::less_equal<>());
+            break;
+        case IRExpr::OpCode::GTE_F64:
+            typed_compare<double>(stack_, std::greater_equal<>());
+            break;
+        case IRExpr::OpCode::EQ_STR:
+            typed_compare<std::string_view>(stack_, std::equal_to<>());
+            break;
+        case IRExpr::OpCode::NEQ_STR:
+            typed_compare<std::string_view>(stack_, std::not_equal_to<>());
+            break;
+        case IRExpr::OpCode::LT_STR:
+            typed_compare<std::string_view>(stack_, std::less<>());
+            break;
+        case IRExpr::OpCode::GT_STR:
+            typed_compare<std::string_view>(stack_, std::greater<>());
+            break;
+        case IRExpr::OpCode::LTE_STR:
+            typed_compare<std::string_view>(stack_, std::less_equal<>());
+            break;
+        case IRExpr::OpCode::GTE_STR:
+            typed_compare<std::string_view>(stack_, std::greater_equal<>());
+            break;
+        case IRExpr::OpCode::EQ_BOOL:
+            typed_compare<bool>(stack_, std::equal_to<>());
+            break;
+        case IRExpr::OpCode::NEQ_BOOL:
+            typed_compare<bool>(stack_, std::not_equal_to<>());
+            break;
+
+        case IRExpr::OpCode::EQ_I64_CONST:
+            compare_const<int64_t>(stack_, instr.operand, std::equal_to<>());
+            break;
+        case IRExpr::OpCode::NEQ_I64_CONST:
+            compare_const<int64_t>(stack_, instr.operand, std::not_equal_to<>());
+            break;
+        case IRExpr::OpCode::LT_I64_CONST:
+            compare_const<int64_t>(stack_, instr.operand, std::less<>());
+            break;
+        case IRExpr::OpCode::GT_I64_CONST:
+            compare_const<int64_t>(stack_, instr.operand, std::greater<>());
+            break;
+        case IRExpr::OpCode::LTE_I64_CONST:
+            compare_const<int64_t>(stack_, instr.operand, std::less_equal<>());
+            break;
+        case IRExpr::OpCode::GTE_I64_CONST:
+            compare_const<int64_t>(stack_, instr.operand, std::greater_equal<>());
+            break;
+        case IRExpr::OpCode::EQ_F64_CONST:
+            compare_const<double>(stack_, instr.operand, std::equal_to<>());
+            break;
+        case IRExpr::OpCode::NEQ_F64_CONST:
+            compare_const<double>(stack_, instr.operand, std::not_equal_to<>());
+            break;
+        case IRExpr::OpCode::LT_F64_CONST:
+            compare_const<double>(stack_, instr.operand, std::less<>());
+            break;
+        case IRExpr::OpCode::GT_F64_CONST:
+            compare_const<double>(stack_, instr.operand, std::greater<>());
+            break;
+        case IRExpr::OpCode::LTE_F64_CONST:
+            compare_const<double>(stack_, instr.operand, std::less_equal<>());
+            break;
+        case IRExpr::OpCode::GTE_F64_CONST:
+            compare_const<double>(stack_, instr.operand, std::greater_equal<>());
+            break;
         }
     }
 
@@ -0,0 +1,191 @@
+// ============================================================================
+// embed_api - Tests of the Embedding API (joy.hpp)
+// ============================================================================
+// Runs queries through Query and Session the way an application would: CSV
+// text and Tables in memory, a caller-owned BatchReader, WRITE callbacks,
+// repeated runs on one Session (including a schema change between runs) and
+// the errors compile() and run() throw. Exits non-zero on the first failure
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "compiler.hpp"
+#include "joy.hpp"
+#include "parser.hpp"
+
+using namespace joy;
+
+#define CHECK(cond)                                                                   \
+    do {                                                                              \
+        if (!(cond)) {                                                                \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": CHECK(" #cond ") failed\n"; \
+            std::exit(1);                                                             \
+        }                                                                             \
+    } while (0)
+
+// Collects every batch a WRITE produces as text rows ("v1,v2,..."; NULL as "")
+struct Collected {
+    std::vector<std::string> names;
+    std::vector<ColumnType> types;
+    std::vector<std::string> rows;
+
+    BatchCallback callback() {
+        return [this](const Table& batch) {
+            names.clear();
+            types.clear();
+            for (const auto& col : batch.columns) {
+                names.push_back(col.name);
+                types.push_back(col.type);
+            }
+            for (size_t row = 0; row < batch.num_rows; ++row) {
+                std::string text;
+                for (size_t c = 0; c < batch.columns.size(); ++c) {
+                    const Column& col = batch.columns[c];
+                    text += c ? "," : "";
+                    if (col.is_null(row))
+                        continue;
+                    switch (col.type) {
+                    case ColumnType::INT64:
+                        text += std::to_string(col.get_int(row));
+                        break;
+                    case ColumnType::DOUBLE:
+                        text += std::to_string(col.get_double(row));
+                        break;
+                    case ColumnType::STRING:
+                        text += col.get_string(row);
+                        break;
+                    case ColumnType::BOOL:
+                        text += col.get_bool(row) ? "true" : "false";
+                        break;
+                    }
+                }
+                rows.push_back(std::move(text));
+            }
+        };
+    }
+};
+
+static const char* kQuery = R"(
+    from "requests"
+    filter status >= 500
+    transform slow = ms > 100
+    select path, status, slow
+    write "errors"
+)";
+
+static const char* kCsv =
+    "path,status,ms\n"
+    "/a,200,5\n"
+    "/b,500,150\n"
+    "/c,503,20\n"
+    "/d,404,300\n";
+
+// CSV text in, callback out; a second run on the same Session and Query
+static void test_run_csv() {
+    Query query = Query::compile(kQuery);
+    Session session;
+    for (int run = 0; run < 2; ++run) {
+        Collected out;
+        session.run_csv(query, kCsv, {{"errors", out.callback()}});
+        CHECK((out.names == std::vector<std::string>{"path", "status", "slow"}));
+        CHECK((out.rows == std::vector<std::string>{"/b,500,true", "/c,503,false"}));
+    }
+}
+
+// A new input schema between runs rebinds the plan (ms becomes DOUBLE)
+static void test_schema_change() {
+    Query query = Query::compile("from \"in\"\ntransform twice = ms * 2\nwrite \"out\"\n");
+    Session session;
+    Collected ints;
+    session.run_csv(query, "ms\n1\n2\n", {{"out", ints.callback()}});
+    CHECK(ints.types.back() == ColumnType::INT64);
+    CHECK((ints.rows == std::vector<std::string>{"1,2", "2,4"}));
+
+    Collected doubles;
+    session.run_csv(query, "ms\n1.5\n", {{"out", doubles.callback()}});
+    CHECK(doubles.types.back() == ColumnType::DOUBLE);
+    CHECK((doubles.rows == std::vector<std::string>{"1.500000,3.000000"}));
+}
+
+// A Table in, split into batches smaller than the table, over several threads
+static void test_run_table() {
+    VMOptions options;
+    options.batch_size = 2;
+    options.num_threads = 4;
+    Session session(options);
+    Query query = Query::compile("from \"in\"\nfilter id >= 4\nwrite \"out\"\n");
+
+    Table input;
+    Column id = Column::make("id", ColumnType::INT64);
+    for (int64_t i = 0; i < 9; ++i)
+        id.append_int(i);
+    input.add_column(std::move(id));
+    input.num_rows = 9;
+
+    Collected out;
+    session.run(query, std::move(input), {{"out", out.callback()}});
+    CHECK((out.rows == std::vector<std::string>{"4", "5", "6", "7", "8"}));
+}
+
+// A BatchReader the caller owns, with a declared column type
+static void test_run_reader() {
+    std::vector<DeclaredColumn> schema = {{"zip", ColumnType::STRING}};
+    const std::string csv = "zip,n\n02134,1\n10001,2\n";
+    CsvReader reader(std::string_view(csv), "zips", nullptr, nullptr, &schema);
+    Query query = Query::compile("from \"zips\" schema (zip string)\nwrite \"out\"\n");
+    Session session;
+    Collected out;
+    session.run(query, reader, {{"out", out.callback()}});
+    CHECK((out.rows == std::vector<std::string>{"02134,1", "10001,2"}));
+}
+
+// compile() throws ParseError and CompileError, run() RuntimeError
+static void test_errors() {
+    bool thrown = false;
+    try {
+        Query::compile("from \"in\"\nfilter\n");
+    } catch (const ParseError&) {
+        thrown = true;
+    }
+    CHECK(thrown);
+
+    thrown = false;
+    try {
+        Query::compile("from \"in\"\ngroup by k, k\n");
+    } catch (const CompileError&) {
+        thrown = true;
+    }
+    CHECK(thrown);
+
+    // An output callback for a WRITE the query does not have
+    Query query = Query::compile(kQuery);
+    Session session;
+    thrown = false;
+    try {
+        session.run_csv(query, kCsv, {{"nope", [](const Table&) {}}});
+    } catch (const RuntimeError&) {
+        thrown = true;
+    }
+    CHECK(thrown);
+
+    // A column the query needs is missing from the input
+    thrown = false;
+    try {
+        session.run_csv(query, "path,ms\n/a,1\n", {{"errors", [](const Table&) {}}});
+    } catch (const std::runtime_error&) {
+        thrown = true;
+    }
+    CHECK(thrown);
+}
+
+int main() {
+    test_run_csv();
+    test_schema_change();
+    test_run_table();
+    test_run_reader();
+    test_errors();
+    std::cout << "embed_api: all tests passed\n";
+    return 0;
+}
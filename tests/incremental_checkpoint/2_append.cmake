@@ -0,0 +1,2 @@
+# New rows, the last one still being written (no line break yet)
+file(APPEND ${WORK}/log.csv "4,error,7\n5,info,1\n6,err")
@@ -0,0 +1,2 @@
+# Finish the partly written row and add another
+file(APPEND ${WORK}/log.csv "or,40\n7,error,2\n")
@@ -0,0 +1,38 @@
+# Runs one pipeline test (see tests/README.md)
+#   cmake -DJOY=<joy executable> -DCASE=<test directory> -DWORK=<scratch directory>
+#         -P run_test.cmake
+
+file(REMOVE_RECURSE ${WORK})
+file(COPY ${CASE}/ DESTINATION ${WORK})
+
+set(args "")
+if(EXISTS ${CASE}/args)
+    file(READ ${CASE}/args args)
+    separate_arguments(args UNIX_COMMAND "${args}")
+endif()
+
+# Steps run in name order, so a later one can read an earlier one's output;
+# a .cmake step is a script run in between (e.g. to append to an input)
+file(GLOB steps RELATIVE ${WORK} ${WORK}/*.jy ${WORK}/*.cmake)
+list(SORT steps)
+foreach(step ${steps})
+    if(step MATCHES "\\.cmake$")
+        include(${WORK}/${step})
+        continue()
+    endif()
+    execute_process(COMMAND ${JOY} ${args} ${step}
+                    WORKING_DIRECTORY ${WORK}
+                    RESULT_VARIABLE result
+                    OUTPUT_VARIABLE output
+                    ERROR_VARIABLE output)
+    if(NOT result EQUAL 0)
+        message(FATAL_ERROR "${step} failed (${result}):\n${output}")
+    endif()
+endforeach()
+
+execute_process(COMMAND ${CMAKE_COMMAND} -E compare_files ${WORK}/out.csv ${CASE}/expected.csv
+                RESULT_VARIABLE differs)
+if(differs)
+    file(READ ${WORK}/out.csv actual)
+    message(FATAL_ERROR "out.csv differs from expected.csv:\n${actual}")
+endif()